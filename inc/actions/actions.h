@@ -302,6 +302,9 @@ DECLARE_SIMPLE (
   activate_selected_tracks_direct_out_new);
 DECLARE_SIMPLE (
   activate_toggle_track_passthrough_input);
+DECLARE_SIMPLE (
+  activate_toggle_track_loudness_analysis);
+DECLARE_SIMPLE (activate_reset_track_loudness);
 
 void
 activate_snap_events (
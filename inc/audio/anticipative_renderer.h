@@ -0,0 +1,376 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Anticipative (look-ahead) rendering of tracks
+ * that do not receive live input.
+ */
+
+#ifndef __AUDIO_ANTICIPATIVE_RENDERER_H__
+#define __AUDIO_ANTICIPATIVE_RENDERER_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include "zix/sem.h"
+#include <glib.h>
+
+typedef struct CompiledGraph CompiledGraph;
+typedef struct Graph         Graph;
+typedef struct GraphNode     GraphNode;
+typedef struct Track         Track;
+typedef struct AnticipativeRenderer
+  AnticipativeRenderer;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Frames the worker jumps ahead of the requested
+ * position when seeking, in blocks, so that it has
+ * time to catch up with the playhead.
+ */
+#define ANTICIPATIVE_SEEK_LEAD_BLOCKS 2
+
+/**
+ * Minimum number of chunks between the chunk
+ * being played and the first chunk that may be
+ * re-rendered after an edit.
+ */
+#define ANTICIPATIVE_INVALIDATE_MARGIN_CHUNKS 2
+
+typedef enum AnticipativeChunkState
+{
+  /** Rendered and not touched by the processing
+   * thread yet. */
+  ANTICIPATIVE_CHUNK_READY,
+
+  /** Being played by the processing thread. */
+  ANTICIPATIVE_CHUNK_READING,
+
+  /** Invalidated by an edit, to be skipped. */
+  ANTICIPATIVE_CHUNK_STALE,
+} AnticipativeChunkState;
+
+/**
+ * A block of pre-rendered pre-fader audio.
+ */
+typedef struct AnticipativeChunk
+{
+  float * l;
+  float * r;
+
+  /** Timeline position of the first frame, as seen
+   * by the track's fader. */
+  unsigned_frame_t g_start_frame;
+
+  nframes_t nframes;
+
+  /** Frames already played. */
+  nframes_t read_offset;
+
+  /** Seek request this chunk was rendered for. */
+  gint seek_gen;
+
+  /** Whether the chunk contains only silence. */
+  bool silent;
+
+  /** AnticipativeChunkState. */
+  volatile gint state;
+} AnticipativeChunk;
+
+/**
+ * A track whose pre-fader part (track processor,
+ * plugins and pre-fader) is rendered ahead of the
+ * playhead.
+ *
+ * The processing thread only runs the fader,
+ * which reads the rendered audio instead of the
+ * pre-fader output.
+ *
+ * These are owned by the CompiledGraph they were
+ * set up for.
+ */
+typedef struct AnticipativeTrack
+{
+  AnticipativeRenderer * renderer;
+
+  Track * track;
+
+  /** Nodes processed by the worker, in
+   * topological order. */
+  GraphNode ** nodes;
+  size_t       num_nodes;
+
+  /** Fader node (processed by the processing
+   * thread). */
+  GraphNode * fader_node;
+
+  /**
+   * Ring of rendered chunks (single producer,
+   * single consumer).
+   *
+   * The size is a power of 2.
+   */
+  AnticipativeChunk * chunks;
+  guint               num_chunks;
+
+  /** Capacity of each chunk, in frames. */
+  nframes_t chunk_size;
+
+  /** Max number of valid chunks to render ahead. */
+  guint max_chunks_ahead;
+
+  /** Next chunk to play (processing thread). */
+  volatile guint read_idx;
+
+  /** Next chunk to render (worker). */
+  volatile guint write_idx;
+
+  /* --- written by the processing thread --- */
+
+  /** Position to restart rendering at. */
+  unsigned_frame_t seek_pos;
+
+  /** Number of seek requests (incremented after
+   * setting \ref seek_pos). */
+  volatile gint seek_requests;
+
+  /** Number of times the processing thread had no
+   * rendered audio to play. */
+  volatile guint num_underruns;
+
+  /* --- written by the worker --- */
+
+  /** Position of the next chunk to render. */
+  unsigned_frame_t render_pos;
+
+  gint seek_requests_handled;
+  gint invalidations_handled;
+
+  /** Stale chunks are between these indices. */
+  guint stale_start;
+  guint stale_end;
+} AnticipativeTrack;
+
+/**
+ * Renders tracks that do not receive live input
+ * (not armed for recording, not monitored, not
+ * recording automation and not in the editor)
+ * ahead of the playhead in a background thread.
+ *
+ * Enabled with the ZRYTHM_DSP_ANTICIPATIVE_MS
+ * environment variable.
+ *
+ * The processing thread decides at the start of
+ * each cycle whether the tracks are rendered
+ * ahead (while rolling) or processed live, so a
+ * track's pre-fader part is only ever processed
+ * by one thread at a time.
+ */
+typedef struct AnticipativeRenderer
+{
+  Graph * graph;
+
+  /** How far ahead to render, in milliseconds. */
+  int lookahead_ms;
+
+  GThread * thread;
+
+  /** Wakes up the worker. */
+  ZixSem wake;
+
+  volatile gint terminate;
+
+  /**
+   * Set from the thread that recalculates the
+   * graph to have tracks processed live (e.g.,
+   * while swapping graphs).
+   */
+  volatile gint enabled;
+
+  /**
+   * Whether the processing thread plays the
+   * rendered audio.
+   *
+   * Only changed by the processing thread at the
+   * start of a cycle (or when it is not
+   * processing the graph).
+   */
+  volatile gint ahead;
+
+  /** Set by the processing thread to have the
+   * worker stop rendering. */
+  volatile gint stop_requested;
+
+  /** Whether the worker may be rendering. */
+  volatile gint worker_running;
+
+  /** Incremented after edits. */
+  volatile gint invalidations;
+} AnticipativeRenderer;
+
+/**
+ * Returns a new renderer if enabled by the
+ * environment, or NULL.
+ */
+AnticipativeRenderer *
+anticipative_renderer_new (Graph * graph);
+
+/**
+ * Starts the worker thread.
+ */
+NONNULL
+void
+anticipative_renderer_start (
+  AnticipativeRenderer * self);
+
+/**
+ * Finds the tracks of the compiled graph that can
+ * be rendered ahead and prepares them.
+ *
+ * To be called after the graph is packed.
+ */
+NONNULL
+void
+anticipative_renderer_setup (
+  AnticipativeRenderer * self,
+  CompiledGraph *        compiled);
+
+/**
+ * Frees the anticipative tracks of the compiled
+ * graph.
+ */
+NONNULL
+void
+anticipative_renderer_free_tracks (
+  CompiledGraph * compiled);
+
+/**
+ * Has all tracks processed live and waits until
+ * the worker stopped using the current graph.
+ *
+ * To be called before swapping graphs.
+ */
+NONNULL
+void
+anticipative_renderer_pause (
+  AnticipativeRenderer * self);
+
+/**
+ * Allows rendering tracks ahead again.
+ */
+NONNULL
+void
+anticipative_renderer_resume (
+  AnticipativeRenderer * self);
+
+/**
+ * Switches between rendering ahead and live
+ * processing.
+ *
+ * To be called by the processing thread at the
+ * start of a cycle, after publishing the pending
+ * graph.
+ */
+HOT NONNULL void
+anticipative_renderer_begin_cycle (
+  AnticipativeRenderer *      self,
+  const CompiledGraph *       compiled,
+  const EngineProcessTimeInfo time_nfo);
+
+/**
+ * Returns whether the processing thread plays the
+ * rendered audio of the track's node.
+ */
+static inline bool
+anticipative_track_is_ahead (
+  const AnticipativeTrack * self)
+{
+  return self && self->renderer->ahead;
+}
+
+/**
+ * Returns whether the pre-fader part of the track
+ * is currently processed by the renderer.
+ *
+ * To be called by the processing thread.
+ */
+HOT bool
+anticipative_renderer_is_rendering_track (
+  const AnticipativeRenderer * self,
+  const Track *                track);
+
+/**
+ * Copies the rendered audio for the given range to
+ * the fader's inputs.
+ *
+ * To be called by the processing thread.
+ */
+HOT NONNULL void
+anticipative_track_read (
+  AnticipativeTrack *                 self,
+  const EngineProcessTimeInfo * const time_nfo);
+
+/**
+ * Re-renders the audio that was not played yet.
+ *
+ * To be called after the timeline is edited.
+ *
+ * @param self The renderer, or NULL.
+ */
+void
+anticipative_renderer_invalidate (
+  AnticipativeRenderer * self);
+
+/**
+ * Returns whether the track must be processed
+ * live (e.g., because it is armed for recording).
+ */
+NONNULL
+bool
+anticipative_renderer_track_needs_live_processing (
+  Track * track);
+
+/**
+ * To be called when a track starts or stops
+ * needing live processing, to recalculate the
+ * graph if the renderer is enabled.
+ */
+NONNULL
+void
+anticipative_renderer_on_track_live_changed (
+  Track * track);
+
+/**
+ * Returns whether the current thread is the
+ * worker.
+ */
+bool
+anticipative_renderer_is_current_thread (
+  const AnticipativeRenderer * self);
+
+/**
+ * Stops the worker thread.
+ */
+NONNULL
+void
+anticipative_renderer_terminate (
+  AnticipativeRenderer * self);
+
+NONNULL
+void
+anticipative_renderer_free (
+  AnticipativeRenderer * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -72,6 +72,59 @@ static const cyaml_strval_t
     { "<invalid>", NUM_AUTOMATION_RECORD_MODES },
 };
 
+/**
+ * State of the last automation read, so that
+ * reading while playing forward doesn't need to
+ * look up the region and automation point again.
+ *
+ * @see automation_track_read_normalized_val().
+ */
+typedef struct AutomationReadCache
+{
+  /** Edit generation the cache was filled in,
+   * or 0 if it was never filled. */
+  gint generation;
+
+  /** Whether the region was picked with
+   * ends_after. */
+  bool ends_after;
+
+  /** Timeline frames (start inclusive, end
+   * exclusive) in which \ref
+   * AutomationReadCache.region is the region
+   * picked. */
+  signed_frame_t region_start;
+  signed_frame_t region_end;
+
+  /** Region picked, if any. */
+  ZRegion * region;
+
+  /** Whether the segment below is filled in. */
+  bool has_segment;
+
+  /** Index of the automation point the segment
+   * starts at, or -1 if it is before the first
+   * one. */
+  int ap_idx;
+
+  /** Region-local frames (start inclusive, end
+   * exclusive) of the segment. */
+  signed_frame_t segment_start;
+  signed_frame_t segment_end;
+
+  /** Normalized value the curve starts from and
+   * difference to the value it ends at. */
+  float base_val;
+  float val_diff;
+
+  /** Whether the curve goes down. */
+  bool start_higher;
+
+  /** 1 / segment length in frames, or 0 after the
+   * last automation point. */
+  double inv_length;
+} AutomationReadCache;
+
 typedef struct AutomationTrack
 {
   int schema_version;
@@ -166,6 +219,10 @@ typedef struct AutomationTrack
 
   /** Cache used during DSP. */
   Port * port;
+
+  /** Cache used when reading automation during
+   * DSP. */
+  AutomationReadCache read_cache;
 } AutomationTrack;
 
 static const cyaml_schema_field_t
@@ -445,6 +502,39 @@ NONNULL
 void
 automation_track_clear (AutomationTrack * self);
 
+/**
+ * Marks that an automation region or point was
+ * edited, so that automation reads don't use
+ * stale cached state.
+ */
+void
+automation_track_bump_edit_generation (void);
+
+/**
+ * Reads the normalized automation value at the
+ * given frame during processing.
+ *
+ * This is equivalent to calling
+ * automation_track_get_ap_before_pos() and then
+ * automation_track_get_val_at_pos(), but it caches
+ * the region and the curve segment it reads from,
+ * so reading while playing forward is O(1).
+ *
+ * @param ends_after See
+ *   automation_track_get_ap_before_pos().
+ * @param[out] val The normalized value, set if
+ *   there is an automation point before @p frame.
+ *
+ * @return Whether @p val was set.
+ */
+NONNULL
+HOT bool
+automation_track_read_normalized_val (
+  AutomationTrack *    self,
+  const signed_frame_t frame,
+  const bool           ends_after,
+  float *              val);
+
 /**
  * Returns the actual parameter value at the given
  * position.
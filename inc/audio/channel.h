@@ -394,6 +394,25 @@ NONNULL
 void
 channel_prepare_process (Channel * channel);
 
+/**
+ * Prepares the part of the channel up to the
+ * pre-fader for processing.
+ *
+ * Used when the pre-fader part is processed
+ * separately by the anticipative renderer.
+ */
+NONNULL
+void
+channel_prepare_process_pre_fader (Channel * self);
+
+/**
+ * Prepares the fader and the rest of the channel
+ * after it for processing.
+ */
+NONNULL
+void
+channel_prepare_process_post_fader (Channel * self);
+
 /**
  * Creates a channel of the given type with the
  * given label.
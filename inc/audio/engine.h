@@ -715,6 +715,21 @@ typedef struct AudioEngine
   bool  denormal_prevention_val_positive;
   float denormal_prevention_val;
 
+  /**
+   * Whether denormals are flushed to zero (FTZ/DAZ)
+   * on the processing threads instead.
+   *
+   * When set, the denormal prevention value is 0,
+   * so silent buffers are plain zeroes.
+   *
+   * Set unless the CPU does not support it or
+   * ZRYTHM_DSP_DENORMAL_FILL is set.
+   *
+   * Processing threads apply it once when they
+   * start (see engine_init_process_thread()).
+   */
+  bool flush_denormals;
+
   /* --- trial version flags --- */
 
   /** Time at start to keep track if trial limit
@@ -972,6 +987,20 @@ engine_process_prepare (
   AudioEngine * self,
   nframes_t     nframes);
 
+/**
+ * Prepares the calling thread for processing
+ * (flushing denormals to zero if enabled).
+ *
+ * To be called by each implementation from the
+ * thread that calls engine_process(), when the
+ * thread starts, or at the start of its callback
+ * if the thread is owned by the backend. The
+ * graph threads call it when they start. Only the
+ * first call on each thread has any effect.
+ */
+NONNULL void
+engine_init_process_thread (AudioEngine * self);
+
 /**
  * Processes current cycle.
  *
@@ -119,6 +119,43 @@ bounce_step_to_str (BounceStep bounce_step)
   return bounce_step_str[bounce_step];
 }
 
+/**
+ * Highest true peak loudness normalization may
+ * raise the audio to, in dBTP.
+ */
+#define EXPORT_TRUE_PEAK_CEILING -1.f
+
+/**
+ * Loudness of an exported audio file, measured
+ * while rendering.
+ */
+typedef struct ExportLoudness
+{
+  /** Integrated loudness in LUFS. */
+  float integrated;
+
+  /** Loudness range in LU. */
+  float range;
+
+  /** Highest momentary loudness in LUFS. */
+  float max_momentary;
+
+  /** True peak in dBTP. */
+  float true_peak;
+
+  /** Gain applied by loudness normalization, in
+   * dB. */
+  float gain;
+} ExportLoudness;
+
+/**
+ * Returns a newly allocated human friendly
+ * description of the loudness.
+ */
+NONNULL
+char *
+export_loudness_to_str (const ExportLoudness * self);
+
 /**
  * Export settings to be passed to the exporter
  * to use.
@@ -167,6 +204,27 @@ typedef struct ExportSettings
    */
   bool dither;
 
+  /**
+   * Whether to normalize the integrated loudness
+   * to ExportSettings.loudness_target.
+   *
+   * The mix is rendered once to a temporary file
+   * while being measured, and then written with
+   * the normalization gain applied.
+   *
+   * The gain is limited so that the true peak
+   * does not exceed EXPORT_TRUE_PEAK_CEILING.
+   */
+  bool normalize_loudness;
+
+  /** Integrated loudness to normalize to, in
+   * LUFS. */
+  float loudness_target;
+
+  /** Loudness of the exported audio, filled in
+   * after exporting. */
+  ExportLoudness loudness;
+
   /**
    * Absolute path for export file.
    */
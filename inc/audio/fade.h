@@ -26,9 +26,11 @@
 #ifndef __AUDIO_FADE_H__
 #define __AUDIO_FADE_H__
 
-#include "utils/yaml.h"
+#include <stdbool.h>
 
-typedef struct CurveOptions CurveOptions;
+#include "audio/curve.h"
+#include "utils/types.h"
+#include "utils/yaml.h"
 
 /**
  * @addtogroup audio
@@ -48,6 +50,84 @@ fade_get_y_normalized (
   CurveOptions * opts,
   int            fade_in);
 
+/** Number of segments in a fade table. */
+#define FADE_TABLE_SIZE 1024
+
+/** Number of fade tables kept around. */
+#define FADE_TABLE_CACHE_SIZE 32
+
+/**
+ * Precomputed fade curve.
+ *
+ * Tables are shared and looked up by their curve
+ * options, so they should only be accessed through
+ * fade_table_acquire() and fade_table_release().
+ */
+typedef struct FadeTable
+{
+  CurveOptions opts;
+  bool         fade_in;
+
+  /** Whether the table has been filled. */
+  bool valid;
+
+  /** Y at x = i / FADE_TABLE_SIZE. */
+  float y[FADE_TABLE_SIZE + 1];
+
+  /** Number of users, or -1 while the table is
+   * being filled. */
+  volatile gint refcount;
+
+  /** Time the table was last acquired, used to
+   * pick the table to replace. */
+  volatile gint last_used;
+} FadeTable;
+
+/**
+ * Returns a table for the given fade, filling one
+ * if needed.
+ *
+ * This does not block, so it can be used in the
+ * audio threads.
+ *
+ * @return The table, or NULL if no table could be
+ *   used without waiting. Must be released with
+ *   fade_table_release().
+ */
+const FadeTable *
+fade_table_acquire (
+  const CurveOptions * opts,
+  bool                 fade_in);
+
+NONNULL
+void
+fade_table_release (const FadeTable * self);
+
+/**
+ * Multiplies the given frames with the fade.
+ *
+ * The fade is applied as linear segments between
+ * the points of a fade table. It is calculated
+ * for each frame near the edges, where steep
+ * curves bend too much for linear segments, for
+ * pulses, and when a table is not available.
+ *
+ * @param l Left channel.
+ * @param r Right channel.
+ * @param pos Position of the first frame in the
+ *   fade (0 to \p len inclusive).
+ * @param len Length of the fade in frames.
+ */
+HOT void
+fade_apply (
+  const CurveOptions * opts,
+  bool                 fade_in,
+  float *              l,
+  float *              r,
+  signed_frame_t       pos,
+  signed_frame_t       len,
+  nframes_t            nframes);
+
 /**
  * @}
  */
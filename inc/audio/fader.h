@@ -27,16 +27,18 @@
 #define __AUDIO_FADER_H__
 
 #include "audio/port.h"
+#include "utils/smoothed_value.h"
 #include "utils/types.h"
 #include "utils/yaml.h"
 
-typedef struct StereoPorts     StereoPorts;
-typedef struct Port            Port;
-typedef struct Channel         Channel;
-typedef struct AudioEngine     AudioEngine;
-typedef struct ControlRoom     ControlRoom;
-typedef struct SampleProcessor SampleProcessor;
-typedef struct PortIdentifier  PortIdentifier;
+typedef struct StereoPorts      StereoPorts;
+typedef struct Port             Port;
+typedef struct Channel          Channel;
+typedef struct AudioEngine      AudioEngine;
+typedef struct ControlRoom      ControlRoom;
+typedef struct SampleProcessor  SampleProcessor;
+typedef struct PortIdentifier   PortIdentifier;
+typedef struct LoudnessAnalyzer LoudnessAnalyzer;
 
 /**
  * @addtogroup audio
@@ -228,6 +230,31 @@ typedef struct Fader
    * graph. */
   bool implied_soloed;
   bool soloed;
+
+  /** Gains applied to the L and R outputs (amp
+   * and balance), ramped to avoid zipper noise. */
+  SmoothedValue gain_l;
+  SmoothedValue gain_r;
+
+  /** Mute level (1 when not muted). */
+  SmoothedValue mute_gain;
+
+  /** Dim levels applied by the monitor fader
+   * when there are listened tracks and when dim
+   * is enabled (1 when not dimmed). */
+  SmoothedValue listen_dim_gain;
+  SmoothedValue dim_gain;
+
+  /**
+   * Loudness analyzer of the output, created the
+   * first time loudness analysis is enabled.
+   *
+   * Not serialized.
+   */
+  LoudnessAnalyzer * loudness_analyzer;
+
+  /** Whether the output is analyzed. */
+  volatile gint analyze_loudness;
 } Fader;
 
 static const cyaml_schema_field_t fader_fields_schema[] = {
@@ -488,6 +515,28 @@ fader_disconnect_all (Fader * self);
 void
 fader_copy_values (Fader * src, Fader * dest);
 
+/**
+ * Sets whether the loudness of the output is
+ * analyzed.
+ *
+ * Only the output of channel faders can be
+ * analyzed. Analysis is enabled on the master
+ * channel by default.
+ */
+NONNULL
+void
+fader_set_loudness_analysis_enabled (
+  Fader * self,
+  bool    enabled);
+
+/**
+ * Returns the loudness analyzer of the output, or
+ * NULL if loudness analysis is disabled.
+ */
+NONNULL
+LoudnessAnalyzer *
+fader_get_loudness_analyzer (Fader * self);
+
 /**
  * Process the Fader.
  */
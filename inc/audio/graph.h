@@ -47,8 +47,20 @@ typedef struct Plugin          Plugin;
 typedef struct Position        Position;
 typedef struct GraphThread     GraphThread;
 typedef struct Router          Router;
+typedef struct PortConnection  PortConnection;
 typedef struct ModulatorMacroProcessor
   ModulatorMacroProcessor;
+typedef struct AnticipativeTrack AnticipativeTrack;
+typedef struct AnticipativeRenderer
+  AnticipativeRenderer;
+typedef struct GraphBufferPlan GraphBufferPlan;
+typedef struct MidiEvents      MidiEvents;
+typedef struct ZixRingImpl     ZixRing;
+typedef struct ZRegion         ZRegion;
+typedef struct AutomationTrack AutomationTrack;
+typedef struct WsDeque         WsDeque;
+typedef struct AutomationTracklist
+  AutomationTracklist;
 
 /**
  * @addtogroup audio
@@ -64,24 +76,184 @@ typedef struct ModulatorMacroProcessor
 
 #define MAX_GRAPH_THREADS 128
 
+/** Size of a CPU cache line, used for padding
+ * data written by multiple graph threads. */
+#define GRAPH_CACHE_LINE_SIZE 64
+
 /**
- * Graph.
+ * Strategy used to hand ready nodes to the graph
+ * threads.
  */
-typedef struct Graph
+typedef enum GraphSchedulerType
 {
-  /** Pointer back to router for convenience. */
-  Router * router;
+  /** All threads push to and pull from the shared
+   * trigger queue. */
+  GRAPH_SCHEDULER_TYPE_SHARED_QUEUE,
 
-  /** Flag to indicate if graph is currently getting
-   * destroyed. */
-  int destroying;
+  /** Nodes triggered by a graph thread are pushed
+   * to that thread's local deque and idle threads
+   * steal from the other threads' deques. */
+  GRAPH_SCHEDULER_TYPE_WORK_STEALING,
+} GraphSchedulerType;
+
+/**
+ * Port connections, owners and buffers computed
+ * while compiling a graph.
+ *
+ * These are applied to the port when the graph is
+ * published, so that Port.srcs and Port.dests
+ * always match the graph being processed and
+ * ports in use are never modified by the thread
+ * compiling the graph.
+ */
+typedef struct GraphPortTopology
+{
+  Port * port;
+
+  Port **           srcs;
+  PortConnection ** src_connections;
+  int               num_srcs;
+  size_t            srcs_size;
+
+  Port **           dests;
+  PortConnection ** dest_connections;
+  int               num_dests;
+  size_t            dests_size;
+
+  /** Owners to set on the port, if any. */
+  Plugin * plugin;
+  Track *  track;
+
+  /**
+   * Whether the port was missing DSP buffers (or
+   * they were too small) and gets the ones below.
+   *
+   * After publishing, these hold the previous
+   * buffers of the port until the graph is
+   * reclaimed.
+   */
+  bool         has_bufs;
+  float *      buf;
+  size_t       last_buf_sz;
+  bool         buf_in_arena;
+  ZixRing *    audio_ring;
+  MidiEvents * midi_events;
+  ZixRing *    midi_ring;
+} GraphPortTopology;
+
+/**
+ * Caches of a track computed while compiling a
+ * graph and applied when it is published (see
+ * track_set_caches()).
+ */
+typedef struct GraphTrackCaches
+{
+  Track *      track;
+  unsigned int name_hash;
+
+  /** Automation tracklist to update, or NULL. */
+  AutomationTracklist * atl;
+
+  /** Automation tracks and their ports. */
+  AutomationTrack ** ats;
+  Port **            at_ports;
+  int                num_ats;
+
+  /**
+   * Automation tracks in record mode, sized for
+   * all automation tracks.
+   *
+   * Swapped with
+   * AutomationTracklist.ats_in_record_mode when
+   * publishing.
+   */
+  AutomationTrack ** ats_in_record_mode;
+  int                num_ats_in_record_mode;
+} GraphTrackCaches;
+
+/**
+ * Port caches of a plugin computed while
+ * compiling a graph (see plugin_set_caches()).
+ *
+ * The arrays are swapped with the ones of the
+ * plugin when publishing.
+ */
+typedef struct GraphPluginCaches
+{
+  Plugin *    pl;
+  GPtrArray * ctrl_in_ports;
+  GPtrArray * audio_in_ports;
+  GPtrArray * cv_in_ports;
+  GPtrArray * midi_in_ports;
+} GraphPluginCaches;
+
+/**
+ * Reference count of a node in a packed schedule.
+ *
+ * Each one occupies its own cache line so that
+ * threads triggering different nodes do not
+ * contend for the same line.
+ */
+typedef struct GraphNodeRefcount
+{
+  _Alignas (GRAPH_CACHE_LINE_SIZE) volatile gint
+    refcount;
+} GraphNodeRefcount;
 
-  /** List of all graph nodes (only used for memory
-   * management) */
+/**
+ * A compiled graph.
+ *
+ * This is built by graph_setup() away from the
+ * processing threads and its topology is never
+ * modified after it is published, so that a new
+ * one can be compiled while the engine is running
+ * and swapped in at a cycle boundary.
+ */
+typedef struct CompiledGraph
+{
+  /** List of all graph nodes. */
   /** key = internal pointer, value = graph node. */
-  GHashTable * graph_nodes;
+  GHashTable * nodes;
+
+  /* --- packed schedule (see
+   * graph_rechain()) --- */
+
+  /**
+   * All graph nodes, in topological order.
+   *
+   * GraphNode.id is the index in this array.
+   * When set, this owns the nodes and the values
+   * in \ref CompiledGraph.nodes point here.
+   */
+  GraphNode * schedule;
+  size_t      schedule_size;
 
-  /* --- caches for current graph --- */
+  /**
+   * Child node indices (CSR): the children of
+   * schedule[i] are child_indices[child_offsets[i]]
+   * up to child_indices[child_offsets[i + 1]].
+   */
+  guint * child_offsets;
+  guint * child_indices;
+
+  /** Remaining parents per node in the current
+   * cycle, indexed like the schedule. */
+  GraphNodeRefcount * refcounts;
+
+  /** Recent processing times per node, indexed
+   * like the schedule. */
+  GraphNodeTimings * timings;
+
+  /** Tracks rendered ahead by the anticipative
+   * renderer (see anticipative_renderer_setup()). */
+  AnticipativeTrack * anticipative_tracks;
+  size_t              n_anticipative_tracks;
+
+  /** Port buffers of this graph, or NULL if
+   * Graph.use_buffer_arena is false. */
+  GraphBufferPlan * buffer_plan;
+
+  /* --- caches for this graph --- */
   GraphNode * bpm_node;
   GraphNode * beats_per_bar_node;
   GraphNode * beat_unit_node;
@@ -92,11 +264,122 @@ typedef struct Graph
   GraphNode ** init_trigger_list;
   size_t       n_init_triggers;
 
-  /* Terminal node reference count. */
-  /** Number of graph nodes without an outgoing
-   * edge. */
-  gint         n_terminal_nodes;
+  /** Graph nodes without an outgoing edge. */
   GraphNode ** terminal_nodes;
+  size_t       n_terminal_nodes;
+
+  /** Queue containing nodes that can be
+   * processed, sized to fit all nodes. */
+  MPMCQueue * trigger_queue;
+
+  /**
+   * Work-stealing deques sized to fit all nodes,
+   * to give to the threads when publishing (see
+   * GraphThread.deque), or NULL if theirs are big
+   * enough.
+   *
+   * Indexed like Graph.threads, with the main
+   * thread last. After publishing, this holds the
+   * previous deques of the threads until the
+   * graph is reclaimed.
+   */
+  WsDeque ** deques;
+  int        num_deques;
+
+  /**
+   * Port connections (GraphPortTopology) to apply
+   * when publishing.
+   *
+   * After publishing, the entries hold the
+   * previous arrays of the ports until the graph
+   * is reclaimed.
+   */
+  GArray * port_topologies;
+
+  /** Track caches (GraphTrackCaches) to apply
+   * when publishing. */
+  GArray * track_caches;
+
+  /** Plugin caches (GraphPluginCaches) to apply
+   * when publishing. */
+  GArray * plugin_caches;
+
+  /** Clip editor caches to apply when
+   * publishing (see clip_editor_set_caches()). */
+  ZRegion * clip_editor_region;
+  Track *   clip_editor_track;
+
+  /**
+   * An array of pointers to ports that are exposed
+   * to the backend and are outputs.
+   *
+   * Used to clear their buffers when returning
+   * early from the processing cycle.
+   */
+  GPtrArray * external_out_ports;
+
+  /**
+   * Graph replaced by this one when it was
+   * published, until it is reclaimed.
+   *
+   * Reclaiming it also frees the previous port
+   * state held by this graph.
+   */
+  struct CompiledGraph * replaced;
+
+  /** Graph.epoch when this graph was published. */
+  gint publish_epoch;
+
+  /**
+   * Port connections removed from the project
+   * before this graph was compiled.
+   *
+   * The graphs this one replaced may still use
+   * them, so they are freed along with the
+   * previous port state.
+   */
+  GPtrArray * removed_connections;
+} CompiledGraph;
+
+/**
+ * Graph.
+ */
+typedef struct Graph
+{
+  /** Pointer back to router for convenience. */
+  Router * router;
+
+  /** Flag to indicate if graph is currently getting
+   * destroyed. */
+  int destroying;
+
+  /** Graph currently used for processing. */
+  CompiledGraph * compiled;
+
+  /**
+   * Graph waiting to be published by the
+   * processing thread at the start of the next
+   * cycle, or NULL.
+   */
+  CompiledGraph * pending;
+
+  /**
+   * Port connections removed from the project
+   * since the last graph was compiled (see
+   * graph_free_connection_later()).
+   */
+  GPtrArray * removed_connections;
+
+  /**
+   * Number of engine cycles completed.
+   *
+   * A graph that was replaced can be reclaimed
+   * once the engine cycle that was running when
+   * it was replaced has finished, ie, when this is
+   * larger than the epoch at which it was
+   * replaced (see CompiledGraph.publish_epoch).
+   */
+  volatile gint epoch;
 
   /** Remaining unprocessed terminal nodes in this
    * cycle. */
@@ -109,10 +392,6 @@ typedef struct Graph
   /** Wake up graph node process threads. */
   ZixSem trigger;
 
-  /** Queue containing nodes that can be
-   * processed. */
-  MPMCQueue * trigger_queue;
-
   /** Number of entries in trigger queue. */
   volatile guint trigger_queue_size;
 
@@ -122,20 +401,55 @@ typedef struct Graph
   /** Number of threads waiting for work. */
   volatile guint idle_thread_cnt;
 
-  /** Chain used to setup in the background.
-   * This is applied and cleared by graph_rechain()
+  /**
+   * Scheduler in use.
+   *
+   * Read from the ZRYTHM_GRAPH_SCHEDULER
+   * environment variable ("queue" or
+   * "work-stealing") when the graph is created.
    */
-  /** key = internal pointer, value = graph node. */
-  GHashTable * setup_graph_nodes;
+  GraphSchedulerType scheduler_type;
 
-  GraphNode ** setup_init_trigger_list;
-  size_t       num_setup_init_triggers;
+  /**
+   * Time in microseconds that idle threads spin
+   * before going to sleep.
+   *
+   * Read from the ZRYTHM_DSP_SPIN_USEC environment
+   * variable (defaults to 0, i.e. sleep right
+   * away).
+   */
+  gint64 idle_spin_usec;
+
+  /**
+   * CPUs to pin the threads to, or none if
+   * ZRYTHM_DSP_THREAD_AFFINITY is not set.
+   *
+   * Threads are assigned round-robin, in the order
+   * they are created.
+   */
+  int cpus[MAX_GRAPH_THREADS];
+  int num_cpus;
+
+  /** Graph being compiled by graph_setup(). */
+  CompiledGraph * setup;
+
+  /**
+   * Renderer of tracks that do not receive live
+   * input, or NULL if disabled (see
+   * ZRYTHM_DSP_ANTICIPATIVE_MS).
+   */
+  AnticipativeRenderer * anticipative;
 
-  /** Used only when constructing the graph so we
-   * can traverse the graph backwards to calculate
-   * the playback latencies. */
-  GraphNode ** setup_terminal_nodes;
-  size_t       num_setup_terminal_nodes;
+  /**
+   * Whether to allocate the port buffers of each
+   * compiled graph from an arena and share them
+   * between ports where possible (see
+   * GraphBufferPlan).
+   *
+   * Read from the ZRYTHM_DSP_BUFFER_ARENA
+   * environment variable.
+   */
+  bool use_buffer_arena;
 
   /** Dummy member to make lookups work. */
   int initial_processor;
@@ -146,15 +460,6 @@ typedef struct Graph
   GraphThread * main_thread;
   gint          num_threads;
 
-  /**
-   * An array of pointers to ports that are exposed
-   * to the backend and are outputs.
-   *
-   * Used to clear their buffers when returning
-   * early from the processing cycle.
-   */
-  GPtrArray * external_out_ports;
-
 } Graph;
 
 void
@@ -255,9 +560,19 @@ graph_update_latencies (
   bool    use_setup_nodes);
 
 /*
- * Adds the graph nodes and connections, then
+ * Compiles the graph nodes and connections, then
  * rechains.
  *
+ * Compiling does not modify anything the running
+ * graph uses. Rechaining hands the compiled graph
+ * to the processing thread, which applies it and
+ * swaps it in at the start of the next cycle
+ * (or publishes it here if the engine is not
+ * running), and returns once it is live.
+ *
+ * The graph it replaced is reclaimed by a later
+ * call, once no thread can be processing it.
+ *
  * @param drop_unnecessary_ports Drops any ports
  *   that don't connect anywhere.
  * @param rechain Whether to rechain or not. If
@@ -269,6 +584,41 @@ graph_setup (
   const int drop_unnecessary_ports,
   const int rechain);
 
+/**
+ * Frees the given port connection once no graph
+ * can be using it anymore.
+ *
+ * To be called instead of port_connection_free()
+ * for connections removed from the project while
+ * the graph exists.
+ */
+NONNULL void
+graph_free_connection_later (
+  Graph *          self,
+  PortConnection * conn);
+
+/**
+ * Chooses again how \p port is processed by the
+ * live and pending graphs.
+ *
+ * To be called after the port was exposed to or
+ * unexposed from the backend.
+ */
+NONNULL void
+graph_update_port_process_func (
+  Graph * self,
+  Port *  port);
+
+/**
+ * Publishes the pending compiled graph, if any.
+ *
+ * To be called by the processing thread at the
+ * start of a cycle, before waking up the graph
+ * threads.
+ */
+HOT void
+graph_publish_pending (Graph * self);
+
 /**
  * Adds a new connection for the given
  * src and dest ports and validates the graph.
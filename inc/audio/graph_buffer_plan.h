@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Allocation of the audio/CV port buffers of a
+ * compiled graph from a single arena.
+ */
+
+#ifndef __AUDIO_GRAPH_BUFFER_PLAN_H__
+#define __AUDIO_GRAPH_BUFFER_PLAN_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct CompiledGraph CompiledGraph;
+typedef struct GraphNode     GraphNode;
+typedef struct Port          Port;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Alignment of the arena and of each buffer in
+ * it, in bytes. */
+#define GRAPH_BUFFER_PLAN_ALIGNMENT 64
+
+/**
+ * Max number of nodes for which buffers are
+ * shared.
+ *
+ * Finding buffers that can be shared needs
+ * n * n / 2 bits, so larger graphs only get their
+ * buffers packed.
+ */
+#define GRAPH_BUFFER_PLAN_MAX_SHARING_NODES 16384
+
+/**
+ * Buffer of a port in a GraphBufferPlan.
+ */
+typedef struct GraphBufferPlanEntry
+{
+  Port * port;
+
+  /**
+   * Buffer to give to the port when the graph is
+   * published.
+   *
+   * After publishing, this holds the previous
+   * buffer of the port until
+   * graph_buffer_plan_release_previous() is
+   * called.
+   */
+  float * buf;
+
+  /** Size of \ref buf, in floats. */
+  size_t buf_sz;
+
+  /** Whether \ref buf is in an arena. */
+  bool in_arena;
+} GraphBufferPlanEntry;
+
+/**
+ * Audio and CV port buffers of a compiled graph.
+ *
+ * Each port in the graph gets a block-sized,
+ * aligned slot in one arena. Ports whose buffers
+ * are only used while processing the graph share
+ * a slot when every node reading the buffer of
+ * one port always finishes before the node
+ * writing to the buffer of the next one starts,
+ * whichever thread processes them.
+ *
+ * Shared slots are cleared by the writer of each
+ * port but the first before it is processed (see
+ * graph_buffer_plan_clear_node_buffers()).
+ *
+ * Enabled with the ZRYTHM_DSP_BUFFER_ARENA
+ * environment variable.
+ */
+typedef struct GraphBufferPlan
+{
+  /** Memory allocated for the arena. */
+  void * arena_mem;
+
+  /** Start of the arena (aligned). */
+  float * arena;
+
+  /** Size of the arena, in bytes. */
+  size_t arena_size;
+
+  /** Size the arena would have if no slots were
+   * shared, in bytes. */
+  size_t unshared_size;
+
+  /** Number of slots in the arena. */
+  size_t num_slots;
+
+  /** Number of ports that reuse a slot of another
+   * port. */
+  size_t num_shared;
+
+  /**
+   * Buffers to apply when publishing.
+   *
+   * Ports in the arena of the previous graph that
+   * are not in this graph anymore get a new buffer
+   * of their own.
+   */
+  GraphBufferPlanEntry * entries;
+  size_t                 num_entries;
+
+  /**
+   * Slots to clear before processing each node
+   * (CSR): the slots of schedule[i] are
+   * clear_bufs[clear_offsets[i]] up to
+   * clear_bufs[clear_offsets[i + 1]].
+   */
+  guint *  clear_offsets;
+  float ** clear_bufs;
+} GraphBufferPlan;
+
+/**
+ * Plans the buffers of the ports of the compiled
+ * graph.
+ *
+ * To be called after the graph is packed and the
+ * anticipative renderer is set up.
+ */
+NONNULL
+GraphBufferPlan *
+graph_buffer_plan_new (CompiledGraph * compiled);
+
+/**
+ * Gives the planned buffers to the ports.
+ *
+ * To be called when publishing the graph.
+ */
+HOT NONNULL void
+graph_buffer_plan_apply (GraphBufferPlan * self);
+
+/**
+ * Frees the buffers the ports had before the plan
+ * was applied.
+ *
+ * To be called once no thread can be processing
+ * the previous graph.
+ */
+NONNULL
+void
+graph_buffer_plan_release_previous (
+  GraphBufferPlan * self);
+
+/**
+ * Clears the shared slots that the node writes to
+ * for the given range.
+ */
+HOT NONNULL void
+graph_buffer_plan_clear_node_buffers (
+  const GraphBufferPlan *             self,
+  const GraphNode *                   node,
+  const EngineProcessTimeInfo * const time_nfo);
+
+NONNULL
+void
+graph_buffer_plan_free (GraphBufferPlan * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -46,6 +46,7 @@
 
 #include <stdbool.h>
 
+#include "audio/port.h"
 #include "utils/types.h"
 
 #include <gtk/gtk.h>
@@ -62,6 +63,7 @@ TYPEDEF_STRUCT (HardwareProcessor);
 TYPEDEF_STRUCT (ModulatorMacroProcessor);
 TYPEDEF_STRUCT (EngineProcessTimeInfo);
 TYPEDEF_STRUCT (ChannelSend);
+TYPEDEF_STRUCT (AnticipativeTrack);
 
 /**
  * @addtogroup audio
@@ -69,6 +71,18 @@ TYPEDEF_STRUCT (ChannelSend);
  * @{
  */
 
+/**
+ * Weight of the latest measurement in
+ * GraphNode.cost.
+ */
+#define GRAPH_NODE_COST_EWMA_ALPHA 0.1f
+
+/**
+ * Number of recent processing times kept per
+ * node (must be a power of 2).
+ */
+#define GRAPH_NODE_TIMING_RING_SIZE 128
+
 /**
  * Graph nodes can be either ports or processors.
  *
@@ -125,19 +139,46 @@ typedef struct GraphNode
   GraphNode ** childnodes;
   int          n_childnodes;
 
-  /** Incoming node count. */
-  volatile gint refcount;
-
-  /** Initial incoming node count. */
+  /** Incoming node count.
+   *
+   * The count remaining in the current cycle is
+   * kept in CompiledGraph.refcounts. */
   gint init_refcount;
 
   /** Used when creating the graph so we can
    * traverse it backwards to set the latencies. */
   GraphNode ** parentnodes;
 
+  /**
+   * Next node in a fused chain, if any.
+   *
+   * This is set when the graph is packed if this
+   * node's only child has no other parent. The
+   * child is then processed right after this node
+   * by the same thread instead of going through
+   * the trigger queue.
+   */
+  GraphNode * chain_next;
+
   /** Port, if not a plugin or fader. */
   Port * port;
 
+  /**
+   * Routine that processes \ref port, or NULL if
+   * the port needs no processing.
+   *
+   * Chosen when the node is created, along with
+   * \ref port_process_flags, and again when the
+   * port is exposed to or unexposed from the
+   * backend (see graph_node_update_port_process_func()).
+   */
+  PortProcessFunc  process_port;
+  PortProcessFlags port_process_flags;
+
+  /** Whether \ref port is owned by the engine
+   * (not processed when exporting). */
+  bool engine_port;
+
   /** Plugin, if plugin. */
   Plugin * pl;
 
@@ -164,6 +205,36 @@ typedef struct GraphNode
   bool terminal;
   bool initial;
 
+  /**
+   * Exponentially weighted moving average of the
+   * time taken to process this node, in
+   * microseconds (0 if not measured yet).
+   *
+   * Carried over when the graph is recompiled.
+   */
+  float cost;
+
+  /**
+   * Estimated time from the start of this node
+   * until the end of the longest path through its
+   * descendants, in microseconds.
+   *
+   * Calculated when the graph is packed and used
+   * to start the longest paths first.
+   */
+  float critical_path;
+
+  /**
+   * Track rendered ahead that this node belongs
+   * to, if any.
+   *
+   * Set on the nodes processed by the
+   * anticipative renderer and on the track's fader
+   * and fader inputs, which play the rendered
+   * audio instead.
+   */
+  AnticipativeTrack * anticipative;
+
   /** The playback latency of the node, in
    * samples. */
   nframes_t playback_latency;
@@ -174,6 +245,37 @@ typedef struct GraphNode
   GraphNodeType type;
 } GraphNode;
 
+/**
+ * Lock-free ring of the most recent processing
+ * times of a node, in microseconds.
+ *
+ * Only the thread processing the node writes to
+ * it, so readers may see a slot being overwritten
+ * but never block the engine.
+ */
+typedef struct GraphNodeTimings
+{
+  float samples[GRAPH_NODE_TIMING_RING_SIZE];
+
+  /** Total number of samples written. */
+  volatile guint num_written;
+} GraphNodeTimings;
+
+/**
+ * Statistics over the recent processing times of
+ * a node, in microseconds.
+ */
+typedef struct GraphNodeTimingStats
+{
+  float min;
+  float mean;
+  float p99;
+
+  /** Number of samples the statistics are
+   * calculated from. */
+  int num_samples;
+} GraphNodeTimingStats;
+
 /**
  * Returns a human friendly name of the node.
  *
@@ -194,6 +296,33 @@ graph_node_print_to_str (
 void
 graph_node_print (GraphNode * node);
 
+/**
+ * Returns the track the node belongs to, if any.
+ */
+Track *
+graph_node_get_track (GraphNode * self);
+
+/**
+ * Returns the plugin the node belongs to, if any.
+ */
+Plugin *
+graph_node_get_plugin (GraphNode * self);
+
+/**
+ * Calculates statistics over the recent processing
+ * times of the node.
+ *
+ * The node must be part of the live (compiled)
+ * graph. Must be called from the thread that
+ * recalculates the graph.
+ *
+ * @return Whether any samples were available.
+ */
+NONNULL bool
+graph_node_get_timing_stats (
+  GraphNode *            self,
+  GraphNodeTimingStats * stats);
+
 /**
  * Processes the GraphNode.
  */
@@ -202,6 +331,18 @@ graph_node_process (
   GraphNode *           node,
   EngineProcessTimeInfo time_nfo);
 
+/**
+ * Processes the node for the anticipative
+ * renderer.
+ *
+ * Unlike graph_node_process(), this does not
+ * trigger the children or measure the time taken.
+ */
+HOT void
+graph_node_process_ahead (
+  GraphNode *           node,
+  EngineProcessTimeInfo time_nfo);
+
 /**
  * Returns the latency of only the given port,
  * without adding the previous/next latencies.
@@ -255,6 +396,18 @@ graph_node_new (
   GraphNodeType type,
   void *        data);
 
+/**
+ * Chooses again how the port of the node is
+ * processed.
+ *
+ * To be called after the port was exposed to or
+ * unexposed from the backend, while the graph is
+ * not being processed.
+ */
+NONNULL void
+graph_node_update_port_process_func (
+  GraphNode * self);
+
 void
 graph_node_free (GraphNode * node);
 
@@ -58,7 +58,10 @@
 #  include <lsp-plug.in/dsp/dsp.h>
 #endif
 
-typedef struct Graph Graph;
+typedef struct Graph      Graph;
+typedef struct GraphNode  GraphNode;
+typedef struct WsDeque    WsDeque;
+typedef struct ZixSemImpl ZixSem;
 
 /**
  * @addtogroup audio
@@ -81,6 +84,16 @@ typedef struct GraphThread
   /** Pointer back to the graph. */
   Graph * graph;
 
+  /** Local deque of ready nodes, used by the
+   * work-stealing scheduler.
+   *
+   * Replaced by a bigger one when a bigger graph
+   * is published (see CompiledGraph.deques). */
+  WsDeque * deque;
+
+  /** CPU the thread is pinned to, or -1. */
+  int cpu;
+
 #ifdef HAVE_LSP_DSP
   /** LSP DSP context. */
   lsp_dsp_context_t lsp_ctx;
@@ -100,6 +113,48 @@ graph_thread_new (
   const bool is_main,
   Graph *    graph);
 
+/**
+ * Hands a node that became ready to the
+ * scheduler.
+ *
+ * When using the work-stealing scheduler and
+ * called from a graph thread, the node is pushed
+ * to the calling thread's deque. Otherwise it is
+ * pushed to the shared trigger queue.
+ */
+HOT NONNULL void
+graph_thread_schedule_node (
+  Graph *     graph,
+  GraphNode * node);
+
+/**
+ * Hints the CPU that the calling thread is
+ * busy-waiting.
+ */
+static inline void
+graph_thread_cpu_relax (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause ();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__ ("yield");
+#endif
+}
+
+/**
+ * Waits for @p sem to be posted.
+ *
+ * The thread spins for up to
+ * Graph.idle_spin_usec first, so that it can pick
+ * up work posted soon after without paying the
+ * wake-up latency of sleeping.
+ */
+HOT NONNULL void
+graph_thread_wait (Graph * graph, ZixSem * sem);
+
+void
+graph_thread_free (GraphThread * self);
+
 /**
  * @}
  */
@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Incremental EBU R128 loudness analyzer.
+ */
+
+#ifndef __AUDIO_LOUDNESS_ANALYZER_H__
+#define __AUDIO_LOUDNESS_ANALYZER_H__
+
+#include <glib.h>
+
+#include "utils/types.h"
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Number of 100 ms sub-blocks in a short-term
+ * (3 s) window. */
+#define LOUDNESS_ANALYZER_SUBBLOCKS 30
+
+/** Number of 100 ms sub-blocks in a momentary
+ * (400 ms) window. */
+#define LOUDNESS_ANALYZER_MOMENTARY_SUBBLOCKS 4
+
+/** Number of 100 ms sub-blocks between short-term
+ * values used for the loudness range. */
+#define LOUDNESS_ANALYZER_SHORT_TERM_HOP 10
+
+/** Lowest loudness kept in the histograms (the
+ * absolute gate), in LUFS. */
+#define LOUDNESS_ANALYZER_HISTOGRAM_MIN -70.0
+
+/** Histogram bins per LU. */
+#define LOUDNESS_ANALYZER_BINS_PER_LU 10
+
+/** Number of histogram bins, from the absolute
+ * gate up to +10 LUFS. */
+#define LOUDNESS_ANALYZER_HISTOGRAM_BINS \
+  (80 * LOUDNESS_ANALYZER_BINS_PER_LU)
+
+/**
+ * Loudness analyzer following ITU-R BS.1770 and
+ * EBU R128 / Tech 3342.
+ *
+ * The K-weighted signal is summed in 100 ms
+ * sub-blocks, from which the momentary (400 ms)
+ * and short-term (3 s) loudness are derived.
+ *
+ * Instead of keeping every gating block, the
+ * blocks are counted in histograms of 0.1 LU
+ * bins, so each block costs O(1) and the memory
+ * used does not grow with the duration. The
+ * integrated loudness and the loudness range are
+ * calculated from the histograms when requested,
+ * which is accurate to the width of a bin.
+ *
+ * Processing must happen on a single thread. The
+ * values can be read from any thread.
+ */
+typedef struct LoudnessAnalyzer
+{
+  sample_rate_t sample_rate;
+
+  /**
+   * K-weighting coefficients (b0, b1, b2, a1, a2)
+   * of the pre-filter and the RLB filter.
+   */
+  double coeffs[2][5];
+
+  /** Filter states for each channel and stage. */
+  double z[2][2][2];
+
+  /** Number of samples in a sub-block. */
+  nframes_t subblock_len;
+
+  /** Samples summed in the current sub-block. */
+  nframes_t subblock_pos;
+
+  /** Sum of the weighted squares of the current
+   * sub-block. */
+  double subblock_sum;
+
+  /** Mean squares of the last sub-blocks (ring
+   * buffer). */
+  double subblocks[LOUDNESS_ANALYZER_SUBBLOCKS];
+
+  /** Index of the next sub-block to write. */
+  unsigned int subblock_idx;
+
+  /** Number of sub-blocks processed so far
+   * (saturated). */
+  unsigned int num_subblocks;
+
+  /** Sub-blocks until the next short-term value
+   * for the loudness range. */
+  unsigned int short_term_countdown;
+
+  /** Counts of the 400 ms gating blocks. */
+  volatile gint
+    block_hist[LOUDNESS_ANALYZER_HISTOGRAM_BINS];
+
+  /** Counts of the 3 s short-term values. */
+  volatile gint short_term_hist
+    [LOUDNESS_ANALYZER_HISTOGRAM_BINS];
+
+  /** Last momentary and short-term loudness, as
+   * float bits. */
+  volatile gint momentary;
+  volatile gint short_term;
+
+  /** Highest momentary loudness, as float bits. */
+  volatile gint max_momentary;
+
+  /** Set by other threads to restart the
+   * measurement on the next cycle. */
+  volatile gint reset_requested;
+} LoudnessAnalyzer;
+
+/**
+ * Returns a new analyzer for the given sample
+ * rate.
+ */
+LoudnessAnalyzer *
+loudness_analyzer_new (sample_rate_t sample_rate);
+
+/**
+ * Restarts the measurement, optionally at a new
+ * sample rate.
+ *
+ * Must not be called while processing.
+ *
+ * @see loudness_analyzer_request_reset().
+ */
+NONNULL
+void
+loudness_analyzer_reset (
+  LoudnessAnalyzer * self,
+  sample_rate_t      sample_rate);
+
+/**
+ * Restarts the measurement at the beginning of
+ * the next call to loudness_analyzer_process().
+ *
+ * Can be called from any thread.
+ */
+NONNULL
+void
+loudness_analyzer_request_reset (
+  LoudnessAnalyzer * self);
+
+/**
+ * Analyzes the given stereo samples, which
+ * continue the ones of the previous call.
+ */
+NONNULL
+HOT void
+loudness_analyzer_process (
+  LoudnessAnalyzer * self,
+  const float *      l,
+  const float *      r,
+  nframes_t          nframes);
+
+/**
+ * Returns the momentary loudness in LUFS, or
+ * -INFINITY if nothing was measured yet.
+ */
+NONNULL
+float
+loudness_analyzer_get_momentary (
+  LoudnessAnalyzer * self);
+
+/**
+ * Returns the highest momentary loudness in
+ * LUFS.
+ */
+NONNULL
+float
+loudness_analyzer_get_max_momentary (
+  LoudnessAnalyzer * self);
+
+/**
+ * Returns the short-term loudness in LUFS.
+ */
+NONNULL
+float
+loudness_analyzer_get_short_term (
+  LoudnessAnalyzer * self);
+
+/**
+ * Returns the integrated (gated) loudness in
+ * LUFS, or -INFINITY if no block passed the
+ * gates.
+ */
+NONNULL
+float
+loudness_analyzer_get_integrated (
+  LoudnessAnalyzer * self);
+
+/**
+ * Returns the loudness range (LRA) in LU.
+ */
+NONNULL
+float
+loudness_analyzer_get_range (
+  LoudnessAnalyzer * self);
+
+NONNULL
+void
+loudness_analyzer_free (LoudnessAnalyzer * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -28,11 +28,11 @@
 
 #include <stdbool.h>
 
+#include "audio/true_peak_detector.h"
 #include "utils/types.h"
 
 #include <gtk/gtk.h>
 
-typedef struct TruePeakDsp TruePeakDsp;
 typedef struct KMeterDsp   KMeterDsp;
 typedef struct PeakDsp     PeakDsp;
 typedef struct Port        Port;
@@ -55,28 +55,69 @@ typedef enum MeterAlgorithm
   METER_ALGORITHM_TRUE_PEAK,
   METER_ALGORITHM_RMS,
   METER_ALGORITHM_K,
+  NUM_METER_ALGORITHMS,
 } MeterAlgorithm;
 
 /**
- * A Meter used by a single GUI element.
+ * Meter DSP run by the engine at the end of each
+ * cycle for a port with meters, shared by all
+ * the meters of the port.
+ *
+ * The values are published as a seqlock-protected
+ * snapshot so the UI never touches the DSP state
+ * or the port buffer.
  */
-typedef struct Meter
+typedef struct MeterProcessor
 {
-  /** Port associated with this meter. */
-  Port * port;
+  PeakDsp *        peak_processor;
+  KMeterDsp *      kmeter_processor;
+  TruePeakDetector true_peak_detector;
+
+  /** Number of meters using each algorithm.
+   *
+   * Only the algorithms in use are processed. */
+  volatile gint num_users[NUM_METER_ALGORITHMS];
+
+  /** Reference count (one for the port and one
+   * per meter), so that meters can outlive the
+   * port. */
+  volatile gint refcount;
 
-  /** True peak processor. */
-  TruePeakDsp * true_peak_processor;
-  TruePeakDsp * true_peak_max_processor;
+  /** Set by the UI after reading a snapshot, so
+   * that the values held since the last read
+   * are restarted. */
+  volatile gint read;
 
-  /** Current true peak. */
+  /** Max RMS since the last read. */
+  float rms;
+
+  /** Max true peak since the last read. */
   float true_peak;
-  float true_peak_max;
 
-  /** K RMS processor, if K meter. */
-  KMeterDsp * kmeter_processor;
+  /**
+   * Snapshot sequence number.
+   *
+   * Odd while a snapshot is being written, and 0
+   * until the first one is written.
+   */
+  volatile gint seq;
+
+  /** Amplitude and max amplitude of each
+   * algorithm (float bits). */
+  volatile gint amps[NUM_METER_ALGORITHMS];
+  volatile gint max_amps[NUM_METER_ALGORITHMS];
+} MeterProcessor;
+
+/**
+ * A Meter used by a single GUI element.
+ */
+typedef struct Meter
+{
+  /** Port associated with this meter. */
+  Port * port;
 
-  PeakDsp * peak_processor;
+  /** Port's meter processor, if audio/CV. */
+  MeterProcessor * processor;
 
   /**
    * Algorithm to use.
@@ -101,6 +142,26 @@ typedef struct Meter
 
 } Meter;
 
+/**
+ * Processes a cycle's worth of samples and
+ * publishes the results.
+ *
+ * To be called by the engine at the end of each
+ * cycle.
+ */
+HOT NONNULL void
+meter_processor_process (
+  MeterProcessor * self,
+  float *          buf,
+  nframes_t        nframes);
+
+/**
+ * Releases a reference to the processor and frees
+ * it if it was the last one.
+ */
+void
+meter_processor_unref (MeterProcessor * self);
+
 Meter *
 meter_new_for_port (Port * port);
 
@@ -54,6 +54,10 @@ typedef struct ChordDescriptor ChordDescriptor;
 /** Max events to hold in queues. */
 #define MAX_MIDI_EVENTS 2560
 
+/** Max sorted runs that midi_events_merge_runs()
+ * can merge at once. */
+#define MIDI_EVENTS_MAX_RUNS 32
+
 /**
  * Timed MIDI event.
  */
@@ -424,12 +428,51 @@ midi_events_copy_to_jack (
 
 /**
  * Sorts the MidiEvents by time.
+ *
+ * Events at the same time are sorted by type, with
+ * note offs before note ons, and then by their
+ * bytes.
  */
 void
 midi_events_sort (
   MidiEvents * self,
   const bool   queued);
 
+/**
+ * Sorts the events from @p start onwards in the
+ * same order as midi_events_sort().
+ *
+ * This is linear when the events are nearly
+ * sorted, like the events filled from a region.
+ *
+ * @param queued Sort queued events instead.
+ */
+void
+midi_events_sort_run (
+  MidiEvents * self,
+  const int    start,
+  const bool   queued);
+
+/**
+ * Merges consecutive runs of sorted events into a
+ * single sorted run and drops duplicate events, in
+ * a single pass.
+ *
+ * @param run_starts Index of the first event of
+ *   each run, in ascending order, starting from 0.
+ *   Each run ends where the next one starts and the
+ *   last one at the end of the events.
+ * @param num_runs Number of runs, up to
+ *   MIDI_EVENTS_MAX_RUNS.
+ * @param queued Merge queued events instead.
+ */
+void
+midi_events_merge_runs (
+  MidiEvents * self,
+  const int *  run_starts,
+  const int    num_runs,
+  const bool   queued);
+
 /**
  * Sets the given MIDI channel on all applicable
  * MIDI events.
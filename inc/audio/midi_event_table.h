@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Table of the note on/off events of a MIDI region
+ * sorted by time.
+ */
+
+#ifndef __AUDIO_MIDI_EVENT_TABLE_H__
+#define __AUDIO_MIDI_EVENT_TABLE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <glib.h>
+
+#include "utils/snapshot_publisher.h"
+#include "utils/types.h"
+
+typedef struct MidiNote MidiNote;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * A note on or note off in a MidiEventTable.
+ */
+typedef struct MidiEventTableEntry
+{
+  /** Region-local frame of the event, copied from
+   * the note's start or end position. */
+  signed_frame_t frame;
+
+  MidiNote * note;
+
+  /** Whether this is the note off (end) of the
+   * note. */
+  bool note_off;
+} MidiEventTableEntry;
+
+/**
+ * Copy of the entries of a MidiEventTable read by
+ * the processing threads.
+ *
+ * A snapshot is never modified after it is
+ * published.
+ */
+typedef struct MidiEventTableSnapshot
+{
+  MidiEventTableEntry * entries;
+  int                   num_entries;
+} MidiEventTableSnapshot;
+
+/**
+ * Note ons and note offs of the notes of a MIDI
+ * region as separate entries sorted by frame.
+ *
+ * The events in a range are the entries from
+ * midi_event_table_find_first() until the first
+ * entry after the range, which costs O(log n + k)
+ * per lookup, and O(1) for sequential lookups
+ * thanks to a cursor that remembers where the last
+ * lookup started.
+ *
+ * The table is updated from the GUI thread
+ * whenever a note is added, removed, moved or
+ * resized. Each update publishes a new snapshot
+ * of the entries for the processing threads, which
+ * read it between midi_event_table_acquire() and
+ * midi_event_table_release(). Updates made during
+ * a snapshot_publisher_begin_batch() batch are
+ * published once at the end of it.
+ *
+ * A zeroed table is a valid empty table.
+ */
+typedef struct MidiEventTable
+{
+  /** Entries, only accessed from the GUI
+   * thread. */
+  MidiEventTableEntry * entries;
+  int                   num_entries;
+  size_t                entries_size;
+
+  /** Snapshots of the entries. */
+  SnapshotPublisher publisher;
+
+  /** Result of the last lookup. */
+  volatile gint cursor;
+} MidiEventTable;
+
+/**
+ * Adds the note on and note off of the note to the
+ * table.
+ */
+NONNULL
+void
+midi_event_table_add_note (
+  MidiEventTable * self,
+  MidiNote *       note);
+
+/**
+ * Removes the events of the note from the table.
+ *
+ * @return Whether the note was in the table.
+ */
+NONNULL
+bool
+midi_event_table_remove_note (
+  MidiEventTable * self,
+  MidiNote *       note);
+
+/**
+ * Moves the events of the note to their new place
+ * in the table after its start or end position
+ * changed.
+ *
+ * Does nothing if the note is not in the table.
+ */
+NONNULL
+void
+midi_event_table_update_note (
+  MidiEventTable * self,
+  MidiNote *       note);
+
+/**
+ * Rebuilds the table from the given notes.
+ */
+void
+midi_event_table_rebuild (
+  MidiEventTable *   self,
+  MidiNote * const * notes,
+  int                num_notes);
+
+/**
+ * Returns the latest snapshot of the entries, or
+ * NULL if the table is empty.
+ *
+ * To be called by the processing threads. The
+ * snapshot stays valid until
+ * midi_event_table_release().
+ */
+NONNULL
+HOT const MidiEventTableSnapshot *
+midi_event_table_acquire (MidiEventTable * self);
+
+/**
+ * Releases the snapshot returned by
+ * midi_event_table_acquire().
+ */
+NONNULL
+HOT void
+midi_event_table_release (MidiEventTable * self);
+
+/**
+ * Returns the index of the first entry of the
+ * snapshot at or after @p frame.
+ */
+NONNULL
+HOT int
+midi_event_table_find_first (
+  MidiEventTable *               self,
+  const MidiEventTableSnapshot * snapshot,
+  const signed_frame_t           frame);
+
+/**
+ * Frees the entries and the snapshots and empties
+ * the table.
+ *
+ * Must not be called while the table is being
+ * read.
+ */
+NONNULL
+void
+midi_event_table_clear (MidiEventTable * self);
+
+/**
+ * @}
+ */
+
+#endif
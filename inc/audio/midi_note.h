@@ -91,6 +91,12 @@ typedef struct MidiNote
   /** Index in the parent region. */
   int pos;
 
+  /** Frames of the note on and the note off in
+   * the region's MidiEventTable, which differ from
+   * the positions while the table is being
+   * updated after a move. */
+  signed_frame_t event_table_frames[2];
+
   int magic;
 
   /** Cache layout for drawing the name. */
@@ -154,6 +160,17 @@ midi_note_set_region_and_index (
   ZRegion *  region,
   int        idx);
 
+/**
+ * Updates the event table of the region the note
+ * is in after the note was moved or resized.
+ *
+ * Does nothing if the note is not in a region of
+ * the project (eg, if it is a clone).
+ */
+NONNULL
+void
+midi_note_update_event_table (MidiNote * self);
+
 void
 midi_note_set_cache_val (
   MidiNote *    self,
@@ -66,6 +66,7 @@ typedef struct RtMidiDevice    RtMidiDevice;
 typedef struct RtAudioDevice   RtAudioDevice;
 typedef struct AutomationTrack AutomationTrack;
 typedef struct TruePeakDsp     TruePeakDsp;
+typedef struct MeterProcessor  MeterProcessor;
 typedef struct ExtPort         ExtPort;
 typedef struct AudioClip       AudioClip;
 typedef struct ChannelSend     ChannelSend;
@@ -195,6 +196,27 @@ typedef struct Port
    */
   float * buf;
 
+  /**
+   * Whether \ref buf is in the buffer arena of a
+   * graph (see GraphBufferPlan), in which case it
+   * is owned by the graph and must not be freed or
+   * reallocated.
+   */
+  bool buf_in_arena;
+
+  /**
+   * Whether the buffer is known to contain only
+   * silence for the part of the cycle processed so
+   * far.
+   *
+   * This is reset when the buffer is cleared and
+   * only set by code that writes to the buffer
+   * and knows nothing audible was written (see
+   * port_mark_silent()), so false does not
+   * necessarily mean there is sound.
+   */
+  bool is_silent;
+
   /**
    * Contains raw MIDI data (MIDI ports only)
    */
@@ -359,6 +381,15 @@ typedef struct Port
    */
   gint64 last_change;
 
+  /**
+   * Incremented whenever \ref Port.control is
+   * set to a new value.
+   *
+   * Used to detect control changes without
+   * comparing values.
+   */
+  volatile gint control_generation;
+
   /** Pointer to owner plugin, if any. */
   Plugin * plugin;
 
@@ -459,9 +490,22 @@ typedef struct Port
    * cycles' worth of buffers.
    *
    * This is also used for CV.
+   *
+   * Only written to while
+   * \ref Port.write_ring_buffers is set (meters
+   * use \ref Port.meter_processor instead).
    */
   ZixRing * audio_ring;
 
+  /**
+   * Meter values calculated during processing,
+   * if the port has (or had) meters.
+   *
+   * Created by the first meter and accessed
+   * atomically.
+   */
+  MeterProcessor * meter_processor;
+
   /**
    * Ring buffer for saving MIDI events to be
    * used in the UI instead of directly accessing
@@ -595,6 +639,57 @@ static const cyaml_schema_value_t port_schema = {
   YAML_VALUE_PTR_NULLABLE (Port, port_fields_schema),
 };
 
+/**
+ * Per-port work that does not depend on the
+ * routine the port is processed with.
+ *
+ * Decided by port_get_process_func() when the
+ * graph is built.
+ */
+typedef enum PortProcessFlags
+{
+  /** Limit the summed signal (faders). */
+  PORT_PROCESS_FLAG_LIMIT = 1 << 0,
+
+  /** Calculate the peak shown on the mixer
+   * (channel outputs). */
+  PORT_PROCESS_FLAG_METER = 1 << 1,
+
+  /** Add the signal to the master output when
+   * bouncing the track directly to master. */
+  PORT_PROCESS_FLAG_BOUNCE_TO_MASTER = 1 << 2,
+
+  /** Master input, cleared when bouncing tracks
+   * without their parents. */
+  PORT_PROCESS_FLAG_MASTER_INPUT = 1 << 3,
+
+  /** Track processor input, which only receives
+   * external data while the track is armed for
+   * recording. */
+  PORT_PROCESS_FLAG_TRACK_INPUT = 1 << 4,
+
+  /** Show the notes in the piano roll (track
+   * processor MIDI output). */
+  PORT_PROCESS_FLAG_PIANO_ROLL = 1 << 5,
+
+  /** Notify the track of MIDI activity. */
+  PORT_PROCESS_FLAG_MIDI_ACTIVITY = 1 << 6,
+
+  /** Hardware MIDI port (MIDI mappings, CC
+   * capture, etc.). */
+  PORT_PROCESS_FLAG_HW_MIDI = 1 << 7,
+} PortProcessFlags;
+
+/**
+ * Routine that processes a port on each cycle.
+ *
+ * @see port_get_process_func().
+ */
+typedef void (*PortProcessFunc) (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo);
+
 /**
  * L & R port, for convenience.
  *
@@ -703,6 +798,23 @@ NONNULL
 void
 port_allocate_bufs (Port * self);
 
+/**
+ * Allocates the buffers port_allocate_bufs()
+ * would allocate without giving them to the port.
+ *
+ * Buffers not used by the port type are set to
+ * NULL.
+ */
+NONNULL
+void
+port_new_bufs (
+  const Port *  self,
+  float **      buf,
+  size_t *      buf_sz,
+  ZixRing **    audio_ring,
+  MidiEvents ** midi_events,
+  ZixRing **    midi_ring);
+
 /**
  * Frees buffers.
  *
@@ -800,6 +912,50 @@ port_receive_audio_data_from_jack (
   const nframes_t nframes);
 #endif
 
+/**
+ * Records whether silence was written to the
+ * given range of the buffer.
+ *
+ * The port stays marked as silent only if all the
+ * ranges written in this cycle were silent.
+ */
+NONNULL
+static inline void
+port_mark_silent (
+  Port *          self,
+  const nframes_t local_offset,
+  const bool      silent)
+{
+  self->is_silent =
+    silent && (local_offset == 0 || self->is_silent);
+}
+
+/**
+ * Returns whether both ports are known to be
+ * silent.
+ */
+NONNULL
+static inline bool
+stereo_ports_is_silent (const StereoPorts * sp)
+{
+  return sp->l->is_silent && sp->r->is_silent;
+}
+
+/**
+ * Records whether silence was written to the
+ * given range of both ports.
+ */
+NONNULL
+static inline void
+stereo_ports_mark_silent (
+  StereoPorts *   sp,
+  const nframes_t local_offset,
+  const bool      silent)
+{
+  port_mark_silent (sp->l, local_offset, silent);
+  port_mark_silent (sp->r, local_offset, silent);
+}
+
 /**
  * If MIDI port, returns if there are any events,
  * if audio port, returns if there is sound in the
@@ -1054,17 +1210,27 @@ port_apply_fader (
 }
 
 /**
- * First sets port buf to 0, then sums the given
- * port signal from its inputs.
+ * Decides how the port is to be processed.
+ *
+ * The role of the port (audio sum, CV sum, MIDI
+ * merge, hardware input, backend output or
+ * automatable control) is derived once, so that
+ * processing it on each cycle is a direct call.
+ *
+ * To be called when the graph is built, and
+ * again when the port is exposed to or unexposed
+ * from the backend.
+ *
+ * @param[out] flags Flags to pass to the returned
+ *   function.
  *
- * @param noroll Clear the port buffer in this
- *   range.
+ * @return The function to process the port with,
+ *   or NULL if the port needs no processing.
  */
-HOT NONNULL void
-port_process (
-  Port *                      port,
-  const EngineProcessTimeInfo time_nfo,
-  const bool                  noroll);
+NONNULL PortProcessFunc
+port_get_process_func (
+  Port *             self,
+  PortProcessFlags * flags);
 
 #define ports_connected(a, b) \
   (port_connections_manager_find_connection ( \
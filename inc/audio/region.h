@@ -27,6 +27,7 @@
 
 #include "audio/automation_point.h"
 #include "audio/chord_object.h"
+#include "audio/midi_event_table.h"
 #include "audio/midi_note.h"
 #include "audio/midi_region.h"
 #include "audio/position.h"
@@ -125,6 +126,10 @@ typedef struct ZRegion
   int         num_midi_notes;
   size_t      midi_notes_size;
 
+  /** Note ons/offs of the MIDI notes sorted by
+   * time, used during playback. */
+  MidiEventTable midi_event_table;
+
   /**
    * Unended notes started in recording with
    * MIDI NOTE ON
@@ -402,6 +407,30 @@ region_print (const ZRegion * region);
 TrackLane *
 region_get_lane (const ZRegion * region);
 
+/**
+ * Returns the region at the position of @p id in
+ * its lane, or NULL if there is none.
+ *
+ * Unlike region_find(), this doesn't warn if the
+ * track, lane or region doesn't exist.
+ */
+NONNULL
+ZRegion *
+region_find_in_lane (
+  const RegionIdentifier * id,
+  bool                     is_auditioner);
+
+/**
+ * Updates the region index of the lane the region
+ * is in after the region was moved or resized.
+ *
+ * Does nothing if the region is not in a lane of
+ * the project (eg, if it is a clone).
+ */
+NONNULL
+void
+region_update_lane_index (ZRegion * self);
+
 /**
  * Returns the region's link group.
  */
@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Index for looking up the regions of a lane that
+ * are hit by a range.
+ */
+
+#ifndef __AUDIO_REGION_INDEX_H__
+#define __AUDIO_REGION_INDEX_H__
+
+#include <stddef.h>
+
+#include <glib.h>
+
+#include "utils/snapshot_publisher.h"
+#include "utils/types.h"
+
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * An entry in a RegionIndex.
+ *
+ * The positions are copied from the region so that
+ * the entries stay ordered until the index is
+ * updated.
+ */
+typedef struct RegionIndexEntry
+{
+  ZRegion * region;
+
+  /** Start and end frames of the region. */
+  signed_frame_t start;
+  signed_frame_t end;
+
+  /** Highest end frame of this and all the
+   * previous entries. */
+  signed_frame_t max_end;
+} RegionIndexEntry;
+
+/**
+ * Copy of the entries of a RegionIndex read by the
+ * processing threads.
+ *
+ * A snapshot is never modified after it is
+ * published.
+ */
+typedef struct RegionIndexSnapshot
+{
+  RegionIndexEntry * entries;
+  int                num_entries;
+} RegionIndexSnapshot;
+
+/**
+ * Regions of a lane sorted by their start
+ * position, augmented with the highest end
+ * position up to each entry.
+ *
+ * The regions hit by a range are the entries from
+ * region_index_find_first() until the first entry
+ * starting after the range, minus the ones ending
+ * before it. When regions don't overlap this
+ * costs O(log n + k) per lookup, and O(1) for
+ * sequential lookups thanks to a cursor that
+ * remembers where the last lookup started.
+ *
+ * The index is updated from the GUI thread
+ * whenever a region is added, removed, moved or
+ * resized. Each update publishes a new snapshot
+ * of the entries for the processing threads, which
+ * read it between region_index_acquire() and
+ * region_index_release(). Updates made during a
+ * snapshot_publisher_begin_batch() batch are
+ * published once at the end of it.
+ *
+ * A zeroed index is a valid empty index.
+ */
+typedef struct RegionIndex
+{
+  /** Entries, only accessed from the GUI
+   * thread. */
+  RegionIndexEntry * entries;
+  int                num_entries;
+  size_t             entries_size;
+
+  /** Snapshots of the entries. */
+  SnapshotPublisher publisher;
+
+  /** Result of the last lookup. */
+  volatile gint cursor;
+} RegionIndex;
+
+/**
+ * Adds the region to the index.
+ */
+NONNULL
+void
+region_index_add (
+  RegionIndex * self,
+  ZRegion *     region);
+
+/**
+ * Removes the region from the index.
+ *
+ * @return Whether the region was in the index.
+ */
+NONNULL
+bool
+region_index_remove (
+  RegionIndex * self,
+  ZRegion *     region);
+
+/**
+ * Moves the region to its new place in the index
+ * after its start or end position changed.
+ *
+ * Does nothing if the region is not in the index.
+ */
+NONNULL
+void
+region_index_update (
+  RegionIndex * self,
+  ZRegion *     region);
+
+/**
+ * Rebuilds the index from the given regions.
+ */
+void
+region_index_rebuild (
+  RegionIndex *    self,
+  ZRegion * const * regions,
+  int              num_regions);
+
+/**
+ * Returns the latest snapshot of the entries, or
+ * NULL if the index is empty.
+ *
+ * To be called by the processing threads. The
+ * snapshot stays valid until
+ * region_index_release().
+ */
+NONNULL
+HOT const RegionIndexSnapshot *
+region_index_acquire (RegionIndex * self);
+
+/**
+ * Releases the snapshot returned by
+ * region_index_acquire().
+ */
+NONNULL
+HOT void
+region_index_release (RegionIndex * self);
+
+/**
+ * Returns the index of the first entry of the
+ * snapshot that may be hit by a range starting at
+ * @p frame.
+ *
+ * Entries from here on until the first entry that
+ * starts after the range must be checked against
+ * the range.
+ */
+NONNULL
+HOT int
+region_index_find_first (
+  RegionIndex *               self,
+  const RegionIndexSnapshot * snapshot,
+  const signed_frame_t        frame);
+
+/**
+ * Frees the entries and the snapshots and empties
+ * the index.
+ *
+ * Must not be called while the index is being
+ * read.
+ */
+NONNULL
+void
+region_index_clear (RegionIndex * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -1031,8 +1031,10 @@ track_remove_region (
  * @param stereo_ports StereoPorts to fill.
  * @param midi_events MidiEvents to fill (from
  *   Piano Roll Port for example).
+ *
+ * @return Whether any region was filled in.
  */
-void
+bool
 track_fill_events (
   const Track *                       self,
   const EngineProcessTimeInfo * const time_nfo,
@@ -27,6 +27,7 @@
 #define __AUDIO_TRACK_LANE_H__
 
 #include "audio/region.h"
+#include "audio/region_index.h"
 #include "utils/yaml.h"
 
 typedef struct _TrackLaneWidget   TrackLaneWidget;
@@ -87,6 +88,10 @@ typedef struct TrackLane
   int        num_regions;
   size_t     regions_size;
 
+  /** Regions sorted by position, for looking up
+   * the regions to play back. */
+  RegionIndex region_index;
+
   /**
    * MIDI channel, if MIDI lane, starting at 1.
    *
@@ -28,6 +28,7 @@
 
 #include "audio/port.h"
 #include "utils/midi.h"
+#include "utils/smoothed_value.h"
 #include "utils/types.h"
 #include "utils/yaml.h"
 
@@ -170,6 +171,11 @@ typedef struct TrackProcessor
   Track * track;
 
   int magic;
+
+  /** Input and output gains, ramped to avoid
+   * zipper noise. */
+  SmoothedValue smoothed_input_gain;
+  SmoothedValue smoothed_output_gain;
 } TrackProcessor;
 
 static const cyaml_schema_field_t track_processor_fields_schema[] = {
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Polyphase true peak detector.
+ */
+
+#ifndef __AUDIO_TRUE_PEAK_DETECTOR_H__
+#define __AUDIO_TRUE_PEAK_DETECTOR_H__
+
+#include "utils/dsp_simd.h"
+#include "utils/types.h"
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * True peak detector following ITU-R BS.1770.
+ *
+ * The signal is interpolated 4x with a polyphase
+ * FIR filter and only the maximum is kept, so
+ * unlike TruePeakDsp nothing is resampled into a
+ * buffer and no allocation is needed.
+ */
+typedef struct TruePeakDetector
+{
+  /** Last samples of the previous call. */
+  float history[DSP_TRUE_PEAK_TAPS - 1];
+} TruePeakDetector;
+
+/**
+ * Forgets the previous samples.
+ */
+NONNULL
+void
+true_peak_detector_reset (TruePeakDetector * self);
+
+/**
+ * Returns the true peak of the given samples,
+ * which continue the ones of the previous call.
+ */
+NONNULL
+HOT float
+true_peak_detector_process (
+  TruePeakDetector * self,
+  const float *      buf,
+  nframes_t          nframes);
+
+/**
+ * @}
+ */
+
+#endif
@@ -70,6 +70,10 @@ typedef struct _FaderControlsGridWidget
 
   double meter_reading_val;
 
+  /** Short-term loudness last shown, if the
+   * loudness is analyzed. */
+  double loudness_reading_val;
+
   /** Last MIDI event trigger time, for MIDI
    * output. */
   gint64 last_midi_trigger_time;
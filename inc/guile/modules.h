@@ -61,6 +61,8 @@ guile_actions_undo_manager_define_module (void);
 void
 guile_audio_channel_define_module (void);
 void
+guile_audio_graph_define_module (void);
+void
 guile_audio_midi_note_define_module (void);
 void
 guile_audio_midi_region_define_module (void);
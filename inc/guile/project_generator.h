@@ -26,7 +26,8 @@
 #ifndef __GUILE_PROJECT_GENERATOR_H__
 #define __GUILE_PROJECT_GENERATOR_H__
 
-typedef struct Project Project;
+typedef struct Project       Project;
+typedef struct PluginSetting PluginSetting;
 
 /**
  * @addtogroup guile
@@ -34,6 +35,65 @@ typedef struct Project Project;
  * @{
  */
 
+/**
+ * Parameters for generating a synthetic project
+ * of a given size, eg for load testing.
+ *
+ * @see guile_project_generator_params_init().
+ */
+typedef struct ProjectGeneratorParams
+{
+  /** Number of tracks of each type. */
+  int num_midi_tracks;
+  int num_instrument_tracks;
+  int num_audio_tracks;
+  int num_audio_busses;
+
+  /** Lanes per MIDI, instrument and audio
+   * track. */
+  int num_lanes;
+
+  /** Regions in each lane. */
+  int regions_per_lane;
+
+  /** Length of each region, in bars. */
+  int region_bars;
+
+  /** MIDI notes in each MIDI region. */
+  int notes_per_region;
+
+  /** Automation points on the fader of each
+   * track (0 for no automation). */
+  int automation_points;
+
+  /** Sends from each instrument and audio track
+   * to the busses. */
+  int sends_per_track;
+
+  /** Plugins inserted in each instrument and
+   * audio track and bus. */
+  int plugins_per_track;
+
+  /** Plugin used for the insert chains (required
+   * if \ref plugins_per_track is positive). */
+  PluginSetting * plugin_setting;
+
+  /** Plugin used for the instrument tracks
+   * (required if \ref num_instrument_tracks is
+   * positive). */
+  PluginSetting * instrument_setting;
+} ProjectGeneratorParams;
+
+/**
+ * Initializes the parameters to a project without
+ * tracks, where each track gets 4 lanes of 8
+ * regions of 4 bars, 64 notes per MIDI region and
+ * 256 automation points.
+ */
+void
+guile_project_generator_params_init (
+  ProjectGeneratorParams * params);
+
 /**
  * Generates a Zrythm project from the script
  * contained in @ref script.
@@ -62,6 +122,20 @@ guile_project_generator_generate_project_from_file (
   const char * filepath,
   const char * prj_path);
 
+/**
+ * Generates a Zrythm project with the tracks,
+ * regions, automation, sends and plugins given in
+ * @ref params.
+ *
+ * @param prj_path Path to save the project at.
+ *
+ * @return Non-zero if fail.
+ */
+int
+guile_project_generator_generate_project_from_params (
+  const ProjectGeneratorParams * params,
+  const char *                   prj_path);
+
 /**
  * @}
  */
@@ -33,6 +33,7 @@
 #include "plugins/plugin_identifier.h"
 #include "plugins/plugin_preset.h"
 #include "settings/plugin_settings.h"
+#include "utils/smoothed_value.h"
 #include "utils/types.h"
 
 /* pulled in from X11 */
@@ -74,6 +75,16 @@ typedef struct _WrappedObjectWithChangeSignal
 #define PLUGIN_MIN_SCALE_FACTOR 0.5f
 #define PLUGIN_MAX_SCALE_FACTOR 4.f
 
+/**
+ * Seconds of silent output after which a plugin
+ * whose inputs are silent is no longer processed.
+ *
+ * Plugins don't declare their tail length so it
+ * is measured instead. This must be long enough
+ * to cover the gaps between delay repeats.
+ */
+#define PLUGIN_SILENT_TAIL_SECONDS 4
+
 #define plugin_is_in_active_project(self) \
   (self->track \
    && track_is_in_active_project (self->track))
@@ -156,6 +167,10 @@ typedef struct Plugin
    */
   Port * gain;
 
+  /** Gain applied to the audio outputs, ramped to
+   * avoid zipper noise. */
+  SmoothedValue smoothed_gain;
+
   /**
    * Instrument left stereo output, for convenience.
    *
@@ -179,6 +194,23 @@ typedef struct Plugin
    * in samples. */
   nframes_t latency;
 
+  /**
+   * Number of frames the plugin has been
+   * outputting silence for while its inputs were
+   * silent.
+   *
+   * @see PLUGIN_SILENT_TAIL_SECONDS.
+   */
+  nframes_t silent_out_frames;
+
+  /** Sum of the control generations of the
+   * control inputs when \ref
+   * Plugin.silent_out_frames started being
+   * counted, used to detect control changes.
+   *
+   * @see Port.control_generation. */
+  guint silent_ctrls_generation;
+
   /** Whether the plugin is currently instantiated
    * or not. */
   bool instantiated;
@@ -836,6 +868,22 @@ plugin_set_selected_preset_by_name (
   Plugin *     self,
   const char * name);
 
+/**
+ * Adds the input ports of the plugin to the
+ * given arrays by type.
+ *
+ * Used to compute the caches without modifying
+ * the plugin.
+ */
+NONNULL
+void
+plugin_get_port_caches (
+  const Plugin * self,
+  GPtrArray *    ctrl_in_ports,
+  GPtrArray *    audio_in_ports,
+  GPtrArray *    cv_in_ports,
+  GPtrArray *    midi_in_ports);
+
 /**
  * Sets caches for processing.
  */
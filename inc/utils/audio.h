@@ -157,6 +157,31 @@ audio_file_is_silent (const char * filepath);
 int
 audio_get_num_cores (void);
 
+/**
+ * Fills @p cores with the logical CPUs the
+ * process may run on, taking only one of the SMT
+ * siblings of each physical core.
+ *
+ * This takes the CPU affinity mask into account
+ * (e.g. when started via taskset or in a
+ * container).
+ *
+ * @return The number of cores written, or 0 if
+ *   not supported on this platform.
+ */
+int
+audio_get_available_cores (
+  int * cores,
+  int   max_cores);
+
+/**
+ * Returns the number of physical CPU cores the
+ * process may run on, or audio_get_num_cores() if
+ * this cannot be measured.
+ */
+int
+audio_get_num_available_cores (void);
+
 /**
  * @}
  */
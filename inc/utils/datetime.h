@@ -26,6 +26,8 @@
 #ifndef __UTILS_DATETIME_H__
 #define __UTILS_DATETIME_H__
 
+#include <time.h>
+
 #include <glib.h>
 
 /**
@@ -54,6 +56,25 @@ datetime_epoch_to_str (
 char *
 datetime_get_for_filename (void);
 
+/**
+ * Returns a monotonic timestamp in nanoseconds.
+ *
+ * More precise than g_get_monotonic_time(), for
+ * timing DSP code.
+ */
+static inline gint64
+datetime_get_monotonic_time_ns (void)
+{
+#ifdef _WOE32
+  return g_get_monotonic_time () * 1000;
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (gint64) ts.tv_sec * 1000000000
+         + (gint64) ts.tv_nsec;
+#endif
+}
+
 /**
  * @}
  */
@@ -33,6 +33,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "utils/dsp_simd.h"
 #include "utils/math.h"
 #include "zrythm.h"
 
@@ -67,10 +68,7 @@ dsp_limit1 (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = CLAMP (buf[i], minf, maxf);
-        }
+      dsp_simd->limit1 (buf, minf, maxf, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -107,15 +105,8 @@ dsp_abs_max (float * buf, size_t size)
   else
     {
 #endif
-      float ret = 1e-20f;
-      for (size_t i = 0; i < size; i++)
-        {
-          if (fabsf (buf[i]) > ret)
-            {
-              ret = fabsf (buf[i]);
-            }
-        }
-      return ret;
+      return MAX (
+        1e-20f, dsp_simd->abs_max (buf, size));
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -142,13 +133,10 @@ dsp_abs_max_with_existing_peak (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
+      if (size > 0)
         {
-          float val = fabsf (buf[i]);
-          if (val > new_peak)
-            {
-              new_peak = val;
-            }
+          new_peak = MAX (
+            new_peak, dsp_simd->abs_max (buf, size));
         }
 #ifdef HAVE_LSP_DSP
     }
@@ -205,10 +193,7 @@ dsp_mix2 (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] * k1 + src[i] * k2;
-        }
+      dsp_simd->mix2 (dest, src, k1, k2, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -228,6 +213,31 @@ dsp_mix_add2 (
   float         k2,
   size_t        size);
 
+/**
+ * Sums any number of sources into \p dest in a
+ * single pass:
+ * dst[i] = dst[i] + srcs[0][i] * ks[0] + ...
+ *   + srcs[n - 1][i] * ks[n - 1].
+ *
+ * The destination is processed in small blocks
+ * that stay in cache while all the sources are
+ * added, and is written back once per block,
+ * optionally clamped to [\p minf, \p maxf].
+ *
+ * @param limit Whether to clamp the result.
+ */
+NONNULL
+HOT void
+dsp_sum_n (
+  float *               dest,
+  const float * const * srcs,
+  const float *         ks,
+  size_t                num_srcs,
+  bool                  limit,
+  float                 minf,
+  float                 maxf,
+  size_t                size);
+
 /**
  * Calculate linear fade in by multiplying from
  * 0 to 1.
@@ -244,6 +254,44 @@ NONNULL
 void
 dsp_linear_fade_out (float * dest, size_t size);
 
+/**
+ * Calculate dst[i] = dst[i] * (start + inc * i).
+ *
+ * Used to ramp gain changes.
+ */
+NONNULL
+HOT void
+dsp_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size);
+
+/**
+ * Calculate
+ * dst[i] = dst[i] + src[i] * (start + inc * i).
+ */
+NONNULL
+HOT void
+dsp_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size);
+
+/**
+ * Returns the true peak (max absolute value of
+ * the signal oversampled 4x) of the samples
+ * after the first DSP_TRUE_PEAK_TAPS - 1, which
+ * are only used as history.
+ *
+ * @see DspSimdFuncs.true_peak.
+ */
+NONNULL
+HOT float
+dsp_true_peak (const float * src, size_t size);
+
 /**
  * Makes the two signals mono.
  *
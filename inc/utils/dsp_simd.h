@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Built-in vectorized DSP kernels.
+ *
+ * These are used by the functions in dsp.h when
+ * the optimized DSP library is not used.
+ */
+
+#ifndef __UTILS_DSP_SIMD_H__
+#define __UTILS_DSP_SIMD_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/** Taps per phase of the true peak
+ * interpolation filter. */
+#define DSP_TRUE_PEAK_TAPS 12
+
+/** Oversampling factor of the true peak
+ * interpolation filter. */
+#define DSP_TRUE_PEAK_PHASES 4
+
+/**
+ * Instruction set of a kernel table.
+ */
+typedef enum DspSimdLevel
+{
+  /** Plain C (reference). */
+  DSP_SIMD_NONE,
+  DSP_SIMD_SSE2,
+  DSP_SIMD_AVX2,
+  DSP_SIMD_AVX512,
+  DSP_SIMD_NEON,
+  NUM_DSP_SIMD_LEVELS,
+} DspSimdLevel;
+
+/**
+ * Table of kernels for one instruction set.
+ *
+ * Buffers need not be aligned.
+ */
+typedef struct DspSimdFuncs
+{
+  DspSimdLevel level;
+
+  /** Human friendly name of the instruction
+   * set. */
+  const char * name;
+
+  void (*fill) (float * buf, float val, size_t size);
+
+  /** Clamps each sample to [minf, maxf]. */
+  void (*limit1) (
+    float * buf,
+    float   minf,
+    float   maxf,
+    size_t  size);
+
+  /** Returns the max absolute value (0 if
+   * \p size is 0). */
+  float (*abs_max) (const float * buf, size_t size);
+
+  /** Returns the min value (FLT_MAX if \p size
+   * is 0). */
+  float (*min) (const float * buf, size_t size);
+
+  /** Returns the max value (-FLT_MAX if \p size
+   * is 0). */
+  float (*max) (const float * buf, size_t size);
+
+  /** dst[i] = dst[i] + src[i]. */
+  void (*add2) (
+    float *       dest,
+    const float * src,
+    size_t        size);
+
+  /** dst[i] = dst[i] * k. */
+  void (*mul_k2) (float * dest, float k, size_t size);
+
+  /** dst[i] = dst[i] * k1 + src[i] * k2. */
+  void (*mix2) (
+    float *       dest,
+    const float * src,
+    float         k1,
+    float         k2,
+    size_t        size);
+
+  /** dst[i] = dst[i] + src1[i] * k1
+   * + src2[i] * k2. */
+  void (*mix_add2) (
+    float *       dest,
+    const float * src1,
+    const float * src2,
+    float         k1,
+    float         k2,
+    size_t        size);
+
+  /** Multiplies by i / size (fade in) or
+   * (size - i) / size (fade out). */
+  void (*linear_fade) (
+    float * dest,
+    size_t  size,
+    bool    fade_in);
+
+  /** dst[i] = dst[i] * (start + inc * i). */
+  void (*mul_ramp) (
+    float * dest,
+    float   start,
+    float   inc,
+    size_t  size);
+
+  /** dst[i] = dst[i] + src[i] * (start + inc * i). */
+  void (*mix_ramp) (
+    float *       dest,
+    const float * src,
+    float         start,
+    float         inc,
+    size_t        size);
+
+  /**
+   * Returns the max absolute value of the signal
+   * oversampled 4x with the ITU-R BS.1770
+   * interpolation filter, without writing the
+   * oversampled signal anywhere.
+   *
+   * Only the samples interpolated before each of
+   * src[DSP_TRUE_PEAK_TAPS - 1] to src[size - 1]
+   * are considered, so the first
+   * DSP_TRUE_PEAK_TAPS - 1 samples are history
+   * (0 is returned if there are no more).
+   */
+  float (*true_peak) (const float * src, size_t size);
+} DspSimdFuncs;
+
+/**
+ * Kernels used by the functions in dsp.h.
+ *
+ * Points to the plain C kernels until
+ * dsp_simd_init() is called.
+ */
+extern const DspSimdFuncs * dsp_simd;
+
+/**
+ * Returns the kernels for the given instruction
+ * set, or NULL if they are not built in or the
+ * CPU does not support them.
+ */
+const DspSimdFuncs *
+dsp_simd_get_funcs (DspSimdLevel level);
+
+/**
+ * Selects the best kernels supported by the CPU.
+ *
+ * To be called once at startup, before the engine
+ * is running.
+ */
+void
+dsp_simd_init (void);
+
+/**
+ * Returns whether the CPU can flush denormals to
+ * zero (FTZ/DAZ).
+ */
+bool
+dsp_simd_can_flush_denormals (void);
+
+/**
+ * Sets whether denormal results and inputs are
+ * flushed to zero on the calling thread.
+ *
+ * This is per-thread state, so it must be called
+ * from each processing thread. Does nothing if
+ * not supported by the CPU.
+ */
+void
+dsp_simd_set_flush_denormals (bool flush);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Parameter that ramps to new values instead of
+ * jumping, to avoid zipper noise.
+ */
+
+#ifndef __UTILS_SMOOTHED_VALUE_H__
+#define __UTILS_SMOOTHED_VALUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils/types.h"
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/** Time it takes a gain to reach a new value. */
+#define SMOOTHED_VALUE_GAIN_RAMP_MS 10
+
+/**
+ * Exponential ramps are applied as linear
+ * segments of this many samples.
+ */
+#define SMOOTHED_VALUE_EXP_SEGMENT 32
+
+/**
+ * Values below this are treated as silence by
+ * exponential ramps (-100 dBFS).
+ */
+#define SMOOTHED_VALUE_EXP_FLOOR 0.00001f
+
+typedef enum SmoothedValueType
+{
+  /** Same change in value per sample. */
+  SMOOTHED_VALUE_LINEAR,
+
+  /**
+   * Same change in dB per sample.
+   *
+   * Falls back to linear when ramping from or to
+   * silence.
+   */
+  SMOOTHED_VALUE_EXPONENTIAL,
+} SmoothedValueType;
+
+/**
+ * A smoothed parameter.
+ *
+ * Zero-initialized values jump to the first target
+ * they are given.
+ */
+typedef struct SmoothedValue
+{
+  SmoothedValueType type;
+
+  /** Value applied to the next sample. */
+  float current;
+
+  /** Value being ramped to. */
+  float target;
+
+  /**
+   * Per-sample increment (linear) or ratio
+   * (exponential).
+   */
+  float inc;
+
+  /** Samples left until the target is reached. */
+  nframes_t remaining;
+
+  bool initialized;
+} SmoothedValue;
+
+/**
+ * Jumps to the given value.
+ */
+NONNULL
+void
+smoothed_value_reset (SmoothedValue * self, float val);
+
+/**
+ * Starts ramping to \p target over \p ramp_len
+ * samples.
+ *
+ * Does nothing if \p target is already the
+ * target.
+ */
+NONNULL
+void
+smoothed_value_set_target (
+  SmoothedValue *   self,
+  float             target,
+  SmoothedValueType type,
+  nframes_t         ramp_len);
+
+/**
+ * Starts ramping to the given gain over
+ * @ref SMOOTHED_VALUE_GAIN_RAMP_MS.
+ */
+NONNULL
+void
+smoothed_value_set_gain (
+  SmoothedValue * self,
+  float           gain,
+  sample_rate_t   sample_rate);
+
+/**
+ * Returns whether the value has reached its
+ * target.
+ */
+#define smoothed_value_is_settled(self) \
+  ((self)->remaining == 0)
+
+/**
+ * Multiplies each buffer with the value, ramping
+ * where it has not settled yet.
+ *
+ * Once settled this costs the same as
+ * dsp_mul_k2() (nothing if the value is 1).
+ *
+ * All buffers get the same ramp, and the value
+ * advances by \p nframes.
+ */
+HOT void
+smoothed_value_apply (
+  SmoothedValue * self,
+  float * const * bufs,
+  size_t          num_bufs,
+  nframes_t       nframes);
+
+/**
+ * Adds each source multiplied by the value to
+ * the corresponding destination.
+ *
+ * @see smoothed_value_apply().
+ */
+HOT void
+smoothed_value_mix (
+  SmoothedValue *       self,
+  float * const *       dests,
+  const float * const * srcs,
+  size_t                num_bufs,
+  nframes_t             nframes);
+
+/**
+ * Advances the value by \p nframes without
+ * processing anything.
+ */
+NONNULL
+void
+smoothed_value_skip (
+  SmoothedValue * self,
+  nframes_t       nframes);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Publishing of immutable snapshots from the GUI
+ * thread to the processing threads.
+ */
+
+#ifndef __UTILS_SNAPSHOT_PUBLISHER_H__
+#define __UTILS_SNAPSHOT_PUBLISHER_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/**
+ * Callback that publishes a new snapshot of
+ * @p owner with snapshot_publisher_publish().
+ */
+typedef void (*SnapshotPublishFunc) (void * owner);
+
+/**
+ * Latest snapshot of some data edited on the GUI
+ * thread.
+ *
+ * The processing threads read the snapshot between
+ * snapshot_publisher_acquire() and
+ * snapshot_publisher_release(). Replaced snapshots
+ * are freed on the GUI thread once no thread is
+ * reading.
+ *
+ * Changes made between
+ * snapshot_publisher_begin_batch() and
+ * snapshot_publisher_end_batch() are published
+ * once at the end of the batch, so that an edit
+ * operation touching many objects copies the data
+ * only once.
+ *
+ * A zeroed publisher is a valid publisher without
+ * a snapshot.
+ */
+typedef struct SnapshotPublisher
+{
+  /** Latest snapshot, or NULL if none was
+   * published yet. */
+  void * snapshot;
+
+  /** Replaced snapshots that may still be
+   * read. */
+  GPtrArray * retired;
+
+  /** Number of threads between
+   * snapshot_publisher_acquire() and
+   * snapshot_publisher_release(). */
+  volatile gint num_readers;
+
+  /** Whether a publish is pending until the end of
+   * the current batch. */
+  bool dirty;
+} SnapshotPublisher;
+
+/**
+ * Replaces the snapshot with @p snapshot.
+ *
+ * @param free_func Function to free the replaced
+ *   snapshots with.
+ */
+NONNULL_ARGS (1, 3)
+void
+snapshot_publisher_publish (
+  SnapshotPublisher * self,
+  void *              snapshot,
+  GDestroyNotify      free_func);
+
+/**
+ * To be called after the data of @p owner
+ * changed.
+ *
+ * Calls @p publish_func right away, or at the end
+ * of the current batch if one is open.
+ */
+NONNULL_ARGS (1, 2)
+void
+snapshot_publisher_changed (
+  SnapshotPublisher * self,
+  SnapshotPublishFunc publish_func,
+  void *              owner);
+
+/**
+ * Starts collecting changes to publish them at
+ * the matching snapshot_publisher_end_batch().
+ *
+ * Batches can be nested.
+ *
+ * To be called from the GUI thread.
+ */
+void
+snapshot_publisher_begin_batch (void);
+
+/**
+ * Ends a batch started with
+ * snapshot_publisher_begin_batch(), publishing the
+ * changes collected if this is the outermost one.
+ */
+void
+snapshot_publisher_end_batch (void);
+
+/**
+ * Returns the latest snapshot, or NULL.
+ *
+ * To be called by the processing threads. The
+ * snapshot stays valid until
+ * snapshot_publisher_release().
+ */
+NONNULL
+HOT void *
+snapshot_publisher_acquire (
+  SnapshotPublisher * self);
+
+/**
+ * Releases the snapshot returned by
+ * snapshot_publisher_acquire().
+ */
+NONNULL
+HOT void
+snapshot_publisher_release (
+  SnapshotPublisher * self);
+
+/**
+ * Frees all the snapshots and drops any pending
+ * publish.
+ *
+ * Must not be called while the snapshot is being
+ * read.
+ */
+NONNULL_ARGS (1)
+void
+snapshot_publisher_clear (
+  SnapshotPublisher * self,
+  GDestroyNotify      free_func);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Single Producer Multiple Consumer lock-free
+ * work-stealing deque.
+ */
+
+#ifndef __UTILS_WS_DEQUE_H__
+#define __UTILS_WS_DEQUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/**
+ * Fixed-capacity Chase-Lev work-stealing deque.
+ *
+ * The owner thread pushes and pops at the bottom
+ * end, other threads steal from the top end.
+ *
+ * The buffer is never grown while in use, so
+ * ws_deque_reserve() and ws_deque_clear() must
+ * only be called while no thread is accessing
+ * the deque. Users that need a bigger deque
+ * meanwhile replace it with a new one.
+ *
+ * The indices are never rewound while in use
+ * (thieves may hold on to them), they only grow
+ * and wrap around.
+ */
+typedef struct WsDeque
+{
+  void ** buffer;
+  size_t  buffer_mask;
+
+  /** Next index to steal from (wraps
+   * around). */
+  volatile gint top;
+
+  /** Next index to push to (wraps around). */
+  volatile gint bottom;
+} WsDeque;
+
+WsDeque *
+ws_deque_new (void);
+
+/**
+ * Makes sure the deque can hold at least
+ * @p buffer_size elements.
+ *
+ * Not real-time safe.
+ */
+NONNULL
+void
+ws_deque_reserve (
+  WsDeque * self,
+  size_t    buffer_size);
+
+/**
+ * Returns the number of elements the deque can
+ * hold.
+ */
+NONNULL
+size_t
+ws_deque_get_capacity (const WsDeque * self);
+
+/**
+ * Resets the deque indices.
+ *
+ * Must only be called when the deque is empty
+ * and no other thread accesses it.
+ */
+NONNULL
+void
+ws_deque_clear (WsDeque * self);
+
+/**
+ * Pushes an element at the bottom.
+ *
+ * Must only be called by the owner thread.
+ *
+ * @return Whether the element was pushed (false
+ *   if the deque is full).
+ */
+HOT NONNULL bool
+ws_deque_push (WsDeque * self, void * const data);
+
+/**
+ * Pops the most recently pushed element.
+ *
+ * Must only be called by the owner thread.
+ */
+HOT NONNULL bool
+ws_deque_pop (WsDeque * self, void ** data);
+
+/**
+ * Steals the oldest element.
+ *
+ * May be called by any thread.
+ */
+HOT NONNULL bool
+ws_deque_steal (WsDeque * self, void ** data);
+
+NONNULL
+void
+ws_deque_free (WsDeque * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -20,6 +20,7 @@
 #include "audio/graph.h"
 #include "audio/graph_export.h"
 #include "audio/instrument_track.h"
+#include "audio/loudness_analyzer.h"
 #include "audio/marker.h"
 #include "audio/marker_track.h"
 #include "audio/midi_event.h"
@@ -4149,6 +4150,48 @@ DEFINE_SIMPLE (
     !track->passthrough_midi_input;
 }
 
+DEFINE_SIMPLE (
+  activate_toggle_track_loudness_analysis)
+{
+  Track * track = TRACKLIST_SELECTIONS->tracks[0];
+  bool    enable = !fader_get_loudness_analyzer (
+    track_get_fader (track, true));
+  for (int i = 0;
+       i < TRACKLIST_SELECTIONS->num_tracks; i++)
+    {
+      Track * t = TRACKLIST_SELECTIONS->tracks[i];
+      if (
+        t->out_signal_type != TYPE_AUDIO
+        || !track_type_has_channel (t->type))
+        continue;
+
+      g_message (
+        "setting track '%s' loudness analysis to %d",
+        t->name, enable);
+      fader_set_loudness_analysis_enabled (
+        track_get_fader (t, true), enable);
+    }
+}
+
+DEFINE_SIMPLE (activate_reset_track_loudness)
+{
+  for (int i = 0;
+       i < TRACKLIST_SELECTIONS->num_tracks; i++)
+    {
+      Track * t = TRACKLIST_SELECTIONS->tracks[i];
+      if (
+        t->out_signal_type != TYPE_AUDIO
+        || !track_type_has_channel (t->type))
+        continue;
+
+      LoudnessAnalyzer * analyzer =
+        fader_get_loudness_analyzer (
+          track_get_fader (t, true));
+      if (analyzer)
+        loudness_analyzer_request_reset (analyzer);
+    }
+}
+
 /**
  * Used as a workaround for GTK bug 4422.
  */
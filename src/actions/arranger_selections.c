@@ -23,6 +23,7 @@
 #include "utils/math.h"
 #include "utils/object_utils.h"
 #include "utils/objects.h"
+#include "utils/snapshot_publisher.h"
 #include "utils/string.h"
 #include "zrythm_app.h"
 
@@ -2460,6 +2461,33 @@ do_or_undo_edit (
                     own_dest_obj->loop_start_pos;
                   obj->loop_end_pos =
                     own_dest_obj->loop_end_pos;
+                  if (
+                    obj->type
+                    == ARRANGER_OBJECT_TYPE_REGION)
+                    {
+                      region_update_lane_index (
+                        (ZRegion *) obj);
+                    }
+                  else if (
+                    obj->type
+                    == ARRANGER_OBJECT_TYPE_MIDI_NOTE)
+                    {
+                      midi_note_update_event_table (
+                        (MidiNote *) obj);
+                    }
+
+                  /* invalidate cached automation
+                   * reads */
+                  if (
+                    obj->type
+                      == ARRANGER_OBJECT_TYPE_AUTOMATION_POINT
+                    || (obj->type
+                          == ARRANGER_OBJECT_TYPE_REGION
+                        && ((ZRegion *) obj)->id.type
+                             == REGION_TYPE_AUTOMATION))
+                    {
+                      automation_track_bump_edit_generation ();
+                    }
                   break;
                 case ARRANGER_SELECTIONS_ACTION_EDIT_FADES:
                   obj->fade_in_pos =
@@ -3043,7 +3071,7 @@ do_or_undo_quantize (
 }
 
 static int
-do_or_undo (
+do_or_undo_by_type (
   ArrangerSelectionsAction * self,
   bool                       _do,
   GError **                  error)
@@ -3093,6 +3121,21 @@ do_or_undo (
   g_return_val_if_reached (-1);
 }
 
+static int
+do_or_undo (
+  ArrangerSelectionsAction * self,
+  bool                       _do,
+  GError **                  error)
+{
+  /* publish the region indices and MIDI event
+   * tables once for all the objects */
+  snapshot_publisher_begin_batch ();
+  int ret = do_or_undo_by_type (self, _do, error);
+  snapshot_publisher_end_batch ();
+
+  return ret;
+}
+
 int
 arranger_selections_action_do (
   ArrangerSelectionsAction * self,
@@ -4,6 +4,10 @@
 #include "actions/undo_manager.h"
 #include "actions/undo_stack.h"
 #include "actions/undoable_action.h"
+#include "audio/anticipative_renderer.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/router.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/header.h"
@@ -132,6 +136,16 @@ do_or_undo_action (
       undo_stack_pop (main_stack);
     }
 
+  /* re-render the audio that was rendered ahead
+   * before the change */
+  if (
+    PROJECT && AUDIO_ENGINE && ROUTER
+    && ROUTER->graph)
+    {
+      anticipative_renderer_invalidate (
+        ROUTER->graph->anticipative);
+    }
+
   /* if redo stack is locked don't alter it */
   if (
     self->redo_stack_locked
@@ -177,6 +177,11 @@ undoable_action_needs_pause (UndoableAction * self)
           }
       }
       break;
+    case UA_PORT_CONNECTION:
+      /* the new graph is swapped in while the
+       * engine runs, and removed connections are
+       * freed once no graph uses them */
+      return false;
     default:
       break;
     }
@@ -0,0 +1,943 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-config.h"
+
+#include <stdlib.h>
+
+#include "audio/anticipative_renderer.h"
+#include "audio/automation_track.h"
+#include "audio/automation_tracklist.h"
+#include "audio/channel.h"
+#include "audio/control_port.h"
+#include "audio/engine.h"
+#include "audio/fader.h"
+#include "audio/graph.h"
+#include "audio/graph_node.h"
+#include "audio/port.h"
+#include "audio/router.h"
+#include "audio/track.h"
+#include "audio/track_processor.h"
+#include "audio/tracklist.h"
+#include "audio/transport.h"
+#include "gui/backend/clip_editor.h"
+#include "project.h"
+#include "utils/dsp.h"
+#include "utils/dsp_simd.h"
+#include "utils/env.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+#include "zrythm_app.h"
+
+#ifdef HAVE_LSP_DSP
+#  include <lsp-plug.in/dsp/dsp.h>
+#endif
+
+CONST
+static guint
+power_of_two_size (guint sz)
+{
+  guint ret = 2;
+  while (ret < sz)
+    ret <<= 1;
+  return ret;
+}
+
+/**
+ * Returns the duration of an engine cycle in
+ * microseconds, or 0 if unknown.
+ */
+static gint64
+get_cycle_usec (void)
+{
+  if (!AUDIO_ENGINE || AUDIO_ENGINE->sample_rate == 0)
+    return 0;
+
+  return ((gint64) AUDIO_ENGINE->block_length
+          * 1000000)
+         / AUDIO_ENGINE->sample_rate;
+}
+
+bool
+anticipative_renderer_track_needs_live_processing (
+  Track * track)
+{
+  if (
+    track_type_can_record (track->type)
+    && track_get_recording (track))
+    return true;
+
+  if (
+    track->type == TRACK_TYPE_AUDIO
+    && track->processor->monitor_audio
+    && control_port_is_toggled (
+      track->processor->monitor_audio))
+    return true;
+
+  /* the list may contain automation tracks that
+   * are no longer recording */
+  AutomationTracklist * atl =
+    &track->automation_tracklist;
+  for (int i = 0; i < atl->num_ats_in_record_mode;
+       i++)
+    {
+      if (
+        atl->ats_in_record_mode[i]->automation_mode
+        == AUTOMATION_MODE_RECORD)
+        return true;
+    }
+
+  /* notes pressed in the editor are sent to its
+   * track */
+  if (
+    CLIP_EDITOR->has_region
+    && CLIP_EDITOR->track == track)
+    return true;
+
+  return false;
+}
+
+/**
+ * Returns whether the track type and its current
+ * state allow rendering it ahead.
+ */
+static bool
+track_can_be_rendered_ahead (Track * track)
+{
+  return (track->type == TRACK_TYPE_AUDIO
+          || track->type == TRACK_TYPE_INSTRUMENT)
+         && track->out_signal_type == TYPE_AUDIO
+         && track->channel
+         && !track_is_auditioner (track)
+         && !anticipative_renderer_track_needs_live_processing (
+              track);
+}
+
+/**
+ * Returns whether @p parent may feed @p node
+ * without being rendered ahead with it.
+ */
+static bool
+is_allowed_outside_parent (
+  const GraphNode * parent,
+  const GraphNode * node)
+{
+  if (
+    parent->type
+    == ROUTE_NODE_TYPE_INITIAL_PROCESSOR)
+    return true;
+
+  /* hardware MIDI input only passes through to
+   * tracks armed for recording */
+  return parent->type == ROUTE_NODE_TYPE_PORT
+         && parent->port->id.owner_type
+              == PORT_OWNER_TYPE_HW
+         && node->type == ROUTE_NODE_TYPE_PORT
+         && node->port->id.owner_type
+              == PORT_OWNER_TYPE_TRACK_PROCESSOR
+         && node->port->id.type == TYPE_EVENT;
+}
+
+/**
+ * Marks the nodes of the track's pre-fader part
+ * with @p mark.
+ *
+ * The part ends at the fader's inputs, which are
+ * marked with -mark along with the fader.
+ *
+ * @return The number of nodes marked, or 0 if the
+ *   part is connected to anything outside the
+ *   track.
+ */
+static size_t
+mark_pre_fader_nodes (
+  CompiledGraph * compiled,
+  Track *         track,
+  int             mark,
+  int *           marks,
+  GraphNode **    stack)
+{
+  Channel *   ch = track->channel;
+  GraphNode * track_node = (GraphNode *)
+    g_hash_table_lookup (compiled->nodes, track);
+  GraphNode * prefader_node = (GraphNode *)
+    g_hash_table_lookup (
+      compiled->nodes, ch->prefader);
+  GraphNode * fader_node = (GraphNode *)
+    g_hash_table_lookup (compiled->nodes, ch->fader);
+  GraphNode * in_l = (GraphNode *) g_hash_table_lookup (
+    compiled->nodes, ch->fader->stereo_in->l);
+  GraphNode * in_r = (GraphNode *) g_hash_table_lookup (
+    compiled->nodes, ch->fader->stereo_in->r);
+  if (
+    !track_node || !prefader_node || !fader_node
+    || !in_l || !in_r)
+    return 0;
+
+  marks[fader_node->id] = -mark;
+  marks[in_l->id] = -mark;
+  marks[in_r->id] = -mark;
+
+  size_t num_nodes = 1;
+  size_t top = 0;
+  marks[track_node->id] = mark;
+  stack[top++] = track_node;
+  while (top > 0)
+    {
+      GraphNode * node = stack[--top];
+
+      for (int i = 0; i < node->n_childnodes; i++)
+        {
+          GraphNode * child = node->childnodes[i];
+          if (
+            marks[child->id] == mark
+            || marks[child->id] == -mark)
+            continue;
+
+          if (graph_node_get_track (child) != track)
+            return 0;
+
+          marks[child->id] = mark;
+          stack[top++] = child;
+          num_nodes++;
+        }
+
+      /* the parents of a packed node are its
+       * incoming edges */
+      for (int i = 0; i < node->init_refcount; i++)
+        {
+          GraphNode * parent = node->parentnodes[i];
+          if (
+            marks[parent->id] == mark
+            || is_allowed_outside_parent (
+              parent, node))
+            continue;
+
+          if (
+            marks[parent->id] == -mark
+            || graph_node_get_track (parent) != track)
+            return 0;
+
+          marks[parent->id] = mark;
+          stack[top++] = parent;
+          num_nodes++;
+        }
+    }
+
+  if (marks[prefader_node->id] != mark)
+    return 0;
+
+  return num_nodes;
+}
+
+void
+anticipative_renderer_setup (
+  AnticipativeRenderer * self,
+  CompiledGraph *        compiled)
+{
+  g_return_if_fail (compiled->schedule);
+
+  size_t        n = compiled->schedule_size;
+  int *         marks = object_new_n (n, int);
+  GraphNode **  stack = object_new_n (n, GraphNode *);
+  nframes_t     block_length =
+    MAX (AUDIO_ENGINE->block_length, 1);
+  guint64 lookahead_frames =
+    ((guint64) self->lookahead_ms
+     * AUDIO_ENGINE->sample_rate)
+    / 1000;
+  guint max_chunks_ahead = MAX (
+    (guint) ((lookahead_frames + block_length - 1)
+             / block_length),
+    2);
+
+  compiled->anticipative_tracks = object_new_n (
+    (size_t) MAX (TRACKLIST->num_tracks, 1),
+    AnticipativeTrack);
+  compiled->n_anticipative_tracks = 0;
+
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      if (!track_can_be_rendered_ahead (track))
+        continue;
+
+      int    mark = i + 1;
+      size_t num_nodes = mark_pre_fader_nodes (
+        compiled, track, mark, marks, stack);
+      if (num_nodes == 0)
+        continue;
+
+      AnticipativeTrack * at =
+        &compiled->anticipative_tracks
+           [compiled->n_anticipative_tracks++];
+      at->renderer = self;
+      at->track = track;
+      at->nodes = object_new_n (num_nodes, GraphNode *);
+      for (size_t j = 0; j < n; j++)
+        {
+          GraphNode * node = &compiled->schedule[j];
+          if (marks[j] == mark)
+            {
+              at->nodes[at->num_nodes++] = node;
+              node->anticipative = at;
+            }
+          else if (marks[j] == -mark)
+            {
+              node->anticipative = at;
+              if (node->type == ROUTE_NODE_TYPE_FADER)
+                at->fader_node = node;
+            }
+        }
+
+      at->max_chunks_ahead = max_chunks_ahead;
+      at->num_chunks =
+        power_of_two_size (2 * max_chunks_ahead);
+      at->chunk_size = block_length;
+      at->chunks = object_new_n (
+        at->num_chunks, AnticipativeChunk);
+      for (guint j = 0; j < at->num_chunks; j++)
+        {
+          AnticipativeChunk * chunk = &at->chunks[j];
+          chunk->l = object_new_n (block_length, float);
+          chunk->r = object_new_n (block_length, float);
+        }
+    }
+
+  g_debug (
+    "%zu tracks can be rendered ahead",
+    compiled->n_anticipative_tracks);
+
+  free (marks);
+  free (stack);
+}
+
+void
+anticipative_renderer_free_tracks (
+  CompiledGraph * compiled)
+{
+  for (size_t i = 0;
+       i < compiled->n_anticipative_tracks; i++)
+    {
+      AnticipativeTrack * at =
+        &compiled->anticipative_tracks[i];
+      for (guint j = 0; j < at->num_chunks; j++)
+        {
+          free (at->chunks[j].l);
+          free (at->chunks[j].r);
+        }
+      free (at->chunks);
+      free (at->nodes);
+    }
+  object_zero_and_free (
+    compiled->anticipative_tracks);
+  compiled->n_anticipative_tracks = 0;
+}
+
+/**
+ * Returns the number of frames from @p from until
+ * @p to, following the loop, or -1 if @p to was
+ * already passed.
+ */
+static signed_frame_t
+get_frames_until (
+  unsigned_frame_t from,
+  unsigned_frame_t to)
+{
+  if (to >= from)
+    return (signed_frame_t) (to - from);
+
+  unsigned_frame_t loop_start =
+    (unsigned_frame_t) TRANSPORT->loop_start_pos.frames;
+  unsigned_frame_t loop_end =
+    (unsigned_frame_t) TRANSPORT->loop_end_pos.frames;
+  if (
+    TRANSPORT_IS_LOOPING && from < loop_end
+    && to >= loop_start)
+    {
+      return (signed_frame_t) ((loop_end - from)
+                               + (to - loop_start));
+    }
+
+  return -1;
+}
+
+/**
+ * Has the worker restart rendering a bit after
+ * @p pos and drops the rendered chunks.
+ *
+ * To be called by the processing thread.
+ */
+static void
+request_seek (
+  AnticipativeTrack * self,
+  unsigned_frame_t    pos)
+{
+  Position seek_pos;
+  position_from_frames (
+    &seek_pos, (signed_frame_t) pos);
+  transport_position_add_frames (
+    TRANSPORT, &seek_pos,
+    ANTICIPATIVE_SEEK_LEAD_BLOCKS
+      * (signed_frame_t) AUDIO_ENGINE->block_length);
+  self->seek_pos = (unsigned_frame_t) seek_pos.frames;
+
+  /* chunks published after this are rendered for
+   * the previous request and get skipped */
+  g_atomic_int_set (
+    &self->read_idx,
+    g_atomic_int_get (&self->write_idx));
+  g_atomic_int_inc (&self->seek_requests);
+}
+
+void
+anticipative_track_read (
+  AnticipativeTrack *                 self,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  StereoPorts * in =
+    self->track->channel->fader->stereo_in;
+  unsigned_frame_t pos = time_nfo->g_start_frame;
+  nframes_t        offset = time_nfo->local_offset;
+  nframes_t        remaining = time_nfo->nframes;
+  gint             seek_gen = self->seek_requests;
+  guint            mask = self->num_chunks - 1;
+  signed_frame_t   max_wait =
+    (ANTICIPATIVE_SEEK_LEAD_BLOCKS + 1)
+    * (signed_frame_t) AUDIO_ENGINE->block_length;
+  bool silent = true;
+
+  while (remaining > 0)
+    {
+      guint read_idx = self->read_idx;
+      if (
+        read_idx
+        == (guint) g_atomic_int_get (&self->write_idx))
+        {
+          g_atomic_int_inc (&self->num_underruns);
+          break;
+        }
+
+      AnticipativeChunk * chunk =
+        &self->chunks[read_idx & mask];
+      gint state = g_atomic_int_get (&chunk->state);
+      if (
+        state == ANTICIPATIVE_CHUNK_READY
+        && !g_atomic_int_compare_and_exchange (
+          &chunk->state, ANTICIPATIVE_CHUNK_READY,
+          ANTICIPATIVE_CHUNK_READING))
+        {
+          /* invalidated meanwhile */
+          state = ANTICIPATIVE_CHUNK_STALE;
+        }
+      if (
+        state == ANTICIPATIVE_CHUNK_STALE
+        || chunk->seek_gen != seek_gen)
+        {
+          g_atomic_int_set (
+            &self->read_idx, read_idx + 1);
+          continue;
+        }
+
+      unsigned_frame_t chunk_pos =
+        chunk->g_start_frame + chunk->read_offset;
+      nframes_t chunk_remaining =
+        chunk->nframes - chunk->read_offset;
+      if (
+        pos >= chunk_pos
+        && pos < chunk_pos + chunk_remaining)
+        {
+          /* skip any frames that were missed */
+          chunk->read_offset +=
+            (nframes_t) (pos - chunk_pos);
+          nframes_t num_frames = MIN (
+            remaining,
+            chunk->nframes - chunk->read_offset);
+          dsp_copy (
+            &in->l->buf[offset],
+            &chunk->l[chunk->read_offset], num_frames);
+          dsp_copy (
+            &in->r->buf[offset],
+            &chunk->r[chunk->read_offset], num_frames);
+          if (!chunk->silent)
+            silent = false;
+
+          chunk->read_offset += num_frames;
+          pos += num_frames;
+          offset += num_frames;
+          remaining -= num_frames;
+          if (chunk->read_offset == chunk->nframes)
+            {
+              g_atomic_int_set (
+                &self->read_idx, read_idx + 1);
+            }
+          continue;
+        }
+
+      signed_frame_t frames_until =
+        get_frames_until (pos, chunk_pos);
+      if (frames_until < 0 || frames_until > max_wait)
+        {
+          /* the playhead moved */
+          request_seek (self, pos + remaining);
+          break;
+        }
+
+      /* the worker restarted ahead of the playhead
+       * (e.g., after a seek) - output silence until
+       * the playhead gets there */
+      if ((nframes_t) frames_until >= remaining)
+        break;
+      pos += (unsigned_frame_t) frames_until;
+      offset += (nframes_t) frames_until;
+      remaining -= (nframes_t) frames_until;
+    }
+
+  /* the rest of the buffers was cleared at the
+   * start of the cycle */
+  stereo_ports_mark_silent (
+    in, time_nfo->local_offset, silent);
+}
+
+bool
+anticipative_renderer_is_rendering_track (
+  const AnticipativeRenderer * self,
+  const Track *                track)
+{
+  if (!self || !g_atomic_int_get (&self->ahead))
+    return false;
+
+  GraphNode * node = (GraphNode *) g_hash_table_lookup (
+    self->graph->compiled->nodes, track);
+  return node && node->type == ROUTE_NODE_TYPE_TRACK
+         && node->anticipative;
+}
+
+void
+anticipative_renderer_begin_cycle (
+  AnticipativeRenderer *      self,
+  const CompiledGraph *       compiled,
+  const EngineProcessTimeInfo time_nfo)
+{
+  /* only switch at the start of an engine
+   * cycle */
+  bool want_ahead = self->ahead;
+  if (time_nfo.local_offset == 0)
+    {
+      want_ahead =
+        g_atomic_int_get (&self->enabled)
+        && compiled->n_anticipative_tracks > 0
+        && TRANSPORT_IS_ROLLING
+        && AUDIO_ENGINE->remaining_latency_preroll
+             == 0
+        && !AUDIO_ENGINE->exporting;
+    }
+
+  if (self->ahead && !want_ahead)
+    {
+      /* process the tracks live once the worker
+       * stopped */
+      g_atomic_int_set (&self->stop_requested, 1);
+      if (g_atomic_int_get (&self->worker_running))
+        return;
+
+      for (size_t i = 0;
+           i < compiled->n_anticipative_tracks; i++)
+        {
+          channel_prepare_process_pre_fader (
+            compiled->anticipative_tracks[i]
+              .track->channel);
+        }
+      g_atomic_int_set (&self->ahead, 0);
+    }
+  else if (!self->ahead && want_ahead)
+    {
+      for (size_t i = 0;
+           i < compiled->n_anticipative_tracks; i++)
+        {
+          AnticipativeTrack * at =
+            &compiled->anticipative_tracks[i];
+          Position pos = *PLAYHEAD;
+          transport_position_add_frames (
+            TRANSPORT, &pos,
+            at->fader_node->route_playback_latency);
+          request_seek (
+            at, (unsigned_frame_t) pos.frames);
+        }
+      g_atomic_int_set (&self->stop_requested, 0);
+      g_atomic_int_set (&self->ahead, 1);
+    }
+
+  /* let the worker refill the played chunks */
+  if (self->ahead)
+    zix_sem_post (&self->wake);
+}
+
+/**
+ * Marks the rendered chunks that are far enough
+ * from the playhead as stale and has the worker
+ * render them again.
+ */
+static void
+invalidate_chunks (AnticipativeTrack * self)
+{
+  guint mask = self->num_chunks - 1;
+  guint first =
+    g_atomic_int_get (&self->read_idx)
+    + ANTICIPATIVE_INVALIDATE_MARGIN_CHUNKS;
+
+  /* go backwards so that the stale chunks always
+   * come after the ones that may be played (the
+   * processing thread claims chunks in order) */
+  guint stale_start = self->write_idx;
+  while ((gint) (stale_start - first) > 0)
+    {
+      AnticipativeChunk * chunk =
+        &self->chunks[(stale_start - 1) & mask];
+      if (!g_atomic_int_compare_and_exchange (
+            &chunk->state, ANTICIPATIVE_CHUNK_READY,
+            ANTICIPATIVE_CHUNK_STALE))
+        break;
+      stale_start--;
+    }
+
+  if (stale_start == self->write_idx)
+    return;
+
+  self->render_pos =
+    self->chunks[stale_start & mask].g_start_frame;
+  self->stale_start = stale_start;
+  self->stale_end = self->write_idx;
+}
+
+/**
+ * Renders the next chunk of the track, if there is
+ * room for it.
+ *
+ * @return Whether a chunk was rendered.
+ */
+static bool
+render_next_chunk (AnticipativeTrack * self)
+{
+  Track * track = self->track;
+
+  /* tracks that need live processing are moved
+   * out of the renderer when the graph is
+   * recalculated */
+  if (anticipative_renderer_track_needs_live_processing (
+        track))
+    return false;
+
+  gint seek_requests =
+    g_atomic_int_get (&self->seek_requests);
+  if (seek_requests != self->seek_requests_handled)
+    {
+      self->render_pos = self->seek_pos;
+      self->seek_requests_handled = seek_requests;
+      self->stale_start = self->write_idx;
+      self->stale_end = self->write_idx;
+    }
+
+  gint invalidations =
+    g_atomic_int_get (&self->renderer->invalidations);
+  if (invalidations != self->invalidations_handled)
+    {
+      self->invalidations_handled = invalidations;
+      invalidate_chunks (self);
+    }
+
+  guint read_idx = g_atomic_int_get (&self->read_idx);
+  guint num_queued = self->write_idx - read_idx;
+  guint num_stale = 0;
+  if ((gint) (self->stale_end - read_idx) > 0)
+    {
+      guint stale_start =
+        (gint) (self->stale_start - read_idx) > 0
+          ? self->stale_start
+          : read_idx;
+      num_stale = self->stale_end - stale_start;
+    }
+  if (
+    num_queued >= self->num_chunks
+    || num_queued - num_stale
+         >= self->max_chunks_ahead)
+    return false;
+
+  nframes_t nframes =
+    MIN (AUDIO_ENGINE->block_length, self->chunk_size);
+  unsigned_frame_t loop_end =
+    (unsigned_frame_t) TRANSPORT->loop_end_pos.frames;
+  if (TRANSPORT_IS_LOOPING && self->render_pos < loop_end)
+    {
+      nframes = (nframes_t) MIN (
+        (unsigned_frame_t) nframes,
+        loop_end - self->render_pos);
+    }
+
+  Channel * ch = track->channel;
+  channel_prepare_process_pre_fader (ch);
+
+  /* process each node at the position it is
+   * compensated for */
+  signed_frame_t fader_latency =
+    (signed_frame_t)
+      self->fader_node->route_playback_latency;
+  for (size_t i = 0; i < self->num_nodes; i++)
+    {
+      GraphNode * node = self->nodes[i];
+      Position    pos;
+      position_from_frames (
+        &pos, (signed_frame_t) self->render_pos);
+      transport_position_add_frames (
+        TRANSPORT, &pos,
+        (signed_frame_t) node->route_playback_latency
+          - fader_latency);
+      EngineProcessTimeInfo time_nfo = {
+        .g_start_frame =
+          (unsigned_frame_t) MAX (pos.frames, 0),
+        .local_offset = 0,
+        .nframes = nframes,
+      };
+      graph_node_process_ahead (node, time_nfo);
+    }
+
+  guint               mask = self->num_chunks - 1;
+  AnticipativeChunk * chunk =
+    &self->chunks[self->write_idx & mask];
+  StereoPorts * out = ch->prefader->stereo_out;
+  dsp_copy (chunk->l, out->l->buf, nframes);
+  dsp_copy (chunk->r, out->r->buf, nframes);
+  chunk->silent = stereo_ports_is_silent (out);
+  chunk->g_start_frame = self->render_pos;
+  chunk->nframes = nframes;
+  chunk->read_offset = 0;
+  chunk->seek_gen = self->seek_requests_handled;
+  g_atomic_int_set (
+    &chunk->state, ANTICIPATIVE_CHUNK_READY);
+  g_atomic_int_set (
+    &self->write_idx, self->write_idx + 1);
+
+  self->render_pos += nframes;
+  if (
+    TRANSPORT_IS_LOOPING
+    && self->render_pos == loop_end)
+    {
+      self->render_pos =
+        (unsigned_frame_t) TRANSPORT->loop_start_pos.frames;
+    }
+
+  return true;
+}
+
+static gpointer
+worker_thread (gpointer data)
+{
+  AnticipativeRenderer * self =
+    (AnticipativeRenderer *) data;
+
+  dsp_simd_set_flush_denormals (
+    AUDIO_ENGINE->flush_denormals);
+
+#ifdef HAVE_LSP_DSP
+  lsp_dsp_context_t lsp_ctx;
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_start (&lsp_ctx);
+    }
+#endif
+
+  while (!g_atomic_int_get (&self->terminate))
+    {
+      /* announce that this thread may be rendering
+       * before checking the flags, so that the
+       * processing thread either sees it running
+       * or this thread sees the stop request (glib
+       * atomics are sequentially consistent) */
+      g_atomic_int_set (&self->worker_running, 1);
+
+      bool rendered = false;
+      if (
+        g_atomic_int_get (&self->ahead)
+        && !g_atomic_int_get (&self->stop_requested))
+        {
+          /* graphs are only swapped while not
+           * rendering ahead */
+          CompiledGraph * compiled =
+            g_atomic_pointer_get (
+              &self->graph->compiled);
+
+          /* one chunk per track at a time so that
+           * all tracks stay ahead */
+          for (size_t i = 0;
+               i < compiled->n_anticipative_tracks;
+               i++)
+            {
+              if (render_next_chunk (
+                    &compiled->anticipative_tracks[i]))
+                rendered = true;
+            }
+        }
+
+      if (!rendered)
+        {
+          g_atomic_int_set (&self->worker_running, 0);
+          zix_sem_wait (&self->wake);
+        }
+    }
+
+  g_atomic_int_set (&self->worker_running, 0);
+
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_finish (&lsp_ctx);
+    }
+#endif
+
+  return NULL;
+}
+
+void
+anticipative_renderer_start (
+  AnticipativeRenderer * self)
+{
+  g_return_if_fail (!self->thread);
+
+  self->thread = g_thread_new (
+    "anticipative_renderer", worker_thread, self);
+}
+
+void
+anticipative_renderer_pause (
+  AnticipativeRenderer * self)
+{
+  g_atomic_int_set (&self->enabled, 0);
+
+  /* give the processing thread a chance to switch
+   * to live processing (wait for up to a few
+   * cycles) */
+  gint64 timeout =
+    g_get_monotonic_time ()
+    + MAX (4 * get_cycle_usec (), 10000);
+  while (
+    g_atomic_int_get (&self->ahead)
+    && g_get_monotonic_time () < timeout)
+    {
+      g_usleep (100);
+    }
+
+  if (!g_atomic_int_get (&self->ahead))
+    return;
+
+  /* the engine is not processing cycles (or it
+   * skipped the graph) - stop the worker here */
+  zix_sem_wait (&self->graph->router->graph_access);
+  g_atomic_int_set (&self->stop_requested, 1);
+  while (g_atomic_int_get (&self->worker_running))
+    {
+      g_usleep (100);
+    }
+  g_atomic_int_set (&self->ahead, 0);
+  zix_sem_post (&self->graph->router->graph_access);
+}
+
+void
+anticipative_renderer_resume (
+  AnticipativeRenderer * self)
+{
+  g_atomic_int_set (&self->enabled, 1);
+}
+
+void
+anticipative_renderer_invalidate (
+  AnticipativeRenderer * self)
+{
+  if (!self)
+    return;
+
+  g_atomic_int_inc (&self->invalidations);
+}
+
+void
+anticipative_renderer_on_track_live_changed (
+  Track * track)
+{
+  if (
+    !ROUTER || !ROUTER->graph
+    || !ROUTER->graph->anticipative
+    || !ROUTER->graph->compiled || !PROJECT->loaded
+    || !ZRYTHM_APP_IS_GTK_THREAD
+    || !track_is_in_active_project (track)
+    || track_is_auditioner (track))
+    return;
+
+  GraphNode * node = graph_find_node_from_track (
+    ROUTER->graph, track, false);
+  if (!node)
+    return;
+
+  bool rendered_ahead = node->anticipative != NULL;
+  bool can_be_rendered_ahead =
+    track_can_be_rendered_ahead (track);
+  if (rendered_ahead != can_be_rendered_ahead)
+    {
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+    }
+}
+
+bool
+anticipative_renderer_is_current_thread (
+  const AnticipativeRenderer * self)
+{
+  return self && self->thread
+         && g_thread_self () == self->thread;
+}
+
+AnticipativeRenderer *
+anticipative_renderer_new (Graph * graph)
+{
+  int lookahead_ms =
+    env_get_int ("ZRYTHM_DSP_ANTICIPATIVE_MS", 0);
+  if (lookahead_ms <= 0)
+    return NULL;
+
+  AnticipativeRenderer * self =
+    object_new (AnticipativeRenderer);
+
+  self->graph = graph;
+  self->lookahead_ms = lookahead_ms;
+  zix_sem_init (&self->wake, 0);
+  g_atomic_int_set (&self->enabled, 1);
+
+  g_message (
+    "rendering tracks up to %d ms ahead",
+    lookahead_ms);
+
+  return self;
+}
+
+void
+anticipative_renderer_terminate (
+  AnticipativeRenderer * self)
+{
+  if (!self->thread)
+    return;
+
+  g_atomic_int_set (&self->terminate, 1);
+  zix_sem_post (&self->wake);
+  g_thread_join (self->thread);
+  self->thread = NULL;
+}
+
+void
+anticipative_renderer_free (
+  AnticipativeRenderer * self)
+{
+  anticipative_renderer_terminate (self);
+
+  zix_sem_destroy (&self->wake);
+  object_set_to_zero (&self->wake);
+
+  object_zero_and_free (self);
+}
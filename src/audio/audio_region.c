@@ -284,6 +284,35 @@ timestretch_buf (
     == frames_to_process);
 }
 
+/**
+ * Gets the part of the cycle that falls in
+ * [\p start, \p end).
+ *
+ * @param block_start Frame of the first frame in
+ *   the cycle.
+ *
+ * @return Whether there is any.
+ */
+static bool
+get_block_overlap (
+  signed_frame_t   block_start,
+  nframes_t        block_frames,
+  signed_frame_t   start,
+  signed_frame_t   end,
+  signed_frame_t * overlap_start,
+  nframes_t *      overlap_frames)
+{
+  signed_frame_t from = MAX (block_start, start);
+  signed_frame_t to = MIN (
+    block_start + (signed_frame_t) block_frames, end);
+  if (from >= to)
+    return false;
+
+  *overlap_start = from;
+  *overlap_frames = (nframes_t) (to - from);
+  return true;
+}
+
 /**
  * Fills audio data from the region.
  *
@@ -520,115 +549,88 @@ audio_region_fill_stereo_ports (
   const signed_frame_t local_builtin_fade_out_start_frames =
     r_obj->end_pos.frames
     - (AUDIO_REGION_BUILTIN_FADE_FRAMES + r_obj->pos.frames);
-  for (nframes_t j = 0; j < time_nfo->nframes; j++)
-    {
-      const unsigned_frame_t current_cycle_frame =
-        time_nfo->local_offset + j;
-
-      /* current frame local to region start */
-      const signed_frame_t current_local_frame =
-        (signed_frame_t) (time_nfo->g_start_frame + current_cycle_frame)
-        - r_obj->pos.frames;
 
-      /* skip to fade out (or builtin fade out) if
-       * not in any fade area */
-      if (
-        G_LIKELY (
-          current_local_frame >= MAX (
-            r_obj->fade_in_pos.frames,
-            AUDIO_REGION_BUILTIN_FADE_FRAMES)
-          && current_local_frame < MIN (
-               r_obj->fade_out_pos.frames,
-               local_builtin_fade_out_start_frames)))
-        {
-          j +=
-            MIN (
-              r_obj->fade_out_pos.frames,
-              local_builtin_fade_out_start_frames)
-            - current_local_frame;
-          j--;
-          continue;
-        }
-
-      /* if inside object fade in */
-      if (
-        current_local_frame >= 0
-        && current_local_frame
-             < num_frames_in_fade_in_area)
-        {
-          float fade_in = (float) fade_get_y_normalized (
-            (double) current_local_frame
-              / (double) num_frames_in_fade_in_area,
-            &r_obj->fade_in_opts, 1);
-
-          stereo_ports->l
-            ->buf[current_cycle_frame] *= fade_in;
-          stereo_ports->r
-            ->buf[current_cycle_frame] *= fade_in;
-        }
-      /* if inside object fade out */
-      if (
-        current_local_frame
-        >= r_obj->fade_out_pos.frames)
-        {
-          z_return_if_fail_cmp (
-            num_frames_in_fade_out_area, >, 0);
-          signed_frame_t
-            num_frames_from_fade_out_start =
-              current_local_frame
-              - r_obj->fade_out_pos.frames;
-          z_return_if_fail_cmp (
-            num_frames_from_fade_out_start, <=,
-            num_frames_in_fade_out_area);
-          float fade_out = (float) fade_get_y_normalized (
-            (double) num_frames_from_fade_out_start
-              / (double) num_frames_in_fade_out_area,
-            &r_obj->fade_out_opts, 0);
-
-          stereo_ports->l
-            ->buf[current_cycle_frame] *= fade_out;
-          stereo_ports->r
-            ->buf[current_cycle_frame] *= fade_out;
-        }
-      /* if inside builtin fade in, apply builtin
-       * fade in */
-      if (
-        current_local_frame >= 0
-        && current_local_frame
-             < AUDIO_REGION_BUILTIN_FADE_FRAMES)
-        {
-          float fade_in =
-            (float) current_local_frame
-            / (float)
-              AUDIO_REGION_BUILTIN_FADE_FRAMES;
-
-          stereo_ports->l
-            ->buf[current_cycle_frame] *= fade_in;
-          stereo_ports->r
-            ->buf[current_cycle_frame] *= fade_in;
-        }
-      /* if inside builtin fade out, apply builtin
-       * fade out */
-      if (
-        current_local_frame
-        >= local_builtin_fade_out_start_frames)
-        {
-          signed_frame_t
-            num_frames_from_fade_out_start =
-              current_local_frame
-              - local_builtin_fade_out_start_frames;
-          z_return_if_fail_cmp (
-            num_frames_from_fade_out_start, <=,
-            AUDIO_REGION_BUILTIN_FADE_FRAMES);
-          float fade_out =
-            1.f
-            - ((float) num_frames_from_fade_out_start / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES);
-
-          stereo_ports->l
-            ->buf[current_cycle_frame] *= fade_out;
-          stereo_ports->r
-            ->buf[current_cycle_frame] *= fade_out;
-        }
+  /* frame local to region start of the first
+   * frame in the cycle */
+  const signed_frame_t block_start =
+    (signed_frame_t) (time_nfo->g_start_frame + time_nfo->local_offset)
+    - r_obj->pos.frames;
+  float * lbuf =
+    &stereo_ports->l->buf[time_nfo->local_offset];
+  float * rbuf =
+    &stereo_ports->r->buf[time_nfo->local_offset];
+  signed_frame_t start;
+  nframes_t      nframes;
+
+  /* if inside object fade in */
+  if (get_block_overlap (
+        block_start, time_nfo->nframes, 0,
+        num_frames_in_fade_in_area, &start,
+        &nframes))
+    {
+      fade_apply (
+        &r_obj->fade_in_opts, true,
+        &lbuf[start - block_start],
+        &rbuf[start - block_start], start,
+        num_frames_in_fade_in_area, nframes);
+    }
+  /* if inside object fade out (including the
+   * last frame) */
+  if (
+    num_frames_in_fade_out_area > 0
+    && get_block_overlap (
+      block_start, time_nfo->nframes,
+      r_obj->fade_out_pos.frames,
+      r_obj->fade_out_pos.frames
+        + num_frames_in_fade_out_area + 1,
+      &start, &nframes))
+    {
+      fade_apply (
+        &r_obj->fade_out_opts, false,
+        &lbuf[start - block_start],
+        &rbuf[start - block_start],
+        start - r_obj->fade_out_pos.frames,
+        num_frames_in_fade_out_area, nframes);
+    }
+  /* if inside builtin fade in, apply builtin
+   * fade in */
+  if (get_block_overlap (
+        block_start, time_nfo->nframes, 0,
+        AUDIO_REGION_BUILTIN_FADE_FRAMES, &start,
+        &nframes))
+    {
+      float fade_in =
+        (float) start
+        / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES;
+      float inc =
+        1.f / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES;
+      dsp_mul_ramp (
+        &lbuf[start - block_start], fade_in, inc,
+        nframes);
+      dsp_mul_ramp (
+        &rbuf[start - block_start], fade_in, inc,
+        nframes);
+    }
+  /* if inside builtin fade out, apply builtin
+   * fade out */
+  if (get_block_overlap (
+        block_start, time_nfo->nframes,
+        local_builtin_fade_out_start_frames,
+        local_builtin_fade_out_start_frames
+          + AUDIO_REGION_BUILTIN_FADE_FRAMES + 1,
+        &start, &nframes))
+    {
+      float fade_out =
+        1.f
+        - ((float) (start - local_builtin_fade_out_start_frames) / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES);
+      float inc =
+        -1.f / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES;
+      dsp_mul_ramp (
+        &lbuf[start - block_start], fade_out, inc,
+        nframes);
+      dsp_mul_ramp (
+        &rbuf[start - block_start], fade_out, inc,
+        nframes);
     }
 }
 
@@ -199,6 +199,7 @@ automation_point_set_fvalue (
   g_message ("setting to %f", (double) real_val);
   self->fvalue = real_val;
   self->normalized_val = normalized_val;
+  automation_track_bump_edit_generation ();
 
   if (ZRYTHM_TESTING)
     {
@@ -7,6 +7,7 @@
 
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
+#include "audio/automation_track.h"
 #include "audio/position.h"
 #include "audio/region.h"
 #include "gui/backend/automation_selections.h"
@@ -105,6 +106,8 @@ automation_region_force_sort (ZRegion * self)
       automation_point_set_region_and_index (
         self->aps[i], self, i);
     }
+
+  automation_track_bump_edit_generation ();
 }
 
 /**
@@ -252,6 +255,7 @@ automation_region_remove_ap (
     }
 
   array_delete (self->aps, self->num_aps, ap);
+  automation_track_bump_edit_generation ();
 
   if (!freeing_region)
     {
@@ -3,6 +3,7 @@
 
 #include <math.h>
 
+#include "audio/anticipative_renderer.h"
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
 #include "audio/automation_track.h"
@@ -262,6 +263,7 @@ automation_track_insert_region (
 
   self->regions[idx] = region;
   region_set_automation_track (region, self);
+  automation_track_bump_edit_generation ();
   region->id.idx = idx;
   region_update_identifier (region);
 }
@@ -557,6 +559,14 @@ automation_track_set_automation_mode (
 
   self->automation_mode = mode;
 
+  Track * track =
+    automation_track_get_track (self);
+  if (track)
+    {
+      anticipative_renderer_on_track_live_changed (
+        track);
+    }
+
   if (fire_events)
     {
       EVENTS_PUSH (
@@ -680,6 +690,7 @@ automation_track_remove_region (
 
   array_delete (
     self->regions, self->num_regions, region);
+  automation_track_bump_edit_generation ();
 
   for (int i = region->id.idx;
        i < self->num_regions; i++)
@@ -740,6 +751,264 @@ automation_track_set_index (
     }
 }
 
+/**
+ * Incremented on every edit that may change the
+ * result of automation reads.
+ *
+ * Starts at 1 so that zeroed caches are invalid.
+ */
+static volatile gint edit_generation = 1;
+
+void
+automation_track_bump_edit_generation (void)
+{
+  g_atomic_int_inc (&edit_generation);
+}
+
+/**
+ * Picks the region to read from like
+ * automation_track_get_region_before_pos() and
+ * remembers the frames around @p frame in which
+ * the same region would be picked.
+ *
+ * The picked region can only change when a region
+ * starts or, if @p ends_after is set, ends.
+ */
+static void
+read_cache_find_region (
+  AutomationTrack *    self,
+  const signed_frame_t frame,
+  const bool           ends_after)
+{
+  AutomationReadCache * cache = &self->read_cache;
+  ZRegion *             region = NULL;
+  signed_frame_t        region_end = 0;
+  signed_frame_t        valid_start = G_MININT64;
+  signed_frame_t        valid_end = G_MAXINT64;
+  for (int i = self->num_regions - 1; i >= 0; i--)
+    {
+      ZRegion *              r = self->regions[i];
+      const ArrangerObject * r_obj =
+        (const ArrangerObject *) r;
+      const signed_frame_t start = r_obj->pos.frames;
+      const signed_frame_t end =
+        r_obj->end_pos.frames;
+
+      if (start <= frame)
+        valid_start = MAX (valid_start, start);
+      else
+        valid_end = MIN (valid_end, start);
+      if (ends_after)
+        {
+          if (end + 1 <= frame)
+            valid_start = MAX (valid_start, end + 1);
+          else
+            valid_end = MIN (valid_end, end + 1);
+        }
+
+      if (start > frame)
+        continue;
+
+      /* same precedence as
+       * automation_track_get_region_before_pos() */
+      if (ends_after)
+        {
+          if (!region && end >= frame)
+            region = r;
+        }
+      else if (!region || end > region_end)
+        {
+          region = r;
+          region_end = end;
+        }
+    }
+
+  cache->ends_after = ends_after;
+  cache->region = region;
+  cache->region_start = valid_start;
+  cache->region_end = valid_end;
+  cache->has_segment = false;
+}
+
+/**
+ * Fills in the segment from the automation point
+ * at @p ap_idx until the next one.
+ */
+static void
+read_cache_set_segment (
+  AutomationReadCache * cache,
+  const ZRegion *       region,
+  const int             ap_idx)
+{
+  cache->has_segment = true;
+  cache->ap_idx = ap_idx;
+  if (ap_idx < 0)
+    {
+      cache->segment_start = G_MININT64;
+      cache->segment_end =
+        region->num_aps > 0
+          ? ((ArrangerObject *) region->aps[0])
+              ->pos.frames
+          : G_MAXINT64;
+      return;
+    }
+
+  const AutomationPoint * ap = region->aps[ap_idx];
+  cache->segment_start =
+    ((const ArrangerObject *) ap)->pos.frames;
+  cache->base_val = ap->normalized_val;
+  cache->val_diff = 0.f;
+  cache->start_higher = false;
+  cache->inv_length = 0.0;
+  if (ap_idx == region->num_aps - 1)
+    {
+      cache->segment_end = G_MAXINT64;
+      return;
+    }
+
+  const AutomationPoint * next_ap =
+    region->aps[ap_idx + 1];
+  cache->segment_end =
+    ((const ArrangerObject *) next_ap)->pos.frames;
+  cache->inv_length =
+    1.0
+    / (double) (cache->segment_end - cache->segment_start);
+  cache->val_diff = fabsf (
+    ap->normalized_val - next_ap->normalized_val);
+  cache->start_higher =
+    next_ap->normalized_val < ap->normalized_val;
+  if (cache->start_higher)
+    {
+      cache->base_val = next_ap->normalized_val;
+    }
+}
+
+/**
+ * Finds the segment containing @p local_frame,
+ * checking the one after the cached segment first.
+ *
+ * Automation points are sorted by position.
+ */
+static void
+read_cache_find_segment (
+  AutomationReadCache * cache,
+  const ZRegion *       region,
+  const signed_frame_t  local_frame)
+{
+  /* the next segment is the usual case during
+   * playback */
+  if (
+    cache->has_segment
+    && local_frame >= cache->segment_end
+    && cache->ap_idx + 1 < region->num_aps)
+    {
+      int idx = cache->ap_idx + 1;
+      if (
+        idx == region->num_aps - 1
+        || local_frame
+             < ((ArrangerObject *) region->aps[idx + 1])
+                 ->pos.frames)
+        {
+          read_cache_set_segment (cache, region, idx);
+          return;
+        }
+    }
+
+  /* find the last point at or before the frame */
+  int lo = 0;
+  int hi = region->num_aps;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (
+        ((ArrangerObject *) region->aps[mid])
+          ->pos.frames
+        <= local_frame)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  read_cache_set_segment (cache, region, lo - 1);
+}
+
+bool
+automation_track_read_normalized_val (
+  AutomationTrack *    self,
+  const signed_frame_t frame,
+  const bool           ends_after,
+  float *              val)
+{
+  AutomationReadCache * cache = &self->read_cache;
+
+  const gint generation =
+    g_atomic_int_get (&edit_generation);
+  if (
+    cache->generation != generation
+    || cache->ends_after != ends_after
+    || frame < cache->region_start
+    || frame >= cache->region_end)
+    {
+      read_cache_find_region (
+        self, frame, ends_after);
+      cache->generation = generation;
+    }
+
+  ZRegion * region = cache->region;
+  if (!region)
+    return false;
+
+  /* same as arranger_object_get_muted () for
+   * automation regions */
+  const ArrangerObject * r_obj =
+    (const ArrangerObject *) region;
+  if (
+    self->automation_mode == AUTOMATION_MODE_OFF
+    || r_obj->muted)
+    return false;
+
+  /* if region ends before the frame, assume the
+   * frame is the region's end */
+  const signed_frame_t local_frame =
+    region_timeline_frames_to_local (
+      region,
+      !ends_after && r_obj->end_pos.frames < frame
+        ? r_obj->end_pos.frames - 1
+        : frame,
+      F_NORMALIZE);
+
+  if (
+    !cache->has_segment
+    || local_frame < cache->segment_start
+    || local_frame >= cache->segment_end)
+    {
+      read_cache_find_segment (
+        cache, region, local_frame);
+    }
+
+  if (cache->ap_idx < 0)
+    return false;
+
+  /* after the last point */
+  if (cache->segment_end == G_MAXINT64)
+    {
+      *val = cache->base_val;
+      return true;
+    }
+
+  /* the curve options are not cached since they
+   * can be changed without moving the point */
+  AutomationPoint * ap = region->aps[cache->ap_idx];
+  double            ratio =
+    (double) (local_frame - cache->segment_start)
+    * cache->inv_length;
+  *val =
+    (float) curve_get_normalized_y (
+      ratio, &ap->curve_opts, cache->start_higher)
+      * cache->val_diff
+    + cache->base_val;
+  return true;
+}
+
 /**
  * Returns the actual parameter value at the given
  * position.
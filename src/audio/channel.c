@@ -346,33 +346,19 @@ disconnect_prev_next (
 }
 
 /**
- * Prepares the channel for processing.
- *
- * To be called before the main cycle each time on
- * all channels.
+ * Prepares the part of the channel up to the
+ * pre-fader for processing.
  */
 void
-channel_prepare_process (Channel * self)
+channel_prepare_process_pre_fader (Channel * self)
 {
   Plugin * plugin;
   int      j;
   Track *  tr = channel_get_track (self);
-  PortType out_type = tr->out_signal_type;
 
   /* clear buffers */
   track_processor_clear_buffers (tr->processor);
   fader_clear_buffers (self->prefader);
-  fader_clear_buffers (self->fader);
-
-  if (out_type == TYPE_AUDIO)
-    {
-      port_clear_buffer (self->stereo_out->l);
-      port_clear_buffer (self->stereo_out->r);
-    }
-  else if (out_type == TYPE_EVENT)
-    {
-      port_clear_buffer (self->midi_out);
-    }
 
   for (j = 0; j < STRIP_SIZE; j++)
     {
@@ -388,7 +374,9 @@ channel_prepare_process (Channel * self)
 
   for (int i = 0; i < STRIP_SIZE; i++)
     {
-      channel_send_prepare_process (self->sends[i]);
+      if (channel_send_is_prefader (self->sends[i]))
+        channel_send_prepare_process (
+          self->sends[i]);
     }
 
   if (tr->in_signal_type == TYPE_EVENT)
@@ -411,6 +399,50 @@ channel_prepare_process (Channel * self)
     }
 }
 
+/**
+ * Prepares the fader and the rest of the channel
+ * after it for processing.
+ */
+void
+channel_prepare_process_post_fader (Channel * self)
+{
+  Track *  tr = channel_get_track (self);
+  PortType out_type = tr->out_signal_type;
+
+  /* clear buffers */
+  fader_clear_buffers (self->fader);
+
+  if (out_type == TYPE_AUDIO)
+    {
+      port_clear_buffer (self->stereo_out->l);
+      port_clear_buffer (self->stereo_out->r);
+    }
+  else if (out_type == TYPE_EVENT)
+    {
+      port_clear_buffer (self->midi_out);
+    }
+
+  for (int i = 0; i < STRIP_SIZE; i++)
+    {
+      if (!channel_send_is_prefader (self->sends[i]))
+        channel_send_prepare_process (
+          self->sends[i]);
+    }
+}
+
+/**
+ * Prepares the channel for processing.
+ *
+ * To be called before the main cycle each time on
+ * all channels.
+ */
+void
+channel_prepare_process (Channel * self)
+{
+  channel_prepare_process_pre_fader (self);
+  channel_prepare_process_post_fader (self);
+}
+
 void
 channel_init_loaded (Channel * self, Track * track)
 {
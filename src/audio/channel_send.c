@@ -206,6 +206,14 @@ channel_send_process (
   g_return_if_fail (track);
   if (track->out_signal_type == TYPE_AUDIO)
     {
+      /* the output was cleared before the cycle */
+      if (stereo_ports_is_silent (self->stereo_in))
+        {
+          stereo_ports_mark_silent (
+            self->stereo_out, local_offset, true);
+          return;
+        }
+
       if (math_floats_equal_epsilon (
             self->amount->control, 1.f, 0.00001f))
         {
@@ -229,6 +237,8 @@ channel_send_process (
             &self->stereo_in->r->buf[local_offset],
             1.f, self->amount->control, nframes);
         }
+      stereo_ports_mark_silent (
+        self->stereo_out, local_offset, false);
     }
   else if (track->out_signal_type == TYPE_EVENT)
     {
@@ -36,6 +36,7 @@
 #include <signal.h>
 #include <stdlib.h>
 
+#include "audio/anticipative_renderer.h"
 #include "audio/automation_track.h"
 #include "audio/automation_tracklist.h"
 #include "audio/channel.h"
@@ -74,6 +75,8 @@
 #include "settings/settings.h"
 #include "utils/arrays.h"
 #include "utils/dsp.h"
+#include "utils/dsp_simd.h"
+#include "utils/env.h"
 #include "utils/flags.h"
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
@@ -723,6 +726,15 @@ init_common (AudioEngine * self)
   self->metronome = metronome_new ();
   self->router = router_new ();
 
+  self->flush_denormals =
+    dsp_simd_can_flush_denormals ()
+    && !env_get_int ("ZRYTHM_DSP_DENORMAL_FILL", 0);
+  g_message (
+    "denormals will be %s",
+    self->flush_denormals
+      ? "flushed to zero"
+      : "prevented with a small offset");
+
   /* get audio backend */
   AudioBackend ab_code = AUDIO_BACKEND_DUMMY;
   if (ZRYTHM_TESTING)
@@ -1385,12 +1397,13 @@ clear_output_buffers (
 
     /* clear outputs exposed to jack */
 #ifdef HAVE_JACK
-  for (size_t i = 0;
-       i < ROUTER->graph->external_out_ports->len;
+  GPtrArray * external_out_ports =
+    ROUTER->graph->compiled->external_out_ports;
+  for (size_t i = 0; i < external_out_ports->len;
        i++)
     {
-      Port * port = g_ptr_array_index (
-        ROUTER->graph->external_out_ports, i);
+      Port * port =
+        g_ptr_array_index (external_out_ports, i);
 
       if (
         port->internal_type == INTERNAL_JACK_PORT
@@ -1436,7 +1449,11 @@ engine_process_prepare (
   g_atomic_int_set (
     &self->preparing_for_process, 1);
 
-  if (self->denormal_prevention_val_positive)
+  if (self->flush_denormals)
+    {
+      self->denormal_prevention_val = 0.f;
+    }
+  else if (self->denormal_prevention_val_positive)
     {
       self->denormal_prevention_val = -1e-20f;
     }
@@ -1534,13 +1551,24 @@ engine_process_prepare (
   sample_processor_prepare_process (
     self->sample_processor, nframes);
 
-  /* prepare channels for this cycle */
+  /* prepare channels for this cycle (the part
+   * before the fader of tracks rendered ahead is
+   * prepared by the anticipative renderer) */
+  AnticipativeRenderer * anticipative =
+    ROUTER->graph ? ROUTER->graph->anticipative
+                  : NULL;
   Channel * ch;
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
     {
       ch = TRACKLIST->tracks[i]->channel;
 
-      if (ch)
+      if (!ch)
+        continue;
+
+      if (anticipative_renderer_is_rendering_track (
+            anticipative, TRACKLIST->tracks[i]))
+        channel_prepare_process_post_fader (ch);
+      else
         channel_prepare_process (ch);
     }
 
@@ -1577,6 +1605,26 @@ receive_midi_events (
     }
 }
 
+/** Whether engine_init_process_thread() was
+ * called on this thread. */
+static _Thread_local bool
+  process_thread_initialized = false;
+
+/**
+ * Prepares the calling thread for processing
+ * (flushing denormals to zero if enabled).
+ */
+void
+engine_init_process_thread (AudioEngine * self)
+{
+  if (G_LIKELY (process_thread_initialized))
+    return;
+
+  dsp_simd_set_flush_denormals (
+    self->flush_denormals);
+  process_thread_initialized = true;
+}
+
 /**
  * Processes current cycle.
  *
@@ -1671,13 +1719,13 @@ engine_process (
         }
 
       /* loop through each route */
+      CompiledGraph * compiled =
+        self->router->graph->compiled;
       for (size_t i = 0;
-           i < self->router->graph->n_init_triggers;
-           i++)
+           i < compiled->n_init_triggers; i++)
         {
           GraphNode * start_node =
-            self->router->graph
-              ->init_trigger_list[i];
+            compiled->init_trigger_list[i];
 
 #define route_latency \
   (start_node->route_playback_latency)
@@ -1841,6 +1889,11 @@ finalize_processing:
 
   self->cycle++;
 
+  /* let graph_setup() know that the graphs
+   * replaced during this cycle are no longer in
+   * use */
+  g_atomic_int_inc (&self->router->graph->epoch);
+
   g_atomic_int_set (&self->cycle_running, 0);
 
   if (ZRYTHM_TESTING)
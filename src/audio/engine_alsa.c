@@ -404,6 +404,7 @@ audio_thread (void * _self)
     (unsigned int) nfds);
   nframes_t frames_processed;
   int l1;
+  engine_init_process_thread (self);
   while (1)
     {
       if (poll (pfds, (nfds_t) nfds, 1000) > 0)
@@ -30,6 +30,8 @@ process_cb (gpointer data)
   g_message (
     "Running dummy audio engine for first time");
 
+  engine_init_process_thread (self);
+
   while (1)
     {
       if (self->stop_dummy_audio_thread)
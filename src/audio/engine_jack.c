@@ -272,6 +272,17 @@ process_cb (nframes_t nframes, void * data)
   return engine_process (engine, nframes);
 }
 
+/**
+ * Called by JACK once in the process thread
+ * before it runs the process callback.
+ */
+static void
+thread_init_cb (void * data)
+{
+  AudioEngine * engine = (AudioEngine *) data;
+  engine_init_process_thread (engine);
+}
+
 /**
  * Client-supplied function that is called whenever
  * an xrun has occurred.
@@ -573,6 +584,8 @@ engine_jack_setup (AudioEngine * self)
   int ret;
   jack_set_process_callback (
     self->client, process_cb, self);
+  jack_set_thread_init_callback (
+    self->client, thread_init_cb, self);
   jack_set_buffer_size_callback (
     self->client,
     (JackBufferSizeCallback) buffer_size_cb, self);
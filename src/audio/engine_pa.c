@@ -36,6 +36,9 @@ pa_stream_cb (
   PaStreamCallbackFlags            status_flags,
   AudioEngine *                    self)
 {
+  /* the callback thread is owned by PortAudio */
+  engine_init_process_thread (self);
+
   engine_process (self, (nframes_t) nframes);
 
   float * outf = (float *) out;
@@ -58,6 +58,9 @@ engine_pulse_stream_write_callback (
       should_free_buffer = TRUE;
     }
 
+  /* the mainloop thread is owned by pulse */
+  engine_init_process_thread (self);
+
   nframes_t num_frames = BYTES_TO_FRAMES (bytes);
   engine_process (self, num_frames);
 
@@ -87,12 +87,13 @@ audio_cb (
   if (!engine_get_run (self))
     return 0;
 
+  /* the callback thread is owned by RtAudio */
+  engine_init_process_thread (self);
+
   nframes_t num_frames = (nframes_t) nframes;
   engine_process (self, num_frames);
 
-  dsp_fill (
-    out_buf, DENORMAL_PREVENTION_VAL,
-    (size_t) (nframes * 2));
+  /* every sample is written below */
   for (nframes_t i = 0; i < num_frames; i++)
     {
 #  ifdef TRIAL_VER
@@ -32,6 +32,9 @@ sdl_callback (void * user_data, Uint8 * buf, int len)
   if (!self->run)
     return;
 
+  /* the callback thread is owned by SDL */
+  engine_init_process_thread (self);
+
   nframes_t num_frames = AUDIO_ENGINE->block_length;
   /*g_message (*/
   /*"processing for num frames %u (len %d)",*/
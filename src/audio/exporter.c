@@ -13,6 +13,7 @@
 #  include "audio/engine_jack.h"
 #endif
 #include "audio/exporter.h"
+#include "audio/loudness_analyzer.h"
 #include "audio/marker_track.h"
 #include "audio/master_track.h"
 #include "audio/midi_event.h"
@@ -20,9 +21,11 @@
 #include "audio/router.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
+#include "audio/true_peak_detector.h"
 #include "gui/widgets/main_window.h"
 #include "project.h"
 #include "settings/settings.h"
+#include "utils/dsp.h"
 #include "utils/error.h"
 #include "utils/flags.h"
 #include "utils/io.h"
@@ -84,6 +87,128 @@ export_format_from_pretty_str (
   g_return_val_if_reached (EXPORT_FORMAT_FLAC);
 }
 
+/**
+ * Returns a newly allocated human friendly
+ * description of the loudness.
+ */
+char *
+export_loudness_to_str (const ExportLoudness * self)
+{
+  return g_strdup_printf (
+    _ ("Integrated loudness: %.1f LUFS\n"
+       "Loudness range: %.1f LU\n"
+       "True peak: %.1f dBTP"),
+    (double) self->integrated, (double) self->range,
+    (double) self->true_peak);
+}
+
+/**
+ * Dithers the given interleaved frames if needed
+ * and writes them at \p covered_frames.
+ */
+static void
+write_frames (
+  ExportSettings * info,
+  SNDFILE *        sndfile,
+  Ditherer *       ditherer,
+  float *          frames,
+  nframes_t        nframes,
+  sf_count_t       covered_frames)
+{
+  /* apply dither */
+  if (info->dither)
+    {
+      ditherer_process (ditherer, frames, nframes, 2);
+    }
+
+  /* seek to the write position in the file */
+  if (covered_frames != 0)
+    {
+      sf_count_t seek_cnt = sf_seek (
+        sndfile, covered_frames,
+        SEEK_SET | SFM_WRITE);
+
+      /* wav is weird for some reason */
+      if (
+        info->format == EXPORT_FORMAT_WAV
+        || info->format == EXPORT_FORMAT_RAW)
+        {
+          if (seek_cnt < 0)
+            {
+              char err[256];
+              sf_error_str (
+                0, err, sizeof (err) - 1);
+              g_message (
+                "Error seeking file: %s", err);
+            }
+          g_warn_if_fail (seek_cnt == covered_frames);
+        }
+    }
+
+  /* write the frames for the current cycle */
+  sf_count_t written_frames =
+    sf_writef_float (sndfile, frames, nframes);
+  g_warn_if_fail (written_frames == nframes);
+}
+
+/**
+ * Writes the rendered frames to the export file
+ * with the loudness normalization gain applied.
+ *
+ * The gain is limited so that the true peak stays
+ * under EXPORT_TRUE_PEAK_CEILING.
+ */
+static void
+write_normalized (
+  ExportSettings * info,
+  SNDFILE *        render_file,
+  SNDFILE *        sndfile,
+  Ditherer *       ditherer,
+  float *          frames,
+  nframes_t        block_length)
+{
+  ExportLoudness * loudness = &info->loudness;
+  if (isfinite (loudness->integrated))
+    {
+      loudness->gain =
+        info->loudness_target - loudness->integrated;
+    }
+  if (isfinite (loudness->true_peak))
+    {
+      /* the true peak scales with the gain */
+      loudness->gain = MIN (
+        loudness->gain,
+        EXPORT_TRUE_PEAK_CEILING
+          - loudness->true_peak);
+    }
+  float gain = math_dbfs_to_amp (loudness->gain);
+  g_message (
+    "normalizing loudness to %.1f LUFS (%.2f dB)",
+    (double) info->loudness_target,
+    (double) loudness->gain);
+
+  sf_seek (render_file, 0, SEEK_SET);
+  sf_count_t covered_frames = 0;
+  sf_count_t read_frames;
+  while (
+    !info->progress_info.cancelled
+    && (read_frames = sf_readf_float (
+          render_file, frames, block_length))
+         > 0)
+    {
+      nframes_t nframes = (nframes_t) read_frames;
+      dsp_mul_k2 (frames, gain, nframes * 2);
+      write_frames (
+        info, sndfile, ditherer, frames, nframes,
+        covered_frames);
+      covered_frames += read_frames;
+    }
+
+  loudness->integrated += loudness->gain;
+  loudness->max_momentary += loudness->gain;
+  loudness->true_peak += loudness->gain;
+}
+
 static int
 export_audio (ExportSettings * info)
 {
@@ -259,6 +384,59 @@ export_audio (ExportSettings * info)
   sf_set_string (
     sndfile, SF_STR_GENRE, info->genre);
 
+  /* when normalizing, the gain is only known at
+   * the end, so render to a temporary file first */
+  SNDFILE * render_file = NULL;
+  char *    render_dir = NULL;
+  char *    render_path = NULL;
+  if (info->normalize_loudness)
+    {
+      GError * err = NULL;
+      render_dir = g_dir_make_tmp (
+        "zrythm_export_XXXXXX", &err);
+      if (!render_dir)
+        {
+          info->progress_info.has_error = true;
+          sprintf (
+            info->progress_info.error_str,
+            _ ("Failed to create temporary "
+               "directory: %s"),
+            err->message);
+          g_warning (
+            "%s", info->progress_info.error_str);
+          g_error_free (err);
+          sf_close (sndfile);
+
+          return -1;
+        }
+      render_path = g_build_filename (
+        render_dir, "render.w64", NULL);
+      SF_INFO render_info = {
+        .samplerate = sfinfo.samplerate,
+        .channels = EXPORT_CHANNELS,
+        .format = SF_FORMAT_W64 | SF_FORMAT_FLOAT,
+      };
+      render_file = sf_open (
+        render_path, SFM_RDWR, &render_info);
+      if (!render_file)
+        {
+          int error = sf_error (NULL);
+          info->progress_info.has_error = true;
+          sprintf (
+            info->progress_info.error_str,
+            _ ("Couldn't open SNDFILE %s:\n%d: %s"),
+            render_path, error,
+            sf_error_number (error));
+          g_warning (
+            "%s", info->progress_info.error_str);
+          sf_close (sndfile);
+          g_free (render_path);
+          g_free (render_dir);
+
+          return -1;
+        }
+    }
+
   Position prev_playhead_pos;
   /* position to start at */
   POSITION_INIT_ON_STACK (start_pos);
@@ -346,6 +524,15 @@ export_audio (ExportSettings * info)
         audio_bit_depth_enum_to_int (info->depth));
     }
 
+  /* measure the loudness of the mix while
+   * rendering */
+  LoudnessAnalyzer * loudness_analyzer =
+    loudness_analyzer_new (AUDIO_ENGINE->sample_rate);
+  TruePeakDetector true_peak_detectors[2];
+  true_peak_detector_reset (&true_peak_detectors[0]);
+  true_peak_detector_reset (&true_peak_detectors[1]);
+  float true_peak = 0.f;
+
   nframes_t nframes;
   g_return_val_if_fail (
     stop_pos.frames >= 1 || start_pos.frames >= 0,
@@ -390,54 +577,38 @@ export_audio (ExportSettings * info)
       /* by this time, the Master channel should
        * have its Stereo Out ports filled.
        * pass its buffers to the output */
+      const float * l =
+        P_MASTER_TRACK->channel->stereo_out->l->buf;
+      const float * r =
+        P_MASTER_TRACK->channel->stereo_out->r->buf;
       for (nframes_t i = 0; i < nframes; i++)
         {
-          out_ptr[i * 2] =
-            P_MASTER_TRACK->channel->stereo_out->l
-              ->buf[i];
-          out_ptr[i * 2 + 1] =
-            P_MASTER_TRACK->channel->stereo_out->r
-              ->buf[i];
+          out_ptr[i * 2] = l[i];
+          out_ptr[i * 2 + 1] = r[i];
         }
 
-      /* apply dither */
-      if (info->dither)
+      loudness_analyzer_process (
+        loudness_analyzer, l, r, nframes);
+      float l_true_peak = true_peak_detector_process (
+        &true_peak_detectors[0], l, nframes);
+      float r_true_peak = true_peak_detector_process (
+        &true_peak_detectors[1], r, nframes);
+      true_peak =
+        MAX (true_peak, MAX (l_true_peak, r_true_peak));
+
+      if (render_file)
         {
-          ditherer_process (
-            &ditherer, out_ptr, nframes, 2);
+          sf_count_t written_frames = sf_writef_float (
+            render_file, out_ptr, nframes);
+          g_warn_if_fail (written_frames == nframes);
         }
-
-      /* seek to the write position in the file */
-      if (covered_frames != 0)
+      else
         {
-          sf_count_t seek_cnt = sf_seek (
-            sndfile, covered_frames,
-            SEEK_SET | SFM_WRITE);
-
-          /* wav is weird for some reason */
-          if (
-            info->format == EXPORT_FORMAT_WAV
-            || info->format == EXPORT_FORMAT_RAW)
-            {
-              if (seek_cnt < 0)
-                {
-                  char err[256];
-                  sf_error_str (
-                    0, err, sizeof (err) - 1);
-                  g_message (
-                    "Error seeking file: %s", err);
-                }
-              g_warn_if_fail (
-                seek_cnt == covered_frames);
-            }
+          write_frames (
+            info, sndfile, &ditherer, out_ptr,
+            nframes, covered_frames);
         }
 
-      /* write the frames for the current
-       * cycle */
-      sf_count_t written_frames = sf_writef_float (
-        sndfile, out_ptr, nframes);
-      g_warn_if_fail (written_frames == nframes);
-
       covered_frames += nframes;
       covered_ticks +=
         AUDIO_ENGINE->ticks_per_frame * nframes;
@@ -475,6 +646,44 @@ export_audio (ExportSettings * info)
 
   /* TODO silence output */
 
+  if (!info->progress_info.cancelled)
+    {
+      ExportLoudness * loudness = &info->loudness;
+      loudness->integrated =
+        loudness_analyzer_get_integrated (
+          loudness_analyzer);
+      loudness->range = loudness_analyzer_get_range (
+        loudness_analyzer);
+      loudness->max_momentary =
+        loudness_analyzer_get_max_momentary (
+          loudness_analyzer);
+      loudness->true_peak =
+        math_amp_to_dbfs (true_peak);
+      loudness->gain = 0.f;
+
+      if (render_file)
+        {
+          write_normalized (
+            info, render_file, sndfile, &ditherer,
+            out_ptr, AUDIO_ENGINE->block_length);
+        }
+
+      char * loudness_str =
+        export_loudness_to_str (&info->loudness);
+      g_message ("%s", loudness_str);
+      g_free (loudness_str);
+    }
+  loudness_analyzer_free (loudness_analyzer);
+
+  if (render_file)
+    {
+      sf_close (render_file);
+      io_remove (render_path);
+      io_rmdir (render_dir, false);
+      g_free (render_path);
+      g_free (render_dir);
+    }
+
   info->progress_info.progress = 1.0;
 
   /* set jack freewheeling mode and transport type */
@@ -866,6 +1075,7 @@ export_settings_print (const ExportSettings * self)
     "bounce with parents: %d\n"
     "bounce step: %s\n"
     "dither: %d\n"
+    "normalize loudness: %d (%.1f LUFS)\n"
     "file: %s\n"
     "num files: %d\n",
     export_format_to_pretty_str (self->format),
@@ -875,7 +1085,9 @@ export_settings_print (const ExportSettings * self)
     self->disable_after_bounce,
     self->bounce_with_parents,
     bounce_step_to_str (self->bounce_step),
-    self->dither, self->file_uri, self->num_files);
+    self->dither, self->normalize_loudness,
+    (double) self->loudness_target, self->file_uri,
+    self->num_files);
 }
 
 void
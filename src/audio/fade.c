@@ -1,10 +1,28 @@
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 /*
- * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2020, 2022 Alexandros Theodotou <alex at zrythm dot org>
  */
 
 #include "audio/curve.h"
 #include "audio/fade.h"
+#include "utils/dsp.h"
+
+#include <glib.h>
+
+/**
+ * Number of table segments at each edge where the
+ * fade is calculated for each frame.
+ */
+#define EXACT_EDGE_SEGMENTS 4
+
+static FadeTable tables[FADE_TABLE_CACHE_SIZE];
+
+/** Held while filling a table, so that only one
+ * table is replaced at a time. */
+static GMutex fill_lock;
+
+/** Incremented on each acquire. */
+static volatile gint acquire_count;
 
 /**
  * Gets the normalized Y for a normalized X.
@@ -20,3 +38,251 @@ fade_get_y_normalized (
 {
   return curve_get_normalized_y (x, opts, !fade_in);
 }
+
+static bool
+table_matches (
+  const FadeTable *    self,
+  const CurveOptions * opts,
+  bool                 fade_in)
+{
+  return self->valid && self->fade_in == fade_in
+         && curve_options_are_equal (
+           &self->opts, opts);
+}
+
+/**
+ * Adds a user to the table unless it is being
+ * filled.
+ */
+static bool
+table_ref (FadeTable * self)
+{
+  for (;;)
+    {
+      int refcount =
+        g_atomic_int_get (&self->refcount);
+      if (refcount < 0)
+        return false;
+      if (g_atomic_int_compare_and_exchange (
+            &self->refcount, refcount, refcount + 1))
+        return true;
+    }
+}
+
+/**
+ * Returns a table for the given fade, filling one
+ * if needed.
+ *
+ * This does not block, so it can be used in the
+ * audio threads.
+ *
+ * @return The table, or NULL if no table could be
+ *   used without waiting. Must be released with
+ *   fade_table_release().
+ */
+const FadeTable *
+fade_table_acquire (
+  const CurveOptions * opts,
+  bool                 fade_in)
+{
+  gint now = g_atomic_int_add (&acquire_count, 1);
+
+  for (int i = 0; i < FADE_TABLE_CACHE_SIZE; i++)
+    {
+      FadeTable * table = &tables[i];
+      if (!table_matches (table, opts, fade_in))
+        continue;
+
+      if (!table_ref (table))
+        continue;
+
+      /* check again in case it was refilled
+       * before the ref */
+      if (table_matches (table, opts, fade_in))
+        {
+          g_atomic_int_set (&table->last_used, now);
+          return table;
+        }
+      fade_table_release (table);
+    }
+
+  /* not found - replace the least recently used
+   * table that is not in use */
+  if (!g_mutex_trylock (&fill_lock))
+    return NULL;
+
+  FadeTable *  table = NULL;
+  unsigned int max_age = 0;
+  for (int i = 0; i < FADE_TABLE_CACHE_SIZE; i++)
+    {
+      FadeTable * cur = &tables[i];
+      if (g_atomic_int_get (&cur->refcount) != 0)
+        continue;
+
+      /* unsigned so that it works when the count
+       * wraps around */
+      unsigned int age =
+        (unsigned int) now
+        - (unsigned int) g_atomic_int_get (
+          &cur->last_used);
+      if (!table || age > max_age)
+        {
+          table = cur;
+          max_age = age;
+        }
+    }
+  if (
+    !table
+    || !g_atomic_int_compare_and_exchange (
+      &table->refcount, 0, -1))
+    {
+      g_mutex_unlock (&fill_lock);
+      return NULL;
+    }
+
+  table->valid = false;
+  table->opts = *opts;
+  table->fade_in = fade_in;
+  for (int i = 0; i <= FADE_TABLE_SIZE; i++)
+    {
+      table->y[i] = (float) fade_get_y_normalized (
+        (double) i / FADE_TABLE_SIZE, &table->opts,
+        fade_in);
+    }
+  table->valid = true;
+  g_atomic_int_set (&table->last_used, now);
+
+  /* publish with the caller as its only user */
+  g_atomic_int_set (&table->refcount, 1);
+  g_mutex_unlock (&fill_lock);
+
+  return table;
+}
+
+void
+fade_table_release (const FadeTable * self)
+{
+  (void) g_atomic_int_dec_and_test (
+    &((FadeTable *) self)->refcount);
+}
+
+/**
+ * Multiplies the frames with the fade calculated
+ * for each frame.
+ */
+static void
+apply_exact (
+  const CurveOptions * opts,
+  bool                 fade_in,
+  float *              l,
+  float *              r,
+  signed_frame_t       pos,
+  signed_frame_t       len,
+  nframes_t            nframes)
+{
+  CurveOptions opts_copy = *opts;
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      float y = (float) fade_get_y_normalized (
+        (double) (pos + i) / (double) len,
+        &opts_copy, fade_in);
+      l[i] *= y;
+      r[i] *= y;
+    }
+}
+
+/**
+ * Multiplies the given frames with the fade.
+ *
+ * The fade is applied as linear segments between
+ * the points of a fade table. It is calculated
+ * for each frame near the edges, where steep
+ * curves bend too much for linear segments, for
+ * pulses, and when a table is not available.
+ *
+ * @param l Left channel.
+ * @param r Right channel.
+ * @param pos Position of the first frame in the
+ *   fade (0 to \p len inclusive).
+ * @param len Length of the fade in frames.
+ */
+void
+fade_apply (
+  const CurveOptions * opts,
+  bool                 fade_in,
+  float *              l,
+  float *              r,
+  signed_frame_t       pos,
+  signed_frame_t       len,
+  nframes_t            nframes)
+{
+  g_return_if_fail (
+    len > 0 && pos >= 0
+    && pos + (signed_frame_t) nframes <= len + 1);
+
+  /* pulses are cheap to calculate and would be
+   * smoothed by the table */
+  if (opts->algo == CURVE_ALGORITHM_PULSE)
+    {
+      apply_exact (
+        opts, fade_in, l, r, pos, len, nframes);
+      return;
+    }
+
+  const FadeTable * table =
+    fade_table_acquire (opts, fade_in);
+  if (!table)
+    {
+      apply_exact (
+        opts, fade_in, l, r, pos, len, nframes);
+      return;
+    }
+
+  /* frame f is in segment
+   * k = f * FADE_TABLE_SIZE / len, in which the
+   * fade is linear */
+  nframes_t i = 0;
+  while (i < nframes)
+    {
+      signed_frame_t f = pos + i;
+      signed_frame_t scaled = f * FADE_TABLE_SIZE;
+      signed_frame_t k =
+        MIN (scaled / len, FADE_TABLE_SIZE - 1);
+
+      /* first frame in the next segment */
+      signed_frame_t next_f =
+        ((k + 1) * len + FADE_TABLE_SIZE - 1)
+        / FADE_TABLE_SIZE;
+      nframes_t n = (nframes_t) CLAMP (
+        next_f - f, 1, (signed_frame_t) (nframes - i));
+      if (k == FADE_TABLE_SIZE - 1)
+        n = nframes - i;
+
+      /* steep curves can have an infinite slope
+       * at the edges, where linear segments would
+       * be too far off */
+      if (
+        k < EXACT_EDGE_SEGMENTS
+        || k >= FADE_TABLE_SIZE - EXACT_EDGE_SEGMENTS)
+        {
+          apply_exact (
+            opts, fade_in, &l[i], &r[i], f, len, n);
+        }
+      else
+        {
+          float dy = table->y[k + 1] - table->y[k];
+          float start =
+            table->y[k]
+            + dy * (float) (scaled - k * len)
+                / (float) len;
+          float inc =
+            dy * FADE_TABLE_SIZE / (float) len;
+          dsp_mul_ramp (&l[i], start, inc, n);
+          dsp_mul_ramp (&r[i], start, inc, n);
+        }
+
+      i += n;
+    }
+
+  fade_table_release (table);
+}
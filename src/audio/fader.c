@@ -11,6 +11,7 @@
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/group_target_track.h"
+#include "audio/loudness_analyzer.h"
 #include "audio/master_track.h"
 #include "audio/midi_event.h"
 #include "audio/track.h"
@@ -28,6 +29,22 @@
 
 #include <glib/gi18n.h>
 
+/**
+ * Analyzes the loudness of the master output.
+ */
+static void
+enable_default_loudness_analysis (Fader * self)
+{
+  if (
+    self->type == FADER_TYPE_AUDIO_CHANNEL
+    && !self->passthrough && self->track
+    && self->track->type == TRACK_TYPE_MASTER)
+    {
+      fader_set_loudness_analysis_enabled (
+        self, true);
+    }
+}
+
 /**
  * Inits fader after a project is loaded.
  */
@@ -53,6 +70,8 @@ fader_init_loaded (
   g_ptr_array_unref (ports);
 
   fader_set_amp ((void *) self, self->amp->control);
+
+  enable_default_loudness_analysis (self);
 }
 
 /**
@@ -375,6 +394,8 @@ fader_new (
         midi_events_new ();
     }
 
+  enable_default_loudness_analysis (self);
+
   return self;
 }
 
@@ -942,6 +963,112 @@ fader_update_track_pos (
 }
 #endif
 
+/**
+ * Sets whether the loudness of the output is
+ * analyzed.
+ */
+void
+fader_set_loudness_analysis_enabled (
+  Fader * self,
+  bool    enabled)
+{
+  g_return_if_fail (
+    self->type == FADER_TYPE_AUDIO_CHANNEL
+    && !self->passthrough);
+
+  if (enabled && !self->loudness_analyzer)
+    {
+      g_atomic_pointer_set (
+        &self->loudness_analyzer,
+        loudness_analyzer_new (
+          AUDIO_ENGINE ? AUDIO_ENGINE->sample_rate
+                       : 0));
+    }
+  g_atomic_int_set (
+    &self->analyze_loudness, enabled);
+}
+
+/**
+ * Returns the loudness analyzer of the output, or
+ * NULL if loudness analysis is disabled.
+ */
+LoudnessAnalyzer *
+fader_get_loudness_analyzer (Fader * self)
+{
+  if (!g_atomic_int_get (&self->analyze_loudness))
+    return NULL;
+
+  return self->loudness_analyzer;
+}
+
+/**
+ * Analyzes the loudness of the output, if
+ * enabled.
+ */
+static inline void
+analyze_loudness (
+  Fader *                             self,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  if (!g_atomic_int_get (&self->analyze_loudness))
+    return;
+
+  LoudnessAnalyzer * analyzer =
+    self->loudness_analyzer;
+  if (
+    analyzer->sample_rate
+    != AUDIO_ENGINE->sample_rate)
+    {
+      loudness_analyzer_reset (
+        analyzer, AUDIO_ENGINE->sample_rate);
+    }
+  loudness_analyzer_process (
+    analyzer,
+    &self->stereo_out->l
+       ->buf[time_nfo->local_offset],
+    &self->stereo_out->r
+       ->buf[time_nfo->local_offset],
+    time_nfo->nframes);
+}
+
+/**
+ * Sets the targets of the fader/pan gains and the
+ * mute gain.
+ *
+ * @return The mute gain.
+ */
+static float
+set_gain_targets (
+  Fader *    self,
+  const bool effectively_muted)
+{
+  sample_rate_t sample_rate =
+    AUDIO_ENGINE->sample_rate;
+
+  float pan =
+    port_get_control_value (self->balance, 0);
+  float amp = port_get_control_value (self->amp, 0);
+
+  float calc_l, calc_r;
+  balance_control_get_calc_lr (
+    BALANCE_CONTROL_ALGORITHM_LINEAR, pan, &calc_l,
+    &calc_r);
+
+  smoothed_value_set_gain (
+    &self->gain_l, amp * calc_l, sample_rate);
+  smoothed_value_set_gain (
+    &self->gain_r, amp * calc_r, sample_rate);
+
+  float mute_amp =
+    effectively_muted
+      ? fader_get_amp (CONTROL_ROOM->mute_fader)
+      : 1.f;
+  smoothed_value_set_gain (
+    &self->mute_gain, mute_amp, sample_rate);
+
+  return mute_amp;
+}
+
 /**
  * Process the Fader.
  */
@@ -1012,11 +1139,41 @@ fader_process (
 #endif
     }
 
+  /* nothing to do if the input is silent (the
+   * output was cleared before the cycle) */
+  if (
+    self->type == FADER_TYPE_AUDIO_CHANNEL
+    && stereo_ports_is_silent (self->stereo_in))
+    {
+      stereo_ports_mark_silent (
+        self->stereo_out, time_nfo->local_offset,
+        true);
+
+      /* keep the gains moving so that they don't
+       * ramp from stale values once the signal
+       * comes back */
+      if (!self->passthrough)
+        {
+          set_gain_targets (self, effectively_muted);
+          smoothed_value_skip (
+            &self->gain_l, time_nfo->nframes);
+          smoothed_value_skip (
+            &self->gain_r, time_nfo->nframes);
+          smoothed_value_skip (
+            &self->mute_gain, time_nfo->nframes);
+        }
+
+      analyze_loudness (self, time_nfo);
+      return;
+    }
+
   if (
     self->type == FADER_TYPE_AUDIO_CHANNEL
     || self->type == FADER_TYPE_MONITOR
     || self->type == FADER_TYPE_SAMPLE_PROCESSOR)
     {
+      bool out_silent = false;
+
       /* copy the input to output */
       dsp_copy (
         &self->stereo_out->l
@@ -1059,25 +1216,35 @@ fader_process (
         }
       else /* not prefader */
         {
+          float * bufs[] = {
+            &self->stereo_out->l
+               ->buf[time_nfo->local_offset],
+            &self->stereo_out->r
+               ->buf[time_nfo->local_offset],
+          };
+          sample_rate_t sample_rate =
+            AUDIO_ENGINE->sample_rate;
+
           /* if monitor */
           if (self->type == FADER_TYPE_MONITOR)
             {
               float dim_amp = fader_get_amp (
                 CONTROL_ROOM->dim_fader);
+              bool have_listened =
+                tracklist_has_listened (TRACKLIST);
+
+              /* dim signal if have listened
+               * tracks */
+              smoothed_value_set_gain (
+                &self->listen_dim_gain,
+                have_listened ? dim_amp : 1.f,
+                sample_rate);
+              smoothed_value_apply (
+                &self->listen_dim_gain, bufs, 2,
+                time_nfo->nframes);
 
-              /* if have listened tracks */
-              if (tracklist_has_listened (TRACKLIST))
+              if (have_listened)
                 {
-                  /* dim signal */
-                  dsp_mul_k2 (
-                    &self->stereo_out->l->buf
-                       [time_nfo->local_offset],
-                    dim_amp, time_nfo->nframes);
-                  dsp_mul_k2 (
-                    &self->stereo_out->r->buf
-                       [time_nfo->local_offset],
-                    dim_amp, time_nfo->nframes);
-
                   /* add listened signal */
                   /* TODO add "listen" buffer
                    * on fader struct and add
@@ -1104,18 +1271,14 @@ fader_process (
                             track_get_fader (
                               t, true);
                           dsp_mix2 (
-                            &self->stereo_out->l->buf
-                               [time_nfo
-                                  ->local_offset],
+                            bufs[0],
                             &f->stereo_out->l->buf
                                [time_nfo
                                   ->local_offset],
                             1.f, listen_amp,
                             time_nfo->nframes);
                           dsp_mix2 (
-                            &self->stereo_out->r->buf
-                               [time_nfo
-                                  ->local_offset],
+                            bufs[1],
                             &f->stereo_out->r->buf
                                [time_nfo
                                   ->local_offset],
@@ -1126,38 +1289,27 @@ fader_process (
                 }
 
               /* apply dim if enabled */
-              if (CONTROL_ROOM->dim_output)
-                {
-                  dsp_mul_k2 (
-                    &self->stereo_out->l->buf
-                       [time_nfo->local_offset],
-                    dim_amp, time_nfo->nframes);
-                  dsp_mul_k2 (
-                    &self->stereo_out->r->buf
-                       [time_nfo->local_offset],
-                    dim_amp, time_nfo->nframes);
-                }
+              smoothed_value_set_gain (
+                &self->dim_gain,
+                CONTROL_ROOM->dim_output
+                  ? dim_amp
+                  : 1.f,
+                sample_rate);
+              smoothed_value_apply (
+                &self->dim_gain, bufs, 2,
+                time_nfo->nframes);
             } /* endif monitor fader */
 
-          float pan = port_get_control_value (
-            self->balance, 0);
-          float amp =
-            port_get_control_value (self->amp, 0);
-
-          float calc_l, calc_r;
-          balance_control_get_calc_lr (
-            BALANCE_CONTROL_ALGORITHM_LINEAR, pan,
-            &calc_l, &calc_r);
+          float mute_amp = set_gain_targets (
+            self, effectively_muted);
 
           /* apply fader and pan */
-          dsp_mul_k2 (
-            &self->stereo_out->l
-               ->buf[time_nfo->local_offset],
-            amp * calc_l, time_nfo->nframes);
-          dsp_mul_k2 (
-            &self->stereo_out->r
-               ->buf[time_nfo->local_offset],
-            amp * calc_r, time_nfo->nframes);
+          smoothed_value_apply (
+            &self->gain_l, &bufs[0], 1,
+            time_nfo->nframes);
+          smoothed_value_apply (
+            &self->gain_r, &bufs[1], 1,
+            time_nfo->nframes);
 
           /* make mono if mono compat
            * enabled. equal amplitude is
@@ -1172,44 +1324,33 @@ fader_process (
                 self->mono_compat_enabled))
             {
               dsp_make_mono (
-                &self->stereo_out->l
-                   ->buf[time_nfo->local_offset],
-                &self->stereo_out->r
-                   ->buf[time_nfo->local_offset],
+                bufs[0], bufs[1],
                 time_nfo->nframes, false);
             }
 
-          if (effectively_muted)
+          /* apply mute level */
+          if (
+            mute_amp < 0.00001f
+            && smoothed_value_is_settled (
+              &self->mute_gain))
             {
-              /* apply mute level */
-              float mute_amp = fader_get_amp (
-                CONTROL_ROOM->mute_fader);
-              if (mute_amp < 0.00001f)
-                {
-                  dsp_fill (
-                    &self->stereo_out->l->buf
-                       [time_nfo->local_offset],
-                    AUDIO_ENGINE
-                      ->denormal_prevention_val,
-                    time_nfo->nframes);
-                  dsp_fill (
-                    &self->stereo_out->r->buf
-                       [time_nfo->local_offset],
-                    AUDIO_ENGINE
-                      ->denormal_prevention_val,
-                    time_nfo->nframes);
-                }
-              else
-                {
-                  dsp_mul_k2 (
-                    &self->stereo_out->l->buf
-                       [time_nfo->local_offset],
-                    mute_amp, time_nfo->nframes);
-                  dsp_mul_k2 (
-                    &self->stereo_out->r->buf
-                       [time_nfo->local_offset],
-                    mute_amp, time_nfo->nframes);
-                }
+              out_silent = true;
+              dsp_fill (
+                bufs[0],
+                AUDIO_ENGINE
+                  ->denormal_prevention_val,
+                time_nfo->nframes);
+              dsp_fill (
+                bufs[1],
+                AUDIO_ENGINE
+                  ->denormal_prevention_val,
+                time_nfo->nframes);
+            }
+          else
+            {
+              smoothed_value_apply (
+                &self->mute_gain, bufs, 2,
+                time_nfo->nframes);
             }
 
           /* if master or monitor or sample
@@ -1232,7 +1373,12 @@ fader_process (
                 -2.f, 2.f, time_nfo->nframes);
             }
         } /* fi not prefader */
-    }     /* fi monitor/audio fader */
+
+      stereo_ports_mark_silent (
+        self->stereo_out, time_nfo->local_offset,
+        out_silent);
+      analyze_loudness (self, time_nfo);
+    } /* fi monitor/audio fader */
   else if (self->type == FADER_TYPE_MIDI_CHANNEL)
     {
       if (!effectively_muted)
@@ -1357,5 +1503,8 @@ fader_free (Fader * self)
 #undef DISCONNECT_AND_FREE
 #undef DISCONNECT_AND_FREE_STEREO
 
+  object_free_w_func_and_null (
+    loudness_analyzer_free, self->loudness_analyzer);
+
   object_zero_and_free (self);
 }
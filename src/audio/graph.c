@@ -24,14 +24,28 @@
  * ---
  */
 
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WOE32
+#  include <malloc.h>
+#endif
+
+#include "audio/anticipative_renderer.h"
+#include "audio/automation_track.h"
+#include "audio/automation_tracklist.h"
+#include "audio/channel.h"
 #include "audio/control_room.h"
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/graph.h"
+#include "audio/graph_buffer_plan.h"
 #include "audio/graph_node.h"
 #include "audio/graph_thread.h"
 #include "audio/hardware_processor.h"
+#include "audio/midi_event.h"
 #include "audio/port.h"
+#include "audio/port_connection.h"
 #include "audio/router.h"
 #include "audio/sample_processor.h"
 #include "audio/track.h"
@@ -48,6 +62,16 @@
 #include "utils/objects.h"
 #include "utils/stoat.h"
 #include "utils/string.h"
+#include "utils/ws_deque.h"
+
+#include "zix/ring.h"
+
+/**
+ * Time to wait for the engine to start a new
+ * cycle before publishing a graph from the
+ * calling thread.
+ */
+#define GRAPH_PUBLISH_TIMEOUT_USEC 500000
 
 /* called from a terminal node (from the Graph
  * worked-thread) to indicate it has completed
@@ -81,39 +105,507 @@ graph_on_reached_terminal_node (Graph * self)
        * If there are more threads than CPU cores,
        * some worker- threads may only be "on
        * the way" to become idle. */
-      while (
-        g_atomic_int_get (&self->idle_thread_cnt)
-        != self->num_threads)
-        sched_yield ();
+      for (int i = 0;
+           g_atomic_int_get (&self->idle_thread_cnt)
+           != self->num_threads;
+           i++)
+        {
+          /* they are usually only a few
+           * instructions away */
+          if (i < 1024)
+            graph_thread_cpu_relax ();
+          else
+            sched_yield ();
+        }
 
       if (g_atomic_int_get (&self->terminate))
         return;
 
       /* now wait for the next cycle to begin */
-      zix_sem_wait (&self->callback_start);
+      graph_thread_wait (self, &self->callback_start);
 
       if (g_atomic_int_get (&self->terminate))
         return;
 
+      /* a new graph may have been published at
+       * the start of this cycle */
+      CompiledGraph * compiled = self->compiled;
+
       /* reset terminal reference count */
       g_atomic_int_set (
         &self->terminal_refcnt,
-        (unsigned int) self->n_terminal_nodes);
+        (unsigned int) compiled->n_terminal_nodes);
 
       /* and start the initial nodes */
-      for (size_t i = 0; i < self->n_init_triggers;
-           ++i)
+      for (size_t i = 0;
+           i < compiled->n_init_triggers; ++i)
         {
           g_atomic_int_inc (
             &self->trigger_queue_size);
           mpmc_queue_push_back_node (
-            self->trigger_queue,
-            self->init_trigger_list[i]);
+            compiled->trigger_queue,
+            compiled->init_trigger_list[i]);
         }
       /* continue in worker-thread */
     }
 }
 
+static CompiledGraph *
+compiled_graph_new (void)
+{
+  CompiledGraph * self = object_new (CompiledGraph);
+
+  self->nodes = g_hash_table_new (
+    g_direct_hash, g_direct_equal);
+  self->trigger_queue = mpmc_queue_new ();
+  self->port_topologies = g_array_new (
+    false, true, sizeof (GraphPortTopology));
+  self->track_caches = g_array_new (
+    false, true, sizeof (GraphTrackCaches));
+  self->plugin_caches = g_array_new (
+    false, true, sizeof (GraphPluginCaches));
+  self->external_out_ports = g_ptr_array_new ();
+  self->removed_connections =
+    g_ptr_array_new_with_free_func (
+      (GDestroyNotify) port_connection_free);
+
+  return self;
+}
+
+/**
+ * Frees the port connection arrays, buffers and
+ * caches held by the graph and clears them.
+ *
+ * Before the graph is published these are the
+ * ones to apply, after publishing they are the
+ * previous ones of the ports and plugins.
+ */
+static void
+compiled_graph_release_previous (
+  CompiledGraph * self)
+{
+  for (size_t i = 0; i < self->port_topologies->len;
+       i++)
+    {
+      GraphPortTopology * topo = &g_array_index (
+        self->port_topologies, GraphPortTopology, i);
+      object_zero_and_free (topo->srcs);
+      object_zero_and_free (topo->src_connections);
+      object_zero_and_free (topo->dests);
+      object_zero_and_free (topo->dest_connections);
+      if (!topo->has_bufs)
+        continue;
+
+      /* buffers in an arena are freed with the
+       * graph owning the arena */
+      if (topo->buf_in_arena)
+        topo->buf = NULL;
+      object_zero_and_free (topo->buf);
+      object_free_w_func_and_null (
+        zix_ring_free, topo->audio_ring);
+      object_free_w_func_and_null (
+        midi_events_free, topo->midi_events);
+      object_free_w_func_and_null (
+        zix_ring_free, topo->midi_ring);
+    }
+  g_array_set_size (self->port_topologies, 0);
+
+  for (size_t i = 0; i < self->track_caches->len;
+       i++)
+    {
+      GraphTrackCaches * caches = &g_array_index (
+        self->track_caches, GraphTrackCaches, i);
+      object_zero_and_free (caches->ats);
+      object_zero_and_free (caches->at_ports);
+      object_zero_and_free (
+        caches->ats_in_record_mode);
+    }
+  g_array_set_size (self->track_caches, 0);
+
+  for (size_t i = 0; i < self->plugin_caches->len;
+       i++)
+    {
+      GraphPluginCaches * caches = &g_array_index (
+        self->plugin_caches, GraphPluginCaches, i);
+      object_free_w_func_and_null (
+        g_ptr_array_unref, caches->ctrl_in_ports);
+      object_free_w_func_and_null (
+        g_ptr_array_unref, caches->audio_in_ports);
+      object_free_w_func_and_null (
+        g_ptr_array_unref, caches->cv_in_ports);
+      object_free_w_func_and_null (
+        g_ptr_array_unref, caches->midi_in_ports);
+    }
+  g_array_set_size (self->plugin_caches, 0);
+
+  g_ptr_array_set_size (
+    self->removed_connections, 0);
+
+  for (int i = 0; i < self->num_deques; i++)
+    {
+      object_free_w_func_and_null (
+        ws_deque_free, self->deques[i]);
+    }
+  object_zero_and_free (self->deques);
+  self->num_deques = 0;
+
+  if (self->buffer_plan)
+    {
+      graph_buffer_plan_release_previous (
+        self->buffer_plan);
+    }
+}
+
+/**
+ * Allocates \p size bytes aligned to a cache line.
+ *
+ * Must be free'd with cache_aligned_free().
+ */
+static void *
+cache_aligned_alloc (size_t size)
+{
+#ifdef _WOE32
+  return _aligned_malloc (
+    size, GRAPH_CACHE_LINE_SIZE);
+#elif defined(__APPLE__)
+  void * ptr = NULL;
+  if (posix_memalign (
+        &ptr, GRAPH_CACHE_LINE_SIZE, size)
+      != 0)
+    return NULL;
+  return ptr;
+#else
+  return aligned_alloc (
+    GRAPH_CACHE_LINE_SIZE, size);
+#endif
+}
+
+static void
+cache_aligned_free (void * ptr)
+{
+#ifdef _WOE32
+  _aligned_free (ptr);
+#else
+  free (ptr);
+#endif
+}
+
+static void
+compiled_graph_free (CompiledGraph * self)
+{
+  if (self->schedule)
+    {
+      for (size_t i = 0; i < self->schedule_size;
+           i++)
+        {
+          GraphNode * node = &self->schedule[i];
+          free (node->childnodes);
+          free (node->parentnodes);
+        }
+      object_zero_and_free (self->schedule);
+    }
+  else if (self->nodes)
+    {
+      GHashTableIter iter;
+      gpointer       key, value;
+      g_hash_table_iter_init (&iter, self->nodes);
+      while (
+        g_hash_table_iter_next (&iter, &key, &value))
+        {
+          graph_node_free ((GraphNode *) value);
+        }
+    }
+  anticipative_renderer_free_tracks (self);
+  object_free_w_func_and_null (
+    graph_buffer_plan_free, self->buffer_plan);
+  object_free_w_func_and_null (
+    g_hash_table_unref, self->nodes);
+  object_zero_and_free (self->child_offsets);
+  object_zero_and_free (self->child_indices);
+  object_free_w_func_and_null (
+    cache_aligned_free, self->refcounts);
+  object_zero_and_free (self->timings);
+  object_zero_and_free (self->init_trigger_list);
+  object_zero_and_free (self->terminal_nodes);
+  object_free_w_func_and_null (
+    mpmc_queue_free, self->trigger_queue);
+  compiled_graph_release_previous (self);
+  object_free_w_func_and_null (
+    g_array_unref, self->port_topologies);
+  object_free_w_func_and_null (
+    g_array_unref, self->track_caches);
+  object_free_w_func_and_null (
+    g_array_unref, self->plugin_caches);
+  object_free_w_func_and_null (
+    g_ptr_array_unref, self->external_out_ports);
+  object_free_w_func_and_null (
+    g_ptr_array_unref, self->removed_connections);
+
+  object_zero_and_free (self);
+}
+
+/**
+ * Returns the measured cost of the node, or a
+ * rough estimate if it was never processed.
+ */
+static float
+get_node_cost (const GraphNode * node)
+{
+  if (node->cost > 0.f)
+    return node->cost;
+
+  return node->type == ROUTE_NODE_TYPE_PLUGIN
+           ? 10.f
+           : 0.5f;
+}
+
+/**
+ * Sorts nodes by descending critical path.
+ */
+static int
+cmp_critical_path_desc (
+  const void * a,
+  const void * b)
+{
+  const GraphNode * node_a = *(GraphNode * const *) a;
+  const GraphNode * node_b = *(GraphNode * const *) b;
+  if (node_a->critical_path > node_b->critical_path)
+    return -1;
+  if (node_a->critical_path < node_b->critical_path)
+    return 1;
+  return node_a->id - node_b->id;
+}
+
+/**
+ * Packs the nodes into a contiguous array in
+ * topological order and builds the child index
+ * arrays and refcounts used while processing.
+ *
+ * The GraphNode pointers held by the compiled
+ * graph are remapped to the packed nodes.
+ */
+static void
+compiled_graph_pack (CompiledGraph * self)
+{
+  size_t n = g_hash_table_size (self->nodes);
+  g_return_if_fail (n > 0 && !self->schedule);
+
+  GraphNode ** nodes = object_new_n (n, GraphNode *);
+  gint * pending_parents = object_new_n (n, gint);
+  size_t * order = object_new_n (n, size_t);
+  size_t * pos = object_new_n (n, size_t);
+
+  /* index the nodes */
+  GHashTableIter iter;
+  gpointer       key, value;
+  size_t         idx = 0;
+  g_hash_table_iter_init (&iter, self->nodes);
+  while (
+    g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * node = (GraphNode *) value;
+      node->id = (int) idx;
+      nodes[idx] = node;
+      pending_parents[idx] = node->init_refcount;
+      idx++;
+    }
+
+  /* sort topologically, starting from the initial
+   * nodes */
+  size_t n_ordered = 0;
+  for (size_t i = 0; i < self->n_init_triggers; i++)
+    {
+      order[n_ordered++] =
+        (size_t) self->init_trigger_list[i]->id;
+    }
+  for (size_t i = 0; i < n_ordered; i++)
+    {
+      GraphNode * node = nodes[order[i]];
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          size_t child =
+            (size_t) node->childnodes[j]->id;
+          if (--pending_parents[child] == 0)
+            order[n_ordered++] = child;
+        }
+    }
+  if (n_ordered != n)
+    {
+      g_critical (
+        "graph has cycles (%zu of %zu nodes "
+        "ordered)",
+        n_ordered, n);
+      for (size_t i = 0; i < n; i++)
+        {
+          if (pending_parents[i] > 0)
+            order[n_ordered++] = i;
+        }
+    }
+  for (size_t i = 0; i < n; i++)
+    {
+      pos[order[i]] = i;
+    }
+
+#define PACKED(node) \
+  (&self->schedule[pos[(node)->id]])
+
+  /* copy the nodes and remap their edges */
+  self->schedule = object_new_n (n, GraphNode);
+  self->schedule_size = n;
+  for (size_t i = 0; i < n; i++)
+    {
+      self->schedule[i] = *nodes[order[i]];
+    }
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &self->schedule[i];
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          node->childnodes[j] =
+            PACKED (node->childnodes[j]);
+        }
+      for (int j = 0; j < node->init_refcount; j++)
+        {
+          node->parentnodes[j] =
+            PACKED (node->parentnodes[j]);
+        }
+    }
+
+  /* remap the node pointers of the graph */
+  g_hash_table_iter_init (&iter, self->nodes);
+  while (
+    g_hash_table_iter_next (&iter, &key, &value))
+    {
+      g_hash_table_iter_replace (
+        &iter, PACKED ((GraphNode *) value));
+    }
+  for (size_t i = 0; i < self->n_init_triggers; i++)
+    {
+      self->init_trigger_list[i] =
+        PACKED (self->init_trigger_list[i]);
+    }
+  for (size_t i = 0; i < self->n_terminal_nodes;
+       i++)
+    {
+      self->terminal_nodes[i] =
+        PACKED (self->terminal_nodes[i]);
+    }
+  if (self->bpm_node)
+    self->bpm_node = PACKED (self->bpm_node);
+  if (self->beats_per_bar_node)
+    self->beats_per_bar_node =
+      PACKED (self->beats_per_bar_node);
+  if (self->beat_unit_node)
+    self->beat_unit_node =
+      PACKED (self->beat_unit_node);
+
+#undef PACKED
+
+  /* the edge arrays now belong to the packed
+   * nodes */
+  for (size_t i = 0; i < n; i++)
+    {
+      object_zero_and_free (nodes[i]);
+    }
+  for (size_t i = 0; i < n; i++)
+    {
+      self->schedule[i].id = (int) i;
+    }
+
+  /* calculate the remaining critical path of each
+   * node (children come after their parents) and
+   * order children and initial nodes so that the
+   * longest paths get scheduled first */
+  for (size_t i = n; i-- > 0;)
+    {
+      GraphNode * node = &self->schedule[i];
+      float       longest_child_path = 0.f;
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          longest_child_path = MAX (
+            longest_child_path,
+            node->childnodes[j]->critical_path);
+        }
+      node->critical_path =
+        get_node_cost (node) + longest_child_path;
+    }
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &self->schedule[i];
+      if (node->n_childnodes > 1)
+        {
+          qsort (
+            node->childnodes,
+            (size_t) node->n_childnodes,
+            sizeof (GraphNode *),
+            cmp_critical_path_desc);
+        }
+    }
+  if (self->n_init_triggers > 1)
+    {
+      qsort (
+        self->init_trigger_list,
+        self->n_init_triggers, sizeof (GraphNode *),
+        cmp_critical_path_desc);
+    }
+
+  /* build the child index arrays */
+  self->child_offsets = object_new_n (n + 1, guint);
+  size_t n_edges = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      self->child_offsets[i] = (guint) n_edges;
+      n_edges +=
+        (size_t) self->schedule[i].n_childnodes;
+    }
+  self->child_offsets[n] = (guint) n_edges;
+  self->child_indices =
+    object_new_n (MAX (n_edges, 1), guint);
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &self->schedule[i];
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          self->child_indices
+            [self->child_offsets[i] + (guint) j] =
+            (guint) node->childnodes[j]->id;
+        }
+    }
+
+  /* fuse chains of nodes whose only child has no
+   * other parent */
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &self->schedule[i];
+      node->chain_next = NULL;
+      if (
+        node->n_childnodes == 1
+        && node->childnodes[0]->init_refcount == 1)
+        {
+          node->chain_next = node->childnodes[0];
+        }
+    }
+
+  /* refcounts, each on its own cache line */
+  size_t refcounts_sz =
+    n * sizeof (GraphNodeRefcount);
+  self->refcounts =
+    cache_aligned_alloc (refcounts_sz);
+  for (size_t i = 0; i < n; i++)
+    {
+      g_atomic_int_set (
+        &self->refcounts[i].refcount,
+        self->schedule[i].init_refcount);
+    }
+
+  self->timings = object_new_n (n, GraphNodeTimings);
+
+  free (nodes);
+  free (pending_parents);
+  free (order);
+  free (pos);
+}
+
 /**
  * Checks for cycles in the graph.
  */
@@ -123,14 +615,14 @@ is_valid (Graph * self)
   /* Fill up an array of trigger nodes, and make
    * it large enough so that we can append more
    * nodes to it */
-  int num_setup_graph_nodes = (int)
-    g_hash_table_size (self->setup_graph_nodes);
+  CompiledGraph * setup = self->setup;
+  int             num_setup_graph_nodes =
+    (int) g_hash_table_size (setup->nodes);
   GraphNode * triggers[num_setup_graph_nodes];
-  int num_triggers = self->num_setup_init_triggers;
+  int num_triggers = (int) setup->n_init_triggers;
   for (int i = 0; i < num_triggers; i++)
     {
-      triggers[i] =
-        self->setup_init_trigger_list[i];
+      triggers[i] = setup->init_trigger_list[i];
     }
 
   while (num_triggers > 0)
@@ -151,8 +643,7 @@ is_valid (Graph * self)
 
   GHashTableIter iter;
   gpointer       key, value;
-  g_hash_table_iter_init (
-    &iter, self->setup_graph_nodes);
+  g_hash_table_iter_init (&iter, setup->nodes);
   while (
     g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -166,80 +657,436 @@ is_valid (Graph * self)
   return true;
 }
 
+void
+graph_publish_pending (Graph * self)
+{
+  CompiledGraph * pending =
+    g_atomic_pointer_get (&self->pending);
+  if (G_LIKELY (!pending))
+    return;
+
+#define SWAP_FIELD(type, obj, field, other) \
+  { \
+    type tmp = (obj)->field; \
+    (obj)->field = (other)->field; \
+    (other)->field = tmp; \
+  }
+
+  /* apply the port connections, owners and
+   * buffers of the new graph and keep the
+   * previous ones around until the previous graph
+   * is reclaimed */
+  for (size_t i = 0;
+       i < pending->port_topologies->len; i++)
+    {
+      GraphPortTopology * topo = &g_array_index (
+        pending->port_topologies, GraphPortTopology,
+        i);
+      Port * port = topo->port;
+
+      SWAP_FIELD (Port **, port, srcs, topo);
+      SWAP_FIELD (
+        PortConnection **, port, src_connections,
+        topo);
+      SWAP_FIELD (int, port, num_srcs, topo);
+      SWAP_FIELD (size_t, port, srcs_size, topo);
+      SWAP_FIELD (Port **, port, dests, topo);
+      SWAP_FIELD (
+        PortConnection **, port, dest_connections,
+        topo);
+      SWAP_FIELD (int, port, num_dests, topo);
+      SWAP_FIELD (size_t, port, dests_size, topo);
+
+      if (topo->plugin)
+        port->plugin = topo->plugin;
+      if (topo->track)
+        port->track = topo->track;
+
+      if (!topo->has_bufs)
+        continue;
+
+      if (port->id.type == TYPE_EVENT)
+        {
+          SWAP_FIELD (
+            MidiEvents *, port, midi_events, topo);
+          SWAP_FIELD (ZixRing *, port, midi_ring, topo);
+        }
+      else
+        {
+          SWAP_FIELD (float *, port, buf, topo);
+          SWAP_FIELD (
+            size_t, port, last_buf_sz, topo);
+          SWAP_FIELD (bool, port, buf_in_arena, topo);
+          SWAP_FIELD (
+            ZixRing *, port, audio_ring, topo);
+        }
+    }
+
+  /* likewise for the port buffers */
+  if (pending->buffer_plan)
+    graph_buffer_plan_apply (pending->buffer_plan);
+
+  /* and the thread deques, which are all empty
+   * between cycles (threads that are still
+   * looking for work may steal from the previous
+   * ones until the previous graph is reclaimed) */
+  if (
+    self->main_thread
+    && pending->num_deques == self->num_threads + 1)
+    {
+      for (int i = 0; i < pending->num_deques; i++)
+        {
+          GraphThread * thread =
+            i == self->num_threads
+              ? self->main_thread
+              : self->threads[i];
+          WsDeque * deque = thread->deque;
+          g_atomic_pointer_set (
+            &thread->deque, pending->deques[i]);
+          pending->deques[i] = deque;
+        }
+    }
+
+  /* apply the caches */
+  CLIP_EDITOR->region = pending->clip_editor_region;
+  CLIP_EDITOR->track = pending->clip_editor_track;
+  for (size_t i = 0; i < pending->track_caches->len;
+       i++)
+    {
+      GraphTrackCaches * caches = &g_array_index (
+        pending->track_caches, GraphTrackCaches, i);
+      caches->track->name_hash = caches->name_hash;
+      for (int j = 0; j < caches->num_ats; j++)
+        {
+          caches->ats[j]->port = caches->at_ports[j];
+        }
+      if (caches->atl)
+        {
+          SWAP_FIELD (
+            AutomationTrack **, caches->atl,
+            ats_in_record_mode, caches);
+          SWAP_FIELD (
+            int, caches->atl, num_ats_in_record_mode,
+            caches);
+        }
+    }
+  for (size_t i = 0;
+       i < pending->plugin_caches->len; i++)
+    {
+      GraphPluginCaches * caches = &g_array_index (
+        pending->plugin_caches, GraphPluginCaches,
+        i);
+      SWAP_FIELD (
+        GPtrArray *, caches->pl, ctrl_in_ports,
+        caches);
+      SWAP_FIELD (
+        GPtrArray *, caches->pl, audio_in_ports,
+        caches);
+      SWAP_FIELD (
+        GPtrArray *, caches->pl, cv_in_ports, caches);
+      SWAP_FIELD (
+        GPtrArray *, caches->pl, midi_in_ports,
+        caches);
+    }
+
+#undef SWAP_FIELD
+
+  g_atomic_int_set (
+    &self->terminal_refcnt,
+    (guint) pending->n_terminal_nodes);
+
+  pending->publish_epoch =
+    g_atomic_int_get (&self->epoch);
+  pending->replaced = self->compiled;
+  g_atomic_pointer_set (&self->compiled, pending);
+  g_atomic_pointer_set (&self->pending, NULL);
+}
+
+/**
+ * Returns whether no thread can be accessing the
+ * graphs replaced by the given published graph
+ * anymore.
+ */
+static bool
+grace_period_is_over (
+  Graph *               self,
+  const CompiledGraph * compiled)
+{
+  /* the engine cycle that was running at publish
+   * time (if any) must have ended */
+  if (
+    g_atomic_int_get (&self->epoch)
+      == compiled->publish_epoch
+    && g_atomic_int_get (
+      &AUDIO_ENGINE->cycle_running))
+    return false;
+
+  /* worker threads that were woken up may still
+   * be looking at the previous trigger queue */
+  if (
+    self->main_thread
+    && g_atomic_int_get (&self->idle_thread_cnt)
+         < self->num_threads)
+    return false;
+
+  return true;
+}
+
+/**
+ * Frees the graphs replaced by the live graph, if
+ * their grace period is over.
+ *
+ * Does not wait, so graphs whose grace period is
+ * not over are left for the next call.
+ *
+ * @param force Whether to free them regardless,
+ *   if nothing can be processing anymore.
+ */
 static void
-clear_setup (Graph * self)
+reclaim_replaced_graphs (Graph * self, bool force)
 {
-  g_hash_table_remove_all (self->setup_graph_nodes);
-  self->num_setup_init_triggers = 0;
-  self->num_setup_terminal_nodes = 0;
+  CompiledGraph * compiled = self->compiled;
+  if (!compiled || !compiled->replaced)
+    return;
+
+  if (!force && !grace_period_is_over (self, compiled))
+    return;
+
+  /* the live graph now holds the previous port
+   * connections, buffers and caches */
+  compiled_graph_release_previous (compiled);
+
+  CompiledGraph * replaced = compiled->replaced;
+  compiled->replaced = NULL;
+  while (replaced)
+    {
+      CompiledGraph * next = replaced->replaced;
+      compiled_graph_free (replaced);
+      replaced = next;
+    }
 }
 
+/**
+ * Creates deques that fit all the nodes of
+ * @p setup for the threads whose deques are too
+ * small, so that nodes are not pushed to the
+ * trigger queue instead.
+ *
+ * The deques can't grow while the threads use
+ * them, so they are replaced when publishing.
+ */
 static void
-graph_rechain (Graph * self)
+prepare_thread_deques (
+  Graph *         self,
+  CompiledGraph * setup)
 {
-  /*g_warn_if_fail (*/
-  /*g_atomic_int_get (*/
-  /*&self->terminal_refcnt) == 0);*/
-  g_warn_if_fail (
-    g_atomic_int_get (&self->trigger_queue_size)
-    == 0);
-
-  /* --- swap setup nodes with graph nodes --- */
-  g_return_if_fail (
-    self->graph_nodes && self->setup_graph_nodes);
-  GHashTable * tmp = g_hash_table_new_full (
-    g_direct_hash, g_direct_equal, NULL, NULL);
-  GHashTableIter iter;
-  gpointer       key, value;
-  g_hash_table_iter_init (&iter, self->graph_nodes);
-  while (
-    g_hash_table_iter_next (&iter, &key, &value))
+  /* threads created later reserve their deques
+   * for the live graph */
+  if (!self->main_thread)
+    return;
+
+  size_t num_nodes =
+    (size_t) g_hash_table_size (setup->nodes);
+  int num_deques = self->num_threads + 1;
+  bool too_small = false;
+  for (int i = 0; i < num_deques; i++)
     {
-      g_hash_table_insert (tmp, key, value);
+      GraphThread * thread =
+        i == self->num_threads
+          ? self->main_thread
+          : self->threads[i];
+      if (
+        ws_deque_get_capacity (thread->deque)
+        < num_nodes)
+        too_small = true;
     }
-  g_hash_table_steal_all (self->graph_nodes);
+  if (!too_small)
+    return;
 
-  g_hash_table_iter_init (
-    &iter, self->setup_graph_nodes);
-  while (
-    g_hash_table_iter_next (&iter, &key, &value))
+  setup->deques = object_new_n (
+    (size_t) num_deques, WsDeque *);
+  setup->num_deques = num_deques;
+  for (int i = 0; i < num_deques; i++)
     {
-      g_hash_table_insert (
-        self->graph_nodes, key, value);
+      setup->deques[i] = ws_deque_new ();
+      ws_deque_reserve (setup->deques[i], num_nodes);
     }
-  g_hash_table_steal_all (self->setup_graph_nodes);
+}
 
-  g_hash_table_iter_init (&iter, tmp);
-  while (
-    g_hash_table_iter_next (&iter, &key, &value))
+static void
+graph_rechain (Graph * self)
+{
+  CompiledGraph * setup = self->setup;
+  g_return_if_fail (setup);
+  self->setup = NULL;
+
+  /* the connections removed until now are no
+   * longer used once this graph is live */
+  GPtrArray * removed_connections =
+    setup->removed_connections;
+  setup->removed_connections =
+    self->removed_connections;
+  self->removed_connections = removed_connections;
+
+  /* keep the measured costs of nodes that were
+   * already in the graph */
+  if (self->compiled)
     {
-      g_hash_table_insert (
-        self->setup_graph_nodes, key, value);
+      GHashTableIter iter;
+      gpointer       key, value;
+      g_hash_table_iter_init (&iter, setup->nodes);
+      while (
+        g_hash_table_iter_next (&iter, &key, &value))
+        {
+          GraphNode * node = (GraphNode *) value;
+          GraphNode * prev_node = (GraphNode *)
+            g_hash_table_lookup (
+              self->compiled->nodes, key);
+          if (prev_node && prev_node->type == node->type)
+            node->cost = prev_node->cost;
+        }
     }
 
-  /* --- end --- */
+  compiled_graph_pack (setup);
 
-  array_dynamic_swap (
-    &self->init_trigger_list,
-    &self->n_init_triggers,
-    &self->setup_init_trigger_list,
-    &self->num_setup_init_triggers);
-  array_dynamic_swap (
-    &self->terminal_nodes, &self->n_terminal_nodes,
-    &self->setup_terminal_nodes,
-    &self->num_setup_terminal_nodes);
+  /* keep the recent processing times too (these
+   * may be written to by the engine meanwhile,
+   * which only affects the copied samples) */
+  if (self->compiled && self->compiled->timings)
+    {
+      GHashTableIter iter;
+      gpointer       key, value;
+      g_hash_table_iter_init (&iter, setup->nodes);
+      while (
+        g_hash_table_iter_next (&iter, &key, &value))
+        {
+          GraphNode * node = (GraphNode *) value;
+          GraphNode * prev_node = (GraphNode *)
+            g_hash_table_lookup (
+              self->compiled->nodes, key);
+          if (!prev_node || prev_node->type != node->type)
+            continue;
 
-  /*self->n_terminal_nodes =*/
-  /*(int) self->num_setup_terminal_nodes;*/
-  g_atomic_int_set (
-    &self->terminal_refcnt,
-    (guint) self->n_terminal_nodes);
+          GraphNodeTimings * timings =
+            &setup->timings[node->id];
+          GraphNodeTimings * prev_timings =
+            &self->compiled->timings[prev_node->id];
+          memcpy (
+            timings->samples, prev_timings->samples,
+            sizeof (timings->samples));
+          timings->num_written =
+            g_atomic_int_get (
+              &prev_timings->num_written);
+        }
+    }
+
+  if (self->anticipative)
+    {
+      anticipative_renderer_setup (
+        self->anticipative, setup);
+    }
+
+  if (self->use_buffer_arena)
+    {
+      setup->buffer_plan =
+        graph_buffer_plan_new (setup);
+    }
 
   mpmc_queue_reserve (
-    self->trigger_queue,
-    (size_t) g_hash_table_size (self->graph_nodes));
+    setup->trigger_queue,
+    (size_t) g_hash_table_size (setup->nodes));
+  prepare_thread_deques (self, setup);
 
-  clear_setup (self);
+  g_return_if_fail (!self->pending);
+  g_atomic_pointer_set (&self->pending, setup);
+
+  if (!self->compiled)
+    {
+      /* first graph - nothing is processing yet */
+      graph_publish_pending (self);
+      compiled_graph_release_previous (setup);
+      return;
+    }
+
+  /* the processing thread swaps it in at the
+   * start of its next cycle - if the engine is not
+   * running (anymore) or has stopped cycling (eg,
+   * the backend stalled), it is published here
+   * instead */
+  uint_fast64_t last_cycle = AUDIO_ENGINE->cycle;
+  gint64        last_cycle_time =
+    g_get_monotonic_time ();
+  while (g_atomic_pointer_get (&self->pending))
+    {
+      gint64 now = g_get_monotonic_time ();
+      if (AUDIO_ENGINE->cycle != last_cycle)
+        {
+          last_cycle = AUDIO_ENGINE->cycle;
+          last_cycle_time = now;
+        }
+      if (
+        !engine_get_run (AUDIO_ENGINE)
+        || now - last_cycle_time
+             > GRAPH_PUBLISH_TIMEOUT_USEC)
+        {
+          if (engine_get_run (AUDIO_ENGINE))
+            {
+              g_message (
+                "engine stopped cycling, publishing "
+                "graph");
+            }
+          zix_sem_wait (&self->router->graph_access);
+          graph_publish_pending (self);
+          zix_sem_post (&self->router->graph_access);
+          break;
+        }
+      g_usleep (100);
+    }
+
+  /* the previous graph is reclaimed by a later
+   * call once its grace period is over */
+}
+
+/**
+ * Frees the given port connection once no graph
+ * can be using it anymore.
+ */
+void
+graph_free_connection_later (
+  Graph *          self,
+  PortConnection * conn)
+{
+  g_ptr_array_add (self->removed_connections, conn);
+}
+
+/**
+ * Chooses again how \p port is processed by the
+ * live and pending graphs.
+ */
+void
+graph_update_port_process_func (
+  Graph * self,
+  Port *  port)
+{
+  /* the graphs can't be processed or published
+   * while updating */
+  zix_sem_wait (&self->router->graph_access);
+  CompiledGraph * graphs[] = {
+    self->compiled,
+    g_atomic_pointer_get (&self->pending),
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (graphs);
+       i++)
+    {
+      if (!graphs[i])
+        continue;
+
+      GraphNode * node = (GraphNode *)
+        g_hash_table_lookup (graphs[i]->nodes, port);
+      if (node && node->type == ROUTE_NODE_TYPE_PORT)
+        graph_node_update_port_process_func (node);
+    }
+  zix_sem_post (&self->router->graph_access);
 }
 
 static void
@@ -305,10 +1152,11 @@ graph_print (Graph * self)
 {
   g_message ("==printing graph");
 
+  g_return_if_fail (self->setup);
+
   GHashTableIter iter;
   gpointer       key, value;
-  g_hash_table_iter_init (
-    &iter, self->setup_graph_nodes);
+  g_hash_table_iter_init (&iter, self->setup->nodes);
   while (
     g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -320,9 +1168,9 @@ graph_print (Graph * self)
     "num trigger nodes %zu | "
     /*"num max trigger nodes %d | "*/
     "num terminal nodes %zu",
-    self->num_setup_init_triggers,
+    self->setup->n_init_triggers,
     /*self->trigger_queue_size,*/
-    self->num_setup_terminal_nodes);
+    self->setup->n_terminal_nodes);
   g_message ("==finish printing graph");
 }
 
@@ -352,6 +1200,29 @@ graph_destroy (Graph * self)
   graph_free (self);
 }
 
+/**
+ * Returns whether the port's DSP buffers are
+ * missing or too small.
+ */
+static bool
+port_needs_bufs (const Port * port)
+{
+  switch (port->id.type)
+    {
+    case TYPE_EVENT:
+      return !port->midi_events || !port->midi_ring;
+    case TYPE_AUDIO:
+    case TYPE_CV:
+      return !port->buf || !port->audio_ring
+             || port->last_buf_sz
+                  < MAX (
+                    AUDIO_ENGINE->block_length,
+                    port->min_buf_size);
+    default:
+      return false;
+    }
+}
+
 /**
  * Add the port to the nodes.
  *
@@ -368,31 +1239,33 @@ add_port (
 {
   PortOwnerType owner = port->id.owner_type;
 
+  /* compute port owners and sources/dests
+   * (applied to the port when the graph is
+   * published) */
+  GraphPortTopology topo = { .port = port };
+
   if (owner == PORT_OWNER_TYPE_PLUGIN)
     {
-      port->plugin = port_get_plugin (port, true);
+      topo.plugin = port_get_plugin (port, true);
       g_return_val_if_fail (
-        IS_PLUGIN_AND_NONNULL (port->plugin), NULL);
+        IS_PLUGIN_AND_NONNULL (topo.plugin), NULL);
     }
 
   if (port->id.track_name_hash != 0)
     {
-      port->track = port_get_track (port, true);
+      topo.track = port_get_track (port, true);
       g_return_val_if_fail (
-        IS_TRACK_AND_NONNULL (port->track), NULL);
+        IS_TRACK_AND_NONNULL (topo.track), NULL);
     }
 
-  /* reset port sources/dests */
-  GPtrArray * srcs = g_ptr_array_new ();
-  int         num_srcs =
+  GPtrArray *       srcs = g_ptr_array_new ();
+  int               num_srcs =
     port_connections_manager_get_sources_or_dests (
       PORT_CONNECTIONS_MGR, srcs, &port->id, true);
-  port->srcs_size = (size_t) num_srcs;
-  port->srcs = object_realloc_n (
-    port->srcs, 0, port->srcs_size, Port *);
-  port->src_connections = object_realloc_n (
-    port->src_connections, 0, port->srcs_size,
-    PortConnection *);
+  topo.srcs_size = (size_t) num_srcs;
+  topo.srcs = object_new_n (topo.srcs_size, Port *);
+  topo.src_connections = object_new_n (
+    topo.srcs_size, PortConnection *);
 #if 0
   if (num_srcs > 0)
     g_debug (
@@ -404,24 +1277,22 @@ add_port (
       PortConnection * conn = (PortConnection *)
         g_ptr_array_index (srcs, i);
 
-      port->srcs[i] =
+      topo.srcs[i] =
         port_find_from_identifier (conn->src_id);
-      g_return_val_if_fail (port->srcs[i], NULL);
-      port->src_connections[i] = conn;
+      topo.src_connections[i] = conn;
     }
-  port->num_srcs = num_srcs;
+  topo.num_srcs = num_srcs;
   g_ptr_array_unref (srcs);
 
   GPtrArray * dests = g_ptr_array_new ();
   int         num_dests =
     port_connections_manager_get_sources_or_dests (
       PORT_CONNECTIONS_MGR, dests, &port->id, false);
-  port->dests_size = (size_t) num_dests;
-  port->dests = object_realloc_n (
-    port->dests, 0, port->dests_size, Port *);
-  port->dest_connections = object_realloc_n (
-    port->dest_connections, 0, port->dests_size,
-    PortConnection *);
+  topo.dests_size = (size_t) num_dests;
+  topo.dests =
+    object_new_n (topo.dests_size, Port *);
+  topo.dest_connections = object_new_n (
+    topo.dests_size, PortConnection *);
 #if 0
   if (num_dests > 0)
     g_debug (
@@ -433,14 +1304,26 @@ add_port (
       PortConnection * conn = (PortConnection *)
         g_ptr_array_index (dests, i);
 
-      port->dests[i] =
+      topo.dests[i] =
         port_find_from_identifier (conn->dest_id);
-      g_return_val_if_fail (port->dests[i], NULL);
-      port->dest_connections[i] = conn;
+      topo.dest_connections[i] = conn;
     }
-  port->num_dests = num_dests;
+  topo.num_dests = num_dests;
   g_ptr_array_unref (dests);
 
+  /* append before validating so that the arrays
+   * are owned by the compiled graph */
+  g_array_append_val (
+    self->setup->port_topologies, topo);
+  for (int i = 0; i < num_srcs; i++)
+    {
+      g_return_val_if_fail (topo.srcs[i], NULL);
+    }
+  for (int i = 0; i < num_dests; i++)
+    {
+      g_return_val_if_fail (topo.dests[i], NULL);
+    }
+
   if (drop_if_unnecessary)
     {
       /* skip unnecessary control ports */
@@ -460,7 +1343,7 @@ add_port (
           g_return_val_if_fail (found_at, NULL);
           if (
             found_at->num_regions == 0
-            && port->num_srcs == 0)
+            && topo.num_srcs == 0)
             {
               return NULL;
             }
@@ -469,8 +1352,8 @@ add_port (
 
   /* drop ports without sources and dests */
   if (
-    drop_if_unnecessary && port->num_dests == 0
-    && port->num_srcs == 0
+    drop_if_unnecessary && topo.num_dests == 0
+    && topo.num_srcs == 0
     && owner != PORT_OWNER_TYPE_PLUGIN
     && owner != PORT_OWNER_TYPE_FADER
     && owner != PORT_OWNER_TYPE_TRACK_PROCESSOR
@@ -488,8 +1371,20 @@ add_port (
   else
     {
       /* allocate buffers to be used during
-       * DSP */
-      port_allocate_bufs (port);
+       * DSP (ports already in the running graph
+       * keep their buffers) */
+      if (port_needs_bufs (port))
+        {
+          GraphPortTopology * added = &g_array_index (
+            self->setup->port_topologies,
+            GraphPortTopology,
+            self->setup->port_topologies->len - 1);
+          added->has_bufs = true;
+          port_new_bufs (
+            port, &added->buf, &added->last_buf_sz,
+            &added->audio_ring, &added->midi_events,
+            &added->midi_ring);
+        }
       return graph_create_node (
         self, ROUTE_NODE_TYPE_PORT, port);
     }
@@ -499,14 +1394,17 @@ add_port (
  * Connect the port as a node.
  */
 static void
-connect_port (Graph * self, Port * port)
+connect_port (
+  Graph *                   self,
+  const GraphPortTopology * topo)
 {
+  Port *      port = topo->port;
   GraphNode * node =
     graph_find_node_from_port (self, port);
   GraphNode * node2;
-  for (int j = 0; j < port->num_srcs; j++)
+  for (int j = 0; j < topo->num_srcs; j++)
     {
-      Port * src = port->srcs[j];
+      Port * src = topo->srcs[j];
       node2 = graph_find_node_from_port (self, src);
       g_warn_if_fail (node);
       g_warn_if_fail (node2);
@@ -516,9 +1414,9 @@ connect_port (Graph * self, Port * port)
 #endif
       graph_node_connect (node2, node);
     }
-  for (int j = 0; j < port->num_dests; j++)
+  for (int j = 0; j < topo->num_dests; j++)
     {
-      Port * dest = port->dests[j];
+      Port * dest = topo->dests[j];
       node2 =
         graph_find_node_from_port (self, dest);
       g_warn_if_fail (node);
@@ -540,19 +1438,15 @@ graph_get_max_route_playback_latency (
   Graph * graph,
   bool    use_setup_nodes)
 {
-  nframes_t   max = 0;
-  GraphNode * node;
-  for (size_t i = 0;
-       i <
-         (use_setup_nodes ?
-            graph->num_setup_init_triggers :
-            graph->n_init_triggers);
+  nframes_t       max = 0;
+  CompiledGraph * compiled =
+    use_setup_nodes ? graph->setup : graph->compiled;
+  g_return_val_if_fail (compiled, 0);
+  for (size_t i = 0; i < compiled->n_init_triggers;
        i++)
     {
-      node =
-        (use_setup_nodes
-           ? graph->setup_init_trigger_list[i]
-           : graph->init_trigger_list[i]);
+      GraphNode * node =
+        compiled->init_trigger_list[i];
       if (node->route_playback_latency > max)
         max = node->route_playback_latency;
     }
@@ -568,10 +1462,10 @@ graph_update_latencies (
   g_message ("updating graph latencies...");
 
   /* reset latencies */
-  GHashTable * ht =
-    use_setup_nodes
-      ? self->setup_graph_nodes
-      : self->graph_nodes;
+  CompiledGraph * compiled =
+    use_setup_nodes ? self->setup : self->compiled;
+  g_return_if_fail (compiled);
+  GHashTable *   ht = compiled->nodes;
   GHashTableIter iter;
   gpointer       key, value;
   g_hash_table_iter_init (&iter, ht);
@@ -606,6 +1500,88 @@ graph_update_latencies (
     0);
 }
 
+/**
+ * Returns whether the plugin is processed by the
+ * running graph.
+ */
+static bool
+plugin_is_processed (Graph * self, Plugin * pl)
+{
+  return self->compiled
+         && g_hash_table_contains (
+           self->compiled->nodes, pl);
+}
+
+/**
+ * Computes the caches of the track, its plugins
+ * and its automation tracks to apply when the
+ * graph is published (see track_set_caches()).
+ */
+static void
+add_track_caches (Graph * self, Track * track)
+{
+  CompiledGraph *  setup = self->setup;
+  GraphTrackCaches caches = {
+    .track = track,
+    .name_hash = track_get_name_hash (track),
+  };
+
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (track);
+  if (atl && !track_is_auditioner (track))
+    {
+      size_t num_ats = (size_t) atl->num_ats;
+      caches.atl = atl;
+      caches.num_ats = atl->num_ats;
+      caches.ats =
+        object_new_n (num_ats, AutomationTrack *);
+      caches.at_ports = object_new_n (num_ats, Port *);
+      caches.ats_in_record_mode =
+        object_new_n (num_ats, AutomationTrack *);
+      for (int i = 0; i < atl->num_ats; i++)
+        {
+          AutomationTrack * at = atl->ats[i];
+          caches.ats[i] = at;
+          caches.at_ports[i] =
+            port_find_from_identifier (&at->port_id);
+
+          if (
+            at->automation_mode
+            == AUTOMATION_MODE_RECORD)
+            {
+              array_append (
+                caches.ats_in_record_mode,
+                caches.num_ats_in_record_mode, at);
+            }
+        }
+    }
+  g_array_append_val (setup->track_caches, caches);
+
+  if (!track_type_has_channel (track->type))
+    return;
+
+  Plugin * pls[120];
+  int      num_pls =
+    channel_get_plugins (track->channel, pls);
+  for (int i = 0; i < num_pls; i++)
+    {
+      GraphPluginCaches pl_caches = {
+        .pl = pls[i],
+        .ctrl_in_ports = g_ptr_array_new (),
+        .audio_in_ports = g_ptr_array_new (),
+        .cv_in_ports = g_ptr_array_new (),
+        .midi_in_ports = g_ptr_array_new (),
+      };
+      plugin_get_port_caches (
+        pls[i], pl_caches.ctrl_in_ports,
+        pl_caches.audio_in_ports,
+        pl_caches.cv_in_ports,
+        pl_caches.midi_in_ports);
+      g_array_append_val (
+        setup->plugin_caches, pl_caches);
+    }
+}
+
 /*
  * Adds the graph nodes and connections, then
  * rechains.
@@ -623,6 +1599,26 @@ graph_setup (
 {
   GraphNode *node, *node2;
 
+  /* free the graphs that were replaced before if
+   * nothing can be processing them anymore */
+  if (rechain)
+    reclaim_replaced_graphs (self, false);
+
+  /* graphs are only swapped while the
+   * anticipative renderer is not rendering ahead,
+   * so have all tracks processed live until the
+   * new graph is published */
+  if (rechain && self->anticipative)
+    {
+      anticipative_renderer_pause (
+        self->anticipative);
+    }
+
+  object_free_w_func_and_null (
+    compiled_graph_free, self->setup);
+  self->setup = compiled_graph_new ();
+  CompiledGraph * setup = self->setup;
+
   /* ========================
    * first add all the nodes
    * ======================== */
@@ -656,6 +1652,11 @@ graph_setup (
       if (!tr)
         {
           g_warning ("track not found at %d", i);
+          if (rechain && self->anticipative)
+            {
+              anticipative_renderer_resume (
+                self->anticipative);
+            }
           return;
         }
 
@@ -671,7 +1672,15 @@ graph_setup (
             continue;
 
           add_plugin (self, pl);
-          plugin_update_latency (pl);
+
+          /* processing keeps the latency of
+           * running plugins up to date (LV2 plugins
+           * read their latency port and Carla
+           * queries it after each run), and
+           * querying LV2 plugins here would run
+           * them concurrently with the engine */
+          if (rechain && !plugin_is_processed (self, pl))
+            plugin_update_latency (pl);
         }
 
       /* add the modulator macro processors */
@@ -716,7 +1725,8 @@ graph_setup (
             continue;
 
           add_plugin (self, pl);
-          plugin_update_latency (pl);
+          if (rechain && !plugin_is_processed (self, pl))
+            plugin_update_latency (pl);
         }
 
       /* add sends */
@@ -743,10 +1753,6 @@ graph_setup (
         }
     }
 
-  object_free_w_func_and_null (
-    g_ptr_array_unref, self->external_out_ports);
-  self->external_out_ports = g_ptr_array_new ();
-
   /* add ports */
   Port *      port;
   GPtrArray * ports = g_ptr_array_new ();
@@ -771,7 +1777,7 @@ graph_setup (
         && port->internal_type == INTERNAL_JACK_PORT)
         {
           g_ptr_array_add (
-            self->external_out_ports, port);
+            setup->external_out_ports, port);
         }
 #endif
 
@@ -1000,16 +2006,16 @@ graph_setup (
         }
       if (tr->type == TRACK_TYPE_TEMPO)
         {
-          self->bpm_node = NULL;
-          self->beats_per_bar_node = NULL;
-          self->beat_unit_node = NULL;
+          setup->bpm_node = NULL;
+          setup->beats_per_bar_node = NULL;
+          setup->beat_unit_node = NULL;
 
           port = tr->bpm_port;
           node2 =
             graph_find_node_from_port (self, port);
           if (node2 || !drop_unnecessary_ports)
             {
-              self->bpm_node = node2;
+              setup->bpm_node = node2;
               graph_node_connect (node2, node);
             }
           port = tr->beats_per_bar_port;
@@ -1017,7 +2023,7 @@ graph_setup (
             graph_find_node_from_port (self, port);
           if (node2 || !drop_unnecessary_ports)
             {
-              self->beats_per_bar_node = node2;
+              setup->beats_per_bar_node = node2;
               graph_node_connect (node2, node);
             }
           port = tr->beat_unit_port;
@@ -1025,7 +2031,7 @@ graph_setup (
             graph_find_node_from_port (self, port);
           if (node2 || !drop_unnecessary_ports)
             {
-              self->beat_unit_node = node2;
+              setup->beat_unit_node = node2;
               graph_node_connect (node2, node);
             }
           graph_node_connect (
@@ -1270,20 +2276,14 @@ graph_setup (
         }
     }
 
-  for (size_t i = 0; i < ports->len; i++)
+  for (size_t i = 0;
+       i < setup->port_topologies->len; i++)
     {
-      port = g_ptr_array_index (ports, i);
-      if (G_UNLIKELY (port->deleting))
-        continue;
-      if (port->id.owner_type == PORT_OWNER_TYPE_PLUGIN)
-        {
-          Plugin * port_pl =
-            port_get_plugin (port, 1);
-          if (G_UNLIKELY (port_pl->deleting))
-            continue;
-        }
-
-      connect_port (self, port);
+      connect_port (
+        self,
+        &g_array_index (
+          setup->port_topologies, GraphPortTopology,
+          i));
     }
 
   /* ========================
@@ -1291,8 +2291,7 @@ graph_setup (
    * ======================== */
   GHashTableIter iter;
   gpointer       key, value;
-  g_hash_table_iter_init (
-    &iter, self->setup_graph_nodes);
+  g_hash_table_iter_init (&iter, setup->nodes);
   while (
     g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -1302,13 +2301,13 @@ graph_setup (
           /* terminal node */
           node->terminal = true;
 
-          self->setup_terminal_nodes =
+          setup->terminal_nodes =
             (GraphNode **) realloc (
-              self->setup_terminal_nodes,
-              (size_t) (1 + self->num_setup_terminal_nodes)
+              setup->terminal_nodes,
+              (size_t) (1 + setup->n_terminal_nodes)
                 * sizeof (GraphNode *));
-          self->setup_terminal_nodes
-            [self->num_setup_terminal_nodes++] =
+          setup
+            ->terminal_nodes[setup->n_terminal_nodes++] =
             node;
         }
       if (node->init_refcount == 0)
@@ -1316,14 +2315,13 @@ graph_setup (
           /* initial node */
           node->initial = true;
 
-          self->setup_init_trigger_list =
+          setup->init_trigger_list =
             (GraphNode **) realloc (
-              self->setup_init_trigger_list,
-              (size_t) (1 + self->num_setup_init_triggers)
+              setup->init_trigger_list,
+              (size_t) (1 + setup->n_init_triggers)
                 * sizeof (GraphNode *));
-          self->setup_init_trigger_list
-            [self->num_setup_init_triggers++] =
-            node;
+          setup->init_trigger_list
+            [setup->n_init_triggers++] = node;
         }
     }
 
@@ -1340,21 +2338,48 @@ graph_setup (
    *
    * this is because indices can be changed by the
    * GUI thread while the graph is running
-   * TODO or maybe not needed since there is a lock
-   * now
+   *
+   * these are applied when the graph is published
+   * since the running graph uses the current ones
    * ======================== */
 
-  clip_editor_set_caches (CLIP_EDITOR);
-  tracklist_set_caches (TRACKLIST);
-  tracklist_set_caches (
-    SAMPLE_PROCESSOR->tracklist);
+  if (rechain)
+    {
+      if (CLIP_EDITOR->has_region)
+        {
+          setup->clip_editor_region =
+            clip_editor_get_region (CLIP_EDITOR);
+          setup->clip_editor_track =
+            clip_editor_get_track (CLIP_EDITOR);
+        }
+      for (int i = 0; i < TRACKLIST->num_tracks; i++)
+        {
+          add_track_caches (self, TRACKLIST->tracks[i]);
+        }
+      Tracklist * sp_tracklist =
+        SAMPLE_PROCESSOR->tracklist;
+      for (int i = 0; i < sp_tracklist->num_tracks;
+           i++)
+        {
+          add_track_caches (
+            self, sp_tracklist->tracks[i]);
+        }
+    }
 
   /*graph_print (self);*/
 
   g_ptr_array_unref (ports);
 
   if (rechain)
-    graph_rechain (self);
+    {
+      graph_rechain (self);
+
+      if (self->anticipative)
+        {
+          anticipative_renderer_resume (
+            self->anticipative);
+        }
+    }
 }
 
 /**
@@ -1410,6 +2435,49 @@ graph_validate_with_connection (
   return valid;
 }
 
+/**
+ * Picks the CPUs to pin the DSP threads to if
+ * ZRYTHM_DSP_THREAD_AFFINITY is set, leaving the
+ * first ZRYTHM_DSP_GUI_CORES available cores
+ * free of DSP threads.
+ */
+static void
+setup_thread_cpus (Graph * self)
+{
+  self->num_cpus = 0;
+#ifdef __linux__
+  if (!env_get_int ("ZRYTHM_DSP_THREAD_AFFINITY", 0))
+    return;
+
+  int cores[MAX_GRAPH_THREADS * 2];
+  int num_cores = audio_get_available_cores (
+    cores, G_N_ELEMENTS (cores));
+  int num_gui_cores =
+    MAX (env_get_int ("ZRYTHM_DSP_GUI_CORES", 1), 0);
+  if (num_cores - num_gui_cores < 1)
+    {
+      g_message (
+        "not enough cores (%d) to pin DSP threads",
+        num_cores);
+      return;
+    }
+
+  for (int i = num_gui_cores;
+       i < num_cores
+       && self->num_cpus < MAX_GRAPH_THREADS;
+       i++)
+    {
+      self->cpus[self->num_cpus++] = cores[i];
+    }
+
+  /* only the DSP threads are pinned - the GTK
+   * thread and the threads it creates keep the
+   * affinity of the process and are left to the
+   * scheduler, which will mostly use the cores
+   * the DSP threads are not busy on */
+#endif
+}
+
 /**
  * Starts as many threads as there are cores.
  *
@@ -1418,13 +2486,24 @@ graph_validate_with_connection (
 int
 graph_start (Graph * graph)
 {
-  int num_cores = MIN (
-    MAX_GRAPH_THREADS, audio_get_num_cores ());
+  /* the nominal count includes SMT siblings and
+   * cores the process may not run on */
+  char * cores_type =
+    env_get_string ("ZRYTHM_DSP_CORES", "nominal");
+  int num_cores =
+    string_is_equal (cores_type, "measured")
+      ? audio_get_num_available_cores ()
+      : audio_get_num_cores ();
+  g_free (cores_type);
+  num_cores = MIN (MAX_GRAPH_THREADS, num_cores);
   graph->num_threads = env_get_int (
     "ZRYTHM_DSP_THREADS", num_cores - 2);
   g_warn_if_fail (graph->num_threads >= 0);
 
-  graph->num_threads = MAX (graph->num_threads, 0);
+  graph->num_threads = MIN (
+    MAX (graph->num_threads, 0), MAX_GRAPH_THREADS);
+
+  setup_thread_cpus (graph);
 
   /* create worker threads (num cores - 2 because
    * the main thread will become a worker too, so
@@ -1451,6 +2530,12 @@ graph_start (Graph * graph)
       return 0;
     }
 
+  if (graph->anticipative)
+    {
+      anticipative_renderer_start (
+        graph->anticipative);
+    }
+
   /* breathe */
   sched_yield ();
 
@@ -1480,16 +2565,6 @@ graph_new (Router * router)
   Graph * self = object_new (Graph);
 
   self->router = router;
-  self->trigger_queue = mpmc_queue_new ();
-  self->init_trigger_list =
-    object_new (GraphNode *);
-  self->terminal_nodes = object_new (GraphNode *);
-  self->graph_nodes = g_hash_table_new_full (
-    g_direct_hash, g_direct_equal, NULL,
-    (GDestroyNotify) graph_node_free);
-  self->setup_graph_nodes = g_hash_table_new_full (
-    g_direct_hash, g_direct_equal, NULL,
-    (GDestroyNotify) graph_node_free);
 
   zix_sem_init (&self->callback_start, 0);
   zix_sem_init (&self->callback_done, 0);
@@ -1499,6 +2574,34 @@ graph_new (Router * router)
   g_atomic_int_set (&self->terminate, 0);
   g_atomic_int_set (&self->idle_thread_cnt, 0);
   g_atomic_int_set (&self->trigger_queue_size, 0);
+  g_atomic_int_set (&self->epoch, 0);
+
+  self->removed_connections =
+    g_ptr_array_new_with_free_func (
+      (GDestroyNotify) port_connection_free);
+
+  char * scheduler =
+    env_get_string ("ZRYTHM_GRAPH_SCHEDULER", "queue");
+  if (string_is_equal (scheduler, "work-stealing"))
+    {
+      self->scheduler_type =
+        GRAPH_SCHEDULER_TYPE_WORK_STEALING;
+    }
+  else
+    {
+      self->scheduler_type =
+        GRAPH_SCHEDULER_TYPE_SHARED_QUEUE;
+    }
+  g_free (scheduler);
+
+  self->idle_spin_usec =
+    MAX (env_get_int ("ZRYTHM_DSP_SPIN_USEC", 0), 0);
+
+  self->use_buffer_arena =
+    env_get_int ("ZRYTHM_DSP_BUFFER_ARENA", 0) > 0;
+
+  self->anticipative =
+    anticipative_renderer_new (self);
 
   return self;
 }
@@ -1511,6 +2614,12 @@ graph_terminate (Graph * self)
 {
   g_message ("terminating graph...");
 
+  if (self->anticipative)
+    {
+      anticipative_renderer_terminate (
+        self->anticipative);
+    }
+
   /* Flag threads to terminate */
   g_atomic_int_set (&self->terminate, 1);
 
@@ -1548,13 +2657,15 @@ graph_terminate (Graph * self)
       void * status;
       pthread_join (
         self->threads[i]->pthread, &status);
-      self->threads[i] = NULL;
+      object_free_w_func_and_null (
+        graph_thread_free, self->threads[i]);
     }
   g_return_if_fail (self->main_thread);
   void * status;
   pthread_join (
     self->main_thread->pthread, &status);
-  self->main_thread = NULL;
+  object_free_w_func_and_null (
+    graph_thread_free, self->main_thread);
 
   g_message ("graph terminated");
 }
@@ -1566,7 +2677,7 @@ graph_find_node_from_port (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, port);
+      self->setup->nodes, port);
   if (node && node->type == ROUTE_NODE_TYPE_PORT)
     {
       g_return_val_if_fail (
@@ -1584,7 +2695,7 @@ graph_find_node_from_plugin (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, pl);
+      self->setup->nodes, pl);
   if (node && node->type == ROUTE_NODE_TYPE_PLUGIN)
     return node;
   else
@@ -1597,10 +2708,10 @@ graph_find_node_from_track (
   const Track * track,
   bool          use_setup_nodes)
 {
-  GHashTable * nodes =
-    (use_setup_nodes
-       ? self->setup_graph_nodes
-       : self->graph_nodes);
+  CompiledGraph * compiled =
+    use_setup_nodes ? self->setup : self->compiled;
+  g_return_val_if_fail (compiled, NULL);
+  GHashTable * nodes = compiled->nodes;
   GraphNode * node = (GraphNode *)
     g_hash_table_lookup (nodes, track);
   if (node && node->type == ROUTE_NODE_TYPE_TRACK)
@@ -1616,7 +2727,7 @@ graph_find_node_from_fader (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, fader);
+      self->setup->nodes, fader);
   if (node && node->type == ROUTE_NODE_TYPE_FADER)
     return node;
   else
@@ -1630,7 +2741,7 @@ graph_find_node_from_prefader (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, prefader);
+      self->setup->nodes, prefader);
   if (node && node->type == ROUTE_NODE_TYPE_PREFADER)
     return node;
   else
@@ -1644,7 +2755,7 @@ graph_find_node_from_sample_processor (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, sample_processor);
+      self->setup->nodes, sample_processor);
   if (
     node
     && node->type == ROUTE_NODE_TYPE_SAMPLE_PROCESSOR)
@@ -1660,7 +2771,7 @@ graph_find_node_from_monitor_fader (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, fader);
+      self->setup->nodes, fader);
   if (
     node
     && node->type == ROUTE_NODE_TYPE_MONITOR_FADER)
@@ -1676,7 +2787,7 @@ graph_find_node_from_channel_send (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, send);
+      self->setup->nodes, send);
   if (node && node->type == ROUTE_NODE_TYPE_CHANNEL_SEND)
     return node;
   else
@@ -1689,7 +2800,7 @@ graph_find_initial_processor_node (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes,
+      self->setup->nodes,
       &self->initial_processor);
   if (
     node
@@ -1707,7 +2818,7 @@ graph_find_hw_processor_node (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, processor);
+      self->setup->nodes, processor);
   if (node && node->type == ROUTE_NODE_TYPE_HW_PROCESSOR)
     return node;
   else
@@ -1721,7 +2832,7 @@ graph_find_node_from_modulator_macro_processor (
 {
   GraphNode * node =
     (GraphNode *) g_hash_table_lookup (
-      self->setup_graph_nodes, processor);
+      self->setup->nodes, processor);
   if (
     node
     && node->type
@@ -1741,10 +2852,15 @@ graph_create_node (
   GraphNodeType type,
   void *        data)
 {
+  GraphNode * prev_node = (GraphNode *)
+    g_hash_table_lookup (self->setup->nodes, data);
+  if (prev_node)
+    graph_node_free (prev_node);
+
   GraphNode * node =
     graph_node_new (self, type, data);
   g_hash_table_insert (
-    self->setup_graph_nodes, data, node);
+    self->setup->nodes, data, node);
 
   return node;
 }
@@ -1757,17 +2873,17 @@ graph_free (Graph * self)
 {
   g_debug ("%s: freeing...", __func__);
 
+  reclaim_replaced_graphs (self, true);
   object_free_w_func_and_null (
-    g_hash_table_unref, self->graph_nodes);
-  object_zero_and_free (self->init_trigger_list);
+    compiled_graph_free, self->compiled);
   object_free_w_func_and_null (
-    g_hash_table_unref, self->setup_graph_nodes);
-  object_zero_and_free (
-    self->setup_init_trigger_list);
-  object_zero_and_free (self->terminal_nodes);
-
+    compiled_graph_free, self->pending);
   object_free_w_func_and_null (
-    g_ptr_array_unref, self->external_out_ports);
+    compiled_graph_free, self->setup);
+  object_free_w_func_and_null (
+    g_ptr_array_unref, self->removed_connections);
+  object_free_w_func_and_null (
+    anticipative_renderer_free, self->anticipative);
 
   zix_sem_destroy (&self->callback_start);
   zix_sem_destroy (&self->callback_done);
@@ -1776,9 +2892,6 @@ graph_free (Graph * self)
   object_set_to_zero (&self->callback_done);
   object_set_to_zero (&self->trigger);
 
-  object_free_w_func_and_null (
-    mpmc_queue_free, self->trigger_queue);
-
   object_zero_and_free (self);
 
   g_debug ("%s: done", __func__);
@@ -0,0 +1,562 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-config.h"
+
+#include <stdlib.h>
+
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/graph_buffer_plan.h"
+#include "audio/graph_node.h"
+#include "audio/port.h"
+#include "audio/track.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+
+#ifdef HAVE_LSP_DSP
+#  include <lsp-plug.in/dsp/dsp.h>
+#endif
+
+/** Number of floats per aligned unit. */
+#define FLOATS_PER_ALIGNMENT \
+  (GRAPH_BUFFER_PLAN_ALIGNMENT / sizeof (float))
+
+/**
+ * A port being planned.
+ */
+typedef struct PlannedPort
+{
+  GraphNode * node;
+
+  /** Node that writes to the buffer first, or -1
+   * if the buffer cannot be shared. */
+  int writer;
+
+  /** Buffer size, in floats. */
+  size_t sz;
+
+  /** Slot index. */
+  size_t slot;
+} PlannedPort;
+
+typedef struct PlanSlot
+{
+  /** Size, in floats. */
+  size_t sz;
+
+  /** Offset in the arena, in floats. */
+  size_t offset;
+
+  /** Last port assigned to the slot (index in the
+   * planned ports). */
+  size_t last;
+
+  /** Number of ports assigned to the slot. */
+  size_t num_ports;
+
+  bool shareable;
+} PlanSlot;
+
+/**
+ * Strict ancestors of each node of a schedule, as
+ * bitsets over the nodes before it.
+ */
+typedef struct Ancestors
+{
+  guint64 * bits;
+  size_t *  row_offsets;
+} Ancestors;
+
+static void
+ancestors_init (
+  Ancestors *           self,
+  const CompiledGraph * compiled)
+{
+  size_t n = compiled->schedule_size;
+  self->row_offsets = object_new_n (n + 1, size_t);
+  for (size_t i = 0; i < n; i++)
+    {
+      self->row_offsets[i + 1] =
+        self->row_offsets[i] + (i + 63) / 64;
+    }
+  self->bits = object_new_n (
+    MAX (self->row_offsets[n], 1), guint64);
+
+  /* parents always come before their children in
+   * the schedule */
+  for (size_t i = 0; i < n; i++)
+    {
+      const GraphNode * node = &compiled->schedule[i];
+      guint64 * row = &self->bits[self->row_offsets[i]];
+      for (int j = 0; j < node->init_refcount; j++)
+        {
+          size_t p = (size_t) node->parentnodes[j]->id;
+          const guint64 * parent_row =
+            &self->bits[self->row_offsets[p]];
+          size_t parent_words =
+            self->row_offsets[p + 1]
+            - self->row_offsets[p];
+          for (size_t k = 0; k < parent_words; k++)
+            row[k] |= parent_row[k];
+          row[p / 64] |= (guint64) 1 << (p % 64);
+        }
+    }
+}
+
+PURE static inline bool
+ancestors_contains (
+  const Ancestors * self,
+  size_t            node,
+  size_t            ancestor)
+{
+  if (ancestor >= node)
+    return false;
+
+  const guint64 * row =
+    &self->bits[self->row_offsets[node]];
+  return (row[ancestor / 64] >> (ancestor % 64)) & 1;
+}
+
+static void
+ancestors_free_members (Ancestors * self)
+{
+  object_zero_and_free (self->bits);
+  object_zero_and_free (self->row_offsets);
+}
+
+/**
+ * Returns whether the port may have its buffer in
+ * the arena.
+ */
+static bool
+port_can_use_arena (const Port * port)
+{
+  if (
+    port->id.type != TYPE_AUDIO
+    && port->id.type != TYPE_CV)
+    return false;
+
+  /* the sample processor processes its tracks
+   * outside the graph */
+  return !(
+    port->id.flags2
+    & PORT_FLAG2_SAMPLE_PROCESSOR_TRACK);
+}
+
+/**
+ * Returns the node that writes to the port's
+ * buffer first, or -1 if the buffer is used
+ * outside the nodes next to the port's node and
+ * cannot be shared.
+ */
+static int
+get_shared_buffer_writer (const GraphNode * node)
+{
+  const Port * port = node->port;
+  if (port->id.type != TYPE_AUDIO)
+    return -1;
+
+  /* channel outputs and engine ports are read
+   * after the graph is processed (e.g., by the
+   * exporter and the backend) */
+  switch (port->id.owner_type)
+    {
+    case PORT_OWNER_TYPE_PLUGIN:
+    case PORT_OWNER_TYPE_TRACK_PROCESSOR:
+    case PORT_OWNER_TYPE_FADER:
+    case PORT_OWNER_TYPE_CHANNEL_SEND:
+      break;
+    default:
+      return -1;
+    }
+  if (
+    port->id.flags2
+      & (PORT_FLAG2_MONITOR_FADER
+         | PORT_FLAG2_SAMPLE_PROCESSOR_FADER)
+    || port_is_exposed_to_backend (port))
+    return -1;
+
+  /* the monitor fader mixes in the post-fader
+   * outputs of listened tracks without being
+   * connected to them */
+  if (
+    port->id.owner_type == PORT_OWNER_TYPE_FADER
+    && port->id.flow == FLOW_OUTPUT
+    && port->id.flags2 & PORT_FLAG2_POSTFADER)
+    return -1;
+
+  /* the anticipative renderer processes its nodes
+   * at other times */
+  if (node->anticipative)
+    return -1;
+  for (int i = 0; i < node->n_childnodes; i++)
+    {
+      if (node->childnodes[i]->anticipative)
+        return -1;
+    }
+
+  int writer = -1;
+  if (port->id.flow == FLOW_OUTPUT)
+    {
+      /* written by the processor owning it */
+      for (int i = 0; i < node->init_refcount; i++)
+        {
+          const GraphNode * parent =
+            node->parentnodes[i];
+          if (
+            parent->type == ROUTE_NODE_TYPE_PORT
+            || parent->type
+                 == ROUTE_NODE_TYPE_INITIAL_PROCESSOR)
+            continue;
+
+          if (writer >= 0 || parent->anticipative)
+            return -1;
+
+          writer = parent->id;
+        }
+    }
+  else if (port->id.flow == FLOW_INPUT)
+    {
+      /* written by the port's process routine,
+       * which sums the sources */
+      for (int i = 0; i < node->init_refcount; i++)
+        {
+          const GraphNode * parent =
+            node->parentnodes[i];
+          if (
+            parent->type != ROUTE_NODE_TYPE_PORT
+            && parent->type
+                 != ROUTE_NODE_TYPE_INITIAL_PROCESSOR)
+            return -1;
+        }
+      writer = node->id;
+    }
+
+  return writer;
+}
+
+/**
+ * Returns whether all the nodes that read the
+ * buffer of @p prev always finish before @p writer
+ * starts.
+ *
+ * The buffer is only read by the port's node and
+ * its children.
+ */
+static bool
+is_dead_before (
+  const Ancestors *   ancestors,
+  const PlannedPort * prev,
+  int                 writer)
+{
+  const GraphNode * node = prev->node;
+  if (!ancestors_contains (
+        ancestors, (size_t) writer,
+        (size_t) node->id))
+    return false;
+
+  for (int i = 0; i < node->n_childnodes; i++)
+    {
+      if (!ancestors_contains (
+            ancestors, (size_t) writer,
+            (size_t) node->childnodes[i]->id))
+        return false;
+    }
+
+  return true;
+}
+
+/**
+ * Sorts planned ports by the position of the node
+ * that first writes to them.
+ */
+static int
+cmp_planned_ports (const void * a, const void * b)
+{
+  const PlannedPort * port_a = (const PlannedPort *) a;
+  const PlannedPort * port_b = (const PlannedPort *) b;
+  int pos_a =
+    port_a->writer >= 0
+      ? port_a->writer
+      : port_a->node->id;
+  int pos_b =
+    port_b->writer >= 0
+      ? port_b->writer
+      : port_b->node->id;
+  if (pos_a != pos_b)
+    return pos_a - pos_b;
+  return port_a->node->id - port_b->node->id;
+}
+
+GraphBufferPlan *
+graph_buffer_plan_new (CompiledGraph * compiled)
+{
+  size_t n = compiled->schedule_size;
+  g_return_val_if_fail (compiled->schedule, NULL);
+
+  size_t num_ports = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      if (
+        node->type == ROUTE_NODE_TYPE_PORT
+        && port_can_use_arena (node->port))
+        num_ports++;
+    }
+
+  bool share = n <= GRAPH_BUFFER_PLAN_MAX_SHARING_NODES;
+  PlannedPort * ports =
+    object_new_n (MAX (num_ports, 1), PlannedPort);
+  size_t idx = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      if (
+        node->type != ROUTE_NODE_TYPE_PORT
+        || !port_can_use_arena (node->port))
+        continue;
+
+      PlannedPort * planned = &ports[idx++];
+      planned->node = node;
+      planned->writer =
+        share ? get_shared_buffer_writer (node) : -1;
+      size_t sz = MAX (
+        (size_t) AUDIO_ENGINE->block_length,
+        node->port->min_buf_size);
+      sz = MAX (sz, 1);
+      planned->sz =
+        ((sz + FLOATS_PER_ALIGNMENT - 1)
+         / FLOATS_PER_ALIGNMENT)
+        * FLOATS_PER_ALIGNMENT;
+    }
+  qsort (
+    ports, num_ports, sizeof (PlannedPort),
+    cmp_planned_ports);
+
+  Ancestors ancestors = { 0 };
+  if (share)
+    ancestors_init (&ancestors, compiled);
+
+  /* assign slots, reusing the first shareable slot
+   * whose last port is dead by the time the port
+   * is written to */
+  GraphBufferPlan * self = object_new (GraphBufferPlan);
+  PlanSlot * slots =
+    object_new_n (MAX (num_ports, 1), PlanSlot);
+  for (size_t i = 0; i < num_ports; i++)
+    {
+      PlannedPort * planned = &ports[i];
+      self->unshared_size +=
+        planned->sz * sizeof (float);
+
+      PlanSlot * slot = NULL;
+      if (planned->writer >= 0)
+        {
+          for (size_t j = 0; j < self->num_slots; j++)
+            {
+              PlanSlot * cur_slot = &slots[j];
+              if (
+                cur_slot->shareable
+                && is_dead_before (
+                  &ancestors, &ports[cur_slot->last],
+                  planned->writer))
+                {
+                  slot = cur_slot;
+                  self->num_shared++;
+                  break;
+                }
+            }
+        }
+      if (!slot)
+        {
+          slot = &slots[self->num_slots++];
+          slot->shareable = planned->writer >= 0;
+        }
+
+      slot->sz = MAX (slot->sz, planned->sz);
+      slot->last = i;
+      slot->num_ports++;
+      planned->slot = (size_t) (slot - slots);
+    }
+
+  size_t arena_floats = 0;
+  for (size_t i = 0; i < self->num_slots; i++)
+    {
+      slots[i].offset = arena_floats;
+      arena_floats += slots[i].sz;
+    }
+  self->arena_size = arena_floats * sizeof (float);
+  self->arena_mem = calloc (
+    1, self->arena_size + GRAPH_BUFFER_PLAN_ALIGNMENT);
+  self->arena = (float *) ((
+    ((guintptr) self->arena_mem
+     + GRAPH_BUFFER_PLAN_ALIGNMENT - 1)
+    / GRAPH_BUFFER_PLAN_ALIGNMENT)
+    * GRAPH_BUFFER_PLAN_ALIGNMENT);
+
+  /* ports in the arena of the live graph that are
+   * not in this graph get a buffer of their own */
+  GHashTable * planned_ports =
+    g_hash_table_new (NULL, NULL);
+  for (size_t i = 0; i < num_ports; i++)
+    {
+      g_hash_table_add (
+        planned_ports, ports[i].node->port);
+    }
+  GPtrArray * all_ports = g_ptr_array_new ();
+  port_get_all (all_ports);
+  GPtrArray * orphans = g_ptr_array_new ();
+  for (size_t i = 0; i < all_ports->len; i++)
+    {
+      Port * port = g_ptr_array_index (all_ports, i);
+      if (
+        port->buf_in_arena
+        && !g_hash_table_contains (
+          planned_ports, port))
+        g_ptr_array_add (orphans, port);
+    }
+
+  self->num_entries = num_ports + orphans->len;
+  self->entries = object_new_n (
+    MAX (self->num_entries, 1), GraphBufferPlanEntry);
+  self->clear_offsets = object_new_n (n + 1, guint);
+  for (size_t i = 0; i < num_ports; i++)
+    {
+      PlannedPort *          planned = &ports[i];
+      PlanSlot *             slot = &slots[planned->slot];
+      GraphBufferPlanEntry * entry = &self->entries[i];
+      entry->port = planned->node->port;
+      entry->buf = &self->arena[slot->offset];
+      entry->buf_sz = slot->sz;
+      entry->in_arena = true;
+
+      if (slot->num_ports > 1)
+        self->clear_offsets[planned->writer + 1]++;
+    }
+  for (size_t i = 0; i < orphans->len; i++)
+    {
+      Port * port = g_ptr_array_index (orphans, i);
+      GraphBufferPlanEntry * entry =
+        &self->entries[num_ports + i];
+      entry->port = port;
+      entry->buf_sz = MAX (port->last_buf_sz, 1);
+      entry->buf = object_new_n (entry->buf_sz, float);
+      entry->in_arena = false;
+    }
+
+  /* shared slots are cleared by the writer of each
+   * port before it is processed */
+  for (size_t i = 0; i < n; i++)
+    {
+      self->clear_offsets[i + 1] +=
+        self->clear_offsets[i];
+    }
+  self->clear_bufs = object_new_n (
+    MAX (self->clear_offsets[n], 1), float *);
+  guint * clear_pos = object_new_n (n, guint);
+  for (size_t i = 0; i < num_ports; i++)
+    {
+      PlannedPort * planned = &ports[i];
+      PlanSlot *    slot = &slots[planned->slot];
+      if (slot->num_ports < 2)
+        continue;
+
+      size_t writer = (size_t) planned->writer;
+      self->clear_bufs
+        [self->clear_offsets[writer]
+         + clear_pos[writer]++] =
+        &self->arena[slot->offset];
+    }
+
+  g_message (
+    "port buffer arena: %zu ports in %zu slots "
+    "(%zu shared), %zu KiB (%zu KiB without "
+    "sharing)",
+    num_ports, self->num_slots, self->num_shared,
+    self->arena_size / 1024,
+    self->unshared_size / 1024);
+
+  free (clear_pos);
+  g_ptr_array_unref (orphans);
+  g_ptr_array_unref (all_ports);
+  g_hash_table_destroy (planned_ports);
+  ancestors_free_members (&ancestors);
+  free (slots);
+  free (ports);
+
+  return self;
+}
+
+void
+graph_buffer_plan_apply (GraphBufferPlan * self)
+{
+  for (size_t i = 0; i < self->num_entries; i++)
+    {
+      GraphBufferPlanEntry * entry = &self->entries[i];
+      Port *                 port = entry->port;
+
+      float * buf = port->buf;
+      port->buf = entry->buf;
+      entry->buf = buf;
+
+      size_t buf_sz = port->last_buf_sz;
+      port->last_buf_sz = entry->buf_sz;
+      entry->buf_sz = buf_sz;
+
+      bool in_arena = port->buf_in_arena;
+      port->buf_in_arena = entry->in_arena;
+      entry->in_arena = in_arena;
+    }
+}
+
+void
+graph_buffer_plan_release_previous (
+  GraphBufferPlan * self)
+{
+  /* previous buffers in an arena are freed with
+   * the previous graph */
+  for (size_t i = 0; i < self->num_entries; i++)
+    {
+      GraphBufferPlanEntry * entry = &self->entries[i];
+      if (!entry->in_arena)
+        object_zero_and_free (entry->buf);
+      entry->buf = NULL;
+      entry->in_arena = false;
+    }
+}
+
+void
+graph_buffer_plan_clear_node_buffers (
+  const GraphBufferPlan *             self,
+  const GraphNode *                   node,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  guint start = self->clear_offsets[node->id];
+  guint end = self->clear_offsets[node->id + 1];
+  for (guint i = start; i < end; i++)
+    {
+      dsp_fill (
+        &self->clear_bufs[i][time_nfo->local_offset],
+        DENORMAL_PREVENTION_VAL, time_nfo->nframes);
+    }
+}
+
+void
+graph_buffer_plan_free (GraphBufferPlan * self)
+{
+  /* buffers not given to the ports yet, or
+   * previous buffers not released */
+  for (size_t i = 0; i < self->num_entries; i++)
+    {
+      GraphBufferPlanEntry * entry = &self->entries[i];
+      if (!entry->in_arena)
+        object_zero_and_free (entry->buf);
+    }
+  object_zero_and_free (self->entries);
+  object_zero_and_free (self->clear_offsets);
+  object_zero_and_free (self->clear_bufs);
+  object_free_w_func_and_null (free, self->arena_mem);
+
+  object_zero_and_free (self);
+}
@@ -26,6 +26,11 @@ typedef struct ANode
 
   /** Subgraph the node is a part of. */
   Agraph_t * graph;
+
+  /** Recent processing times of the corresponding
+   * node in the live graph. */
+  GraphNodeTimingStats stats;
+  bool                 has_stats;
 } ANode;
 
 static ANode *
@@ -183,12 +188,48 @@ get_parent_graph (
   return get_graph_from_node (anodes, parent_node);
 }
 
+/**
+ * Fetches the timing statistics of the node in the
+ * live graph that corresponds to @p node (the
+ * exported graph is usually not processed).
+ */
+static bool
+get_live_timing_stats (
+  GraphNode *            node,
+  GraphNodeTimingStats * stats)
+{
+  if (!AUDIO_ENGINE || !ROUTER || !ROUTER->graph)
+    return false;
+
+  CompiledGraph * compiled = ROUTER->graph->compiled;
+  void *          ptr = graph_node_get_pointer (node);
+  if (!compiled || !compiled->timings || !ptr)
+    return false;
+
+  GraphNode * live_node = (GraphNode *)
+    g_hash_table_lookup (compiled->nodes, ptr);
+  if (!live_node || live_node->type != node->type)
+    return false;
+
+  return graph_node_get_timing_stats (
+    live_node, stats);
+}
+
+/**
+ * @param max_cost Mean processing time of the most
+ *   expensive node, used to colour the nodes by
+ *   cost.
+ */
 static Agnode_t *
 create_anode (
   Agraph_t *   aroot_graph,
   GraphNode *  node,
-  GHashTable * anodes)
+  GHashTable * anodes,
+  float        max_cost)
 {
+  ANode * anode_nfo =
+    (ANode *) g_hash_table_lookup (anodes, node);
+
   Agraph_t * aparent_graph =
     get_parent_graph (anodes, node);
   if (!aparent_graph)
@@ -197,9 +238,11 @@ create_anode (
   char * plain_node_name =
     graph_node_get_name (node);
   char * node_name = g_strdup_printf (
-    "%s\np:%d (%d) c:%d", plain_node_name,
-    node->playback_latency,
-    node->route_playback_latency, 0);
+    "%s\np:%d (%d) c:%.1fus (p99 %.1fus)",
+    plain_node_name, node->playback_latency,
+    node->route_playback_latency,
+    (double) anode_nfo->stats.mean,
+    (double) anode_nfo->stats.p99);
   /*g_strdup_printf (*/
   /*"%s i:%d t:%d init refcount: %d",*/
   /*plain_node_name,*/
@@ -244,6 +287,23 @@ create_anode (
         (char *) "ellipse");
       break;
     }
+
+  /* fill from green (cheap) to red (expensive) */
+  if (anode_nfo->has_stats && max_cost > 0.f)
+    {
+      float hue =
+        0.333f
+        * (1.f - anode_nfo->stats.mean / max_cost);
+      char fillcolor[40];
+      sprintf (
+        fillcolor, "%.3f 0.600 1.000", (double) hue);
+      agsafeset (
+        anode, (char *) "style", (char *) "filled",
+        (char *) "");
+      agsafeset (
+        anode, (char *) "fillcolor", fillcolor,
+        (char *) "white");
+    }
   g_free (node_name);
 
   return anode;
@@ -261,7 +321,7 @@ fill_anodes (
   GHashTableIter iter;
   gpointer       key, value;
   g_hash_table_iter_init (
-    &iter, graph->setup_graph_nodes);
+    &iter, graph->setup->nodes);
   while (
     g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -409,22 +469,35 @@ export_as_graphviz_type (
     (GDestroyNotify) anode_free);
   fill_anodes (graph, agraph, anodes);
 
-  /* create graph */
+  /* get the processing times */
+  float          max_cost = 0.f;
   GHashTableIter iter;
   gpointer       key, value;
   g_hash_table_iter_init (&iter, anodes);
+  while (
+    g_hash_table_iter_next (&iter, &key, &value))
+    {
+      ANode * anode = (ANode *) value;
+      anode->has_stats = get_live_timing_stats (
+        anode->node, &anode->stats);
+      if (anode->has_stats)
+        max_cost = MAX (max_cost, anode->stats.mean);
+    }
+
+  /* create graph */
+  g_hash_table_iter_init (&iter, anodes);
   while (
     g_hash_table_iter_next (&iter, &key, &value))
     {
       GraphNode * node = (GraphNode *) key;
 
-      Agnode_t * anode =
-        create_anode (agraph, node, anodes);
+      Agnode_t * anode = create_anode (
+        agraph, node, anodes, max_cost);
       for (int j = 0; j < node->n_childnodes; j++)
         {
           GraphNode * child = node->childnodes[j];
-          Agnode_t *  achildnode =
-            create_anode (agraph, child, anodes);
+          Agnode_t *  achildnode = create_anode (
+            agraph, child, anodes, max_cost);
 
           /* create edge */
           Agedge_t * edge = agedge (
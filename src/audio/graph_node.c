@@ -2,12 +2,17 @@
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
 #include <inttypes.h>
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "audio/anticipative_renderer.h"
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/graph.h"
+#include "audio/graph_buffer_plan.h"
 #include "audio/graph_node.h"
+#include "audio/graph_thread.h"
 #include "audio/master_track.h"
 #include "audio/midi_event.h"
 #include "audio/port.h"
@@ -21,6 +26,7 @@
 #include "plugins/plugin.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/datetime.h"
 #include "utils/mpmc_queue.h"
 #include "utils/objects.h"
 
@@ -129,6 +135,111 @@ graph_node_get_pointer (GraphNode * node)
   g_return_val_if_reached (NULL);
 }
 
+/**
+ * Returns the track the node belongs to, if any.
+ */
+Track *
+graph_node_get_track (GraphNode * self)
+{
+  switch (self->type)
+    {
+    case ROUTE_NODE_TYPE_PORT:
+      return port_get_track (self->port, false);
+    case ROUTE_NODE_TYPE_PLUGIN:
+      return plugin_get_track (self->pl);
+    case ROUTE_NODE_TYPE_TRACK:
+      return self->track;
+    case ROUTE_NODE_TYPE_FADER:
+      return fader_get_track (self->fader);
+    case ROUTE_NODE_TYPE_PREFADER:
+      return fader_get_track (self->prefader);
+    case ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR:
+      return port_get_track (
+        self->modulator_macro_processor->cv_in,
+        false);
+    case ROUTE_NODE_TYPE_CHANNEL_SEND:
+      return channel_send_get_track (self->send);
+    default:
+      break;
+    }
+
+  return NULL;
+}
+
+/**
+ * Returns the plugin the node belongs to, if any.
+ */
+Plugin *
+graph_node_get_plugin (GraphNode * self)
+{
+  switch (self->type)
+    {
+    case ROUTE_NODE_TYPE_PLUGIN:
+      return self->pl;
+    case ROUTE_NODE_TYPE_PORT:
+      if (
+        self->port->id.owner_type
+        == PORT_OWNER_TYPE_PLUGIN)
+        return port_get_plugin (self->port, false);
+      break;
+    default:
+      break;
+    }
+
+  return NULL;
+}
+
+/**
+ * Calculates statistics over the recent processing
+ * times of the node.
+ *
+ * @return Whether any samples were available.
+ */
+bool
+graph_node_get_timing_stats (
+  GraphNode *            self,
+  GraphNodeTimingStats * stats)
+{
+  memset (stats, 0, sizeof (GraphNodeTimingStats));
+
+  CompiledGraph * compiled = self->graph->compiled;
+  g_return_val_if_fail (
+    compiled && compiled->timings
+      && self >= compiled->schedule
+      && self < compiled->schedule
+                  + compiled->schedule_size,
+    false);
+
+  GraphNodeTimings * timings =
+    &compiled->timings[self->id];
+  guint num_written =
+    g_atomic_int_get (&timings->num_written);
+  int num_samples = (int) MIN (
+    num_written, GRAPH_NODE_TIMING_RING_SIZE);
+  if (num_samples == 0)
+    return false;
+
+  float samples[GRAPH_NODE_TIMING_RING_SIZE];
+  memcpy (
+    samples, timings->samples, sizeof (samples));
+  array_sort_float (samples, num_samples);
+
+  float sum = 0.f;
+  for (int i = 0; i < num_samples; i++)
+    {
+      sum += samples[i];
+    }
+
+  int p99_idx =
+    (int) ceilf (0.99f * (float) num_samples) - 1;
+  stats->min = samples[0];
+  stats->mean = sum / (float) num_samples;
+  stats->p99 = samples[MAX (p99_idx, 0)];
+  stats->num_samples = num_samples;
+
+  return true;
+}
+
 void
 graph_node_print_to_str (
   GraphNode * node,
@@ -145,7 +256,7 @@ graph_node_print_to_str (
   char * name = graph_node_get_name (node);
   char * str1 = g_strdup_printf (
     "node [(%d) %s] refcount: %d | terminal: %s | initial: %s | playback latency: %d",
-    node->id, name, node->refcount,
+    node->id, name, node->init_refcount,
     node->terminal ? "yes" : "no",
     node->initial ? "yes" : "no",
     node->playback_latency);
@@ -175,27 +286,53 @@ graph_node_print (GraphNode * node)
   g_message ("%s", str);
 }
 
-HOT static void
+/**
+ * Notifies the downstream nodes.
+ *
+ * @return The next node of a fused chain, to be
+ *   processed by the calling thread, or NULL.
+ */
+HOT static GraphNode *
 on_node_finish (GraphNode * self)
 {
+  /* the only child depends only on this node, so
+   * run it right away in this thread */
+  if (self->chain_next)
+    return self->chain_next;
+
   int feeds = 0;
 
   /* notify downstream nodes that depend on this
-   * node */
-  for (int i = 0; i < self->n_childnodes; ++i)
+   * node (only the packed schedule is used
+   * here) */
+  const CompiledGraph * compiled =
+    self->graph->compiled;
+  guint start = compiled->child_offsets[self->id];
+  guint end = compiled->child_offsets[self->id + 1];
+  if (
+    self->graph->scheduler_type
+    == GRAPH_SCHEDULER_TYPE_WORK_STEALING)
     {
-#if 0
-      /* set the largest playback latency of this
-       * route to the child as well */
-      self->childnodes[i]->route_playback_latency =
-        self->playback_latency;
-        /*MAX (*/
-          /*self->playback_latency,*/
-          /*self->childnodes[i]->*/
-            /*route_playback_latency);*/
-#endif
-      graph_node_trigger (self->childnodes[i]);
-      feeds = 1;
+      /* children are sorted by descending critical
+       * path and the local deque is LIFO, so
+       * trigger the most important child last */
+      for (guint i = end; i > start; --i)
+        {
+          graph_node_trigger (
+            &compiled->schedule
+               [compiled->child_indices[i - 1]]);
+          feeds = 1;
+        }
+    }
+  else
+    {
+      for (guint i = start; i < end; ++i)
+        {
+          graph_node_trigger (
+            &compiled->schedule
+               [compiled->child_indices[i]]);
+          feeds = 1;
+        }
     }
 
   /* if there are no outgoing edges, this is a
@@ -205,6 +342,8 @@ on_node_finish (GraphNode * self)
       /* notify parent graph */
       graph_on_reached_terminal_node (self->graph);
     }
+
+  return NULL;
 }
 
 HOT static void
@@ -255,40 +394,19 @@ process_node (
       }
       break;
     case ROUTE_NODE_TYPE_PORT:
-      {
-        /* decide what to do based on what port it
-         * is */
-        Port * port = node->port;
-        /*PortIdentifier * id = &port->id;*/
-
-        /* if midi editor manual press */
-        if (
-          port
-          == AUDIO_ENGINE->midi_editor_manual_press)
-          {
-            g_return_if_fail (
-              AUDIO_ENGINE
-                ->midi_editor_manual_press
-                ->midi_events);
-            midi_events_dequeue (
-              AUDIO_ENGINE
-                ->midi_editor_manual_press
-                ->midi_events);
-          }
-
-        /* if exporting and the port is not a
-         * project port, ignore it */
-        else if (
-          engine_is_port_own (AUDIO_ENGINE, port)
-          && AUDIO_ENGINE->exporting)
-          {
-          }
-
-        else
-          {
-            port_process (port, time_nfo, false);
-          }
-      }
+      /* if exporting and the port is not a project
+       * port, ignore it */
+      if (
+        G_UNLIKELY (node->engine_port)
+        && AUDIO_ENGINE->exporting)
+        break;
+
+      if (node->process_port)
+        {
+          node->process_port (
+            node->port, node->port_process_flags,
+            &time_nfo);
+        }
       break;
     default:
       break;
@@ -296,16 +414,144 @@ process_node (
 }
 
 /**
- * Processes the GraphNode.
+ * Adds a measured processing time (in
+ * microseconds) to the node's moving average.
+ */
+HOT static inline void
+update_cost (GraphNode * node, float cost)
+{
+  if (G_UNLIKELY (node->cost <= 0.f))
+    node->cost = cost;
+  else
+    node->cost +=
+      GRAPH_NODE_COST_EWMA_ALPHA * (cost - node->cost);
+}
+
+/**
+ * Adds a measured processing time (in
+ * microseconds) to the node's ring of recent
+ * times.
+ */
+HOT static inline void
+add_timing (GraphNode * node, float time_us)
+{
+  CompiledGraph * compiled = node->graph->compiled;
+  if (G_UNLIKELY (!compiled->timings))
+    return;
+
+  /* only this thread writes to the ring */
+  GraphNodeTimings * timings =
+    &compiled->timings[node->id];
+  guint pos = timings->num_written;
+  timings->samples
+    [pos & (GRAPH_NODE_TIMING_RING_SIZE - 1)] =
+    time_us;
+  g_atomic_int_set (&timings->num_written, pos + 1);
+}
+
+/**
+ * Processes the node for the given range.
+ *
+ * @param read_ahead Whether to play the audio
+ *   rendered ahead for the node's track first.
+ */
+HOT static inline void
+process_range (
+  const GraphNode *           node,
+  const EngineProcessTimeInfo time_nfo,
+  const bool                  read_ahead)
+{
+  if (read_ahead)
+    {
+      anticipative_track_read (
+        node->anticipative, &time_nfo);
+    }
+  process_node (node, time_nfo);
+}
+
+/**
+ * Processes the node, splitting the range at the
+ * loop points.
+ */
+HOT static void
+process_node_split_at_loop_points (
+  const GraphNode *     node,
+  EngineProcessTimeInfo time_nfo,
+  const bool            read_ahead)
+{
+  /* split at loop points */
+  for (
+    nframes_t num_processable_frames = 0;
+    (num_processable_frames = MIN (
+       transport_is_loop_point_met (
+         TRANSPORT,
+         (signed_frame_t) time_nfo.g_start_frame,
+         time_nfo.nframes),
+       time_nfo.nframes))
+    != 0;)
+    {
+#if 0
+      g_message (
+        "splitting from %ld "
+        "(num processable frames %"
+        PRIu32 ")",
+        g_start_frames, num_processable_frames);
+#endif
+
+      /* temporarily change the nframes to avoid
+       * having to declare a separate
+       * EngineProcessTimeInfo */
+      nframes_t orig_nframes = time_nfo.nframes;
+      time_nfo.nframes = num_processable_frames;
+      process_range (node, time_nfo, read_ahead);
+
+      /* calculate the remaining frames */
+      time_nfo.nframes =
+        orig_nframes - num_processable_frames;
+
+      /* loop back to loop start */
+      time_nfo.g_start_frame =
+        (time_nfo.g_start_frame
+         + num_processable_frames
+         + (unsigned_frame_t)
+             TRANSPORT->loop_start_pos.frames)
+        - (unsigned_frame_t)
+            TRANSPORT->loop_end_pos.frames;
+      time_nfo.local_offset +=
+        num_processable_frames;
+    }
+
+  if (time_nfo.nframes > 0)
+    {
+      process_range (node, time_nfo, read_ahead);
+    }
+}
+
+/**
+ * Processes a single node.
+ *
+ * @return The next node of a fused chain, if any.
  */
 OPTIMIZE_O3
-void
-graph_node_process (
+HOT static GraphNode *
+process_single_node (
   GraphNode *           node,
   EngineProcessTimeInfo time_nfo)
 {
-  g_return_if_fail (
-    node && node->graph && node->graph->router);
+  g_return_val_if_fail (
+    node && node->graph && node->graph->router,
+    NULL);
+
+  /* shared buffers this node writes to may hold
+   * data of ports processed before it, so clear
+   * them even if the node is skipped below */
+  const GraphBufferPlan * buffer_plan =
+    node->graph->compiled->buffer_plan;
+  if (buffer_plan)
+    {
+      graph_buffer_plan_clear_node_buffers (
+        buffer_plan, node, &time_nfo);
+    }
 
   /*g_message (*/
   /*"processing %s", graph_node_get_name (node));*/
@@ -345,6 +591,22 @@ graph_node_process (
       /*}*/
     }
 
+  /* the pre-fader part of tracks rendered ahead
+   * is processed by the anticipative renderer and
+   * the fader plays the rendered audio */
+  bool read_ahead = false;
+  if (G_UNLIKELY (
+        anticipative_track_is_ahead (
+          node->anticipative)))
+    {
+      if (node->type != ROUTE_NODE_TYPE_FADER)
+        goto node_process_finish;
+
+      read_ahead = true;
+    }
+
+  gint64 start_ns = datetime_get_monotonic_time_ns ();
+
   /* only compensate latency when rolling */
   if (TRANSPORT->play_state == PLAYSTATE_ROLLING)
     {
@@ -370,58 +632,55 @@ graph_node_process (
         (unsigned_frame_t) playhead_copy.frames;
     }
 
-  /* split at loop points */
-  for (
-    nframes_t num_processable_frames = 0;
-    (num_processable_frames = MIN (
-       transport_is_loop_point_met (
-         TRANSPORT,
-         (signed_frame_t) time_nfo.g_start_frame,
-         time_nfo.nframes),
-       time_nfo.nframes))
-    != 0;)
-    {
-#if 0
-      g_message (
-        "splitting from %ld "
-        "(num processable frames %"
-        PRIu32 ")",
-        g_start_frames, num_processable_frames);
-#endif
-
-      /* temporarily change the nframes to avoid
-       * having to declare a separate
-       * EngineProcessTimeInfo */
-      nframes_t orig_nframes = time_nfo.nframes;
-      time_nfo.nframes = num_processable_frames;
-      process_node (node, time_nfo);
-
-      /* calculate the remaining frames */
-      time_nfo.nframes =
-        orig_nframes - num_processable_frames;
+  process_node_split_at_loop_points (
+    node, time_nfo, read_ahead);
 
-      /* loop back to loop start */
-      time_nfo.g_start_frame =
-        (time_nfo.g_start_frame
-         + num_processable_frames
-         + (unsigned_frame_t)
-             TRANSPORT->loop_start_pos.frames)
-        - (unsigned_frame_t)
-            TRANSPORT->loop_end_pos.frames;
-      time_nfo.local_offset +=
-        num_processable_frames;
-    }
+  float time_us =
+    (float) (datetime_get_monotonic_time_ns ()
+             - start_ns)
+    / 1000.f;
+  update_cost (node, time_us);
+  add_timing (node, time_us);
 
-  if (time_nfo.nframes > 0)
+node_process_finish:
+  if (node->graph->router->callback_in_progress)
     {
-      process_node (node, time_nfo);
+      return on_node_finish (node);
     }
 
-node_process_finish:
-  if (node->graph->router->callback_in_progress)
+  return NULL;
+}
+
+/**
+ * Processes the GraphNode, followed by the rest
+ * of its fused chain.
+ */
+void
+graph_node_process (
+  GraphNode *           node,
+  EngineProcessTimeInfo time_nfo)
+{
+  do
     {
-      on_node_finish (node);
+      node = process_single_node (node, time_nfo);
     }
+  while (node);
+}
+
+/**
+ * Processes the node for the anticipative
+ * renderer.
+ *
+ * Unlike graph_node_process(), this does not
+ * trigger the children or measure the time taken.
+ */
+void
+graph_node_process_ahead (
+  GraphNode *           node,
+  EngineProcessTimeInfo time_nfo)
+{
+  process_node_split_at_loop_points (
+    node, time_nfo, false);
 }
 
 /**
@@ -431,22 +690,21 @@ node_process_finish:
 void
 graph_node_trigger (GraphNode * self)
 {
+  GraphNodeRefcount * refcount =
+    &self->graph->compiled->refcounts[self->id];
+
   /* check if we can run */
-  if (g_atomic_int_dec_and_test (&self->refcount))
+  if (g_atomic_int_dec_and_test (&refcount->refcount))
     {
       /* reset reference count for next cycle */
       g_atomic_int_set (
-        &self->refcount,
-        (unsigned int) self->init_refcount);
+        &refcount->refcount, self->init_refcount);
 
       /* all nodes that feed this node have
        * completed, so this node be processed
        * now. */
-      g_atomic_int_inc (
-        &self->graph->trigger_queue_size);
       /*g_message ("triggering node, pushing back");*/
-      mpmc_queue_push_back_node (
-        self->graph->trigger_queue, self);
+      graph_thread_schedule_node (self->graph, self);
     }
 }
 
@@ -475,7 +733,6 @@ static void
 add_depends (GraphNode * self, GraphNode * src)
 {
   ++self->init_refcount;
-  self->refcount = self->init_refcount;
 
   /* add parent nodes */
   self->parentnodes = (GraphNode **) g_realloc (
@@ -567,6 +824,20 @@ graph_node_connect (GraphNode * from, GraphNode * to)
   g_warn_if_fail (!from->terminal && !to->initial);
 }
 
+/**
+ * Process routine of the MIDI editor manual press
+ * port.
+ */
+static void
+process_midi_editor_manual_press (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  g_return_if_fail (port->midi_events);
+  midi_events_dequeue (port->midi_events);
+}
+
 GraphNode *
 graph_node_new (
   Graph *       graph,
@@ -574,8 +845,8 @@ graph_node_new (
   void *        data)
 {
   GraphNode * node = object_new (GraphNode);
-  node->id = (int) g_hash_table_size (
-    graph->setup_graph_nodes);
+  node->id =
+    (int) g_hash_table_size (graph->setup->nodes);
   node->graph = graph;
   node->type = type;
   switch (type)
@@ -585,6 +856,20 @@ graph_node_new (
       break;
     case ROUTE_NODE_TYPE_PORT:
       node->port = (Port *) data;
+      if (
+        node->port
+        == AUDIO_ENGINE->midi_editor_manual_press)
+        {
+          node->process_port =
+            process_midi_editor_manual_press;
+        }
+      else
+        {
+          node->engine_port = engine_is_port_own (
+            AUDIO_ENGINE, node->port);
+          node->process_port = port_get_process_func (
+            node->port, &node->port_process_flags);
+        }
       break;
     case ROUTE_NODE_TYPE_FADER:
       node->fader = (Fader *) data;
@@ -625,6 +910,27 @@ graph_node_new (
   return node;
 }
 
+/**
+ * Chooses again how the port of the node is
+ * processed.
+ */
+void
+graph_node_update_port_process_func (
+  GraphNode * self)
+{
+  g_return_if_fail (
+    self->type == ROUTE_NODE_TYPE_PORT);
+
+  /* not a regular port */
+  if (
+    self->port
+    == AUDIO_ENGINE->midi_editor_manual_press)
+    return;
+
+  self->process_port = port_get_process_func (
+    self->port, &self->port_process_flags);
+}
+
 void
 graph_node_free (GraphNode * self)
 {
@@ -51,6 +51,9 @@
  * ---
  */
 
+/* for pthread_attr_setaffinity_np */
+#define _GNU_SOURCE
+
 #include "zrythm-config.h"
 
 #ifndef _WOE32
@@ -72,6 +75,7 @@
 #include "utils/mpmc_queue.h"
 #include "utils/objects.h"
 #include "utils/ui.h"
+#include "utils/ws_deque.h"
 #include "zrythm_app.h"
 
 #ifdef HAVE_JACK
@@ -83,6 +87,120 @@
 /* uncomment to show debug messages */
 /*#define DEBUG_THREADS 1*/
 
+/** The graph thread running on the current
+ * thread, if any. */
+static _Thread_local GraphThread * current_thread =
+  NULL;
+
+/**
+ * Returns the thread at the given index, where
+ * the main thread comes after the worker
+ * threads.
+ */
+static inline GraphThread *
+get_thread_at (Graph * graph, int idx)
+{
+  if (idx == graph->num_threads)
+    return graph->main_thread;
+  return graph->threads[idx];
+}
+
+/**
+ * Tries to steal a node from the other threads'
+ * deques, starting from the next thread.
+ */
+HOT static bool
+steal_node (GraphThread * thread, GraphNode ** node)
+{
+  Graph * graph = thread->graph;
+  int     n_threads = graph->num_threads + 1;
+  int     self_idx =
+    thread->id < 0 ? graph->num_threads : thread->id;
+  for (int i = 1; i < n_threads; i++)
+    {
+      GraphThread * victim =
+        get_thread_at (graph, (self_idx + i) % n_threads);
+      if (
+        victim
+        && ws_deque_steal (
+          g_atomic_pointer_get (&victim->deque),
+          (void **) node))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/**
+ * Finds a node to process.
+ */
+HOT static bool
+get_node (GraphThread * thread, GraphNode ** node)
+{
+  Graph * graph = thread->graph;
+  if (
+    graph->scheduler_type
+    == GRAPH_SCHEDULER_TYPE_WORK_STEALING)
+    {
+      if (ws_deque_pop (
+            thread->deque, (void **) node))
+        return true;
+      if (mpmc_queue_dequeue_node (
+            graph->compiled->trigger_queue, node))
+        return true;
+      return steal_node (thread, node);
+    }
+
+  return mpmc_queue_dequeue_node (
+    graph->compiled->trigger_queue, node);
+}
+
+void
+graph_thread_schedule_node (
+  Graph *     graph,
+  GraphNode * node)
+{
+  g_atomic_int_inc (&graph->trigger_queue_size);
+
+  if (
+    graph->scheduler_type
+      == GRAPH_SCHEDULER_TYPE_WORK_STEALING
+    && current_thread
+    && current_thread->graph == graph
+    && ws_deque_push (current_thread->deque, node))
+    {
+      return;
+    }
+
+  mpmc_queue_push_back_node (
+    graph->compiled->trigger_queue, node);
+}
+
+void
+graph_thread_wait (Graph * graph, ZixSem * sem)
+{
+  if (graph->idle_spin_usec > 0)
+    {
+      gint64 end =
+        g_get_monotonic_time () + graph->idle_spin_usec;
+      do
+        {
+          if (zix_sem_try_wait (sem))
+            return;
+
+          for (int i = 0; i < 32; i++)
+            {
+              graph_thread_cpu_relax ();
+            }
+        }
+      while (g_get_monotonic_time () < end);
+    }
+
+  zix_sem_wait (sem);
+}
+
 OPTIMIZE (O3)
 static void *
 worker_thread (void * arg)
@@ -95,6 +213,12 @@ worker_thread (void * arg)
    * allocation is done later on */
   g_thread_self ();
 
+  current_thread = thread;
+
+  /* follows the engine's denormal mode for the
+   * lifetime of the thread */
+  engine_init_process_thread (AUDIO_ENGINE);
+
   g_message (
     "WORKER THREAD %d created (num threads %d)",
     thread->id, graph->num_threads);
@@ -131,8 +255,7 @@ worker_thread (void * arg)
           goto terminate_thread;
         }
 
-      if (mpmc_queue_dequeue_node (
-            graph->trigger_queue, &to_run))
+      if (get_node (thread, &to_run))
         {
           g_warn_if_fail (to_run);
 #ifdef DEBUG_THREADS
@@ -194,7 +317,7 @@ worker_thread (void * arg)
                 graph->num_threads);
             }
 
-          zix_sem_wait (&graph->trigger);
+          graph_thread_wait (graph, &graph->trigger);
 
           if (g_atomic_int_get (&graph->terminate))
             {
@@ -214,8 +337,7 @@ worker_thread (void * arg)
 #endif
 
           /* try to find some work to do */
-          mpmc_queue_dequeue_node (
-            graph->trigger_queue, &to_run);
+          get_node (thread, &to_run);
         }
 
       /* process graph-node */
@@ -259,26 +381,28 @@ main_thread (void * arg)
   zix_sem_wait (&self->callback_start);
 
   /* first time setup */
+  CompiledGraph * compiled = self->compiled;
 
   if (!self->destroying)
     {
       /* Can't run without a graph */
       g_warn_if_fail (
-        g_hash_table_size (self->graph_nodes) > 0);
-      g_warn_if_fail (self->n_init_triggers > 0);
-      g_warn_if_fail (self->n_terminal_nodes > 0);
+        g_hash_table_size (compiled->nodes) > 0);
+      g_warn_if_fail (compiled->n_init_triggers > 0);
+      g_warn_if_fail (compiled->n_terminal_nodes > 0);
     }
 
   /* bootstrap trigger-list.
    * (later this is done by
    * Graph_reached_terminal_node)*/
-  for (size_t i = 0; i < self->n_init_triggers; ++i)
+  for (size_t i = 0; i < compiled->n_init_triggers;
+       ++i)
     {
       g_atomic_int_inc (&self->trigger_queue_size);
       /*g_message ("[main] pushing back node %d during bootstrap", i);*/
       mpmc_queue_push_back_node (
-        self->trigger_queue,
-        self->init_trigger_list[i]);
+        compiled->trigger_queue,
+        compiled->init_trigger_list[i]);
     }
 
   /* after setup, the main-thread just becomes
@@ -409,6 +533,15 @@ graph_thread_new (
 
   self->id = id;
   self->graph = graph;
+  self->cpu = -1;
+  self->deque = ws_deque_new ();
+  if (graph->compiled)
+    {
+      ws_deque_reserve (
+        self->deque,
+        (size_t) g_hash_table_size (
+          graph->compiled->nodes));
+    }
 
   pthread_attr_t attributes;
   pthread_attr_init (&attributes);
@@ -538,6 +671,35 @@ graph_thread_new (
 #  define THREAD_STACK_SIZE 0x20000 // 128kB
 #endif
 
+#ifdef __linux__
+  if (graph->num_cpus > 0)
+    {
+      /* the main thread is created last */
+      int idx = is_main ? graph->num_threads : id;
+      self->cpu = graph->cpus[idx % graph->num_cpus];
+
+      cpu_set_t cpuset;
+      CPU_ZERO (&cpuset);
+      CPU_SET (self->cpu, &cpuset);
+      res = pthread_attr_setaffinity_np (
+        &attributes, sizeof (cpuset), &cpuset);
+      if (res)
+        {
+          g_warning (
+            "Cannot set CPU affinity for thread "
+            "res = %d (%s)",
+            res, strerror (res));
+          self->cpu = -1;
+        }
+      else
+        {
+          g_message (
+            "pinning DSP thread %d to CPU %d", id,
+            self->cpu);
+        }
+    }
+#endif
+
   res = pthread_attr_setstacksize (
     &attributes,
     THREAD_STACK_SIZE + get_stack_size ());
@@ -564,3 +726,12 @@ graph_thread_new (
 
   return self;
 }
+
+void
+graph_thread_free (GraphThread * self)
+{
+  object_free_w_func_and_null (
+    ws_deque_free, self->deque);
+
+  object_zero_and_free (self);
+}
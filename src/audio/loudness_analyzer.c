@@ -0,0 +1,487 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <math.h>
+#include <string.h>
+
+#include "audio/loudness_analyzer.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/** Relative gates of the integrated loudness and
+ * the loudness range, in LU. */
+#define INTEGRATED_GATE -10.0
+#define RANGE_GATE -20.0
+
+static inline gint
+float_to_bits (float val)
+{
+  union
+  {
+    float f;
+    gint  i;
+  } u;
+  u.f = val;
+  return u.i;
+}
+
+static inline float
+bits_to_float (gint val)
+{
+  union
+  {
+    float f;
+    gint  i;
+  } u;
+  u.i = val;
+  return u.f;
+}
+
+static inline double
+energy_to_loudness (double energy)
+{
+  return -0.691 + 10.0 * log10 (energy);
+}
+
+/**
+ * Returns the loudness at the center of the given
+ * histogram bin.
+ */
+static inline double
+bin_to_loudness (int bin)
+{
+  return LOUDNESS_ANALYZER_HISTOGRAM_MIN
+         + (bin + 0.5) / LOUDNESS_ANALYZER_BINS_PER_LU;
+}
+
+static inline double
+bin_to_energy (int bin)
+{
+  return pow (
+    10.0, (bin_to_loudness (bin) + 0.691) / 10.0);
+}
+
+/**
+ * Counts a block with the given energy in the
+ * histogram, unless it is below the absolute
+ * gate.
+ */
+static inline void
+add_to_histogram (volatile gint * hist, double energy)
+{
+  double loudness = energy_to_loudness (energy);
+  if (!(loudness >= LOUDNESS_ANALYZER_HISTOGRAM_MIN))
+    return;
+
+  int bin = MIN (
+    (int) ((loudness - LOUDNESS_ANALYZER_HISTOGRAM_MIN)
+           * LOUDNESS_ANALYZER_BINS_PER_LU),
+    LOUDNESS_ANALYZER_HISTOGRAM_BINS - 1);
+  g_atomic_int_inc (&hist[bin]);
+}
+
+/**
+ * Copies the histogram and returns the total
+ * count.
+ */
+static guint64
+snapshot_histogram (
+  volatile gint * hist,
+  guint *         counts)
+{
+  guint64 total = 0;
+  for (int i = 0; i < LOUDNESS_ANALYZER_HISTOGRAM_BINS;
+       i++)
+    {
+      counts[i] = (guint) g_atomic_int_get (&hist[i]);
+      total += counts[i];
+    }
+  return total;
+}
+
+/**
+ * Returns the first bin above the gate relative
+ * to the mean energy of the counted blocks, or -1
+ * if there are none.
+ */
+static int
+get_relative_gate_bin (
+  const guint * counts,
+  guint64       total,
+  double        gate)
+{
+  if (total == 0)
+    return -1;
+
+  double sum = 0.0;
+  for (int i = 0; i < LOUDNESS_ANALYZER_HISTOGRAM_BINS;
+       i++)
+    {
+      if (counts[i])
+        sum += counts[i] * bin_to_energy (i);
+    }
+  double threshold =
+    energy_to_loudness (sum / (double) total) + gate;
+
+  for (int i = 0; i < LOUDNESS_ANALYZER_HISTOGRAM_BINS;
+       i++)
+    {
+      if (bin_to_loudness (i) >= threshold)
+        return i;
+    }
+  return -1;
+}
+
+/**
+ * Calculates the K-weighting coefficients for the
+ * sample rate (see libebur128).
+ */
+static void
+calc_coeffs (LoudnessAnalyzer * self)
+{
+  double rate = (double) self->sample_rate;
+
+  /* high shelf modeling the head */
+  double f0 = 1681.974450955533;
+  double gain = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = tan (G_PI * f0 / rate);
+  double vh = pow (10.0, gain / 20.0);
+  double vb = pow (vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  self->coeffs[0][0] = (vh + vb * k / q + k * k) / a0;
+  self->coeffs[0][1] = 2.0 * (k * k - vh) / a0;
+  self->coeffs[0][2] = (vh - vb * k / q + k * k) / a0;
+  self->coeffs[0][3] = 2.0 * (k * k - 1.0) / a0;
+  self->coeffs[0][4] = (1.0 - k / q + k * k) / a0;
+
+  /* RLB high-pass */
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = tan (G_PI * f0 / rate);
+  a0 = 1.0 + k / q + k * k;
+  self->coeffs[1][0] = 1.0;
+  self->coeffs[1][1] = -2.0;
+  self->coeffs[1][2] = 1.0;
+  self->coeffs[1][3] = 2.0 * (k * k - 1.0) / a0;
+  self->coeffs[1][4] = (1.0 - k / q + k * k) / a0;
+}
+
+/**
+ * Returns a new analyzer for the given sample
+ * rate.
+ */
+LoudnessAnalyzer *
+loudness_analyzer_new (sample_rate_t sample_rate)
+{
+  LoudnessAnalyzer * self =
+    object_new (LoudnessAnalyzer);
+  loudness_analyzer_reset (self, sample_rate);
+
+  return self;
+}
+
+/**
+ * Restarts the measurement, optionally at a new
+ * sample rate.
+ */
+void
+loudness_analyzer_reset (
+  LoudnessAnalyzer * self,
+  sample_rate_t      sample_rate)
+{
+  memset (self, 0, sizeof (LoudnessAnalyzer));
+  self->sample_rate = sample_rate;
+  self->subblock_len = MAX (sample_rate / 10, 1);
+  self->short_term_countdown = 1;
+  if (sample_rate > 0)
+    calc_coeffs (self);
+
+  g_atomic_int_set (
+    &self->momentary, float_to_bits (-INFINITY));
+  g_atomic_int_set (
+    &self->short_term, float_to_bits (-INFINITY));
+  g_atomic_int_set (
+    &self->max_momentary, float_to_bits (-INFINITY));
+}
+
+/**
+ * Restarts the measurement at the beginning of
+ * the next call to loudness_analyzer_process().
+ */
+void
+loudness_analyzer_request_reset (
+  LoudnessAnalyzer * self)
+{
+  g_atomic_int_set (&self->reset_requested, 1);
+}
+
+/**
+ * Returns the sum of the squares of the K-weighted
+ * samples.
+ */
+static inline double
+filter_and_sum (
+  LoudnessAnalyzer * self,
+  int                ch,
+  const float *      buf,
+  nframes_t          nframes)
+{
+  const double * pre = self->coeffs[0];
+  const double * rlb = self->coeffs[1];
+  double *       z_pre = self->z[ch][0];
+  double *       z_rlb = self->z[ch][1];
+  double         z_pre0 = z_pre[0];
+  double         z_pre1 = z_pre[1];
+  double         z_rlb0 = z_rlb[0];
+  double         z_rlb1 = z_rlb[1];
+  double         sum = 0.0;
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      double x = (double) buf[i];
+      double y = pre[0] * x + z_pre0;
+      z_pre0 = pre[1] * x - pre[3] * y + z_pre1;
+      z_pre1 = pre[2] * x - pre[4] * y;
+
+      x = y;
+      y = rlb[0] * x + z_rlb0;
+      z_rlb0 = rlb[1] * x - rlb[3] * y + z_rlb1;
+      z_rlb1 = rlb[2] * x - rlb[4] * y;
+
+      sum += y * y;
+    }
+  z_pre[0] = z_pre0;
+  z_pre[1] = z_pre1;
+  z_rlb[0] = z_rlb0;
+  z_rlb[1] = z_rlb1;
+
+  return sum;
+}
+
+/**
+ * Returns the mean energy of the last \p num
+ * sub-blocks.
+ */
+static inline double
+get_window_energy (
+  const LoudnessAnalyzer * self,
+  unsigned int             num)
+{
+  double sum = 0.0;
+  for (unsigned int i = 1; i <= num; i++)
+    {
+      sum += self->subblocks
+        [(self->subblock_idx
+          + LOUDNESS_ANALYZER_SUBBLOCKS - i)
+         % LOUDNESS_ANALYZER_SUBBLOCKS];
+    }
+  return sum / num;
+}
+
+static void
+end_subblock (LoudnessAnalyzer * self)
+{
+  self->subblocks[self->subblock_idx] =
+    self->subblock_sum / self->subblock_len;
+  self->subblock_idx =
+    (self->subblock_idx + 1)
+    % LOUDNESS_ANALYZER_SUBBLOCKS;
+  self->num_subblocks = MIN (
+    self->num_subblocks + 1,
+    LOUDNESS_ANALYZER_SUBBLOCKS);
+  self->subblock_sum = 0.0;
+  self->subblock_pos = 0;
+
+  /* gating blocks overlap by 75 % */
+  double momentary = get_window_energy (
+    self, LOUDNESS_ANALYZER_MOMENTARY_SUBBLOCKS);
+  float momentary_lufs =
+    (float) energy_to_loudness (momentary);
+  g_atomic_int_set (
+    &self->momentary, float_to_bits (momentary_lufs));
+  if (
+    self->num_subblocks
+    >= LOUDNESS_ANALYZER_MOMENTARY_SUBBLOCKS)
+    {
+      add_to_histogram (self->block_hist, momentary);
+      if (
+        momentary_lufs > bits_to_float (
+          g_atomic_int_get (&self->max_momentary)))
+        {
+          g_atomic_int_set (
+            &self->max_momentary,
+            float_to_bits (momentary_lufs));
+        }
+    }
+
+  double short_term = get_window_energy (
+    self, LOUDNESS_ANALYZER_SUBBLOCKS);
+  g_atomic_int_set (
+    &self->short_term,
+    float_to_bits (
+      (float) energy_to_loudness (short_term)));
+  if (
+    self->num_subblocks
+      == LOUDNESS_ANALYZER_SUBBLOCKS
+    && --self->short_term_countdown == 0)
+    {
+      add_to_histogram (
+        self->short_term_hist, short_term);
+      self->short_term_countdown =
+        LOUDNESS_ANALYZER_SHORT_TERM_HOP;
+    }
+}
+
+/**
+ * Analyzes the given stereo samples, which
+ * continue the ones of the previous call.
+ */
+void
+loudness_analyzer_process (
+  LoudnessAnalyzer * self,
+  const float *      l,
+  const float *      r,
+  nframes_t          nframes)
+{
+  if (G_UNLIKELY (g_atomic_int_compare_and_exchange (
+        &self->reset_requested, 1, 0)))
+    {
+      loudness_analyzer_reset (
+        self, self->sample_rate);
+    }
+
+  nframes_t pos = 0;
+  while (pos < nframes)
+    {
+      nframes_t len = MIN (
+        nframes - pos,
+        self->subblock_len - self->subblock_pos);
+      self->subblock_sum +=
+        filter_and_sum (self, 0, &l[pos], len)
+        + filter_and_sum (self, 1, &r[pos], len);
+      self->subblock_pos += len;
+      pos += len;
+
+      if (self->subblock_pos == self->subblock_len)
+        end_subblock (self);
+    }
+}
+
+float
+loudness_analyzer_get_momentary (
+  LoudnessAnalyzer * self)
+{
+  return bits_to_float (
+    g_atomic_int_get (&self->momentary));
+}
+
+float
+loudness_analyzer_get_max_momentary (
+  LoudnessAnalyzer * self)
+{
+  return bits_to_float (
+    g_atomic_int_get (&self->max_momentary));
+}
+
+float
+loudness_analyzer_get_short_term (
+  LoudnessAnalyzer * self)
+{
+  return bits_to_float (
+    g_atomic_int_get (&self->short_term));
+}
+
+/**
+ * Returns the integrated (gated) loudness in
+ * LUFS.
+ */
+float
+loudness_analyzer_get_integrated (
+  LoudnessAnalyzer * self)
+{
+  guint   counts[LOUDNESS_ANALYZER_HISTOGRAM_BINS];
+  guint64 total =
+    snapshot_histogram (self->block_hist, counts);
+  int gate_bin = get_relative_gate_bin (
+    counts, total, INTEGRATED_GATE);
+  if (gate_bin < 0)
+    return -INFINITY;
+
+  double  sum = 0.0;
+  guint64 num = 0;
+  for (int i = gate_bin;
+       i < LOUDNESS_ANALYZER_HISTOGRAM_BINS; i++)
+    {
+      if (counts[i])
+        {
+          sum += counts[i] * bin_to_energy (i);
+          num += counts[i];
+        }
+    }
+
+  return (float) energy_to_loudness (
+    sum / (double) num);
+}
+
+/**
+ * Returns the bin containing the value at the
+ * given percentile of the counts from \p
+ * start_bin.
+ */
+static int
+get_percentile_bin (
+  const guint * counts,
+  int           start_bin,
+  guint64       num,
+  double        percentile)
+{
+  guint64 rank =
+    (guint64) round (percentile * (double) (num - 1));
+  guint64 cumulative = 0;
+  for (int i = start_bin;
+       i < LOUDNESS_ANALYZER_HISTOGRAM_BINS; i++)
+    {
+      cumulative += counts[i];
+      if (cumulative > rank)
+        return i;
+    }
+  return LOUDNESS_ANALYZER_HISTOGRAM_BINS - 1;
+}
+
+/**
+ * Returns the loudness range (LRA) in LU.
+ */
+float
+loudness_analyzer_get_range (
+  LoudnessAnalyzer * self)
+{
+  guint   counts[LOUDNESS_ANALYZER_HISTOGRAM_BINS];
+  guint64 total = snapshot_histogram (
+    self->short_term_hist, counts);
+  int gate_bin =
+    get_relative_gate_bin (counts, total, RANGE_GATE);
+  if (gate_bin < 0)
+    return 0.f;
+
+  guint64 num = 0;
+  for (int i = gate_bin;
+       i < LOUDNESS_ANALYZER_HISTOGRAM_BINS; i++)
+    {
+      num += counts[i];
+    }
+
+  int low =
+    get_percentile_bin (counts, gate_bin, num, 0.10);
+  int high =
+    get_percentile_bin (counts, gate_bin, num, 0.95);
+
+  return (float) (
+    bin_to_loudness (high) - bin_to_loudness (low));
+}
+
+void
+loudness_analyzer_free (LoudnessAnalyzer * self)
+{
+  object_zero_and_free (self);
+}
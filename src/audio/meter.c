@@ -8,7 +8,6 @@
 #include "audio/peak_dsp.h"
 #include "audio/port.h"
 #include "audio/track.h"
-#include "audio/true_peak_dsp.h"
 #include "project.h"
 #include "utils/math.h"
 #include "utils/objects.h"
@@ -16,6 +15,189 @@
 
 #include "ext/zix/zix/ring.h"
 
+static inline gint
+float_to_bits (float val)
+{
+  union
+  {
+    float f;
+    gint  i;
+  } u;
+  u.f = val;
+  return u.i;
+}
+
+static inline float
+bits_to_float (gint val)
+{
+  union
+  {
+    float f;
+    gint  i;
+  } u;
+  u.i = val;
+  return u.f;
+}
+
+static MeterProcessor *
+meter_processor_new (void)
+{
+  MeterProcessor * self = object_new (MeterProcessor);
+
+  /* the port's reference */
+  self->refcount = 1;
+
+  self->peak_processor = peak_dsp_new ();
+  peak_dsp_init (
+    self->peak_processor,
+    AUDIO_ENGINE->sample_rate);
+  self->kmeter_processor = kmeter_dsp_new ();
+  kmeter_dsp_init (
+    self->kmeter_processor,
+    AUDIO_ENGINE->sample_rate);
+
+  return self;
+}
+
+/**
+ * Processes a cycle's worth of samples and
+ * publishes the results.
+ *
+ * To be called by the engine at the end of each
+ * cycle.
+ */
+void
+meter_processor_process (
+  MeterProcessor * self,
+  float *          buf,
+  nframes_t        nframes)
+{
+  /* restart the values held since the last read
+   * if the UI has read them */
+  bool read =
+    g_atomic_int_compare_and_exchange (
+      &self->read, 1, 0);
+
+  float amps[NUM_METER_ALGORITHMS] = { 0 };
+  float max_amps[NUM_METER_ALGORITHMS] = { 0 };
+
+  if (
+    g_atomic_int_get (
+      &self->num_users[METER_ALGORITHM_DIGITAL_PEAK])
+    > 0)
+    {
+      PeakDsp * dsp = self->peak_processor;
+      if (read)
+        peak_dsp_read_f (dsp);
+      peak_dsp_process (dsp, buf, (int) nframes);
+      amps[METER_ALGORITHM_DIGITAL_PEAK] = dsp->rms;
+      max_amps[METER_ALGORITHM_DIGITAL_PEAK] =
+        dsp->peak;
+    }
+
+  if (
+    g_atomic_int_get (
+      &self->num_users[METER_ALGORITHM_K])
+    > 0)
+    {
+      KMeterDsp * dsp = self->kmeter_processor;
+      if (read)
+        kmeter_dsp_read_f (dsp);
+      kmeter_dsp_process (dsp, buf, (int) nframes);
+      amps[METER_ALGORITHM_K] = dsp->rms;
+      max_amps[METER_ALGORITHM_K] = dsp->peak;
+    }
+
+  if (
+    g_atomic_int_get (
+      &self->num_users[METER_ALGORITHM_TRUE_PEAK])
+    > 0)
+    {
+      float true_peak = true_peak_detector_process (
+        &self->true_peak_detector, buf, nframes);
+      if (read || true_peak > self->true_peak)
+        self->true_peak = true_peak;
+      amps[METER_ALGORITHM_TRUE_PEAK] =
+        self->true_peak;
+      max_amps[METER_ALGORITHM_TRUE_PEAK] =
+        self->true_peak;
+    }
+
+  if (
+    g_atomic_int_get (
+      &self->num_users[METER_ALGORITHM_RMS])
+    > 0)
+    {
+      float rms =
+        math_calculate_rms_amp (buf, nframes);
+      if (read || rms > self->rms)
+        self->rms = rms;
+      amps[METER_ALGORITHM_RMS] = self->rms;
+      max_amps[METER_ALGORITHM_RMS] = self->rms;
+    }
+
+  /* publish (glib atomics are sequentially
+   * consistent, so readers see either all or none
+   * of the values between the sequence number
+   * changes) */
+  g_atomic_int_inc (&self->seq);
+  for (int i = 0; i < NUM_METER_ALGORITHMS; i++)
+    {
+      g_atomic_int_set (
+        &self->amps[i], float_to_bits (amps[i]));
+      g_atomic_int_set (
+        &self->max_amps[i],
+        float_to_bits (max_amps[i]));
+    }
+  g_atomic_int_inc (&self->seq);
+}
+
+/**
+ * Reads the latest snapshot.
+ *
+ * @return Whether a snapshot was available.
+ */
+static bool
+meter_processor_read (
+  MeterProcessor * self,
+  MeterAlgorithm   algo,
+  float *          amp,
+  float *          max_amp)
+{
+  gint seq;
+  do
+    {
+      seq = g_atomic_int_get (&self->seq);
+      *amp = bits_to_float (
+        g_atomic_int_get (&self->amps[algo]));
+      *max_amp = bits_to_float (
+        g_atomic_int_get (&self->max_amps[algo]));
+    }
+  while (
+    seq % 2 != 0
+    || seq != g_atomic_int_get (&self->seq));
+
+  if (seq == 0)
+    return false;
+
+  g_atomic_int_set (&self->read, 1);
+  return true;
+}
+
+void
+meter_processor_unref (MeterProcessor * self)
+{
+  if (!g_atomic_int_dec_and_test (&self->refcount))
+    return;
+
+  object_free_w_func_and_null (
+    peak_dsp_free, self->peak_processor);
+  object_free_w_func_and_null (
+    kmeter_dsp_free, self->kmeter_processor);
+
+  object_zero_and_free (self);
+}
+
 /**
  * Get the current meter value.
  *
@@ -39,79 +221,17 @@ meter_get_value (
     port->id.type == TYPE_AUDIO
     || port->id.type == TYPE_CV)
     {
-      g_return_if_fail (port->audio_ring);
-      int    num_cycles = 4;
-      size_t read_space_avail =
-        zix_ring_read_space (port->audio_ring);
-      size_t size =
-        sizeof (float)
-        * (size_t) AUDIO_ENGINE->block_length;
-      size_t blocks_to_read =
-        size == 0 ? 0 : read_space_avail / size;
-      /* if no blocks available, skip */
-      if (blocks_to_read == 0)
-        {
-          *val = 1e-20f;
-          *max = 1e-20f;
-          return;
-        }
+      g_return_if_fail (self->processor);
 
-      float  buf[read_space_avail];
-      size_t blocks_read = zix_ring_peek (
-        port->audio_ring, &buf[0],
-        read_space_avail);
-      blocks_read /= size;
-      num_cycles =
-        MIN (num_cycles, (int) blocks_read);
-      size_t start_index =
-        (blocks_read - (size_t) num_cycles)
-        * AUDIO_ENGINE->block_length;
-      g_return_if_fail (IS_PORT_AND_NONNULL (port));
-      if (blocks_read == 0)
+      /* if nothing was processed yet, skip */
+      if (!meter_processor_read (
+            self->processor, self->algorithm, &amp,
+            &max_amp))
         {
-          g_message (
-            "%s: blocks read for port %s is 0",
-            __func__, port->id.label);
           *val = 1e-20f;
           *max = 1e-20f;
           return;
         }
-
-      switch (self->algorithm)
-        {
-        case METER_ALGORITHM_RMS:
-          /* not used */
-          g_warn_if_reached ();
-          amp = math_calculate_rms_amp (
-            &buf[start_index],
-            (size_t) num_cycles
-              * AUDIO_ENGINE->block_length);
-          break;
-        case METER_ALGORITHM_TRUE_PEAK:
-          true_peak_dsp_process (
-            self->true_peak_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          amp = true_peak_dsp_read_f (
-            self->true_peak_processor);
-          break;
-        case METER_ALGORITHM_K:
-          kmeter_dsp_process (
-            self->kmeter_processor, &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          kmeter_dsp_read (
-            self->kmeter_processor, &amp, &max_amp);
-          break;
-        case METER_ALGORITHM_DIGITAL_PEAK:
-          peak_dsp_process (
-            self->peak_processor, &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          peak_dsp_read (
-            self->peak_processor, &amp, &max_amp);
-          break;
-        default:
-          break;
-        }
     }
   else if (port->id.type == TYPE_EVENT)
     {
@@ -192,6 +312,8 @@ meter_get_value (
   switch (format)
     {
     case AUDIO_VALUE_AMPLITUDE:
+      *val = amp;
+      *max = max_amp;
       break;
     case AUDIO_VALUE_DBFS:
       *val = math_amp_to_dbfs (amp);
@@ -232,21 +354,28 @@ meter_new_for_port (Port * port)
       if (is_master_fader)
         {
           self->algorithm = METER_ALGORITHM_K;
-          self->kmeter_processor =
-            kmeter_dsp_new ();
-          kmeter_dsp_init (
-            self->kmeter_processor,
-            AUDIO_ENGINE->sample_rate);
         }
       else
         {
           self->algorithm =
             METER_ALGORITHM_DIGITAL_PEAK;
-          self->peak_processor = peak_dsp_new ();
-          peak_dsp_init (
-            self->peak_processor,
-            AUDIO_ENGINE->sample_rate);
         }
+
+      /* meters are only created in the UI thread,
+       * so only the engine needs to read these
+       * atomically */
+      MeterProcessor * processor =
+        port->meter_processor;
+      if (!processor)
+        {
+          processor = meter_processor_new ();
+          g_atomic_pointer_set (
+            &port->meter_processor, processor);
+        }
+      g_atomic_int_inc (&processor->refcount);
+      g_atomic_int_inc (
+        &processor->num_users[self->algorithm]);
+      self->processor = processor;
     }
   else if (port->id.type == TYPE_EVENT)
     {
@@ -258,18 +387,14 @@ meter_new_for_port (Port * port)
 void
 meter_free (Meter * self)
 {
-#define FREE_DSP(x, name) \
-  if (self->x) \
-    { \
-      name##_free (self->x); \
+  /* the port may have been freed already, in
+   * which case this is the last reference */
+  if (self->processor)
+    {
+      (void) g_atomic_int_dec_and_test (
+        &self->processor->num_users[self->algorithm]);
+      meter_processor_unref (self->processor);
     }
 
-  FREE_DSP (true_peak_processor, true_peak_dsp);
-  FREE_DSP (true_peak_max_processor, true_peak_dsp);
-  FREE_DSP (kmeter_processor, kmeter_dsp);
-  FREE_DSP (peak_processor, peak_dsp);
-
-#undef FREE_DSP
-
   free (self);
 }
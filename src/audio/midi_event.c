@@ -31,6 +31,7 @@
 #include <math.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "audio/channel.h"
 #include "audio/chord_descriptor.h"
@@ -48,8 +49,8 @@
  */
 typedef enum MidiEventType
 {
-  MIDI_EVENT_TYPE_NOTE_ON,
   MIDI_EVENT_TYPE_NOTE_OFF,
+  MIDI_EVENT_TYPE_NOTE_ON,
   MIDI_EVENT_TYPE_ALL_NOTES_OFF,
   MIDI_EVENT_TYPE_CONTROLLER,
   MIDI_EVENT_TYPE_PITCHBEND,
@@ -752,11 +753,16 @@ get_event_type (const midi_byte_t short_msg[3])
     return MIDI_EVENT_TYPE_RAW;
 }
 
-HOT static int
-midi_event_cmpfunc (const void * _a, const void * _b)
+/**
+ * Compares by time, then by type and then by the
+ * bytes, so that equal events end up next to each
+ * other.
+ */
+HOT static inline int
+compare_events (
+  const MidiEvent * a,
+  const MidiEvent * b)
 {
-  const MidiEvent * a = (MidiEvent const *) _a;
-  const MidiEvent * b = (MidiEvent const *) _b;
   if (a->time == b->time)
     {
       MidiEventType a_type =
@@ -769,11 +775,23 @@ midi_event_cmpfunc (const void * _a, const void * _b)
         midi_event_type_strings[a_type],
         midi_event_type_strings[b_type]);
 #endif
-      return (int) a_type - (int) b_type;
+      if (a_type != b_type)
+        return (int) a_type - (int) b_type;
+
+      return memcmp (
+        a->raw_buffer, b->raw_buffer,
+        sizeof (a->raw_buffer));
     }
   return (int) a->time - (int) b->time;
 }
 
+HOT static int
+midi_event_cmpfunc (const void * _a, const void * _b)
+{
+  return compare_events (
+    (MidiEvent const *) _a, (MidiEvent const *) _b);
+}
+
 /**
  * Sorts the MidiEvents by time.
  */
@@ -799,6 +817,144 @@ midi_events_sort (
     midi_event_cmpfunc);
 }
 
+/**
+ * Scratch space for merging events.
+ *
+ * Tracks are processed in parallel so each thread
+ * needs its own.
+ */
+static _Thread_local MidiEvent
+  merge_buf[MAX_MIDI_EVENTS];
+
+/**
+ * Sorts the events from @p start onwards.
+ */
+void
+midi_events_sort_run (
+  MidiEvents * self,
+  const int    start,
+  const bool   queued)
+{
+  MidiEvent * events =
+    queued ? self->queued_events : self->events;
+  const int num_events =
+    queued ? self->num_queued_events
+           : self->num_events;
+
+  /* insertion sort, falling back to qsort if the
+   * events are too far from sorted */
+  const int max_moves = 8 * (num_events - start);
+  int       num_moves = 0;
+  for (int i = start + 1; i < num_events; i++)
+    {
+      if (
+        compare_events (&events[i - 1], &events[i])
+        <= 0)
+        continue;
+
+      MidiEvent ev = events[i];
+      int       j = i;
+      while (
+        j > start
+        && compare_events (&events[j - 1], &ev) > 0
+        && num_moves < max_moves)
+        {
+          events[j] = events[j - 1];
+          j--;
+          num_moves++;
+        }
+      events[j] = ev;
+
+      if (num_moves >= max_moves)
+        {
+          qsort (
+            &events[start],
+            (size_t) (num_events - start),
+            sizeof (MidiEvent), midi_event_cmpfunc);
+          return;
+        }
+    }
+}
+
+/**
+ * Merges the runs and drops duplicates.
+ */
+void
+midi_events_merge_runs (
+  MidiEvents * self,
+  const int *  run_starts,
+  const int    num_runs,
+  const bool   queued)
+{
+  g_return_if_fail (
+    num_runs > 0 && num_runs <= MIDI_EVENTS_MAX_RUNS
+    && run_starts[0] == 0);
+
+  MidiEvent * events =
+    queued ? self->queued_events : self->events;
+  const int num_events =
+    queued ? self->num_queued_events
+           : self->num_events;
+
+  /* next event and end of each run */
+  int heads[MIDI_EVENTS_MAX_RUNS];
+  int ends[MIDI_EVENTS_MAX_RUNS];
+  for (int i = 0; i < num_runs; i++)
+    {
+      heads[i] = run_starts[i];
+      ends[i] =
+        i < num_runs - 1
+          ? run_starts[i + 1]
+          : num_events;
+    }
+
+  /* there are only a few runs (usually one per
+   * region) so pick the smallest head by
+   * checking each run */
+  int num_merged = 0;
+  while (true)
+    {
+      int min_run = -1;
+      for (int i = 0; i < num_runs; i++)
+        {
+          if (heads[i] == ends[i])
+            continue;
+
+          if (
+            min_run < 0
+            || compare_events (
+                 &events[heads[i]],
+                 &events[heads[min_run]])
+                 < 0)
+            {
+              min_run = i;
+            }
+        }
+      if (min_run < 0)
+        break;
+
+      const MidiEvent * ev =
+        &events[heads[min_run]++];
+
+      /* duplicates are next to each other */
+      if (
+        num_merged > 0
+        && midi_events_are_equal (
+          &merge_buf[num_merged - 1], ev))
+        continue;
+
+      merge_buf[num_merged++] = *ev;
+    }
+
+  memcpy (
+    events, merge_buf,
+    (size_t) num_merged * sizeof (MidiEvent));
+  if (queued)
+    self->num_queued_events = num_merged;
+  else
+    self->num_events = num_merged;
+}
+
 /**
  * Adds a note on event to the given MidiEvents.
  *
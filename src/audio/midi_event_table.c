@@ -0,0 +1,422 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/midi_event_table.h"
+#include "audio/midi_note.h"
+#include "utils/arrays.h"
+#include "utils/objects.h"
+
+/**
+ * Entries to step through from the cursor before
+ * falling back to a binary search.
+ */
+#define CURSOR_MAX_STEPS 8
+
+static signed_frame_t
+get_note_frame (
+  const MidiNote * note,
+  const bool       note_off)
+{
+  const ArrangerObject * mn_obj =
+    (const ArrangerObject *) note;
+  return note_off
+           ? mn_obj->end_pos.frames
+           : mn_obj->pos.frames;
+}
+
+/**
+ * Returns whether an event at @p frame_a comes
+ * before an event at @p frame_b.
+ *
+ * Note offs come before note ons at the same
+ * frame.
+ */
+static inline bool
+is_before (
+  const signed_frame_t frame_a,
+  const bool           note_off_a,
+  const signed_frame_t frame_b,
+  const bool           note_off_b)
+{
+  return frame_a < frame_b
+         || (frame_a == frame_b && note_off_a
+             && !note_off_b);
+}
+
+/**
+ * Returns the index of the first entry in
+ * [@p lo, @p hi) at or after @p frame.
+ */
+static inline int
+lower_bound (
+  const MidiEventTableEntry * entries,
+  int                         lo,
+  int                         hi,
+  const signed_frame_t        frame)
+{
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (entries[mid].frame < frame)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/**
+ * Returns the index of the first entry that
+ * comes after an event at @p frame.
+ */
+static int
+find_insert_idx (
+  const MidiEventTable * self,
+  const signed_frame_t   frame,
+  const bool             note_off)
+{
+  int lo = 0;
+  int hi = self->num_entries;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      const MidiEventTableEntry * entry =
+        &self->entries[mid];
+      if (is_before (
+            frame, note_off, entry->frame,
+            entry->note_off))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+  return lo;
+}
+
+/**
+ * Returns the index of the given event.
+ *
+ * The entry is looked up at the frame it was
+ * added with, since the note's position may
+ * already differ.
+ */
+static int
+find_entry (
+  const MidiEventTable * self,
+  const MidiNote *       note,
+  const bool             note_off)
+{
+  const signed_frame_t frame =
+    note->event_table_frames[note_off];
+  for (int i = lower_bound (
+         self->entries, 0, self->num_entries,
+         frame);
+       i < self->num_entries
+       && self->entries[i].frame == frame;
+       i++)
+    {
+      const MidiEventTableEntry * entry =
+        &self->entries[i];
+      if (
+        entry->note == note
+        && entry->note_off == note_off)
+        return i;
+    }
+  return -1;
+}
+
+static void
+insert_entry (
+  MidiEventTable * self,
+  MidiNote *       note,
+  const bool       note_off)
+{
+  const signed_frame_t frame =
+    get_note_frame (note, note_off);
+  int idx = find_insert_idx (self, frame, note_off);
+
+  array_double_size_if_full (
+    self->entries, self->num_entries,
+    self->entries_size, MidiEventTableEntry);
+  memmove (
+    &self->entries[idx + 1], &self->entries[idx],
+    (size_t) (self->num_entries - idx)
+      * sizeof (MidiEventTableEntry));
+  self->entries[idx] = (MidiEventTableEntry){
+    .frame = frame,
+    .note = note,
+    .note_off = note_off,
+  };
+  self->num_entries++;
+  note->event_table_frames[note_off] = frame;
+}
+
+static void
+remove_entry (MidiEventTable * self, int idx)
+{
+  memmove (
+    &self->entries[idx], &self->entries[idx + 1],
+    (size_t) (self->num_entries - idx - 1)
+      * sizeof (MidiEventTableEntry));
+  self->num_entries--;
+}
+
+/**
+ * Updates the frame of the entry in place if the
+ * order is kept, otherwise moves it.
+ *
+ * @return Whether the entry changed.
+ */
+static bool
+update_entry (MidiEventTable * self, int idx)
+{
+  MidiEventTableEntry * entry = &self->entries[idx];
+  const signed_frame_t  frame =
+    get_note_frame (entry->note, entry->note_off);
+  if (entry->frame == frame)
+    return false;
+
+  if (
+    (idx == 0
+     || !is_before (
+       frame, entry->note_off,
+       self->entries[idx - 1].frame,
+       self->entries[idx - 1].note_off))
+    && (idx == self->num_entries - 1
+        || !is_before (
+          self->entries[idx + 1].frame,
+          self->entries[idx + 1].note_off, frame,
+          entry->note_off)))
+    {
+      entry->frame = frame;
+      entry->note->event_table_frames
+        [entry->note_off] = frame;
+      return true;
+    }
+
+  MidiNote * note = entry->note;
+  bool       note_off = entry->note_off;
+  remove_entry (self, idx);
+  insert_entry (self, note, note_off);
+  return true;
+}
+
+static void
+free_snapshot (void * data)
+{
+  MidiEventTableSnapshot * snapshot =
+    (MidiEventTableSnapshot *) data;
+  object_zero_and_free_if_nonnull (
+    snapshot->entries);
+  object_zero_and_free (snapshot);
+}
+
+/**
+ * Publishes a copy of the entries for the
+ * processing threads.
+ */
+static void
+publish (void * owner)
+{
+  MidiEventTable * self = (MidiEventTable *) owner;
+  MidiEventTableSnapshot * snapshot =
+    object_new (MidiEventTableSnapshot);
+  if (self->num_entries > 0)
+    {
+      snapshot->entries = object_new_n (
+        (size_t) self->num_entries,
+        MidiEventTableEntry);
+      memcpy (
+        snapshot->entries, self->entries,
+        (size_t) self->num_entries
+          * sizeof (MidiEventTableEntry));
+    }
+  snapshot->num_entries = self->num_entries;
+
+  snapshot_publisher_publish (
+    &self->publisher, snapshot, free_snapshot);
+}
+
+/**
+ * Publishes the entries now, or at the end of the
+ * current batch.
+ */
+static void
+entries_changed (MidiEventTable * self)
+{
+  snapshot_publisher_changed (
+    &self->publisher, publish, self);
+}
+
+void
+midi_event_table_add_note (
+  MidiEventTable * self,
+  MidiNote *       note)
+{
+  insert_entry (self, note, false);
+  insert_entry (self, note, true);
+  entries_changed (self);
+}
+
+bool
+midi_event_table_remove_note (
+  MidiEventTable * self,
+  MidiNote *       note)
+{
+  bool removed = false;
+  for (int i = 0; i < 2; i++)
+    {
+      int idx = find_entry (self, note, i == 1);
+      if (idx < 0)
+        continue;
+
+      remove_entry (self, idx);
+      removed = true;
+    }
+  if (removed)
+    entries_changed (self);
+  return removed;
+}
+
+void
+midi_event_table_update_note (
+  MidiEventTable * self,
+  MidiNote *       note)
+{
+  bool changed = false;
+  for (int i = 0; i < 2; i++)
+    {
+      int idx = find_entry (self, note, i == 1);
+      if (idx < 0)
+        break;
+
+      if (update_entry (self, idx))
+        changed = true;
+    }
+  if (changed)
+    entries_changed (self);
+}
+
+static int
+cmp_entries (const void * a, const void * b)
+{
+  const MidiEventTableEntry * entry_a =
+    (const MidiEventTableEntry *) a;
+  const MidiEventTableEntry * entry_b =
+    (const MidiEventTableEntry *) b;
+  if (is_before (
+        entry_a->frame, entry_a->note_off,
+        entry_b->frame, entry_b->note_off))
+    return -1;
+  if (is_before (
+        entry_b->frame, entry_b->note_off,
+        entry_a->frame, entry_a->note_off))
+    return 1;
+
+  /* keep the order of the notes */
+  return entry_a->note->pos - entry_b->note->pos;
+}
+
+void
+midi_event_table_rebuild (
+  MidiEventTable *   self,
+  MidiNote * const * notes,
+  int                num_notes)
+{
+  g_return_if_fail (self);
+
+  self->num_entries = 0;
+  for (int i = 0; i < num_notes; i++)
+    {
+      for (int j = 0; j < 2; j++)
+        {
+          const signed_frame_t frame =
+            get_note_frame (notes[i], j == 1);
+          array_double_size_if_full (
+            self->entries, self->num_entries,
+            self->entries_size,
+            MidiEventTableEntry);
+          self->entries[self->num_entries++] =
+            (MidiEventTableEntry){
+              .frame = frame,
+              .note = notes[i],
+              .note_off = j == 1,
+            };
+          notes[i]->event_table_frames[j] = frame;
+        }
+    }
+  if (self->num_entries > 1)
+    {
+      qsort (
+        self->entries, (size_t) self->num_entries,
+        sizeof (MidiEventTableEntry), cmp_entries);
+    }
+  entries_changed (self);
+  g_atomic_int_set (&self->cursor, 0);
+}
+
+const MidiEventTableSnapshot *
+midi_event_table_acquire (MidiEventTable * self)
+{
+  return snapshot_publisher_acquire (
+    &self->publisher);
+}
+
+void
+midi_event_table_release (MidiEventTable * self)
+{
+  snapshot_publisher_release (&self->publisher);
+}
+
+int
+midi_event_table_find_first (
+  MidiEventTable *               self,
+  const MidiEventTableSnapshot * snapshot,
+  const signed_frame_t           frame)
+{
+  const MidiEventTableEntry * entries =
+    snapshot->entries;
+  const int num_entries = snapshot->num_entries;
+
+  int lo = 0;
+  int hi = num_entries;
+
+  /* continue from the last lookup if going
+   * forward, which is the case during playback */
+  int cursor = g_atomic_int_get (&self->cursor);
+  if (
+    cursor > 0 && cursor <= num_entries
+    && entries[cursor - 1].frame < frame)
+    {
+      lo = cursor;
+      int steps_end =
+        MIN (lo + CURSOR_MAX_STEPS, num_entries);
+      while (
+        lo < steps_end
+        && entries[lo].frame < frame)
+        {
+          lo++;
+        }
+      if (lo < steps_end)
+        hi = lo;
+    }
+
+  lo = lower_bound (entries, lo, hi, frame);
+  g_atomic_int_set (&self->cursor, lo);
+
+  return lo;
+}
+
+void
+midi_event_table_clear (MidiEventTable * self)
+{
+  snapshot_publisher_clear (
+    &self->publisher, free_snapshot);
+
+  object_zero_and_free_if_nonnull (self->entries);
+  self->num_entries = 0;
+  self->entries_size = 0;
+  g_atomic_int_set (&self->cursor, 0);
+}
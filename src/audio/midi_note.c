@@ -8,6 +8,7 @@
 #include "audio/midi_event.h"
 #include "audio/midi_note.h"
 #include "audio/position.h"
+#include "audio/region.h"
 #include "audio/track.h"
 #include "audio/velocity.h"
 #include "gui/backend/midi_arranger_selections.h"
@@ -72,6 +73,22 @@ midi_note_set_region_and_index (
   self->pos = idx;
 }
 
+void
+midi_note_update_event_table (MidiNote * self)
+{
+  ArrangerObject * obj = (ArrangerObject *) self;
+  ZRegion *        region = region_find_in_lane (
+    &obj->region_id, obj->is_auditioner);
+  if (
+    !region || self->pos < 0
+    || self->pos >= region->num_midi_notes
+    || region->midi_notes[self->pos] != self)
+    return;
+
+  midi_event_table_update_note (
+    &region->midi_event_table, self);
+}
+
 /**
  * For debugging.
  */
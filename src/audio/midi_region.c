@@ -177,6 +177,9 @@ midi_region_insert_midi_note (
       midi_note_set_region_and_index (mn, self, i);
     }
 
+  midi_event_table_add_note (
+    &self->midi_event_table, midi_note);
+
   if (pub_events)
     {
       EVENTS_PUSH (
@@ -338,6 +341,8 @@ midi_region_remove_midi_note (
   array_delete (
     region->midi_notes, region->num_midi_notes,
     midi_note);
+  midi_event_table_remove_note (
+    &region->midi_event_table, midi_note);
 
   for (int i = 0; i < region->num_midi_notes; i++)
     {
@@ -1157,6 +1162,87 @@ send_notes_off_at (
     midi_events, channel, time, F_QUEUED);
 }
 
+/**
+ * Fills the note ons and note offs in the range
+ * from the event table of the region.
+ *
+ * Note ons are added if they are inside the range
+ * and note offs if they are inside the range or
+ * at its end.
+ */
+static void
+fill_note_events (
+  ZRegion *                           self,
+  const EngineProcessTimeInfo * const time_nfo,
+  const signed_frame_t                r_local_pos,
+  MidiEvents *                        midi_events)
+{
+  MidiEventTable * table = &self->midi_event_table;
+  const signed_frame_t r_local_end =
+    r_local_pos + (signed_frame_t) time_nfo->nframes;
+
+  const MidiEventTableSnapshot * snapshot =
+    midi_event_table_acquire (table);
+  if (!snapshot)
+    {
+      midi_event_table_release (table);
+      return;
+    }
+
+  /* looked up on the first event */
+  midi_byte_t channel = 0;
+
+  for (int i = midi_event_table_find_first (
+         table, snapshot, r_local_pos);
+       i < snapshot->num_entries; i++)
+    {
+      const MidiEventTableEntry * entry =
+        &snapshot->entries[i];
+      if (entry->frame > r_local_end)
+        break;
+
+      MidiNote * mn = entry->note;
+      if (arranger_object_get_muted (
+            (ArrangerObject *) mn, false))
+        {
+          continue;
+        }
+
+      if (channel == 0)
+        {
+          channel = midi_region_get_midi_ch (self);
+        }
+
+      midi_time_t _time =
+        (midi_time_t) (time_nfo->local_offset
+                       + (entry->frame - r_local_pos));
+      if (entry->note_off)
+        {
+          /* note actually ends 1 frame before
+           * the end point, not at the end
+           * point */
+          if (_time > 0)
+            {
+              _time--;
+            }
+
+          midi_events_add_note_off (
+            midi_events, channel, mn->val, _time,
+            F_QUEUED);
+        }
+      else if (
+        entry->frame >= 0
+        && entry->frame < r_local_end)
+        {
+          midi_events_add_note_on (
+            midi_events, channel, mn->val,
+            mn->vel->vel, _time, F_QUEUED);
+        }
+    }
+
+  midi_event_table_release (table);
+}
+
 /**
  * Fills MIDI event queue from the region.
  *
@@ -1216,30 +1302,21 @@ midi_region_fill_midi_events (
     }
 #endif
 
-  /* go through each note */
-  int num_objs =
-    track->type == TRACK_TYPE_CHORD
-      ? self->num_chord_objects
-      : self->num_midi_notes;
-  for (int i = 0; i < num_objs; i++)
+  if (track->type != TRACK_TYPE_CHORD)
     {
-      ArrangerObject *  mn_obj = NULL;
-      MidiNote *        mn = NULL;
-      ChordObject *     co = NULL;
-      ChordDescriptor * descr = NULL;
-      if (track->type == TRACK_TYPE_CHORD)
-        {
-          co = self->chord_objects[i];
-          descr =
-            chord_object_get_chord_descriptor (co);
-          mn_obj = (ArrangerObject *) co;
-        }
-      else
-        {
-          mn = self->midi_notes[i];
-          mn_obj = (ArrangerObject *) mn;
-        }
-      if (arranger_object_get_muted (mn_obj, false))
+      fill_note_events (
+        self, time_nfo, r_local_pos, midi_events);
+      return;
+    }
+
+  /* go through each chord */
+  for (int i = 0; i < self->num_chord_objects; i++)
+    {
+      ChordObject *     co = self->chord_objects[i];
+      ChordDescriptor * descr =
+        chord_object_get_chord_descriptor (co);
+      ArrangerObject * co_obj = (ArrangerObject *) co;
+      if (arranger_object_get_muted (co_obj, false))
         {
           continue;
         }
@@ -1247,49 +1324,36 @@ midi_region_fill_midi_events (
       /* if object starts inside the current
        * range */
       if (
-        mn_obj->pos.frames >= 0
-        && mn_obj->pos.frames >= r_local_pos
-        && mn_obj->pos.frames
+        co_obj->pos.frames >= 0
+        && co_obj->pos.frames >= r_local_pos
+        && co_obj->pos.frames
              < r_local_pos
                  + (signed_frame_t) time_nfo->nframes)
         {
           midi_time_t _time =
             (midi_time_t)
             (time_nfo->local_offset +
-              (mn_obj->pos.frames - r_local_pos));
+              (co_obj->pos.frames - r_local_pos));
           /*g_message ("normal note on at %u", time);*/
 
-          if (mn)
-            {
-              midi_events_add_note_on (
-                midi_events,
-                midi_region_get_midi_ch (self),
-                mn->val, mn->vel->vel, _time,
-                F_QUEUED);
-            }
-          else if (co)
-            {
-              midi_events_add_note_ons_from_chord_descr (
-                midi_events, descr, 1,
-                VELOCITY_DEFAULT, _time, F_QUEUED);
-            }
+          midi_events_add_note_ons_from_chord_descr (
+            midi_events, descr, 1, VELOCITY_DEFAULT,
+            _time, F_QUEUED);
         }
 
-      signed_frame_t mn_obj_end_frames =
-        (track->type == TRACK_TYPE_CHORD
-           ? math_round_double_to_signed_frame_t (
-             mn_obj->pos.frames
-             + TRANSPORT->ticks_per_beat
-                 * AUDIO_ENGINE->frames_per_tick)
-           : mn_obj->end_pos.frames);
-
-      /* if note ends within the cycle */
-      if (mn_obj_end_frames >= r_local_pos &&
-          (mn_obj_end_frames <=
+      signed_frame_t co_obj_end_frames =
+        math_round_double_to_signed_frame_t (
+          co_obj->pos.frames
+          + TRANSPORT->ticks_per_beat
+              * AUDIO_ENGINE->frames_per_tick);
+
+      /* if chord ends within the cycle */
+      if (co_obj_end_frames >= r_local_pos &&
+          (co_obj_end_frames <=
             (r_local_pos + time_nfo->nframes)))
         {
           midi_time_t _time =
-            (midi_time_t) (time_nfo->local_offset + (mn_obj_end_frames - r_local_pos));
+            (midi_time_t) (time_nfo->local_offset + (co_obj_end_frames - r_local_pos));
 
           /* note actually ends 1 frame before
            * the end point, not at the end
@@ -1299,39 +1363,18 @@ midi_region_fill_midi_events (
               _time--;
             }
 
-#if 0
-          if (time_nfo->g_start_frame == 0)
+          for (int l = 0;
+               l < CHORD_DESCRIPTOR_MAX_NOTES; l++)
             {
-              g_debug (
-                "note ends within cycle (end "
-                "frames %ld - note off time: %u",
-                mn_obj_end_frames, _time);
-            }
-#endif
-
-          if (mn)
-            {
-              midi_events_add_note_off (
-                midi_events,
-                midi_region_get_midi_ch (self),
-                mn->val, _time, F_QUEUED);
-            }
-          else if (co)
-            {
-              for (int l = 0;
-                   l < CHORD_DESCRIPTOR_MAX_NOTES;
-                   l++)
+              if (descr->notes[l])
                 {
-                  if (descr->notes[l])
-                    {
-                      midi_events_add_note_off (
-                        midi_events, 1, l + 36,
-                        _time, F_QUEUED);
-                    }
+                  midi_events_add_note_off (
+                    midi_events, 1, l + 36, _time,
+                    F_QUEUED);
                 }
             }
         }
-    } /* foreach midi note */
+    } /* foreach chord object */
 }
 
 /**
@@ -1400,4 +1443,5 @@ midi_region_free_members (ZRegion * self)
       arranger_object_free (
         (ArrangerObject *) self->midi_notes[i]);
     }
+  midi_event_table_clear (&self->midi_event_table);
 }
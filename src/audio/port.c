@@ -15,6 +15,7 @@
 #include "audio/graph.h"
 #include "audio/hardware_processor.h"
 #include "audio/master_track.h"
+#include "audio/meter.h"
 #include "audio/midi_event.h"
 #include "audio/pan.h"
 #include "audio/port.h"
@@ -73,26 +74,78 @@ port_allocate_bufs (Port * self)
     case TYPE_EVENT:
       object_free_w_func_and_null (
         midi_events_free, self->midi_events);
-      self->midi_events = midi_events_new ();
       object_free_w_func_and_null (
         zix_ring_free, self->midi_ring);
-      self->midi_ring = zix_ring_new (
+      break;
+    case TYPE_AUDIO:
+    case TYPE_CV:
+      object_free_w_func_and_null (
+        zix_ring_free, self->audio_ring);
+      if (self->buf_in_arena)
+        {
+          self->buf = NULL;
+          self->buf_in_arena = false;
+        }
+      object_zero_and_free (self->buf);
+      break;
+    default:
+      return;
+    }
+
+  float *      buf;
+  size_t       buf_sz;
+  ZixRing *    audio_ring;
+  MidiEvents * midi_events;
+  ZixRing *    midi_ring;
+  port_new_bufs (
+    self, &buf, &buf_sz, &audio_ring, &midi_events,
+    &midi_ring);
+  if (self->id.type == TYPE_EVENT)
+    {
+      self->midi_events = midi_events;
+      self->midi_ring = midi_ring;
+    }
+  else
+    {
+      self->audio_ring = audio_ring;
+      self->buf = buf;
+      self->last_buf_sz = buf_sz;
+    }
+}
+
+void
+port_new_bufs (
+  const Port *  self,
+  float **      buf,
+  size_t *      buf_sz,
+  ZixRing **    audio_ring,
+  MidiEvents ** midi_events,
+  ZixRing **    midi_ring)
+{
+  *buf = NULL;
+  *buf_sz = 0;
+  *audio_ring = NULL;
+  *midi_events = NULL;
+  *midi_ring = NULL;
+
+  switch (self->id.type)
+    {
+    case TYPE_EVENT:
+      *midi_events = midi_events_new ();
+      *midi_ring = zix_ring_new (
         sizeof (MidiEvent) * (size_t) 11);
       break;
     case TYPE_AUDIO:
     case TYPE_CV:
       {
-        object_free_w_func_and_null (
-          zix_ring_free, self->audio_ring);
-        self->audio_ring = zix_ring_new (
+        *audio_ring = zix_ring_new (
           sizeof (float) * AUDIO_RING_SIZE);
-        object_zero_and_free (self->buf);
         size_t max = MAX (
           AUDIO_ENGINE->block_length,
           self->min_buf_size);
         max = MAX (max, 1);
-        self->buf = object_new_n (max, float);
-        self->last_buf_sz = max;
+        *buf = object_new_n (max, float);
+        *buf_sz = max;
       }
     default:
       break;
@@ -114,6 +167,11 @@ port_free_bufs (Port * self)
     zix_ring_free, self->midi_ring);
   object_free_w_func_and_null (
     zix_ring_free, self->audio_ring);
+  if (self->buf_in_arena)
+    {
+      self->buf = NULL;
+      self->buf_in_arena = false;
+    }
   object_zero_and_free (self->buf);
 }
 
@@ -919,8 +977,10 @@ send_audio_data_to_jack (
 /**
  * Sums the inputs coming in from JACK, before the
  * port is processed.
+ *
+ * @return Whether any data was summed.
  */
-static void
+static bool
 sum_data_from_jack (
   Port *          self,
   const nframes_t start_frame,
@@ -931,7 +991,7 @@ sum_data_from_jack (
       == PORT_OWNER_TYPE_AUDIO_ENGINE
     || self->internal_type != INTERNAL_JACK_PORT
     || self->id.flow != FLOW_INPUT)
-    return;
+    return false;
 
   /* append events from JACK if any */
   if (AUDIO_ENGINE->midi_backend == MIDI_BACKEND_JACK)
@@ -946,6 +1006,8 @@ sum_data_from_jack (
       port_receive_audio_data_from_jack (
         self, start_frame, nframes);
     }
+
+  return true;
 }
 
 /**
@@ -1060,8 +1122,10 @@ expose_to_jack (Port * self, bool expose)
 /**
  * Sums the inputs coming in from dummy, before the
  * port is processed.
+ *
+ * @return Whether any data was summed.
  */
-static void
+static bool
 sum_data_from_dummy (
   Port *          self,
   const nframes_t start_frame,
@@ -1075,7 +1139,7 @@ sum_data_from_dummy (
     || AUDIO_ENGINE->audio_backend != AUDIO_BACKEND_DUMMY
     || AUDIO_ENGINE->midi_backend
          != MIDI_BACKEND_DUMMY)
-    return;
+    return false;
 
   if (AUDIO_ENGINE->dummy_input)
     {
@@ -1089,13 +1153,16 @@ sum_data_from_dummy (
           port = AUDIO_ENGINE->dummy_input->r;
         }
 
-      if (port)
+      if (port && !port->is_silent)
         {
           dsp_add2 (
             &self->buf[start_frame],
             &port->buf[start_frame], nframes);
+          return true;
         }
     }
+
+  return false;
 }
 
 /**
@@ -2065,11 +2132,6 @@ port_prepare_rtaudio_data (Port * self)
     {
       RtAudioDevice * dev = self->rtaudio_ins[i];
 
-      /* clear the data */
-      dsp_fill (
-        dev->buf, DENORMAL_PREVENTION_VAL,
-        AUDIO_ENGINE->nframes);
-
       zix_sem_wait (&dev->audio_ring_sem);
 
       uint32_t read_space =
@@ -2085,6 +2147,13 @@ port_prepare_rtaudio_data (Port * self)
             dev->audio_ring, &dev->buf[0],
             AUDIO_ENGINE->nframes * sizeof (float));
         }
+      /* otherwise clear the data */
+      else
+        {
+          dsp_fill (
+            dev->buf, DENORMAL_PREVENTION_VAL,
+            AUDIO_ENGINE->nframes);
+        }
 
       zix_sem_post (&dev->audio_ring_sem);
     }
@@ -2371,6 +2440,7 @@ port_set_control_value (
         self->control, self->base_value))
     {
       self->control = self->base_value;
+      g_atomic_int_inc (&self->control_generation);
 
       /* remember time */
       self->last_change = g_get_monotonic_time ();
@@ -2580,6 +2650,7 @@ port_copy_values (Port * self, const Port * other)
 {
   /* set value */
   self->control = other->control;
+  g_atomic_int_inc (&self->control_generation);
 }
 
 /**
@@ -2601,6 +2672,7 @@ port_restore_from_non_project (
 
   /* set value */
   prj_port->control = non_project->control;
+  g_atomic_int_inc (&prj_port->control_generation);
 
   g_return_if_fail (
     non_project->num_srcs
@@ -2653,470 +2725,576 @@ stereo_ports_new_generic (
 }
 
 /**
- * First sets port buf to 0, then sums the given
- * port signal from its inputs.
- *
- * @param noroll Clear the port buffer in this
- *   range.
+ * Adds the notes of the track processor's MIDI
+ * output to the piano roll "current notes" (to
+ * show pressed keys in the UI).
  */
-void
-port_process (
-  Port *                      port,
-  const EngineProcessTimeInfo time_nfo,
-  const bool                  noroll)
+static void
+add_piano_roll_current_notes (
+  Port *  port,
+  Track * track)
 {
-#define nframes (time_nfo.nframes)
-#define local_offset (time_nfo.local_offset)
+  if (
+    port->midi_events->num_events == 0
+    || !CLIP_EDITOR->has_region
+    || CLIP_EDITOR->region_id.track_name_hash
+         != track_get_name_hash (track))
+    return;
 
-  g_return_if_fail (IS_PORT (port));
+  MidiEvents * events = port->midi_events;
+  bool         events_processed = false;
+  for (int i = 0; i < events->num_events; i++)
+    {
+      midi_byte_t * buf =
+        events->events[i].raw_buffer;
+      if (midi_is_note_on (buf))
+        {
+          piano_roll_add_current_note (
+            PIANO_ROLL, midi_get_note_number (buf));
+          events_processed = true;
+        }
+      else if (midi_is_note_off (buf))
+        {
+          piano_roll_remove_current_note (
+            PIANO_ROLL, midi_get_note_number (buf));
+          events_processed = true;
+        }
+      else if (midi_is_all_notes_off (buf))
+        {
+          PIANO_ROLL->num_current_notes = 0;
+          events_processed = true;
+        }
+    }
+  if (events_processed)
+    {
+      EVENTS_PUSH (ET_PIANO_ROLL_KEY_ON_OFF, NULL);
+    }
+}
 
-  const PortIdentifier * id = &port->id;
+/**
+ * Handles the MIDI events received by a hardware
+ * port.
+ */
+static void
+process_hw_midi_events (Port * port)
+{
+  MidiEvents * events = port->midi_events;
+  if (events->num_events == 0)
+    return;
 
-  Track * track = NULL;
-  if (id->owner_type ==
-        PORT_OWNER_TYPE_TRACK_PROCESSOR
-      ||
-      id->owner_type == PORT_OWNER_TYPE_TRACK
-      ||
-      id->owner_type == PORT_OWNER_TYPE_CHANNEL
-      ||
-      /* if track/channel fader */
-      (id->owner_type == PORT_OWNER_TYPE_FADER
-       &&
-       (id->flags2 & PORT_FLAG2_PREFADER
-        || id->flags2 & PORT_FLAG2_POSTFADER))
-      ||
-      (id->owner_type == PORT_OWNER_TYPE_PLUGIN
-       &&
-       id->plugin_id.slot_type ==
-         PLUGIN_SLOT_INSTRUMENT))
-    {
-      if (ZRYTHM_TESTING)
-        track = port_get_track (port, true);
-      else
-        track = port->track;
-      g_return_if_fail (
-        IS_TRACK_AND_NONNULL (track));
+  AUDIO_ENGINE->trigger_midi_activity = 1;
+
+  /* queue playback if recording and we should
+   * record on MIDI input */
+  if (
+    TRANSPORT_IS_RECORDING && TRANSPORT_IS_PAUSED
+    && TRANSPORT->start_playback_on_midi_input)
+    {
+      EVENTS_PUSH (ET_TRANSPORT_ROLL_REQUIRED, NULL);
     }
 
-  bool is_stereo_port =
-    id->flags & PORT_FLAG_STEREO_L
-    || id->flags & PORT_FLAG_STEREO_R;
+  /* capture cc if capturing */
+  if (AUDIO_ENGINE->capture_cc)
+    {
+      memcpy (
+        AUDIO_ENGINE->last_cc,
+        events->events[events->num_events - 1]
+          .raw_buffer,
+        sizeof (midi_byte_t) * 3);
+    }
 
-  switch (id->type)
+  /* send cc to mapped ports */
+  for (int i = 0; i < events->num_events; i++)
     {
-    case TYPE_EVENT:
-      if (noroll)
-        break;
+      MidiEvent * ev = &events->events[i];
+      midi_mappings_apply (
+        MIDI_MAPPINGS, ev->raw_buffer);
+    }
+}
 
-      if (G_UNLIKELY (
-            id->owner_type
-              == PORT_OWNER_TYPE_TRACK_PROCESSOR
-            && !track))
+/**
+ * Appends the events of the sources of the port.
+ */
+static void
+merge_midi_sources (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  for (int k = 0; k < port->num_srcs; k++)
+    {
+      Port *                 src_port = port->srcs[k];
+      const PortConnection * conn =
+        port->src_connections[k];
+      if (!conn->enabled)
+        continue;
+
+      /* if hardware device connected to track
+       * processor input, only allow signal to pass
+       * if armed and MIDI channel is valid */
+      if (
+        flags & PORT_PROCESS_FLAG_TRACK_INPUT
+        && src_port->id.owner_type
+             == PORT_OWNER_TYPE_HW)
         {
-          g_return_if_reached ();
-        }
+          Track * track = port->track;
 
-      /* if piano roll keys, add the notes to the
-       * piano roll "current notes" (to show
-       * pressed keys in the UI) */
-      if (
-        G_UNLIKELY (
-          id->owner_type
-            == PORT_OWNER_TYPE_TRACK_PROCESSOR
-          && track
-          && port == track->processor->midi_out
-          && port->midi_events->num_events > 0
-          && CLIP_EDITOR->has_region
-          && CLIP_EDITOR->region_id.track_name_hash
-               == track_get_name_hash (track)))
-        {
-          MidiEvents * events = port->midi_events;
-          bool         events_processed = false;
-          for (int i = 0; i < events->num_events;
-               i++)
-            {
-              midi_byte_t * buf =
-                events->events[i].raw_buffer;
-              if (midi_is_note_on (buf))
-                {
-                  piano_roll_add_current_note (
-                    PIANO_ROLL,
-                    midi_get_note_number (buf));
-                  events_processed = true;
-                }
-              else if (midi_is_note_off (buf))
-                {
-                  piano_roll_remove_current_note (
-                    PIANO_ROLL,
-                    midi_get_note_number (buf));
-                  events_processed = true;
-                }
-              else if (midi_is_all_notes_off (buf))
-                {
-                  PIANO_ROLL->num_current_notes = 0;
-                  events_processed = true;
-                }
-            }
-          if (events_processed)
-            {
-              EVENTS_PUSH (
-                ET_PIANO_ROLL_KEY_ON_OFF, NULL);
-            }
-        }
+          /* skip if not armed */
+          if (!track_get_recording (track))
+            continue;
 
-      /* only consider incoming external data if
-       * armed for recording (if the port is owner
-       * by a track), otherwise always consider
-       * incoming external data */
-      if ((id->owner_type !=
-             PORT_OWNER_TYPE_TRACK_PROCESSOR ||
-           (id->owner_type ==
-              PORT_OWNER_TYPE_TRACK_PROCESSOR &&
-            track &&
-            track_type_can_record (track->type) &&
-            track_get_recording (track))) &&
-           id->flow == FLOW_INPUT)
-        {
-          switch (AUDIO_ENGINE->midi_backend)
+          /* if not set to "all channels",
+           * filter-append */
+          if (
+            (track->type == TRACK_TYPE_MIDI
+             || track->type == TRACK_TYPE_INSTRUMENT)
+            && !track->channel->all_midi_channels)
             {
-#ifdef HAVE_JACK
-            case MIDI_BACKEND_JACK:
-              sum_data_from_jack (
-                port, local_offset, nframes);
-              break;
-#endif
-#ifdef _WOE32
-            case MIDI_BACKEND_WINDOWS_MME:
-              sum_data_from_windows_mme (
-                port, local_offset, nframes);
-              break;
-#endif
-#ifdef HAVE_RTMIDI
-            case MIDI_BACKEND_ALSA_RTMIDI:
-            case MIDI_BACKEND_JACK_RTMIDI:
-            case MIDI_BACKEND_WINDOWS_MME_RTMIDI:
-            case MIDI_BACKEND_COREMIDI_RTMIDI:
-              port_sum_data_from_rtmidi (
-                port, local_offset, nframes);
-              break;
-#endif
-            default:
-              break;
+              midi_events_append_w_filter (
+                port->midi_events,
+                src_port->midi_events,
+                track->channel->midi_channels,
+                time_nfo->local_offset,
+                time_nfo->nframes, F_NOT_QUEUED);
+              continue;
             }
+
+          /* otherwise append normally */
         }
 
-      /* set midi capture if hardware */
-      if (id->owner_type == PORT_OWNER_TYPE_HW)
-        {
-          MidiEvents * events = port->midi_events;
-          if (events->num_events > 0)
-            {
-              AUDIO_ENGINE->trigger_midi_activity =
-                1;
+      midi_events_append (
+        port->midi_events, src_port->midi_events,
+        time_nfo->local_offset, time_nfo->nframes,
+        F_NOT_QUEUED);
+    }
+}
 
-              /* queue playback if recording and
-               * we should record on MIDI input */
-              if (
-                TRANSPORT_IS_RECORDING
-                && TRANSPORT_IS_PAUSED
-                && TRANSPORT
-                     ->start_playback_on_midi_input)
-                {
-                  EVENTS_PUSH (
-                    ET_TRANSPORT_ROLL_REQUIRED,
-                    NULL);
-                }
+/**
+ * Publishes the events of the port to the UI.
+ */
+static void
+finish_midi_events (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  MidiEvents * events = port->midi_events;
 
-              /* capture cc if capturing */
-              if (AUDIO_ENGINE->capture_cc)
-                {
-                  memcpy (
-                    AUDIO_ENGINE->last_cc,
-                    events
-                      ->events[events->num_events - 1]
-                      .raw_buffer,
-                    sizeof (midi_byte_t) * 3);
-                }
+  /* send UI notification */
+  if (
+    flags & PORT_PROCESS_FLAG_MIDI_ACTIVITY
+    && events->num_events > 0)
+    {
+      port->track->trigger_midi_activity = 1;
+    }
 
-              /* send cc to mapped ports */
-              for (int i = 0;
-                   i < events->num_events; i++)
-                {
-                  MidiEvent * ev =
-                    &events->events[i];
-                  midi_mappings_apply (
-                    MIDI_MAPPINGS, ev->raw_buffer);
-                }
-            }
-        }
+  if (
+    time_nfo->local_offset + time_nfo->nframes
+    != AUDIO_ENGINE->block_length)
+    return;
 
-      for (int k = 0; k < port->num_srcs; k++)
+  if (port->write_ring_buffers)
+    {
+      for (int i = events->num_events - 1; i >= 0;
+           i--)
         {
-          Port * src_port = port->srcs[k];
-          const PortConnection * conn =
-            port->src_connections[k];
-          if (!conn->enabled)
-            continue;
-
-          g_return_if_fail (
-            src_port->id.type == TYPE_EVENT);
-
-          /* if hardware device connected to
-           * track processor input, only allow
-           * signal to pass if armed and
-           * MIDI channel is valid */
           if (
-            src_port->id.owner_type
-              == PORT_OWNER_TYPE_HW
-            && id->owner_type
-                 == PORT_OWNER_TYPE_TRACK_PROCESSOR)
+            zix_ring_write_space (port->midi_ring)
+            < sizeof (MidiEvent))
             {
-              g_return_if_fail (track);
-
-              /* skip if not armed */
-              if (!track_get_recording (track))
-                continue;
+              zix_ring_skip (
+                port->midi_ring, sizeof (MidiEvent));
+            }
 
-              /* if not set to "all channels",
-               * filter-append */
-              if (
-                (track->type == TRACK_TYPE_MIDI
-                 || track->type
-                      == TRACK_TYPE_INSTRUMENT)
-                && !track->channel->all_midi_channels)
-                {
-                  midi_events_append_w_filter (
-                    port->midi_events,
-                    src_port->midi_events,
-                    track->channel->midi_channels,
-                    local_offset, nframes,
-                    F_NOT_QUEUED);
-                  continue;
-                }
+          MidiEvent * ev = &events->events[i];
+          ev->systime = g_get_monotonic_time ();
+          zix_ring_write (
+            port->midi_ring, ev, sizeof (MidiEvent));
+        }
+    }
+  else if (events->num_events > 0)
+    {
+      port->last_midi_event_time =
+        g_get_monotonic_time ();
+      g_atomic_int_set (&port->has_midi_events, 1);
+    }
+}
 
-              /* otherwise append normally */
-            }
+/**
+ * Shared MIDI processing after any events from
+ * the backend were received.
+ */
+ALWAYS_INLINE static inline void
+process_midi_events (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo,
+  const bool                          to_backend)
+{
+  if (G_UNLIKELY (flags & PORT_PROCESS_FLAG_HW_MIDI))
+    process_hw_midi_events (port);
 
-          midi_events_append (
-            port->midi_events,
-            src_port->midi_events, local_offset,
-            nframes, F_NOT_QUEUED);
-        } /* foreach source */
+  merge_midi_sources (port, flags, time_nfo);
 
-      if (id->flow == FLOW_OUTPUT)
+  if (to_backend)
+    {
+      switch (AUDIO_ENGINE->midi_backend)
         {
-          switch (AUDIO_ENGINE->midi_backend)
-            {
 #ifdef HAVE_JACK
-            case MIDI_BACKEND_JACK:
-              send_data_to_jack (
-                port, local_offset, nframes);
-              break;
+        case MIDI_BACKEND_JACK:
+          send_data_to_jack (
+            port, time_nfo->local_offset,
+            time_nfo->nframes);
+          break;
 #endif
 #ifdef _WOE32
-            case MIDI_BACKEND_WINDOWS_MME:
-              send_data_to_windows_mme (
-                port, local_offset, nframes);
-              break;
+        case MIDI_BACKEND_WINDOWS_MME:
+          send_data_to_windows_mme (
+            port, time_nfo->local_offset,
+            time_nfo->nframes);
+          break;
 #endif
-            default:
-              break;
-            }
+        default:
+          break;
         }
+    }
 
-      /* send UI notification */
-      if (port->midi_events->num_events > 0)
-        {
-#if 0
-          g_message (
-            "port %s has %d events",
-            id->label,
-            port->midi_events->num_events);
-#endif
-
-          if (
-            id->owner_type
-            == PORT_OWNER_TYPE_TRACK_PROCESSOR)
-            {
-              g_return_if_fail (
-                IS_TRACK_AND_NONNULL (track));
+  finish_midi_events (port, flags, time_nfo);
+}
 
-              track->trigger_midi_activity = 1;
-            }
-        }
+/**
+ * MIDI merge: appends the events of the sources.
+ */
+HOT static void
+process_midi_merge (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  if (G_UNLIKELY (flags & PORT_PROCESS_FLAG_PIANO_ROLL))
+    add_piano_roll_current_notes (port, port->track);
 
-      if (
-        local_offset + nframes
-        == AUDIO_ENGINE->block_length)
-        {
-          MidiEvents * events = port->midi_events;
-          if (port->write_ring_buffers)
-            {
-              for (int i = events->num_events - 1;
-                   i >= 0; i--)
-                {
-                  if (
-                    zix_ring_write_space (
-                      port->midi_ring)
-                    < sizeof (MidiEvent))
-                    {
-                      zix_ring_skip (
-                        port->midi_ring,
-                        sizeof (MidiEvent));
-                    }
+  process_midi_events (port, flags, time_nfo, false);
+}
 
-                  MidiEvent * ev =
-                    &events->events[i];
-                  ev->systime =
-                    g_get_monotonic_time ();
-                  zix_ring_write (
-                    port->midi_ring, ev,
-                    sizeof (MidiEvent));
-                }
-            }
-          else
-            {
-              if (events->num_events > 0)
-                {
-                  port->last_midi_event_time =
-                    g_get_monotonic_time ();
-                  g_atomic_int_set (
-                    &port->has_midi_events, 1);
-                }
-            }
-        }
-      break;
-    case TYPE_AUDIO:
-    case TYPE_CV:
-      if (noroll)
+/**
+ * MIDI input that receives events from the
+ * backend.
+ */
+HOT static void
+process_midi_hw_input (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  /* only consider incoming external data if
+   * armed for recording (if the port is owned by
+   * a track), otherwise always consider incoming
+   * external data */
+  if (
+    !(flags & PORT_PROCESS_FLAG_TRACK_INPUT)
+    || track_get_recording (port->track))
+    {
+      switch (AUDIO_ENGINE->midi_backend)
         {
-          dsp_fill (
-            &port->buf[local_offset],
-            DENORMAL_PREVENTION_VAL, nframes);
-          break;
-        }
-
-      g_return_if_fail (
-        id->owner_type
-          != PORT_OWNER_TYPE_TRACK_PROCESSOR
-        || IS_TRACK_AND_NONNULL (track));
-
-      /* only consider incoming external data if
-       * armed for recording (if the port is owner
-       * by a track), otherwise always consider
-       * incoming external data */
-      if ((id->owner_type !=
-             PORT_OWNER_TYPE_TRACK_PROCESSOR
-           || (id->owner_type ==
-                 PORT_OWNER_TYPE_TRACK_PROCESSOR
-               && track_type_can_record (track->type)
-               && track_get_recording (track)))
-          && id->flow == FLOW_INPUT)
-        {
-          switch (AUDIO_ENGINE->audio_backend)
-            {
 #ifdef HAVE_JACK
-            case AUDIO_BACKEND_JACK:
-              sum_data_from_jack (
-                port, local_offset, nframes);
-              break;
+        case MIDI_BACKEND_JACK:
+          sum_data_from_jack (
+            port, time_nfo->local_offset,
+            time_nfo->nframes);
+          break;
 #endif
-            case AUDIO_BACKEND_DUMMY:
-              sum_data_from_dummy (
-                port, local_offset, nframes);
-              break;
-            default:
-              break;
-            }
+#ifdef _WOE32
+        case MIDI_BACKEND_WINDOWS_MME:
+          sum_data_from_windows_mme (
+            port, time_nfo->local_offset,
+            time_nfo->nframes);
+          break;
+#endif
+#ifdef HAVE_RTMIDI
+        case MIDI_BACKEND_ALSA_RTMIDI:
+        case MIDI_BACKEND_JACK_RTMIDI:
+        case MIDI_BACKEND_WINDOWS_MME_RTMIDI:
+        case MIDI_BACKEND_COREMIDI_RTMIDI:
+          port_sum_data_from_rtmidi (
+            port, time_nfo->local_offset,
+            time_nfo->nframes);
+          break;
+#endif
+        default:
+          break;
         }
+    }
 
-      for (int k = 0; k < port->num_srcs; k++)
-        {
-          Port * src_port = port->srcs[k];
-          const PortConnection * conn =
-            port->src_connections[k];
-          if (!conn->enabled)
-            continue;
-
-          float minf = 0.f, maxf = 0.f,
-                depth_range, multiplier;
-          if (G_LIKELY (id->type == TYPE_AUDIO))
-            {
-              minf = -2.f;
-              maxf = 2.f;
-              depth_range = 1.f;
-              multiplier = conn->multiplier;
-            }
-          else if (id->type == TYPE_CV)
-            {
-              maxf = port->maxf;
-              minf = port->minf;
+  process_midi_events (port, flags, time_nfo, false);
+}
 
-              /* (maxf - minf) / 2 */
-              depth_range = (maxf - minf) * 0.5f;
+/**
+ * MIDI output that sends its events to the
+ * backend.
+ */
+HOT static void
+process_midi_backend_output (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  if (G_UNLIKELY (flags & PORT_PROCESS_FLAG_PIANO_ROLL))
+    add_piano_roll_current_notes (port, port->track);
 
-              multiplier =
-                depth_range * conn->multiplier;
-            }
-          else
-            g_return_if_reached ();
+  process_midi_events (port, flags, time_nfo, true);
+}
 
-          /* sum the signals */
-          if (G_LIKELY (math_floats_equal_epsilon (
-                multiplier, 1.f, 0.00001f)))
-            {
-              dsp_add2 (
-                &port->buf[local_offset],
-                &src_port->buf[local_offset],
-                nframes);
-            }
-          else
-            {
-              dsp_mix2 (
-                &port->buf[local_offset],
-                &src_port->buf[local_offset], 1.f,
-                multiplier, nframes);
-            }
+/** Max number of sources summed with one call to
+ * dsp_sum_n(). */
+#define SUM_BATCH_SIZE 32
 
-          if (
-            G_UNLIKELY (id->type == TYPE_CV)
-            || id->owner_type
-                 == PORT_OWNER_TYPE_FADER)
+/**
+ * Sums the signals of the sources of an audio or
+ * CV port.
+ *
+ * @param silent Whether only silence was added to
+ *   the buffer so far.
+ *
+ * @return Whether only silence was added.
+ */
+ALWAYS_INLINE static inline bool
+sum_signal_sources (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo,
+  const bool                          is_cv,
+  bool                                silent)
+{
+  const nframes_t local_offset =
+    time_nfo->local_offset;
+  const nframes_t nframes = time_nfo->nframes;
+
+  /* limiting is only done on CV connections and
+   * faders */
+  const bool limit =
+    is_cv || flags & PORT_PROCESS_FLAG_LIMIT;
+  const float minf = is_cv ? port->minf : -2.f;
+  const float maxf = is_cv ? port->maxf : 2.f;
+
+  /* (maxf - minf) / 2 */
+  const float depth_range =
+    is_cv ? (maxf - minf) * 0.5f : 1.f;
+
+  /* sources are summed in batches with one pass
+   * over the buffer per batch */
+  const float * bufs[SUM_BATCH_SIZE];
+  float         multipliers[SUM_BATCH_SIZE];
+  size_t        num_bufs = 0;
+  for (int k = 0; k < port->num_srcs; k++)
+    {
+      Port *                 src_port = port->srcs[k];
+      const PortConnection * conn =
+        port->src_connections[k];
+      if (!conn->enabled)
+        continue;
+
+      /* adding silence is a no-op */
+      if (src_port->is_silent)
+        continue;
+      silent = false;
+
+      bufs[num_bufs] = &src_port->buf[local_offset];
+      multipliers[num_bufs] =
+        is_cv
+          ? depth_range * conn->multiplier
+          : conn->multiplier;
+      num_bufs++;
+
+      if (num_bufs == SUM_BATCH_SIZE)
+        {
+          dsp_sum_n (
+            &port->buf[local_offset], bufs,
+            multipliers, num_bufs, limit, minf, maxf,
+            nframes);
+          num_bufs = 0;
+        }
+    }
+
+  if (num_bufs == 0)
+    return silent;
+
+  /* a single source is summed with the (possibly
+   * optimized) 2-way functions */
+  if (num_bufs == 1 && !limit)
+    {
+      if (G_LIKELY (math_floats_equal_epsilon (
+            multipliers[0], 1.f, 0.00001f)))
+        {
+          dsp_add2 (
+            &port->buf[local_offset], bufs[0],
+            nframes);
+        }
+      else
+        {
+          dsp_mix2 (
+            &port->buf[local_offset], bufs[0], 1.f,
+            multipliers[0], nframes);
+        }
+    }
+  else
+    {
+      dsp_sum_n (
+        &port->buf[local_offset], bufs, multipliers,
+        num_bufs, limit, minf, maxf, nframes);
+    }
+
+  return silent;
+}
+
+/**
+ * Adds the buffer of a port of a track bounced
+ * directly to master (e.g., when bouncing the track
+ * on its own without parents) to the master
+ * output.
+ */
+static void
+add_to_master_for_bounce (
+  Port *                              port,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  Track * track = port->track;
+  if (!track->bounce_to_master)
+    return;
+
+#define _ADD(l_or_r) \
+  dsp_add2 ( \
+    &P_MASTER_TRACK->channel->stereo_out->l_or_r \
+       ->buf[time_nfo->local_offset], \
+    &port->buf[time_nfo->local_offset], \
+    time_nfo->nframes)
+
+  Channel *        ch;
+  Fader *          prefader;
+  TrackProcessor * tp;
+  switch (AUDIO_ENGINE->bounce_step)
+    {
+    case BOUNCE_STEP_BEFORE_INSERTS:
+      tp = track->processor;
+      g_return_if_fail (tp);
+      if (track->type == TRACK_TYPE_INSTRUMENT)
+        {
+          if (port == track->channel->instrument->l_out)
             {
-              float abs_peak = dsp_abs_max (
-                &port->buf[local_offset], nframes);
-              if (abs_peak > maxf)
-                {
-                  /* this limiting wastes around
-                   * 50% of port processing so only
-                   * do it on CV connections and
-                   * faders if they exceed maxf */
-                  dsp_limit1 (
-                    &port->buf[local_offset], minf,
-                    maxf, nframes);
-                }
+              _ADD (l);
             }
-        } /* foreach source */
-
-      if (id->flow == FLOW_OUTPUT)
+          if (port == track->channel->instrument->r_out)
+            {
+              _ADD (r);
+            }
+        }
+      else if (tp->stereo_out && track->bounce)
         {
-          switch (AUDIO_ENGINE->audio_backend)
+          if (port == tp->stereo_out->l)
+            {
+              _ADD (l);
+            }
+          else if (port == tp->stereo_out->r)
             {
+              _ADD (r);
+            }
+        }
+      break;
+    case BOUNCE_STEP_PRE_FADER:
+      ch = track->channel;
+      g_return_if_fail (ch);
+      prefader = ch->prefader;
+      if (port == prefader->stereo_out->l)
+        {
+          _ADD (l);
+        }
+      else if (port == prefader->stereo_out->r)
+        {
+          _ADD (r);
+        }
+      break;
+    case BOUNCE_STEP_POST_FADER:
+      ch = track->channel;
+      g_return_if_fail (ch);
+      if (track->type != TRACK_TYPE_MASTER)
+        {
+          if (port == ch->stereo_out->l)
+            {
+              _ADD (l);
+            }
+          else if (port == ch->stereo_out->r)
+            {
+              _ADD (r);
+            }
+        }
+      break;
+    }
+#undef _ADD
+}
+
+/**
+ * Runs the port's meters over the whole cycle, if
+ * it has any.
+ */
+ALWAYS_INLINE static inline void
+process_meter (Port * port)
+{
+  MeterProcessor * meter =
+    g_atomic_pointer_get (&port->meter_processor);
+  if (meter)
+    {
+      meter_processor_process (
+        meter, port->buf, AUDIO_ENGINE->block_length);
+    }
+}
+
+/**
+ * Shared audio/CV processing after the signals
+ * are summed.
+ */
+ALWAYS_INLINE static inline void
+finish_signal (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo,
+  const bool                          to_backend,
+  const bool                          silent)
+{
+  const nframes_t local_offset =
+    time_nfo->local_offset;
+  const nframes_t nframes = time_nfo->nframes;
+
+  /* input ports are only written to here (the
+   * buffer was cleared before the cycle), while
+   * output ports are written to by their owner
+   * before this */
+  if (port->id.flow == FLOW_INPUT)
+    port_mark_silent (port, local_offset, silent);
+  else if (!silent)
+    port->is_silent = false;
+
+  if (to_backend)
+    {
+      switch (AUDIO_ENGINE->audio_backend)
+        {
 #ifdef HAVE_JACK
-            case AUDIO_BACKEND_JACK:
-              send_data_to_jack (
-                port, local_offset, nframes);
-              break;
+        case AUDIO_BACKEND_JACK:
+          send_data_to_jack (
+            port, local_offset, nframes);
+          break;
 #endif
-            default:
-              break;
-            }
+        default:
+          break;
         }
+    }
 
-      if (
-        local_offset + nframes
-        == AUDIO_ENGINE->block_length)
+  if (
+    local_offset + nframes
+    == AUDIO_ENGINE->block_length)
+    {
+      process_meter (port);
+
+      if (port->write_ring_buffers)
         {
           size_t size =
             sizeof (float)
@@ -3135,294 +3313,419 @@ port_process (
           zix_ring_write (
             port->audio_ring, &port->buf[0], size);
         }
+    }
 
-      /* if track output (to be shown on mixer) */
+  /* calculate meter values of channel outputs
+   * (shown on the mixer) */
+  if (flags & PORT_PROCESS_FLAG_METER)
+    {
+      /* reset peak if needed */
+      gint64 time_now = g_get_monotonic_time ();
       if (
-        id->owner_type == PORT_OWNER_TYPE_CHANNEL
-        && is_stereo_port
-        && id->flow == FLOW_OUTPUT)
+        time_now - port->peak_timestamp
+        > TIME_TO_RESET_PEAK)
+        port->peak = -1.f;
+
+      bool changed = dsp_abs_max_with_existing_peak (
+        &port->buf[local_offset], &port->peak,
+        nframes);
+      if (changed)
         {
-          g_return_if_fail (
-            IS_TRACK_AND_NONNULL (track));
-          Channel * ch = track->channel;
-          g_return_if_fail (ch);
-
-          /* calculate meter values */
-          if (
-            port == ch->stereo_out->l
-            || port == ch->stereo_out->r)
-            {
-              /* reset peak if needed */
-              gint64 time_now =
-                g_get_monotonic_time ();
-              if (
-                time_now - port->peak_timestamp
-                > TIME_TO_RESET_PEAK)
-                port->peak = -1.f;
-
-              bool changed =
-                dsp_abs_max_with_existing_peak (
-                  &port->buf[local_offset],
-                  &port->peak, nframes);
-              if (changed)
-                {
-                  port->peak_timestamp =
-                    g_get_monotonic_time ();
-                }
-            }
+          port->peak_timestamp =
+            g_get_monotonic_time ();
         }
+    }
+
+  if (G_LIKELY (
+        AUDIO_ENGINE->bounce_mode == BOUNCE_OFF))
+    return;
+
+  /* if bouncing tracks directly to master (e.g.,
+   * when bouncing the track on its own without
+   * parents), clear master input */
+  if (
+    flags & PORT_PROCESS_FLAG_MASTER_INPUT
+    && !AUDIO_ENGINE->bounce_with_parents)
+    {
+      dsp_fill (
+        &port->buf[local_offset],
+        AUDIO_ENGINE->denormal_prevention_val,
+        nframes);
+    }
+
+  if (flags & PORT_PROCESS_FLAG_BOUNCE_TO_MASTER)
+    add_to_master_for_bounce (port, time_nfo);
+}
 
-      /* if bouncing tracks directly to
-         * master (e.g., when bouncing the
-         * track on its own without parents),
-         * clear master input */
-      if (G_UNLIKELY (
-              AUDIO_ENGINE->bounce_mode > BOUNCE_OFF
-              && !AUDIO_ENGINE->bounce_with_parents
-              &&
-              (port ==
-                 P_MASTER_TRACK->processor->
-                   stereo_in->l
-               ||
-               port ==
-                 P_MASTER_TRACK->processor->
-                   stereo_in->r)))
+/**
+ * Plain audio sum.
+ */
+HOT static void
+process_audio_sum (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  bool silent = sum_signal_sources (
+    port, flags, time_nfo, false, true);
+  finish_signal (
+    port, flags, time_nfo, false, silent);
+}
+
+/**
+ * CV sum, clamped to the range of the port.
+ */
+HOT static void
+process_cv_sum (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  bool silent = sum_signal_sources (
+    port, flags, time_nfo, true, true);
+  finish_signal (
+    port, flags, time_nfo, false, silent);
+}
+
+/**
+ * Audio or CV input that receives data from the
+ * backend.
+ */
+HOT static void
+process_audio_hw_input (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  /* whether only silence was added */
+  bool silent = true;
+
+  /* only consider incoming external data if
+   * armed for recording (if the port is owned by
+   * a track), otherwise always consider incoming
+   * external data */
+  if (
+    !(flags & PORT_PROCESS_FLAG_TRACK_INPUT)
+    || track_get_recording (port->track))
+    {
+      switch (AUDIO_ENGINE->audio_backend)
         {
-          dsp_fill (
-            &port->buf[local_offset],
-            AUDIO_ENGINE->denormal_prevention_val,
-            nframes);
+#ifdef HAVE_JACK
+        case AUDIO_BACKEND_JACK:
+          if (sum_data_from_jack (
+                port, time_nfo->local_offset,
+                time_nfo->nframes))
+            silent = false;
+          break;
+#endif
+        case AUDIO_BACKEND_DUMMY:
+          if (sum_data_from_dummy (
+                port, time_nfo->local_offset,
+                time_nfo->nframes))
+            silent = false;
+          break;
+        default:
+          break;
         }
+    }
+
+  silent = sum_signal_sources (
+    port, flags, time_nfo,
+    port->id.type == TYPE_CV, silent);
+  finish_signal (
+    port, flags, time_nfo, false, silent);
+}
 
-      /* if bouncing track directly to
-         * master (e.g., when bouncing the
-         * track on its own without parents),
-         * add the buffer to master output */
-      if (G_UNLIKELY (
-              AUDIO_ENGINE->bounce_mode >
-                BOUNCE_OFF &&
-              (id->owner_type ==
-                 PORT_OWNER_TYPE_CHANNEL ||
-               id->owner_type ==
-                 PORT_OWNER_TYPE_TRACK_PROCESSOR ||
-               (id->owner_type ==
-                 PORT_OWNER_TYPE_FADER
-                &&
-                id->flags2 &
-                  PORT_FLAG2_PREFADER)
-               ||
-               (id->owner_type ==
-                 PORT_OWNER_TYPE_PLUGIN &&
-                id->plugin_id.slot_type ==
-                  PLUGIN_SLOT_INSTRUMENT)) &&
-              is_stereo_port &&
-              id->flow == FLOW_OUTPUT &&
-              track && track->bounce_to_master))
+/**
+ * Audio or CV output that sends its data to the
+ * backend.
+ */
+HOT static void
+process_audio_backend_output (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  bool silent = sum_signal_sources (
+    port, flags, time_nfo,
+    port->id.type == TYPE_CV, true);
+  finish_signal (
+    port, flags, time_nfo, true, silent);
+}
+
+/**
+ * Control input: reads automation and applies CV
+ * modulation.
+ */
+HOT static void
+process_control (
+  Port *                              port,
+  const PortProcessFlags              flags,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  /* calculate value from automation track */
+  AutomationTrack * at = port->at;
+  if (
+    at
+    && automation_track_should_read_automation (
+      at, AUDIO_ENGINE->timestamp_start))
+    {
+      /* if playhead pos changed manually recently
+       * or transport is rolling, we will force the
+       * last known automation point value
+       * regardless of whether there is a region at
+       * current pos */
+      bool can_read_previous_automation =
+        TRANSPORT_IS_ROLLING
+        || (TRANSPORT->last_manual_playhead_change
+              - AUDIO_ENGINE->last_timestamp_start
+            > 0);
+
+      /* if there was an automation event at the
+       * playhead position, set val and flag */
+      float val;
+      if (automation_track_read_normalized_val (
+            at,
+            (signed_frame_t) time_nfo->g_start_frame,
+            !can_read_previous_automation, &val))
         {
+          control_port_set_val_from_normalized (
+            port, val, true);
+          port->value_changed_from_reading = true;
+        }
+    }
 
-#define _ADD(l_or_r) \
-  dsp_add2 ( \
-    &P_MASTER_TRACK->channel->stereo_out->l_or_r \
-       ->buf[local_offset], \
-    &port->buf[local_offset], nframes)
+  /* whether this is the first CV processed on
+   * this control port */
+  bool first_cv = true;
+  for (int k = 0; k < port->num_srcs; k++)
+    {
+      Port *                 src_port = port->srcs[k];
+      const PortConnection * conn =
+        port->src_connections[k];
+      if (!conn->enabled)
+        continue;
 
-          Channel *        ch;
-          Fader *          prefader;
-          TrackProcessor * tp;
-          switch (AUDIO_ENGINE->bounce_step)
+      if (src_port->id.type == TYPE_CV)
+        {
+          float maxf = port->maxf;
+          float minf = port->minf;
+          float depth_range = (maxf - minf) / 2.f;
+
+          /* figure out whether to use base value or
+           * the current value */
+          float val_to_use;
+          if (first_cv)
             {
-            case BOUNCE_STEP_BEFORE_INSERTS:
-              tp = track->processor;
-              g_return_if_fail (tp);
-              if (track->type == TRACK_TYPE_INSTRUMENT)
-                {
-                  if (
-                    port
-                    == track->channel->instrument
-                         ->l_out)
-                    {
-                      _ADD (l);
-                    }
-                  if (
-                    port
-                    == track->channel->instrument
-                         ->r_out)
-                    {
-                      _ADD (r);
-                    }
-                }
-              else if (tp->stereo_out && track->bounce)
-                {
-                  if (port == tp->stereo_out->l)
-                    {
-                      _ADD (l);
-                    }
-                  else if (port == tp->stereo_out->r)
-                    {
-                      _ADD (r);
-                    }
-                }
-              break;
-            case BOUNCE_STEP_PRE_FADER:
-              ch = track->channel;
-              g_return_if_fail (ch);
-              prefader = ch->prefader;
-              if (port == prefader->stereo_out->l)
-                {
-                  _ADD (l);
-                }
-              else if (port == prefader->stereo_out->r)
-                {
-                  _ADD (r);
-                }
-              break;
-            case BOUNCE_STEP_POST_FADER:
-              ch = track->channel;
-              g_return_if_fail (ch);
-              if (track->type != TRACK_TYPE_MASTER)
-                {
-                  if (port == ch->stereo_out->l)
-                    {
-                      _ADD (l);
-                    }
-                  else if (port == ch->stereo_out->r)
-                    {
-                      _ADD (r);
-                    }
-                }
-              break;
+              val_to_use = port->base_value;
+              first_cv = false;
             }
-#undef _ADD
+          else
+            {
+              val_to_use = port->control;
+            }
+
+          float result = CLAMP (
+            val_to_use
+              + depth_range * src_port->buf[0]
+                  * conn->multiplier,
+            minf, maxf);
+          port->control = result;
+          g_atomic_int_inc (
+            &port->control_generation);
+          port_forward_control_change_event (port);
         }
-      break;
-    case TYPE_CONTROL:
-      {
-        if (
-          id->flow != FLOW_INPUT
-          || (id->owner_type == PORT_OWNER_TYPE_FADER && (id->flags2 & PORT_FLAG2_MONITOR_FADER || id->flags2 & PORT_FLAG2_PREFADER))
-          || id->flags & PORT_FLAG_TP_MONO
-          || id->flags & PORT_FLAG_TP_INPUT_GAIN
-          || !(id->flags & PORT_FLAG_AUTOMATABLE))
-          {
-            break;
-          }
+    }
+}
 
-        /* calculate value from automation track */
-        g_return_if_fail (
-          id->flags & PORT_FLAG_AUTOMATABLE);
-        AutomationTrack * at = port->at;
-        if (G_UNLIKELY (!at))
-          {
-            g_critical (
-              "No automation track found for port "
-              "%s",
-              id->label);
-          }
-        if (ZRYTHM_TESTING && at)
-          {
-            AutomationTrack * found_at =
-              automation_track_find_from_port (
-                port, NULL, true);
-            g_return_if_fail (at == found_at);
-          }
+/**
+ * Returns the track to use when processing the
+ * port, or NULL if the port does not need one.
+ *
+ * @param[out] valid Whether the port has the
+ *   track it needs.
+ */
+static Track *
+get_track_for_processing (
+  Port * self,
+  bool * valid)
+{
+  const PortIdentifier * id = &self->id;
 
-        if (
-          at && id->flags & PORT_FLAG_AUTOMATABLE
-          && automation_track_should_read_automation (
-            at, AUDIO_ENGINE->timestamp_start))
-          {
-            Position pos;
-            position_from_frames (
-              &pos,
-              (signed_frame_t)
-                time_nfo.g_start_frame);
-
-            /* if playhead pos changed manually
-             * recently or transport is rolling,
-             * we will force the last known
-             * automation point value regardless
-             * of whether there is a region at
-             * current pos */
-            bool can_read_previous_automation =
-              TRANSPORT_IS_ROLLING
-              ||
-              (TRANSPORT->last_manual_playhead_change
-               - AUDIO_ENGINE->last_timestamp_start > 0);
-
-            /* if there was an automation event
-             * at the playhead position, set val
-             * and flag */
-            AutomationPoint * ap =
-              automation_track_get_ap_before_pos (
-                at, &pos,
-                !can_read_previous_automation);
-            if (ap)
-              {
-                float val =
-                  automation_track_get_val_at_pos (
-                    at, &pos, true,
-                    !can_read_previous_automation);
-                control_port_set_val_from_normalized (
-                  port, val, true);
-                port->value_changed_from_reading =
-                  true;
-              }
-          }
+  *valid = true;
+  if (
+    id->owner_type != PORT_OWNER_TYPE_TRACK_PROCESSOR
+    && id->owner_type != PORT_OWNER_TYPE_TRACK
+    && id->owner_type != PORT_OWNER_TYPE_CHANNEL
+    /* if track/channel fader */
+    && !(
+      id->owner_type == PORT_OWNER_TYPE_FADER
+      && (id->flags2 & PORT_FLAG2_PREFADER
+          || id->flags2 & PORT_FLAG2_POSTFADER))
+    && !(
+      id->owner_type == PORT_OWNER_TYPE_PLUGIN
+      && id->plugin_id.slot_type
+           == PLUGIN_SLOT_INSTRUMENT))
+    return NULL;
+
+  Track * track = self->track;
+  if (ZRYTHM_TESTING)
+    {
+      g_warn_if_fail (
+        track == port_get_track (self, true));
+    }
+  if (!IS_TRACK_AND_NONNULL (track))
+    {
+      *valid = false;
+      return NULL;
+    }
 
-        float maxf, minf, depth_range, val_to_use;
-        /* whether this is the first CV processed
-         * on this control port */
-        bool first_cv = true;
-        for (int k = 0; k < port->num_srcs; k++)
-          {
-            Port * src_port = port->srcs[k];
-            const PortConnection * conn =
-              port->src_connections[k];
-            if (!conn->enabled)
-              continue;
+  return track;
+}
 
-            if (src_port->id.type == TYPE_CV)
-              {
-                maxf = port->maxf;
-                minf = port->minf;
-
-                /*float deff =*/
-                /*port->lv2_port->lv2_control->deff;*/
-                /*port->lv2_port->control =*/
-                /*deff + (maxf - deff) **/
-                /*src_port->buf[0];*/
-                depth_range = (maxf - minf) / 2.f;
-
-                /* figure out whether to use base
-                 * value or the current value */
-                if (first_cv)
-                  {
-                    val_to_use = port->base_value;
-                    first_cv = false;
-                  }
-                else
-                  {
-                    val_to_use = port->control;
-                  }
-
-                float result = CLAMP (
-                  val_to_use
-                    + depth_range * src_port->buf[0]
-                        * conn->multiplier,
-                  minf, maxf);
-                port->control = result;
-                port_forward_control_change_event (
-                  port);
-              }
-          }
-      }
-      break;
+/**
+ * Decides how the port is to be processed.
+ *
+ * To be called when the graph is built, and
+ * again when the port is exposed to or unexposed
+ * from the backend.
+ *
+ * @param[out] flags Flags to pass to the returned
+ *   function.
+ *
+ * @return The function to process the port with
+ *   on each cycle, or NULL if the port does not
+ *   need processing.
+ */
+PortProcessFunc
+port_get_process_func (
+  Port *             self,
+  PortProcessFlags * flags)
+{
+  *flags = 0;
+
+  g_return_val_if_fail (IS_PORT (self), NULL);
+
+  const PortIdentifier * id = &self->id;
+
+  bool    has_track;
+  Track * track =
+    get_track_for_processing (self, &has_track);
+  g_return_val_if_fail (has_track, NULL);
+
+  bool is_stereo_port =
+    id->flags & PORT_FLAG_STEREO_L
+    || id->flags & PORT_FLAG_STEREO_R;
+
+  /* whether the port may exchange data with the
+   * backend (inputs of tracks that cannot record
+   * never do) */
+  bool is_tp =
+    id->owner_type
+    == PORT_OWNER_TYPE_TRACK_PROCESSOR;
+  bool is_hw_input =
+    id->flow == FLOW_INPUT
+    && (is_tp
+          ? track_type_can_record (track->type)
+          : (id->owner_type == PORT_OWNER_TYPE_HW
+             || port_is_exposed_to_backend (self)));
+  bool is_backend_output =
+    id->flow == FLOW_OUTPUT
+    && port_is_exposed_to_backend (self);
+  if (is_tp && id->flow == FLOW_INPUT)
+    *flags |= PORT_PROCESS_FLAG_TRACK_INPUT;
+
+  switch (id->type)
+    {
+    case TYPE_EVENT:
+      if (id->owner_type == PORT_OWNER_TYPE_HW)
+        *flags |= PORT_PROCESS_FLAG_HW_MIDI;
+      if (is_tp)
+        {
+          *flags |= PORT_PROCESS_FLAG_MIDI_ACTIVITY;
+          if (self == track->processor->midi_out)
+            *flags |= PORT_PROCESS_FLAG_PIANO_ROLL;
+        }
+
+      if (is_hw_input)
+        return process_midi_hw_input;
+      else if (is_backend_output)
+        return process_midi_backend_output;
+      else
+        return process_midi_merge;
+    case TYPE_AUDIO:
+    case TYPE_CV:
+      if (
+        id->type == TYPE_AUDIO
+        && id->owner_type == PORT_OWNER_TYPE_FADER)
+        *flags |= PORT_PROCESS_FLAG_LIMIT;
+
+      if (
+        id->owner_type == PORT_OWNER_TYPE_CHANNEL
+        && id->flow == FLOW_OUTPUT
+        && (self == track->channel->stereo_out->l
+            || self == track->channel->stereo_out->r))
+        *flags |= PORT_PROCESS_FLAG_METER;
+
+      if (
+        is_tp && track->type == TRACK_TYPE_MASTER
+        && (self == track->processor->stereo_in->l
+            || self == track->processor->stereo_in->r))
+        *flags |= PORT_PROCESS_FLAG_MASTER_INPUT;
+
+      if (
+        track && is_stereo_port
+        && id->flow == FLOW_OUTPUT
+        && (id->owner_type == PORT_OWNER_TYPE_CHANNEL
+            || is_tp
+            || (id->owner_type == PORT_OWNER_TYPE_FADER
+                && id->flags2 & PORT_FLAG2_PREFADER)
+            || id->owner_type
+                 == PORT_OWNER_TYPE_PLUGIN))
+        *flags |= PORT_PROCESS_FLAG_BOUNCE_TO_MASTER;
+
+      if (is_hw_input)
+        return process_audio_hw_input;
+      else if (is_backend_output)
+        return process_audio_backend_output;
+      else if (id->type == TYPE_CV)
+        return process_cv_sum;
+      else
+        return process_audio_sum;
+    case TYPE_CONTROL:
+      if (
+        id->flow != FLOW_INPUT
+        || (id->owner_type == PORT_OWNER_TYPE_FADER
+            && (id->flags2 & PORT_FLAG2_MONITOR_FADER
+                || id->flags2 & PORT_FLAG2_PREFADER))
+        || id->flags & PORT_FLAG_TP_MONO
+        || id->flags & PORT_FLAG_TP_INPUT_GAIN
+        || !(id->flags & PORT_FLAG_AUTOMATABLE))
+        {
+          return NULL;
+        }
+
+      if (G_UNLIKELY (!self->at))
+        {
+          g_critical (
+            "No automation track found for port "
+            "%s",
+            id->label);
+        }
+      else if (ZRYTHM_TESTING)
+        {
+          AutomationTrack * found_at =
+            automation_track_find_from_port (
+              self, NULL, true);
+          g_return_val_if_fail (
+            self->at == found_at, NULL);
+        }
+      return process_control;
     default:
       break;
     }
 
-#undef nframes
-#undef local_offset
+  return NULL;
 }
 
 /**
@@ -3468,6 +3771,9 @@ port_set_expose_to_backend (Port * self, int expose)
       return;
     }
 
+  bool was_exposed =
+    port_is_exposed_to_backend (self);
+
   if (self->id.type == TYPE_AUDIO)
     {
       switch (AUDIO_ENGINE->audio_backend)
@@ -3521,6 +3827,17 @@ port_set_expose_to_backend (Port * self, int expose)
     }
   else
     g_return_if_reached ();
+
+  /* the graph chooses whether ports exchange data
+   * with the backend when it is built */
+  if (
+    ROUTER && ROUTER->graph
+    && was_exposed
+         != (bool) port_is_exposed_to_backend (self))
+    {
+      graph_update_port_process_func (
+        ROUTER->graph, self);
+    }
 }
 
 /**
@@ -3577,6 +3894,8 @@ port_has_sound (Port * self)
     {
     case TYPE_AUDIO:
       g_return_val_if_fail (self->buf, false);
+      if (self->is_silent)
+        return false;
       for (nframes_t i = 0;
            i < AUDIO_ENGINE->block_length; i++)
         {
@@ -3699,6 +4018,10 @@ port_clear_audio_cv_buffer (Port * port)
         port->buf, DENORMAL_PREVENTION_VAL,
         AUDIO_ENGINE->block_length);
     }
+
+  /* other code (e.g. plugins) may write to the
+   * buffer without marking it */
+  port->is_silent = false;
 }
 
 /**
@@ -3968,6 +4291,8 @@ void
 port_free (Port * self)
 {
   port_free_bufs (self);
+  object_free_w_func_and_null (
+    meter_processor_unref, self->meter_processor);
 
 #ifdef HAVE_RTMIDI
   for (int i = 0; i < self->num_rtmidi_ins; i++)
@@ -17,7 +17,9 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "audio/graph.h"
 #include "audio/port_connections_manager.h"
+#include "audio/router.h"
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/objects.h"
@@ -389,6 +391,17 @@ remove_connection (
   port_connections_manager_regenerate_hashtables (
     self);
 
+  /* the running graph may still use the
+   * connection */
+  if (
+    self == PORT_CONNECTIONS_MGR && AUDIO_ENGINE
+    && ROUTER && ROUTER->graph)
+    {
+      graph_free_connection_later (
+        ROUTER->graph, conn);
+      return;
+    }
+
   object_free_w_func_and_null (
     port_connection_free, conn);
 }
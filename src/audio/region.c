@@ -15,8 +15,10 @@
 #include "audio/region.h"
 #include "audio/region_link_group_manager.h"
 #include "audio/router.h"
+#include "audio/sample_processor.h"
 #include "audio/stretcher.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "gui/widgets/automation_region.h"
 #include "gui/widgets/bot_dock_edge.h"
 #include "gui/widgets/center_dock.h"
@@ -579,6 +581,52 @@ region_get_lane (const ZRegion * self)
   g_return_val_if_reached (NULL);
 }
 
+ZRegion *
+region_find_in_lane (
+  const RegionIdentifier * id,
+  bool                     is_auditioner)
+{
+  if (
+    !PROJECT
+    || (id->type != REGION_TYPE_MIDI
+        && id->type != REGION_TYPE_AUDIO))
+    return NULL;
+
+  Tracklist * tracklist =
+    is_auditioner
+      ? SAMPLE_PROCESSOR->tracklist
+      : TRACKLIST;
+  if (!tracklist)
+    return NULL;
+
+  Track * track = tracklist_find_track_by_name_hash (
+    tracklist, id->track_name_hash);
+  if (
+    !track || id->lane_pos < 0
+    || id->lane_pos >= track->num_lanes)
+    return NULL;
+
+  TrackLane * lane = track->lanes[id->lane_pos];
+  if (id->idx < 0 || id->idx >= lane->num_regions)
+    return NULL;
+
+  return lane->regions[id->idx];
+}
+
+void
+region_update_lane_index (ZRegion * self)
+{
+  /* only regions in the lane are indexed */
+  if (
+    region_find_in_lane (
+      &self->id, self->base.is_auditioner)
+    != self)
+    return;
+
+  TrackLane * lane = region_get_lane (self);
+  region_index_update (&lane->region_index, self);
+}
+
 /**
  * Returns the region's link group.
  */
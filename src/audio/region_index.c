@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/region.h"
+#include "audio/region_index.h"
+#include "utils/arrays.h"
+#include "utils/objects.h"
+
+/**
+ * Entries to step through from the cursor before
+ * falling back to a binary search.
+ */
+#define CURSOR_MAX_STEPS 8
+
+/**
+ * Recalculates the highest end positions from the
+ * given entry onwards.
+ */
+static void
+update_max_ends (RegionIndex * self, int from)
+{
+  signed_frame_t max_end =
+    from > 0 ? self->entries[from - 1].max_end
+             : G_MININT64;
+  for (int i = from; i < self->num_entries; i++)
+    {
+      RegionIndexEntry * entry = &self->entries[i];
+      max_end = MAX (max_end, entry->end);
+      entry->max_end = max_end;
+    }
+}
+
+/**
+ * Returns the index of the first entry starting
+ * after @p frame.
+ */
+static int
+find_insert_idx (
+  const RegionIndex *  self,
+  const signed_frame_t frame)
+{
+  int lo = 0;
+  int hi = self->num_entries;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (self->entries[mid].start <= frame)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+static int
+find_region (
+  const RegionIndex * self,
+  const ZRegion *     region)
+{
+  for (int i = 0; i < self->num_entries; i++)
+    {
+      if (self->entries[i].region == region)
+        return i;
+    }
+  return -1;
+}
+
+static void
+insert_entry (
+  RegionIndex * self,
+  ZRegion *     region)
+{
+  const ArrangerObject * r_obj =
+    (const ArrangerObject *) region;
+  int idx =
+    find_insert_idx (self, r_obj->pos.frames);
+
+  array_double_size_if_full (
+    self->entries, self->num_entries,
+    self->entries_size, RegionIndexEntry);
+  memmove (
+    &self->entries[idx + 1], &self->entries[idx],
+    (size_t) (self->num_entries - idx)
+      * sizeof (RegionIndexEntry));
+  self->entries[idx] = (RegionIndexEntry){
+    .region = region,
+    .start = r_obj->pos.frames,
+    .end = r_obj->end_pos.frames,
+  };
+  self->num_entries++;
+
+  update_max_ends (self, idx);
+}
+
+static void
+remove_entry (RegionIndex * self, int idx)
+{
+  memmove (
+    &self->entries[idx], &self->entries[idx + 1],
+    (size_t) (self->num_entries - idx - 1)
+      * sizeof (RegionIndexEntry));
+  self->num_entries--;
+
+  update_max_ends (self, idx);
+}
+
+static void
+free_snapshot (void * data)
+{
+  RegionIndexSnapshot * snapshot =
+    (RegionIndexSnapshot *) data;
+  object_zero_and_free_if_nonnull (
+    snapshot->entries);
+  object_zero_and_free (snapshot);
+}
+
+/**
+ * Publishes a copy of the entries for the
+ * processing threads.
+ */
+static void
+publish (void * owner)
+{
+  RegionIndex * self = (RegionIndex *) owner;
+  RegionIndexSnapshot * snapshot =
+    object_new (RegionIndexSnapshot);
+  if (self->num_entries > 0)
+    {
+      snapshot->entries = object_new_n (
+        (size_t) self->num_entries,
+        RegionIndexEntry);
+      memcpy (
+        snapshot->entries, self->entries,
+        (size_t) self->num_entries
+          * sizeof (RegionIndexEntry));
+    }
+  snapshot->num_entries = self->num_entries;
+
+  snapshot_publisher_publish (
+    &self->publisher, snapshot, free_snapshot);
+}
+
+/**
+ * Publishes the entries now, or at the end of the
+ * current batch.
+ */
+static void
+entries_changed (RegionIndex * self)
+{
+  snapshot_publisher_changed (
+    &self->publisher, publish, self);
+}
+
+void
+region_index_add (
+  RegionIndex * self,
+  ZRegion *     region)
+{
+  g_return_if_fail (
+    find_region (self, region) < 0);
+
+  insert_entry (self, region);
+  entries_changed (self);
+}
+
+bool
+region_index_remove (
+  RegionIndex * self,
+  ZRegion *     region)
+{
+  int idx = find_region (self, region);
+  if (idx < 0)
+    return false;
+
+  remove_entry (self, idx);
+  entries_changed (self);
+  return true;
+}
+
+void
+region_index_update (
+  RegionIndex * self,
+  ZRegion *     region)
+{
+  int idx = find_region (self, region);
+  if (idx < 0)
+    return;
+
+  const ArrangerObject * r_obj =
+    (const ArrangerObject *) region;
+  RegionIndexEntry * entry = &self->entries[idx];
+  if (
+    entry->start == r_obj->pos.frames
+    && entry->end == r_obj->end_pos.frames)
+    return;
+
+  /* update in place if the order is kept */
+  if (
+    (idx == 0
+     || self->entries[idx - 1].start
+          <= r_obj->pos.frames)
+    && (idx == self->num_entries - 1
+        || self->entries[idx + 1].start
+             >= r_obj->pos.frames))
+    {
+      entry->start = r_obj->pos.frames;
+      entry->end = r_obj->end_pos.frames;
+      update_max_ends (self, idx);
+    }
+  else
+    {
+      remove_entry (self, idx);
+      insert_entry (self, region);
+    }
+  entries_changed (self);
+}
+
+static int
+cmp_entries (const void * a, const void * b)
+{
+  const RegionIndexEntry * entry_a =
+    (const RegionIndexEntry *) a;
+  const RegionIndexEntry * entry_b =
+    (const RegionIndexEntry *) b;
+  return (entry_a->start > entry_b->start)
+         - (entry_a->start < entry_b->start);
+}
+
+void
+region_index_rebuild (
+  RegionIndex *     self,
+  ZRegion * const * regions,
+  int               num_regions)
+{
+  g_return_if_fail (self);
+
+  self->num_entries = 0;
+  for (int i = 0; i < num_regions; i++)
+    {
+      const ArrangerObject * r_obj =
+        (const ArrangerObject *) regions[i];
+      array_double_size_if_full (
+        self->entries, self->num_entries,
+        self->entries_size, RegionIndexEntry);
+      self->entries[self->num_entries++] =
+        (RegionIndexEntry){
+          .region = regions[i],
+          .start = r_obj->pos.frames,
+          .end = r_obj->end_pos.frames,
+        };
+    }
+  if (self->num_entries > 1)
+    {
+      qsort (
+        self->entries, (size_t) self->num_entries,
+        sizeof (RegionIndexEntry), cmp_entries);
+    }
+  update_max_ends (self, 0);
+  entries_changed (self);
+  g_atomic_int_set (&self->cursor, 0);
+}
+
+const RegionIndexSnapshot *
+region_index_acquire (RegionIndex * self)
+{
+  return snapshot_publisher_acquire (
+    &self->publisher);
+}
+
+void
+region_index_release (RegionIndex * self)
+{
+  snapshot_publisher_release (&self->publisher);
+}
+
+int
+region_index_find_first (
+  RegionIndex *               self,
+  const RegionIndexSnapshot * snapshot,
+  const signed_frame_t        frame)
+{
+  const RegionIndexEntry * entries =
+    snapshot->entries;
+  const int num_entries = snapshot->num_entries;
+
+  /* the highest ends are sorted, so look for the
+   * first one that reaches the frame */
+  int lo = 0;
+  int hi = num_entries;
+
+  /* continue from the last lookup if going
+   * forward, which is the case during playback */
+  int cursor = g_atomic_int_get (&self->cursor);
+  if (
+    cursor > 0 && cursor <= num_entries
+    && entries[cursor - 1].max_end < frame)
+    {
+      lo = cursor;
+      int steps_end =
+        MIN (lo + CURSOR_MAX_STEPS, num_entries);
+      while (
+        lo < steps_end
+        && entries[lo].max_end < frame)
+        {
+          lo++;
+        }
+      if (lo < steps_end)
+        hi = lo;
+    }
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (entries[mid].max_end < frame)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  g_atomic_int_set (&self->cursor, lo);
+
+  return lo;
+}
+
+void
+region_index_clear (RegionIndex * self)
+{
+  snapshot_publisher_clear (
+    &self->publisher, free_snapshot);
+
+  object_zero_and_free_if_nonnull (self->entries);
+  self->num_entries = 0;
+  self->entries_size = 0;
+  g_atomic_int_set (&self->cursor, 0);
+}
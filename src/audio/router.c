@@ -37,6 +37,7 @@
 
 #include "zrythm-config.h"
 
+#include "audio/anticipative_renderer.h"
 #include "audio/audio_track.h"
 #include "audio/control_port.h"
 #include "audio/engine.h"
@@ -116,6 +117,18 @@ router_start_cycle (
       return;
     }
 
+  /* swap in the latest compiled graph, if any */
+  graph_publish_pending (self->graph);
+
+  /* switch between rendering tracks ahead and
+   * processing them live */
+  if (self->graph->anticipative)
+    {
+      anticipative_renderer_begin_cycle (
+        self->graph->anticipative,
+        self->graph->compiled, time_nfo);
+    }
+
   self->global_offset =
     self->max_route_playback_latency
     - AUDIO_ENGINE->remaining_latency_preroll;
@@ -152,20 +165,21 @@ router_start_cycle (
     }
 
   /* process tempo track ports first */
-  if (self->graph->bpm_node)
+  CompiledGraph * compiled = self->graph->compiled;
+  if (compiled->bpm_node)
     {
       graph_node_process (
-        self->graph->bpm_node, time_nfo);
+        compiled->bpm_node, time_nfo);
     }
-  if (self->graph->beats_per_bar_node)
+  if (compiled->beats_per_bar_node)
     {
       graph_node_process (
-        self->graph->beats_per_bar_node, time_nfo);
+        compiled->beats_per_bar_node, time_nfo);
     }
-  if (self->graph->beat_unit_node)
+  if (compiled->beat_unit_node)
     {
       graph_node_process (
-        self->graph->beat_unit_node, time_nfo);
+        compiled->beat_unit_node, time_nfo);
     }
 
   self->callback_in_progress = true;
@@ -205,17 +219,10 @@ router_recalc_graph (Router * self, bool soft)
     }
   else
     {
-      int running =
-        g_atomic_int_get (&AUDIO_ENGINE->run);
-      g_atomic_int_set (&AUDIO_ENGINE->run, 0);
-      while (g_atomic_int_get (
-        &AUDIO_ENGINE->cycle_running))
-        {
-          g_usleep (100);
-        }
+      /* the new graph is compiled while the
+       * engine keeps running and is swapped in at
+       * the start of the next cycle */
       graph_setup (self->graph, 1, 1);
-      g_atomic_int_set (
-        &AUDIO_ENGINE->run, (guint) running);
     }
 
   g_message ("done");
@@ -309,6 +316,10 @@ router_is_processing_thread (
       self->graph->main_thread->pthread))
     return true;
 
+  if (anticipative_renderer_is_current_thread (
+        self->graph->anticipative))
+    return true;
+
   return false;
 }
 
@@ -5,6 +5,7 @@
 
 #include "actions/tracklist_selections.h"
 #include "actions/undo_manager.h"
+#include "audio/anticipative_renderer.h"
 #include "audio/audio_bus_track.h"
 #include "audio/audio_group_track.h"
 #include "audio/audio_region.h"
@@ -782,6 +783,9 @@ track_set_monitor_audio (
   control_port_set_toggled (
     self->processor->monitor_audio, monitor,
     fire_events);
+
+  anticipative_renderer_on_track_live_changed (
+    self);
 }
 
 TrackType
@@ -838,6 +842,9 @@ track_set_recording (
     track->recording, recording,
     F_NO_PUBLISH_EVENTS);
 
+  anticipative_renderer_on_track_live_changed (
+    track);
+
   if (recording)
     {
       g_message (
@@ -2785,8 +2792,10 @@ track_update_positions (
  * @param stereo_ports StereoPorts to fill.
  * @param midi_events MidiEvents to fill (from
  *   Piano Roll Port for example).
+ *
+ * @return Whether any region was filled in.
  */
-void
+bool
 track_fill_events (
   const Track *                       self,
   const EngineProcessTimeInfo * const time_nfo,
@@ -2796,14 +2805,29 @@ track_fill_events (
   if (
     !track_is_auditioner (self)
     && !TRANSPORT_IS_ROLLING)
-    return;
+    return false;
 
   const unsigned_frame_t g_end_frames =
     time_nfo->g_start_frame + time_nfo->nframes;
 
+  /* range the regions must be hit by (inclusive) */
+  const signed_frame_t range_start =
+    (signed_frame_t) time_nfo->g_start_frame;
+  const signed_frame_t range_end =
+    (signed_frame_t) (midi_events
+                        ? g_end_frames
+                        : (g_end_frames - 1));
+
+  /* start of each sorted run of MIDI events,
+   * starting with the events already queued */
+  int run_starts[MIDI_EVENTS_MAX_RUNS];
+  int num_runs = 0;
   if (midi_events)
     {
       zix_sem_wait (&midi_events->access_sem);
+      midi_events_sort_run (
+        midi_events, 0, F_QUEUED);
+      run_starts[num_runs++] = 0;
     }
 
 #if 0
@@ -2815,6 +2839,7 @@ track_fill_events (
 #endif
 
   TrackType tt = self->type;
+  bool      filled = false;
 
   /* go through each lane */
   const int num_loops =
@@ -2825,23 +2850,56 @@ track_fill_events (
       if (tt != TRACK_TYPE_CHORD)
         {
           lane = self->lanes[j];
-          g_return_if_fail (lane);
+          g_return_val_if_fail (lane, filled);
         }
 
-      /* go through each region */
+      /* go through each region that may be hit
+       * (lanes are indexed by region position) */
+      RegionIndex * index =
+        lane ? &lane->region_index : NULL;
+      const RegionIndexSnapshot * snapshot =
+        index ? region_index_acquire (index) : NULL;
       const int num_regions =
         (tt == TRACK_TYPE_CHORD
            ? self->num_chord_regions
-           : lane->num_regions);
-      for (int i = 0; i < num_regions; i++)
+           : (snapshot ? snapshot->num_entries : 0));
+      const int first_region =
+        snapshot
+          ? region_index_find_first (
+            index, snapshot, range_start)
+          : 0;
+      for (int i = first_region; i < num_regions;
+           i++)
         {
-          ZRegion * r =
-            tt == TRACK_TYPE_CHORD
-              ? self->chord_regions[i]
-              : lane->regions[i];
+          ZRegion * r;
+          if (snapshot)
+            {
+              const RegionIndexEntry * entry =
+                &snapshot->entries[i];
+
+              /* the rest start after the range */
+              if (entry->start > range_end)
+                break;
+
+              if (entry->end < range_start)
+                continue;
+
+              r = entry->region;
+            }
+          else
+            {
+              r = self->chord_regions[i];
+            }
           ArrangerObject * r_obj =
             (ArrangerObject *) r;
-          g_return_if_fail (IS_REGION (r));
+
+          /* don't return early while reading the
+           * index */
+          if (!IS_REGION (r))
+            {
+              g_warn_if_reached ();
+              continue;
+            }
 
           /* skip region if muted */
           if (arranger_object_get_muted (
@@ -2863,15 +2921,14 @@ track_fill_events (
            * (inclusive of its last point) */
           if (
             !region_is_hit_by_range (
-              r,
-              (signed_frame_t)
-                time_nfo->g_start_frame,
-              (signed_frame_t) (midi_events ? g_end_frames : (g_end_frames - 1)),
+              r, range_start, range_end,
               F_INCLUSIVE))
             {
               continue;
             }
 
+          filled = true;
+
           signed_frame_t num_frames_to_process = MIN (
             r_obj->end_pos.frames
               - (signed_frame_t)
@@ -2943,9 +3000,31 @@ track_fill_events (
 
               if (midi_events)
                 {
+                  if (num_runs == MIDI_EVENTS_MAX_RUNS)
+                    {
+                      midi_events_merge_runs (
+                        midi_events, run_starts,
+                        num_runs, F_QUEUED);
+                      num_runs = 1;
+                    }
+
+                  /* events from each call are a
+                   * separate run */
+                  int run_start =
+                    midi_events->num_queued_events;
                   midi_region_fill_midi_events (
                     r, &nfo, need_note_off,
                     midi_events);
+                  if (
+                    midi_events->num_queued_events
+                    > run_start)
+                    {
+                      midi_events_sort_run (
+                        midi_events, run_start,
+                        F_QUEUED);
+                      run_starts[num_runs++] =
+                        run_start;
+                    }
                 }
               else if (stereo_ports)
                 {
@@ -2959,6 +3038,9 @@ track_fill_events (
                 cur_num_frames_till_next_r_loop_or_end;
             } /* end while frames left */
         }
+
+      if (index)
+        region_index_release (index);
     }
 
 #if 0
@@ -2967,14 +3049,15 @@ track_fill_events (
 
   if (midi_events)
     {
-      midi_events_clear_duplicates (
-        midi_events, F_QUEUED);
-
-      /* sort events */
-      midi_events_sort (midi_events, F_QUEUED);
+      /* merge the runs into sorted events without
+       * duplicates */
+      midi_events_merge_runs (
+        midi_events, run_starts, num_runs, F_QUEUED);
 
       zix_sem_post (&midi_events->access_sem);
     }
+
+  return filled;
 }
 
 /**
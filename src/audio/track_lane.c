@@ -62,6 +62,10 @@ track_lane_init_loaded (
       region_set_lane (region, self);
       arranger_object_init_loaded (r_obj);
     }
+
+  region_index_rebuild (
+    &self->region_index, self->regions,
+    self->num_regions);
 }
 
 /**
@@ -272,6 +276,11 @@ track_lane_update_positions (
       arranger_object_update_positions (
         r_obj, from_ticks, bpm_change);
     }
+
+  /* the frames of the regions may have changed */
+  region_index_rebuild (
+    &self->region_index, self->regions,
+    self->num_regions);
 }
 
 /**
@@ -318,6 +327,8 @@ track_lane_insert_region (
   region->id.idx = idx;
   region_update_identifier (region);
 
+  region_index_add (&self->region_index, region);
+
   if (region->id.type == REGION_TYPE_AUDIO)
     {
       AudioClip * clip =
@@ -390,6 +401,10 @@ track_lane_clone (
         new_region, region->name, NULL, NULL);
     }
 
+  region_index_rebuild (
+    &self->region_index, self->regions,
+    self->num_regions);
+
   return self;
 }
 
@@ -478,6 +493,8 @@ track_lane_remove_region (
     deleted);
   g_return_if_fail (deleted);
 
+  region_index_remove (&self->region_index, region);
+
   for (int i = region->id.idx;
        i < self->num_regions; i++)
     {
@@ -627,6 +644,7 @@ track_lane_free (TrackLane * self)
     }
 
   object_zero_and_free_if_nonnull (self->regions);
+  region_index_clear (&self->region_index);
 
   /* FIXME this is bad design - this object should
    * not care about widgets */
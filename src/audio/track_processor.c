@@ -901,14 +901,23 @@ track_processor_process (
   /* if frozen or disabled, skip */
   if (tr->frozen || !track_is_enabled (tr))
     {
+      if (self->stereo_out)
+        {
+          stereo_ports_mark_silent (
+            self->stereo_out, local_offset, true);
+        }
       return;
     }
 
+  /* whether nothing was written to stereo out */
+  bool out_silent = true;
+
   /* set the audio clip contents to stereo out */
   if (tr->type == TRACK_TYPE_AUDIO)
     {
-      track_fill_events (
-        tr, time_nfo, NULL, self->stereo_out);
+      if (track_fill_events (
+            tr, time_nfo, NULL, self->stereo_out))
+        out_silent = false;
     }
 
   /* set the piano roll contents to midi out */
@@ -1033,48 +1042,39 @@ track_processor_process (
   switch (tr->in_signal_type)
     {
     case TYPE_AUDIO:
+      /* mixing in silence is a no-op */
+      if (stereo_ports_is_silent (self->stereo_in))
+        break;
+
       if (tr->type != TRACK_TYPE_AUDIO ||
           (tr->type == TRACK_TYPE_AUDIO &&
              control_port_is_toggled (
                self->monitor_audio)))
         {
-          dsp_mix2 (
+          out_silent = false;
+          float * dests[] = {
             &self->stereo_out->l->buf[local_offset],
+            &self->stereo_out->r->buf[local_offset],
+          };
+          bool mono =
+            self->mono
+            && control_port_is_toggled (self->mono);
+          const float * srcs[] = {
             &self->stereo_in->l->buf[local_offset],
-            1.f,
+            mono
+              ? &self->stereo_in->l->buf[local_offset]
+              : &self->stereo_in->r
+                   ->buf[local_offset],
+          };
+          smoothed_value_set_gain (
+            &self->smoothed_input_gain,
             self->input_gain
               ? self->input_gain->control
               : 1.f,
-            nframes);
-
-          if (
-            self->mono
-            && control_port_is_toggled (self->mono))
-            {
-              dsp_mix2 (
-                &self->stereo_out->r
-                   ->buf[local_offset],
-                &self->stereo_in->l
-                   ->buf[local_offset],
-                1.f,
-                self->input_gain
-                  ? self->input_gain->control
-                  : 1.f,
-                nframes);
-            }
-          else
-            {
-              dsp_mix2 (
-                &self->stereo_out->r
-                   ->buf[local_offset],
-                &self->stereo_in->r
-                   ->buf[local_offset],
-                1.f,
-                self->input_gain
-                  ? self->input_gain->control
-                  : 1.f,
-                nframes);
-            }
+            AUDIO_ENGINE->sample_rate);
+          smoothed_value_mix (
+            &self->smoothed_input_gain, dests, srcs,
+            2, nframes);
         }
       break;
     case TYPE_EVENT:
@@ -1137,12 +1137,31 @@ track_processor_process (
   /* apply output gain */
   if (tr->type == TRACK_TYPE_AUDIO)
     {
-      dsp_mul_k2 (
-        &self->stereo_out->l->buf[local_offset],
-        self->output_gain->control, nframes);
-      dsp_mul_k2 (
-        &self->stereo_out->r->buf[local_offset],
-        self->output_gain->control, nframes);
+      smoothed_value_set_gain (
+        &self->smoothed_output_gain,
+        self->output_gain->control,
+        AUDIO_ENGINE->sample_rate);
+      if (out_silent)
+        {
+          smoothed_value_skip (
+            &self->smoothed_output_gain, nframes);
+        }
+      else
+        {
+          float * bufs[] = {
+            &self->stereo_out->l->buf[local_offset],
+            &self->stereo_out->r->buf[local_offset],
+          };
+          smoothed_value_apply (
+            &self->smoothed_output_gain, bufs, 2,
+            nframes);
+        }
+    }
+
+  if (self->stereo_out)
+    {
+      stereo_ports_mark_silent (
+        self->stereo_out, local_offset, out_silent);
     }
 
 #undef g_start_frames
@@ -3,11 +3,14 @@
 
 #include "zrythm-config.h"
 
+#include "audio/anticipative_renderer.h"
 #include "audio/audio_region.h"
 #include "audio/engine.h"
+#include "audio/graph.h"
 #include "audio/marker.h"
 #include "audio/marker_track.h"
 #include "audio/midi_event.h"
+#include "audio/router.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "gui/backend/event.h"
@@ -798,6 +801,16 @@ transport_update_positions (
     &self->punch_in_pos, update_from_ticks);
   position_update (
     &self->punch_out_pos, update_from_ticks);
+
+  /* the loop points or the tempo may have
+   * changed */
+  if (
+    PROJECT && AUDIO_ENGINE && ROUTER
+    && ROUTER->graph)
+    {
+      anticipative_renderer_invalidate (
+        ROUTER->graph->anticipative);
+    }
 }
 
 #define GATHER_MARKERS \
@@ -920,6 +933,14 @@ transport_set_loop (
 
   self->loop = enabled;
 
+  if (
+    PROJECT && AUDIO_ENGINE && ROUTER
+    && ROUTER->graph)
+    {
+      anticipative_renderer_invalidate (
+        ROUTER->graph->anticipative);
+    }
+
   if (!ZRYTHM_TESTING)
     {
       g_settings_set_boolean (
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <string.h>
+
+#include "audio/true_peak_detector.h"
+#include "utils/dsp.h"
+
+#include <glib.h>
+
+#define HISTORY_SIZE (DSP_TRUE_PEAK_TAPS - 1)
+
+/**
+ * Forgets the previous samples.
+ */
+void
+true_peak_detector_reset (TruePeakDetector * self)
+{
+  memset (self->history, 0, sizeof (self->history));
+}
+
+/**
+ * Returns the true peak of the given samples,
+ * which continue the ones of the previous call.
+ */
+float
+true_peak_detector_process (
+  TruePeakDetector * self,
+  const float *      buf,
+  nframes_t          nframes)
+{
+  /* the first samples are interpolated with the
+   * history, so they are processed from a small
+   * copy */
+  float  head[HISTORY_SIZE * 2];
+  size_t num_head = MIN (nframes, HISTORY_SIZE);
+  memcpy (head, self->history, sizeof (self->history));
+  memcpy (
+    &head[HISTORY_SIZE], buf,
+    num_head * sizeof (float));
+  float ret =
+    dsp_true_peak (head, HISTORY_SIZE + num_head);
+
+  /* and the rest in place */
+  if (nframes > HISTORY_SIZE)
+    {
+      ret = MAX (ret, dsp_true_peak (buf, nframes));
+    }
+
+  /* remember the last samples */
+  if (nframes >= HISTORY_SIZE)
+    {
+      memcpy (
+        self->history, &buf[nframes - HISTORY_SIZE],
+        sizeof (self->history));
+    }
+  else
+    {
+      memcpy (
+        self->history, &head[nframes],
+        sizeof (self->history));
+    }
+
+  return ret;
+}
@@ -253,5 +253,6 @@ void
 true_peak_dsp_free (TruePeakDsp * self)
 {
   zita_resampler_free (self->src);
-  free (self->buf);
+  g_free (self->buf);
+  free (self);
 }
@@ -6,6 +6,7 @@
 #include "audio/audio_region.h"
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
+#include "audio/automation_track.h"
 #include "audio/chord_region.h"
 #include "audio/chord_track.h"
 #include "audio/marker_track.h"
@@ -223,6 +224,24 @@ arranger_object_get_num_loops (
   return i;
 }
 
+/**
+ * Invalidates the cached automation reads if the
+ * object is an automation region or point.
+ */
+static void
+bump_automation_edit_generation (
+  const ArrangerObject * self)
+{
+  if (
+    self->type == TYPE (AUTOMATION_POINT)
+    || (self->type == TYPE (REGION)
+        && ((const ZRegion *) self)->id.type
+             == REGION_TYPE_AUTOMATION))
+    {
+      automation_track_bump_edit_generation ();
+    }
+}
+
 static void
 set_to_region_object (ZRegion * src, ZRegion * dest)
 {
@@ -357,10 +376,13 @@ arranger_object_set_to_object (
     case TYPE (REGION):
       set_to_region_object (
         (ZRegion *) src, (ZRegion *) dest);
+      region_update_lane_index ((ZRegion *) dest);
       break;
     case TYPE (MIDI_NOTE):
       set_to_midi_note_object (
         (MidiNote *) src, (MidiNote *) dest);
+      midi_note_update_event_table (
+        (MidiNote *) dest);
       break;
     case TYPE (CHORD_OBJECT):
       {
@@ -382,6 +404,8 @@ arranger_object_set_to_object (
     default:
       break;
     }
+
+  bump_automation_edit_generation (dest);
 }
 
 /**
@@ -744,6 +768,22 @@ arranger_object_set_position (
   pos_ptr = get_position_ptr (self, pos_type);
   g_return_if_fail (pos_ptr);
   position_set_to_pos (pos_ptr, pos);
+  bump_automation_edit_generation (self);
+
+  if (
+    pos_type == ARRANGER_OBJECT_POSITION_TYPE_START
+    || pos_type == ARRANGER_OBJECT_POSITION_TYPE_END)
+    {
+      if (self->type == TYPE (REGION))
+        {
+          region_update_lane_index ((ZRegion *) self);
+        }
+      else if (self->type == TYPE (MIDI_NOTE))
+        {
+          midi_note_update_event_table (
+            (MidiNote *) self);
+        }
+    }
 }
 
 /**
@@ -1116,6 +1156,9 @@ init_loaded_region (ZRegion * self)
           }
         self->midi_notes_size =
           (size_t) self->num_midi_notes;
+        midi_event_table_rebuild (
+          &self->midi_event_table, self->midi_notes,
+          self->num_midi_notes);
       }
       break;
     case REGION_TYPE_CHORD:
@@ -1242,6 +1285,8 @@ arranger_object_update_positions (
         &self->fade_out_pos, from_ticks);
     }
 
+  bump_automation_edit_generation (self);
+
   ZRegion * r;
   switch (self->type)
     {
@@ -1315,6 +1360,12 @@ arranger_object_update_positions (
             (ArrangerObject *) r->midi_notes[i],
             from_ticks, bpm_change);
         }
+      if (r->id.type == REGION_TYPE_MIDI)
+        {
+          midi_event_table_rebuild (
+            &r->midi_event_table, r->midi_notes,
+            r->num_midi_notes);
+        }
       for (int i = 0; i < r->num_unended_notes; i++)
         {
           arranger_object_update_positions (
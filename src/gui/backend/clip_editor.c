@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 
+#include "audio/anticipative_renderer.h"
 #include "audio/channel.h"
 #include "audio/router.h"
 #include "audio/track.h"
@@ -63,6 +64,9 @@ clip_editor_set_region (
         NULL);
     }
 
+  Track * prev_track =
+    self->has_region ? self->track : NULL;
+
   /*
    * block until current DSP cycle finishes to
    * avoid potentially sending the events to
@@ -104,6 +108,22 @@ clip_editor_set_region (
         "clip editor region successfully changed");
     }
 
+  /* notes pressed in the editor go to its track,
+   * so that track must be processed live */
+  if (prev_track != self->track)
+    {
+      if (prev_track)
+        {
+          anticipative_renderer_on_track_live_changed (
+            prev_track);
+        }
+      if (self->track)
+        {
+          anticipative_renderer_on_track_live_changed (
+            self->track);
+        }
+    }
+
   if (
     fire_events && ZRYTHM_HAVE_UI && MAIN_WINDOW
     && MW_CLIP_EDITOR)
@@ -62,6 +62,7 @@
 #include "utils/math.h"
 #include "utils/objects.h"
 #include "utils/resources.h"
+#include "utils/snapshot_publisher.h"
 #include "utils/ui.h"
 #include "zrythm.h"
 #include "zrythm_app.h"
@@ -3311,6 +3312,10 @@ drag_update (
 
   self->drag_update_started = true;
 
+  /* publish the region indices and MIDI event
+   * tables once for all the moved objects */
+  snapshot_publisher_begin_batch ();
+
   ArrangerSelections * sel =
     arranger_widget_get_selections (self);
 
@@ -3723,6 +3728,8 @@ drag_update (
   self->last_offset_y = offset_y;
   self->last_adj_ticks_diff = self->adj_ticks_diff;
 
+  snapshot_publisher_end_batch ();
+
   arranger_widget_refresh_cursor (self);
 }
 
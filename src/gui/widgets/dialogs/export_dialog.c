@@ -627,6 +627,19 @@ init_export_info (
         self->audio_dither_switch);
       g_settings_set_boolean (
         s, "dither", info->dither);
+
+      info->normalize_loudness =
+        gtk_switch_get_active (
+          self->audio_normalize_loudness_switch);
+      g_settings_set_boolean (
+        s, "normalize-loudness",
+        info->normalize_loudness);
+      info->loudness_target =
+        (float) gtk_spin_button_get_value (
+          self->audio_loudness_target_spin);
+      g_settings_set_double (
+        s, "loudness-target",
+        (double) info->loudness_target);
     }
 
   if (!is_audio)
@@ -691,6 +704,33 @@ init_export_info (
  * @param audio Whether exporting audio, otherwise
  *   MIDI.
  */
+/**
+ * Appends the loudness of a finished audio export
+ * to the report shown after exporting.
+ *
+ * @param track Track, if this was a stem.
+ */
+static void
+append_loudness_report (
+  GString *              report,
+  const ExportSettings * info,
+  Track *                track)
+{
+  if (
+    info->progress_info.has_error
+    || info->progress_info.cancelled)
+    return;
+
+  if (report->len > 0)
+    g_string_append (report, "\n\n");
+  if (track)
+    g_string_append_printf (
+      report, "%s\n", track->name);
+  char * str = export_loudness_to_str (&info->loudness);
+  g_string_append (report, str);
+  g_free (str);
+}
+
 static void
 on_export (ExportDialogWidget * self, bool audio)
 {
@@ -718,6 +758,9 @@ on_export (ExportDialogWidget * self, bool audio)
   io_mkdir (exports_dir);
   g_free (exports_dir);
 
+  GString * loudness_report =
+    audio ? g_string_new (NULL) : NULL;
+
   if (export_stems)
     {
       /* export each track individually */
@@ -773,6 +816,12 @@ on_export (ExportDialogWidget * self, bool audio)
           exporter_return_connections_post_export (
             &info, conns);
 
+          if (loudness_report)
+            {
+              append_loudness_report (
+                loudness_report, &info, track);
+            }
+
           g_free (info.file_uri);
 
           track->bounce = false;
@@ -826,11 +875,28 @@ on_export (ExportDialogWidget * self, bool audio)
 
       g_thread_join (thread);
 
+      if (loudness_report)
+        {
+          append_loudness_report (
+            loudness_report, &info, NULL);
+        }
+
       g_free (info.file_uri);
 
       g_debug ("~ finished bouncing mixdown ~");
     }
 
+  if (loudness_report)
+    {
+      if (loudness_report->len > 0)
+        {
+          ui_show_message_printf (
+            self, GTK_MESSAGE_INFO, false, "%s",
+            loudness_report->str);
+        }
+      g_string_free (loudness_report, true);
+    }
+
   free (tracks);
 }
 
@@ -1443,6 +1509,27 @@ setup_dither (
   g_free (descr);
 }
 
+static void
+setup_normalize_loudness (
+  AdwActionRow *  normalize_row,
+  GtkSwitch *     normalize_switch,
+  GtkSpinButton * target_spin)
+{
+  gtk_switch_set_active (
+    normalize_switch,
+    g_settings_get_boolean (
+      S_EXPORT_AUDIO, "normalize-loudness"));
+  gtk_spin_button_set_value (
+    target_spin,
+    g_settings_get_double (
+      S_EXPORT_AUDIO, "loudness-target"));
+
+  char * descr = settings_get_description (
+    S_EXPORT_AUDIO, "normalize-loudness");
+  adw_action_row_set_subtitle (normalize_row, descr);
+  g_free (descr);
+}
+
 /**
  * Creates a new export dialog.
  */
@@ -1479,6 +1566,9 @@ export_dialog_widget_class_init (
   BIND_CHILD (audio_bit_depth);
   BIND_CHILD (audio_dither);
   BIND_CHILD (audio_dither_switch);
+  BIND_CHILD (audio_normalize_loudness);
+  BIND_CHILD (audio_normalize_loudness_switch);
+  BIND_CHILD (audio_loudness_target_spin);
   BIND_CHILD (audio_filename_pattern);
   BIND_CHILD (audio_mixdown_or_stems);
   BIND_CHILD (audio_time_range_drop_down);
@@ -1531,6 +1621,10 @@ export_dialog_widget_init (
   setup_audio_formats_dropdown (self->audio_format);
   setup_dither (
     self->audio_dither, self->audio_dither_switch);
+  setup_normalize_loudness (
+    self->audio_normalize_loudness,
+    self->audio_normalize_loudness_switch,
+    self->audio_loudness_target_spin);
   setup_bit_depth_drop_down (self->audio_bit_depth);
   setup_filename_pattern_combo_row (
     self, self->audio_filename_pattern, true);
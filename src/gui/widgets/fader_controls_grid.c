@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: © 2020-2022 Alexandros Theodotou <alex@zrythm.org>
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
+#include "audio/fader.h"
+#include "audio/loudness_analyzer.h"
 #include "audio/meter.h"
 #include "audio/track.h"
 #include "gui/widgets/balance_control.h"
@@ -70,14 +72,29 @@ update_meter_reading (
 
   double peak_val = (double) math_amp_to_dbfs (amp);
 
-  if (math_doubles_equal (peak_val, prev))
+  /* short-term loudness, if analyzed (floored to
+   * keep the values comparable) */
+  LoudnessAnalyzer * analyzer =
+    fader_get_loudness_analyzer (channel->fader);
+  double loudness_val =
+    analyzer
+      ? MAX (
+        (double) loudness_analyzer_get_short_term (
+          analyzer),
+        -99.)
+      : -99.;
+
+  if (
+    math_doubles_equal (peak_val, prev)
+    && math_doubles_equal (
+      loudness_val, widget->loudness_reading_val))
     return G_SOURCE_CONTINUE;
+
+  char str[800];
   if (peak_val < -98.)
-    gtk_label_set_text (
-      widget->meter_readings, "-∞");
+    strcpy (str, "-∞");
   else
     {
-      char str[800];
       strcpy (str, _ ("Peak"));
       strcat (str, ":\n<small>");
       char peak_str[400];
@@ -104,11 +121,46 @@ update_meter_reading (
             }
         }
       strcat (str, peak_str);
-      gtk_label_set_markup (
-        widget->meter_readings, str);
     }
 
+  if (analyzer)
+    {
+      char loudness_str[400];
+      if (loudness_val < -98.)
+        strcpy (loudness_str, "-∞");
+      else
+        sprintf (
+          loudness_str, "%.1f", loudness_val);
+      strcat (str, "\nLUFS:\n<small>");
+      strcat (str, loudness_str);
+      strcat (str, "</small>");
+
+      char * tooltip = g_strdup_printf (
+        _ ("Momentary: %.1f LUFS\n"
+           "Short-term: %.1f LUFS\n"
+           "Integrated: %.1f LUFS\n"
+           "Loudness range: %.1f LU"),
+        (double) loudness_analyzer_get_momentary (
+          analyzer),
+        loudness_val,
+        (double) loudness_analyzer_get_integrated (
+          analyzer),
+        (double) loudness_analyzer_get_range (
+          analyzer));
+      gtk_widget_set_tooltip_text (
+        GTK_WIDGET (widget->meter_readings),
+        tooltip);
+      g_free (tooltip);
+    }
+  else
+    {
+      gtk_widget_set_tooltip_text (
+        GTK_WIDGET (widget->meter_readings), NULL);
+    }
+  gtk_label_set_markup (widget->meter_readings, str);
+
   widget->meter_reading_val = peak_val;
+  widget->loudness_reading_val = loudness_val;
 
   return G_SOURCE_CONTINUE;
 }
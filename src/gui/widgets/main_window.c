@@ -607,6 +607,10 @@ main_window_widget_init (MainWindowWidget * self)
     {
      "toggle-track-passthrough-input",                                    activate_toggle_track_passthrough_input,
      },
+    { "toggle-track-loudness-analysis",
+     activate_toggle_track_loudness_analysis },
+    { "reset-track-loudness",
+     activate_reset_track_loudness },
 
  /* piano roll */
     { "toggle-drum-mode",
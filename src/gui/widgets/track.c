@@ -788,6 +788,36 @@ show_context_menu (
         G_MENU_MODEL (bounce_submenu));
     }
 
+  if (
+    track->out_signal_type == TYPE_AUDIO
+    && track_type_has_channel (track->type))
+    {
+      GMenu * loudness_submenu = g_menu_new ();
+
+      bool analyzed = fader_get_loudness_analyzer (
+                        track_get_fader (track, true))
+                      != NULL;
+      menuitem = z_gtk_create_menu_item (
+        analyzed ? _ ("Stop Analyzing Loudness")
+                 : _ ("Analyze Loudness"),
+        NULL, "app.toggle-track-loudness-analysis");
+      g_menu_append_item (
+        loudness_submenu, menuitem);
+
+      if (analyzed)
+        {
+          menuitem = z_gtk_create_menu_item (
+            _ ("Reset Loudness"), NULL,
+            "app.reset-track-loudness");
+          g_menu_append_item (
+            loudness_submenu, menuitem);
+        }
+
+      g_menu_append_section (
+        menu, _ ("Loudness"),
+        G_MENU_MODEL (loudness_submenu));
+    }
+
   /* add solo/mute/listen */
   if (track_type_has_channel (track->type))
     {
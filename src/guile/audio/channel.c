@@ -21,6 +21,7 @@
 
 #ifndef SNARF_MODE
 #  include "audio/channel.h"
+#  include "audio/loudness_analyzer.h"
 #  include "project.h"
 #endif
 
@@ -77,6 +78,83 @@ SCM_DEFINE (
 }
 #undef FUNC_NAME
 
+SCM_DEFINE (
+  s_channel_set_loudness_analysis_enabled,
+  "channel-set-loudness-analysis-enabled",
+  2,
+  0,
+  0,
+  (SCM channel, SCM enabled),
+  "Sets whether the loudness of the channel output "
+  "is analyzed")
+#define FUNC_NAME s_
+{
+  Channel * ch =
+    (Channel *) scm_to_pointer (channel);
+
+  fader_set_loudness_analysis_enabled (
+    ch->fader, scm_to_bool (enabled));
+
+  return SCM_UNSPECIFIED;
+}
+#undef FUNC_NAME
+
+SCM_DEFINE (
+  s_channel_get_loudness,
+  "channel-get-loudness",
+  1,
+  0,
+  0,
+  (SCM channel),
+  "Returns the momentary, short-term and "
+  "integrated loudness in LUFS and the loudness "
+  "range in LU of the channel output as a list, or "
+  "#f if it is not analyzed")
+#define FUNC_NAME s_
+{
+  Channel * ch =
+    (Channel *) scm_to_pointer (channel);
+
+  LoudnessAnalyzer * analyzer =
+    fader_get_loudness_analyzer (ch->fader);
+  if (!analyzer)
+    return SCM_BOOL_F;
+
+  return scm_list_4 (
+    scm_from_double (
+      loudness_analyzer_get_momentary (analyzer)),
+    scm_from_double (
+      loudness_analyzer_get_short_term (analyzer)),
+    scm_from_double (
+      loudness_analyzer_get_integrated (analyzer)),
+    scm_from_double (
+      loudness_analyzer_get_range (analyzer)));
+}
+#undef FUNC_NAME
+
+SCM_DEFINE (
+  s_channel_reset_loudness,
+  "channel-reset-loudness",
+  1,
+  0,
+  0,
+  (SCM channel),
+  "Restarts the loudness analysis of the channel "
+  "output")
+#define FUNC_NAME s_
+{
+  Channel * ch =
+    (Channel *) scm_to_pointer (channel);
+
+  LoudnessAnalyzer * analyzer =
+    fader_get_loudness_analyzer (ch->fader);
+  if (analyzer)
+    loudness_analyzer_request_reset (analyzer);
+
+  return SCM_UNSPECIFIED;
+}
+#undef FUNC_NAME
+
 static void
 init_module (void * data)
 {
@@ -86,7 +164,10 @@ init_module (void * data)
 
   scm_c_export (
     "channel-get-insert", "channel-get-instrument",
-    "channel-get-send", NULL);
+    "channel-get-send",
+    "channel-set-loudness-analysis-enabled",
+    "channel-get-loudness", "channel-reset-loudness",
+    NULL);
 }
 
 void
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "guile/modules.h"
+
+#ifndef SNARF_MODE
+#  include "audio/graph.h"
+#  include "audio/graph_node.h"
+#  include "project.h"
+#  include "zrythm_app.h"
+#endif
+
+SCM_DEFINE (
+  s_graph_get_num_nodes,
+  "graph-get-num-nodes",
+  1,
+  0,
+  0,
+  (SCM graph),
+  "Returns the number of nodes in the live "
+  "processing graph.")
+#define FUNC_NAME s_
+{
+  Graph * g = (Graph *) scm_to_pointer (graph);
+  g_return_val_if_fail (
+    ZRYTHM_APP_IS_GTK_THREAD, SCM_BOOL_F);
+
+  return scm_from_size_t (
+    g->compiled ? g->compiled->schedule_size : 0);
+}
+#undef FUNC_NAME
+
+/**
+ * Returns the timing stats as an association
+ * list.
+ */
+static SCM
+timing_stats_to_scm (
+  const GraphNodeTimingStats * stats)
+{
+  return scm_list_4 (
+    scm_cons (
+      scm_from_utf8_symbol ("min"),
+      scm_from_double (stats->min)),
+    scm_cons (
+      scm_from_utf8_symbol ("mean"),
+      scm_from_double (stats->mean)),
+    scm_cons (
+      scm_from_utf8_symbol ("p99"),
+      scm_from_double (stats->p99)),
+    scm_cons (
+      scm_from_utf8_symbol ("num-samples"),
+      scm_from_int (stats->num_samples)));
+}
+
+SCM_DEFINE (
+  s_graph_get_node_at,
+  "graph-get-node-at",
+  2,
+  0,
+  0,
+  (SCM graph, SCM idx),
+  "Returns an association list with the name, "
+  "track, plugin and timing stats of the node at "
+  "index @var{idx} in the processing order of "
+  "the graph, or #f if there is no such node.\n"
+  "\n"
+  "The timing stats are an association list with "
+  "the minimum, mean and 99th percentile of the "
+  "recent processing times of the node in "
+  "microseconds, or #f if the node was not "
+  "processed yet.\n"
+  "\n"
+  "This is a copy taken when called, since the "
+  "graph may be replaced at any time. Reading it "
+  "does not block the engine.")
+#define FUNC_NAME s_
+{
+  Graph * g = (Graph *) scm_to_pointer (graph);
+  size_t  i = scm_to_size_t (idx);
+
+  /* graphs are only replaced and reclaimed by
+   * graph_setup() on the GTK thread, so the live
+   * graph stays valid while copying without
+   * blocking the engine (the timings may be
+   * written meanwhile, which only affects the
+   * copied samples) */
+  g_return_val_if_fail (
+    ZRYTHM_APP_IS_GTK_THREAD, SCM_BOOL_F);
+  CompiledGraph * compiled = g->compiled;
+  if (!compiled || i >= compiled->schedule_size)
+    return SCM_BOOL_F;
+
+  GraphNode * n = &compiled->schedule[i];
+  char *      name = graph_node_get_name (n);
+  Track *     track = graph_node_get_track (n);
+  Plugin *    pl = graph_node_get_plugin (n);
+  GraphNodeTimingStats stats;
+  bool                 has_stats =
+    graph_node_get_timing_stats (n, &stats);
+
+  SCM ret = scm_list_4 (
+    scm_cons (
+      scm_from_utf8_symbol ("name"),
+      scm_from_utf8_string (name)),
+    scm_cons (
+      scm_from_utf8_symbol ("track"),
+      track ? scm_from_pointer (track, NULL)
+            : SCM_BOOL_F),
+    scm_cons (
+      scm_from_utf8_symbol ("plugin"),
+      pl ? scm_from_pointer (pl, NULL) : SCM_BOOL_F),
+    scm_cons (
+      scm_from_utf8_symbol ("timing-stats"),
+      has_stats ? timing_stats_to_scm (&stats)
+                : SCM_BOOL_F));
+  g_free (name);
+
+  return ret;
+}
+#undef FUNC_NAME
+
+static void
+init_module (void * data)
+{
+#ifndef SNARF_MODE
+#  include "audio_graph.x"
+#endif
+  scm_c_export (
+    "graph-get-num-nodes", "graph-get-node-at",
+    NULL);
+}
+
+void
+guile_audio_graph_define_module (void)
+{
+  scm_c_define_module (
+    "audio graph", init_module, NULL);
+}
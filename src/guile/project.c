@@ -24,6 +24,7 @@
 #ifndef SNARF_MODE
 #  include "zrythm-config.h"
 
+#  include "audio/router.h"
 #  include "project.h"
 #endif
 
@@ -63,6 +64,25 @@ SCM_DEFINE (
 }
 #undef FUNC_NAME
 
+SCM_DEFINE (
+  s_project_get_graph,
+  "project-get-graph",
+  1,
+  0,
+  0,
+  (SCM project),
+  "Returns the processing graph of the project's "
+  "audio engine.")
+#define FUNC_NAME s_
+{
+  Project * prj =
+    (Project *) scm_to_pointer (project);
+
+  return scm_from_pointer (
+    prj->audio_engine->router->graph, NULL);
+}
+#undef FUNC_NAME
+
 SCM_DEFINE (
   s_project_get_undo_manager,
   "project-get-undo-manager",
@@ -88,7 +108,8 @@ init_module (void * data)
 #endif
   scm_c_export (
     "project-get-title", "project-get-tracklist",
-    "project-get-undo-manager", NULL);
+    "project-get-graph", "project-get-undo-manager",
+    NULL);
 }
 
 void
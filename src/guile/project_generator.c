@@ -17,30 +17,52 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+
+#include "actions/channel_send_action.h"
+#include "actions/mixer_selections_action.h"
+#include "actions/undo_manager.h"
+#include "audio/audio_region.h"
+#include "audio/automation_region.h"
+#include "audio/channel.h"
+#include "audio/clip.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/pool.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
 #include "project.h"
+#include "utils/error.h"
 #include "utils/flags.h"
 #include "utils/io.h"
+#include "utils/objects.h"
 #include "zrythm.h"
 
 #include "guile/guile.h"
 #include "guile/project_generator.h"
 
 /**
- * Generates a Zrythm project from the script
- * contained in @ref script.
+ * Fills in the current project.
  *
- * @param script Script content.
- * @param prj_path Path to save the project at.
+ * @return Whether successful.
+ */
+typedef bool (*ProjectFillFunc) (
+  const void * data,
+  GError **    error);
+
+/**
+ * Creates a default project, fills it in with
+ * @ref fill and saves it at @ref prj_path.
  *
  * @return Non-zero if fail.
  */
-int
-guile_project_generator_generate_project_from_string (
-  const char * script,
-  const char * prj_path)
+static int
+generate_project (
+  const char *    prj_path,
+  ProjectFillFunc fill,
+  const void *    data)
 {
-  g_return_val_if_fail (
-    ZRYTHM && prj_path && script, -1);
+  g_return_val_if_fail (ZRYTHM && prj_path, -1);
 
   bool use_tmp_project = false;
   if (!PROJECT)
@@ -69,14 +91,15 @@ guile_project_generator_generate_project_from_string (
     }
   PROJECT = prj;
 
-  /* run the script to fill in the project */
-  char * markup = (char *) guile_run_script (
-    script, GUILE_SCRIPT_LANGUAGE_SCHEME);
-  g_message ("\nResult:\n%s", markup);
-
-  if (!guile_script_succeeded (markup))
+  /* fill in the project */
+  GError * err = NULL;
+  bool     success = fill (data, &err);
+  if (!success)
     {
-      return -1;
+      g_warning (
+        "Failed to generate project: %s",
+        err ? err->message : "unknown error");
+      g_clear_error (&err);
     }
 
   /* set back the previous project (if any) */
@@ -85,18 +108,69 @@ guile_project_generator_generate_project_from_string (
       PROJECT = prev_prj;
     }
 
-  /* save the project at the given path */
-  project_save (
-    prj, prj_path, false, false, F_NO_ASYNC);
+  if (success)
+    {
+      /* save the project at the given path */
+      project_save (
+        prj, prj_path, false, false, F_NO_ASYNC);
+    }
 
   /* free the instance */
   project_free (prj);
+  if (use_tmp_project)
+    {
+      PROJECT = NULL;
+    }
 
   /* remove temporary path */
   io_rmdir (tmp_path, true);
   g_free (tmp_path);
 
-  return 0;
+  return success ? 0 : -1;
+}
+
+static bool
+fill_from_script (
+  const void * data,
+  GError **    error)
+{
+  const char * script = (const char *) data;
+
+  /* run the script to fill in the project */
+  char * markup = (char *) guile_run_script (
+    script, GUILE_SCRIPT_LANGUAGE_SCHEME);
+  g_message ("\nResult:\n%s", markup);
+
+  bool success = guile_script_succeeded (markup);
+  if (!success)
+    {
+      g_set_error_literal (
+        error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+        "Script failed");
+    }
+  g_free (markup);
+
+  return success;
+}
+
+/**
+ * Generates a Zrythm project from the script
+ * contained in @ref script.
+ *
+ * @param script Script content.
+ * @param prj_path Path to save the project at.
+ *
+ * @return Non-zero if fail.
+ */
+int
+guile_project_generator_generate_project_from_string (
+  const char * script,
+  const char * prj_path)
+{
+  g_return_val_if_fail (script, -1);
+
+  return generate_project (
+    prj_path, fill_from_script, script);
 }
 
 /**
@@ -128,3 +202,354 @@ guile_project_generator_generate_project_from_file (
   return guile_project_generator_generate_project_from_string (
     contents, prj_path);
 }
+
+/**
+ * Initializes the parameters to a project without
+ * tracks, where each track gets 4 lanes of 8
+ * regions of 4 bars, 64 notes per MIDI region and
+ * 256 automation points.
+ */
+void
+guile_project_generator_params_init (
+  ProjectGeneratorParams * params)
+{
+  *params = (ProjectGeneratorParams){
+    .num_lanes = 4,
+    .regions_per_lane = 8,
+    .region_bars = 4,
+    .notes_per_region = 64,
+    .automation_points = 256,
+  };
+}
+
+/**
+ * Creates @ref num_tracks tracks of the given type
+ * at the end of the tracklist.
+ *
+ * @return The first track created, or NULL if
+ *   failed.
+ */
+static Track *
+create_tracks (
+  TrackType             type,
+  const PluginSetting * setting,
+  int                   num_tracks,
+  GError **             error)
+{
+  return track_create_with_action (
+    type, setting, NULL, NULL,
+    TRACKLIST->num_tracks, num_tracks, error);
+}
+
+static void
+add_midi_regions (
+  Track *                        track,
+  const ProjectGeneratorParams * params)
+{
+  unsigned int track_name_hash =
+    track_get_name_hash (track);
+  Position region_len;
+  position_from_bars (
+    &region_len, params->region_bars);
+  double note_ticks =
+    region_len.ticks
+    / MAX (params->notes_per_region, 1);
+
+  for (int lane = 0; lane < params->num_lanes;
+       lane++)
+    {
+      for (int i = 0; i < params->regions_per_lane;
+           i++)
+        {
+          Position start, end;
+          position_from_bars (
+            &start, i * params->region_bars);
+          position_from_bars (
+            &end, (i + 1) * params->region_bars);
+          ZRegion * r = midi_region_new (
+            &start, &end, track_name_hash, lane, i);
+          for (int j = 0;
+               j < params->notes_per_region; j++)
+            {
+              Position note_start, note_end;
+              position_init (&note_start);
+              position_add_ticks (
+                &note_start, j * note_ticks);
+              note_end = note_start;
+              position_add_ticks (
+                &note_end, note_ticks / 2);
+              MidiNote * mn = midi_note_new (
+                &r->id, &note_start, &note_end,
+                (midi_byte_t) (36 + (lane + j) % 48),
+                90);
+              midi_region_add_midi_note (
+                r, mn, F_NO_PUBLISH_EVENTS);
+            }
+          track_add_region (
+            track, r, NULL, lane, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+        }
+    }
+}
+
+static void
+add_audio_regions (
+  Track *                        track,
+  const ProjectGeneratorParams * params,
+  int                            pool_id)
+{
+  unsigned int track_name_hash =
+    track_get_name_hash (track);
+  for (int lane = 0; lane < params->num_lanes;
+       lane++)
+    {
+      for (int i = 0; i < params->regions_per_lane;
+           i++)
+        {
+          Position start;
+          position_from_bars (
+            &start, i * params->region_bars);
+          ZRegion * r = audio_region_new (
+            pool_id, NULL, true, NULL, 0, NULL, 0, 0,
+            &start, track_name_hash, lane, i);
+          track_add_region (
+            track, r, NULL, lane, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+        }
+    }
+}
+
+/**
+ * Adds a region spanning all the other regions to
+ * the fader automation of the track.
+ */
+static void
+add_automation (
+  Track *                        track,
+  const ProjectGeneratorParams * params)
+{
+  AutomationTrack * at =
+    channel_get_automation_track (
+      track->channel, PORT_FLAG_AMPLITUDE);
+  if (!at)
+    return;
+
+  Position start, end;
+  position_init (&start);
+  position_from_bars (
+    &end,
+    MAX (params->regions_per_lane, 1)
+      * params->region_bars);
+  double ap_ticks =
+    end.ticks / params->automation_points;
+
+  ZRegion * r = automation_region_new (
+    &start, &end, track_get_name_hash (track),
+    at->index, 0);
+  track_add_region (
+    track, r, at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  for (int i = 0; i < params->automation_points;
+       i++)
+    {
+      Position pos;
+      position_init (&pos);
+      position_add_ticks (&pos, i * ap_ticks);
+      float             val = (float) (i % 8) / 8.f;
+      AutomationPoint * ap =
+        automation_point_new_float (val, val, &pos);
+      automation_region_add_ap (
+        r, ap, F_NO_PUBLISH_EVENTS);
+    }
+}
+
+/**
+ * Adds a sine clip of the length of a region to
+ * the pool.
+ *
+ * @return The pool ID of the clip.
+ */
+static int
+add_audio_clip (
+  const ProjectGeneratorParams * params)
+{
+  Position region_len;
+  position_from_bars (
+    &region_len, params->region_bars);
+  unsigned_frame_t nframes =
+    (unsigned_frame_t) region_len.frames;
+  float * frames = object_new_n (
+    (size_t) nframes * 2, float);
+  for (unsigned_frame_t i = 0; i < nframes; i++)
+    {
+      frames[i * 2] = 0.5f
+        * sinf (
+          2.f * (float) G_PI * 440.f * (float) i
+          / (float) AUDIO_ENGINE->sample_rate);
+      frames[i * 2 + 1] = frames[i * 2];
+    }
+
+  AudioClip * clip = audio_clip_new_from_float_array (
+    frames, nframes, 2, BIT_DEPTH_16,
+    "Generated sine");
+  free (frames);
+  audio_pool_add_clip (AUDIO_POOL, clip);
+  audio_clip_write_to_pool (
+    clip, F_NO_PARTS, F_NOT_BACKUP);
+
+  return clip->pool_id;
+}
+
+static bool
+fill_from_params (
+  const void * data,
+  GError **    error)
+{
+  const ProjectGeneratorParams * params =
+    (const ProjectGeneratorParams *) data;
+  GError * err = NULL;
+  int      bus_start = TRACKLIST->num_tracks;
+  int      midi_start, instrument_start,
+    audio_start;
+  int pool_id = -1;
+
+  /* create the tracks */
+  if (
+    params->num_audio_busses > 0
+    && !create_tracks (
+      TRACK_TYPE_AUDIO_BUS, NULL,
+      params->num_audio_busses, &err))
+    goto fail;
+  midi_start = TRACKLIST->num_tracks;
+  if (
+    params->num_midi_tracks > 0
+    && !create_tracks (
+      TRACK_TYPE_MIDI, NULL,
+      params->num_midi_tracks, &err))
+    goto fail;
+  instrument_start = TRACKLIST->num_tracks;
+  if (
+    params->num_instrument_tracks > 0
+    && !create_tracks (
+      TRACK_TYPE_INSTRUMENT,
+      params->instrument_setting,
+      params->num_instrument_tracks, &err))
+    goto fail;
+  audio_start = TRACKLIST->num_tracks;
+  if (
+    params->num_audio_tracks > 0
+    && !create_tracks (
+      TRACK_TYPE_AUDIO, NULL,
+      params->num_audio_tracks, &err))
+    goto fail;
+
+  if (
+    params->num_audio_tracks > 0
+    && params->regions_per_lane > 0)
+    {
+      pool_id = add_audio_clip (params);
+    }
+
+  for (int i = bus_start;
+       i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+
+      /* insert chain */
+      if (
+        params->plugins_per_track > 0
+        && (i < midi_start
+            || i >= instrument_start))
+        {
+          if (!mixer_selections_action_perform_create (
+                PLUGIN_SLOT_INSERT,
+                track_get_name_hash (track), 0,
+                params->plugin_setting,
+                MIN (
+                  params->plugins_per_track,
+                  STRIP_SIZE),
+                &err))
+            goto fail;
+        }
+
+      if (i < midi_start)
+        continue;
+
+      /* lanes and regions */
+      if (params->num_lanes > 1)
+        {
+          track_create_missing_lanes (
+            track, params->num_lanes - 1);
+        }
+      if (i < audio_start)
+        {
+          add_midi_regions (track, params);
+        }
+      else if (pool_id >= 0)
+        {
+          add_audio_regions (
+            track, params, pool_id);
+        }
+
+      if (params->automation_points > 0)
+        {
+          add_automation (track, params);
+        }
+
+      /* sends to the busses, round-robin */
+      int num_sends =
+        i >= instrument_start
+            && params->num_audio_busses > 0
+          ? MIN (params->sends_per_track, STRIP_SIZE)
+          : 0;
+      for (int j = 0; j < num_sends; j++)
+        {
+          Track * bus =
+            TRACKLIST->tracks
+              [bus_start
+               + (i + j) % params->num_audio_busses];
+          if (!channel_send_action_perform_connect_audio (
+                track->channel->sends[j],
+                bus->processor->stereo_in, &err))
+            goto fail;
+        }
+    }
+
+  /* the generated objects are not undoable */
+  undo_manager_clear_stacks (UNDO_MANAGER, true);
+
+  return true;
+
+fail:
+  PROPAGATE_PREFIXED_ERROR (
+    error, err, "%s", "Failed to fill in project");
+  return false;
+}
+
+/**
+ * Generates a Zrythm project with the tracks,
+ * regions, automation, sends and plugins given in
+ * @ref params.
+ *
+ * @param prj_path Path to save the project at.
+ *
+ * @return Non-zero if fail.
+ */
+int
+guile_project_generator_generate_project_from_params (
+  const ProjectGeneratorParams * params,
+  const char *                   prj_path)
+{
+  g_return_val_if_fail (params, -1);
+  g_return_val_if_fail (
+    params->plugins_per_track <= 0
+      || params->plugin_setting,
+    -1);
+  g_return_val_if_fail (
+    params->num_instrument_tracks <= 0
+      || params->instrument_setting,
+    -1);
+
+  return generate_project (
+    prj_path, fill_from_params, params);
+}
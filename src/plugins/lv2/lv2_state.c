@@ -341,6 +341,7 @@ set_port_value (
     {
       /* Set value on port struct directly */
       port->control = fvalue;
+      g_atomic_int_inc (&port->control_generation);
     }
   else
     {
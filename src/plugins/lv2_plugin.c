@@ -391,6 +391,11 @@ create_port (
         {
           g_return_val_if_fail (
             IS_PORT_AND_NONNULL (port), NULL);
+          if (port->buf_in_arena)
+            {
+              port->buf = NULL;
+              port->buf_in_arena = false;
+            }
           port->buf = g_realloc (
             port->buf,
             (size_t) AUDIO_ENGINE->block_length
@@ -3435,13 +3440,16 @@ lv2_plugin_process (
           /* let the plugin know if freewheeling */
           if (id->flags & PORT_FLAG_FREEWHEEL)
             {
-              if (AUDIO_ENGINE->exporting)
-                {
-                  port->control = port->maxf;
-                }
-              else
+              float freewheel =
+                AUDIO_ENGINE->exporting
+                  ? port->maxf
+                  : port->minf;
+              if (!math_floats_equal (
+                    port->control, freewheel))
                 {
-                  port->control = port->minf;
+                  port->control = freewheel;
+                  g_atomic_int_inc (
+                    &port->control_generation);
                 }
             }
         }
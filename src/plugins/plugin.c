@@ -1759,6 +1759,99 @@ plugin_prepare_process (Plugin * self)
     }
 }
 
+/**
+ * Returns whether the plugin only receives
+ * silence, in which case it may be skipped after
+ * its tail.
+ *
+ * Plugins without audio inputs or with event/CV
+ * outputs are never considered silent.
+ */
+static bool
+receives_silence (Plugin * self)
+{
+  const PluginDescriptor * descr =
+    self->setting->descr;
+  if (
+    descr->num_audio_ins == 0
+    || descr->num_midi_outs > 0
+    || descr->num_cv_outs > 0)
+    return false;
+
+  for (size_t i = 0; i < self->audio_in_ports->len;
+       i++)
+    {
+      Port * port = g_ptr_array_index (
+        self->audio_in_ports, i);
+      if (!port->is_silent)
+        return false;
+    }
+  for (size_t i = 0; i < self->cv_in_ports->len; i++)
+    {
+      Port * port =
+        g_ptr_array_index (self->cv_in_ports, i);
+      if (!port->is_silent)
+        return false;
+    }
+  for (size_t i = 0; i < self->midi_in_ports->len;
+       i++)
+    {
+      Port * port =
+        g_ptr_array_index (self->midi_in_ports, i);
+      if (port->midi_events->num_events > 0)
+        return false;
+    }
+
+  /* a control change may produce sound (e.g.,
+   * triggers) - the generations only increase so
+   * changes can't cancel out in the sum */
+  guint ctrls_generation = 0;
+  for (size_t i = 0; i < self->ctrl_in_ports->len;
+       i++)
+    {
+      Port * port = g_ptr_array_index (
+        self->ctrl_in_ports, i);
+      ctrls_generation += (guint) g_atomic_int_get (
+        &port->control_generation);
+    }
+  if (
+    ctrls_generation
+    != self->silent_ctrls_generation)
+    {
+      self->silent_ctrls_generation =
+        ctrls_generation;
+      return false;
+    }
+
+  return true;
+}
+
+/**
+ * Returns whether all audio outputs are silent in
+ * the given range.
+ */
+static bool
+audio_outputs_are_silent (
+  Plugin *                            self,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  for (int i = 0; i < self->num_out_ports; i++)
+    {
+      Port * port = self->out_ports[i];
+      if (port->id.type != TYPE_AUDIO)
+        continue;
+
+      if (
+        dsp_abs_max (
+          &port->buf[time_nfo->local_offset],
+          time_nfo->nframes)
+        > 0.0000001f)
+        return false;
+    }
+
+  return true;
+}
+
 /**
  * Process plugin.
  */
@@ -1780,6 +1873,32 @@ plugin_process (
       return;
     }
 
+  /* skip processing if the inputs are silent and
+   * the tail was already played (the outputs were
+   * cleared before the cycle) */
+  const bool in_silent = receives_silence (plugin);
+  if (!in_silent)
+    {
+      plugin->silent_out_frames = 0;
+    }
+  else if (
+    plugin->silent_out_frames
+    >= plugin->latency
+         + AUDIO_ENGINE->sample_rate
+             * PLUGIN_SILENT_TAIL_SECONDS)
+    {
+      for (int i = 0; i < plugin->num_out_ports; i++)
+        {
+          Port * port = plugin->out_ports[i];
+          if (port->id.type == TYPE_AUDIO)
+            {
+              port_mark_silent (
+                port, time_nfo->local_offset, true);
+            }
+        }
+      return;
+    }
+
   /* if has MIDI input port */
   if (plugin->setting->descr->num_midi_ins > 0)
     {
@@ -1828,8 +1947,15 @@ plugin_process (
     }
 
   /* if plugin has gain, apply it */
-  if (!math_floats_equal_epsilon (
-        plugin->gain->control, 1.f, 0.001f))
+  SmoothedValue * gain = &plugin->smoothed_gain;
+  smoothed_value_set_gain (
+    gain, plugin->gain->control,
+    AUDIO_ENGINE->sample_rate);
+  bool gain_settled = smoothed_value_is_settled (gain);
+  if (
+    !gain_settled
+    || !math_floats_equal_epsilon (
+      plugin->gain->control, 1.f, 0.001f))
     {
       for (int i = 0; i < plugin->num_out_ports; i++)
         {
@@ -1837,26 +1963,45 @@ plugin_process (
           if (port->id.type != TYPE_AUDIO)
             continue;
 
+          float * buf =
+            &port->buf[time_nfo->local_offset];
+
           /* if close to 0 set it to the denormal
            * prevention val */
-          if (math_floats_equal_epsilon (
-                plugin->gain->control, 0.f,
-                0.00001f))
+          if (
+            gain_settled
+            && math_floats_equal_epsilon (
+              plugin->gain->control, 0.f, 0.00001f))
             {
               dsp_fill (
-                &port->buf[time_nfo->local_offset],
-                DENORMAL_PREVENTION_VAL,
+                buf, DENORMAL_PREVENTION_VAL,
                 time_nfo->nframes);
             }
-          /* otherwise just apply gain */
+          /* otherwise apply gain (each output gets
+           * the same ramp) */
           else
             {
-              dsp_mul_k2 (
-                &port->buf[time_nfo->local_offset],
-                plugin->gain->control,
-                time_nfo->nframes);
+              SmoothedValue ramp = *gain;
+              smoothed_value_apply (
+                &ramp, &buf, 1, time_nfo->nframes);
             }
         }
+      smoothed_value_skip (gain, time_nfo->nframes);
+    }
+
+  /* measure the tail */
+  if (in_silent)
+    {
+      if (audio_outputs_are_silent (
+            plugin, time_nfo))
+        {
+          plugin->silent_out_frames +=
+            time_nfo->nframes;
+        }
+      else
+        {
+          plugin->silent_out_frames = 0;
+        }
     }
 }
 
@@ -1883,42 +2028,30 @@ plugin_print (Plugin * self, char * buf, size_t buf_sz)
     }
 }
 
-/**
- * Sets caches for processing.
- */
 void
-plugin_set_caches (Plugin * self)
+plugin_get_port_caches (
+  const Plugin * self,
+  GPtrArray *    ctrl_in_ports,
+  GPtrArray *    audio_in_ports,
+  GPtrArray *    cv_in_ports,
+  GPtrArray *    midi_in_ports)
 {
-
-#define PREPARE_ARRAY(arr) \
-  g_ptr_array_remove_range (arr, 0, arr->len)
-
-  PREPARE_ARRAY (self->ctrl_in_ports);
-  PREPARE_ARRAY (self->audio_in_ports);
-  PREPARE_ARRAY (self->cv_in_ports);
-  PREPARE_ARRAY (self->midi_in_ports);
-
-#undef PREPARE_ARRAY
-
   for (int i = 0; i < self->num_in_ports; i++)
     {
       Port * port = self->in_ports[i];
       switch (port->id.type)
         {
         case TYPE_CONTROL:
-          g_ptr_array_add (
-            self->ctrl_in_ports, port);
+          g_ptr_array_add (ctrl_in_ports, port);
           break;
         case TYPE_AUDIO:
-          g_ptr_array_add (
-            self->audio_in_ports, port);
+          g_ptr_array_add (audio_in_ports, port);
           break;
         case TYPE_CV:
-          g_ptr_array_add (self->cv_in_ports, port);
+          g_ptr_array_add (cv_in_ports, port);
           break;
         case TYPE_EVENT:
-          g_ptr_array_add (
-            self->midi_in_ports, port);
+          g_ptr_array_add (midi_in_ports, port);
           break;
         default:
           break;
@@ -1926,6 +2059,28 @@ plugin_set_caches (Plugin * self)
     }
 }
 
+/**
+ * Sets caches for processing.
+ */
+void
+plugin_set_caches (Plugin * self)
+{
+
+#define PREPARE_ARRAY(arr) \
+  g_ptr_array_remove_range (arr, 0, arr->len)
+
+  PREPARE_ARRAY (self->ctrl_in_ports);
+  PREPARE_ARRAY (self->audio_in_ports);
+  PREPARE_ARRAY (self->cv_in_ports);
+  PREPARE_ARRAY (self->midi_in_ports);
+
+#undef PREPARE_ARRAY
+
+  plugin_get_port_caches (
+    self, self->ctrl_in_ports, self->audio_in_ports,
+    self->cv_in_ports, self->midi_in_ports);
+}
+
 /**
  * Shows plugin ui and sets window close callback
  */
@@ -772,6 +772,7 @@ set_lv2_control (
 
       port->control = *(float *) body;
       port->unsnapped_control = *(float *) body;
+      g_atomic_int_inc (&port->control_generation);
     }
   else
     {
@@ -308,7 +308,7 @@ void
 array_sort_float (float * array, int size)
 {
   qsort (
-    array, (size_t) size, sizeof (long),
+    array, (size_t) size, sizeof (float),
     cmp_float_func);
 }
 
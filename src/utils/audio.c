@@ -1,7 +1,17 @@
 // SPDX-FileCopyrightText: © 2019-2022 Alexandros Theodotou <alex@zrythm.org>
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
+/* for sched_getaffinity */
+#define _GNU_SOURCE
+
+#include <errno.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#  include <sched.h>
+#endif
 
 #include "audio/engine.h"
 #include "project.h"
@@ -22,6 +32,7 @@
 #endif
 
 static int num_cores = 0;
+static int num_available_cores = 0;
 
 static const char * bit_depth_pretty_strings[] = {
   __ ("16 bit"),
@@ -441,3 +452,88 @@ audio_get_num_cores ()
 
   return num_cores;
 }
+
+/**
+ * Fills @p cores with the logical CPUs the
+ * process may run on, taking only one of the SMT
+ * siblings of each physical core.
+ *
+ * @return The number of cores written, or 0 if
+ *   not supported on this platform.
+ */
+int
+audio_get_available_cores (
+  int * cores,
+  int   max_cores)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO (&set);
+  if (sched_getaffinity (0, sizeof (set), &set) != 0)
+    {
+      g_warning (
+        "failed to get CPU affinity: %s",
+        strerror (errno));
+      return 0;
+    }
+
+  int num = 0;
+  for (int i = 0; i < CPU_SETSIZE && num < max_cores;
+       i++)
+    {
+      if (!CPU_ISSET (i, &set))
+        continue;
+
+      /* skip SMT siblings of cores already added
+       * (the list starts with the first sibling,
+       * e.g. "0,4" or "0-1") */
+      char path[200];
+      sprintf (
+        path,
+        "/sys/devices/system/cpu/cpu%d/topology/"
+        "thread_siblings_list",
+        i);
+      char * contents = NULL;
+      if (g_file_get_contents (
+            path, &contents, NULL, NULL))
+        {
+          int first_sibling = atoi (contents);
+          g_free (contents);
+          if (
+            first_sibling != i
+            && CPU_ISSET (first_sibling, &set))
+            continue;
+        }
+
+      cores[num++] = i;
+    }
+
+  return num;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Returns the number of physical CPU cores the
+ * process may run on, or audio_get_num_cores() if
+ * this cannot be measured.
+ */
+int
+audio_get_num_available_cores (void)
+{
+  if (num_available_cores > 0)
+    return num_available_cores;
+
+  int cores[1024];
+  num_available_cores = audio_get_available_cores (
+    cores, G_N_ELEMENTS (cores));
+  if (num_available_cores <= 0)
+    return audio_get_num_cores ();
+
+  g_message (
+    "Number of available physical CPU cores: %d",
+    num_available_cores);
+
+  return num_available_cores;
+}
@@ -45,10 +45,7 @@ dsp_fill (float * buf, float val, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = val;
-        }
+      dsp_simd->fill (buf, val, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -69,13 +66,7 @@ dsp_min (float * buf, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          if (buf[i] < min)
-            {
-              min = buf[i];
-            }
-        }
+      min = MIN (min, dsp_simd->min (buf, size));
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -98,13 +89,7 @@ dsp_max (float * buf, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          if (buf[i] > max)
-            {
-              max = buf[i];
-            }
-        }
+      max = MAX (max, dsp_simd->max (buf, size));
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -149,10 +134,7 @@ dsp_add2 (float * dest, const float * src, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] + src[i];
-        }
+      dsp_simd->add2 (dest, src, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -172,10 +154,7 @@ dsp_mul_k2 (float * dest, float k, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] *= k;
-        }
+      dsp_simd->mul_k2 (dest, k, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -203,16 +182,89 @@ dsp_mix_add2 (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] =
-            dest[i] + src1[i] * k1 + src2[i] * k2;
-        }
+      dsp_simd->mix_add2 (
+        dest, src1, src2, k1, k2, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
 }
 
+/** Number of frames summed at a time by
+ * dsp_sum_n(). */
+#define SUM_N_BLOCK_SIZE 64
+
+/**
+ * Sums any number of sources into \p dest in a
+ * single pass:
+ * dst[i] = dst[i] + srcs[0][i] * ks[0] + ...
+ *   + srcs[n - 1][i] * ks[n - 1].
+ *
+ * @param limit Whether to clamp the result.
+ */
+void
+dsp_sum_n (
+  float *               dest,
+  const float * const * srcs,
+  const float *         ks,
+  size_t                num_srcs,
+  bool                  limit,
+  float                 minf,
+  float                 maxf,
+  size_t                size)
+{
+  float acc[SUM_N_BLOCK_SIZE];
+
+  for (size_t offset = 0; offset < size;
+       offset += SUM_N_BLOCK_SIZE)
+    {
+      const size_t len =
+        MIN (SUM_N_BLOCK_SIZE, size - offset);
+      float * d = &dest[offset];
+
+      for (size_t i = 0; i < len; i++)
+        {
+          acc[i] = d[i];
+        }
+
+      /* add two sources per sweep to halve the
+       * accumulator traffic */
+      size_t k = 0;
+      for (; k + 1 < num_srcs; k += 2)
+        {
+          const float * src1 = &srcs[k][offset];
+          const float * src2 = &srcs[k + 1][offset];
+          const float   k1 = ks[k];
+          const float   k2 = ks[k + 1];
+          for (size_t i = 0; i < len; i++)
+            {
+              acc[i] += src1[i] * k1 + src2[i] * k2;
+            }
+        }
+      if (k < num_srcs)
+        {
+          const float * src = &srcs[k][offset];
+          const float   k1 = ks[k];
+          for (size_t i = 0; i < len; i++)
+            {
+              acc[i] += src[i] * k1;
+            }
+        }
+
+      if (limit)
+        {
+          for (size_t i = 0; i < len; i++)
+            {
+              acc[i] = CLAMP (acc[i], minf, maxf);
+            }
+        }
+
+      for (size_t i = 0; i < len; i++)
+        {
+          d[i] = acc[i];
+        }
+    }
+}
+
 /**
  * Calculate linear fade in by multiplying from
  * 0 to 1.
@@ -221,11 +273,7 @@ NONNULL
 void
 dsp_linear_fade_in (float * dest, size_t size)
 {
-  for (size_t i = 0; i < size; i++)
-    {
-      float k = (float) i / (float) size;
-      dest[i] *= k;
-    }
+  dsp_simd->linear_fade (dest, size, true);
 }
 
 /**
@@ -236,11 +284,51 @@ NONNULL
 void
 dsp_linear_fade_out (float * dest, size_t size)
 {
-  for (size_t i = 0; i < size; i++)
-    {
-      float k = (float) (size - i) / (float) size;
-      dest[i] *= k;
-    }
+  dsp_simd->linear_fade (dest, size, false);
+}
+
+/**
+ * Calculate dst[i] = dst[i] * (start + inc * i).
+ *
+ * Used to ramp gain changes.
+ */
+void
+dsp_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  dsp_simd->mul_ramp (dest, start, inc, size);
+}
+
+/**
+ * Calculate
+ * dst[i] = dst[i] + src[i] * (start + inc * i).
+ */
+void
+dsp_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  dsp_simd->mix_ramp (dest, src, start, inc, size);
+}
+
+/**
+ * Returns the true peak (max absolute value of
+ * the signal oversampled 4x) of the samples
+ * after the first DSP_TRUE_PEAK_TAPS - 1, which
+ * are only used as history.
+ *
+ * @see DspSimdFuncs.true_peak.
+ */
+float
+dsp_true_peak (const float * src, size_t size)
+{
+  return dsp_simd->true_peak (src, size);
 }
 
 /**
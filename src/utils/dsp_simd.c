@@ -0,0 +1,1828 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-config.h"
+
+#include <float.h>
+#include <math.h>
+
+#include "utils/dsp_simd.h"
+#include "utils/env.h"
+
+#include <glib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define HAVE_X86_SIMD 1
+#  include <immintrin.h>
+#  define SSE2 __attribute__ ((target ("sse2")))
+#  define AVX2 __attribute__ ((target ("avx2")))
+#  define AVX512 __attribute__ ((target ("avx512f")))
+#elif defined(__aarch64__)
+/* 32-bit ARM has no vector division, so NEON is
+ * only used on AArch64 */
+#  define HAVE_NEON_SIMD 1
+#  include <arm_neon.h>
+#endif
+
+/**
+ * ITU-R BS.1770 interpolation filter for 4x
+ * oversampling, one row per phase.
+ */
+static const float
+  true_peak_coeffs[DSP_TRUE_PEAK_PHASES]
+                  [DSP_TRUE_PEAK_TAPS] = {
+    {
+     0.0017089843750f, 0.0109863281250f,
+     -0.0196533203125f, 0.0332031250000f,
+     -0.0594482421875f, 0.1373291015625f,
+     0.9721679687500f, -0.1022949218750f,
+     0.0476074218750f, -0.0266113281250f,
+     0.0148925781250f, -0.0083007812500f,
+     },
+    {
+     -0.0291748046875f, 0.0292968750000f,
+     -0.0517578125000f, 0.0891113281250f,
+     -0.1665039062500f, 0.4650878906250f,
+     0.7797851562500f, -0.2003173828125f,
+     0.1015625000000f, -0.0582275390625f,
+     0.0330810546875f, -0.0189208984375f,
+     },
+    {
+     -0.0189208984375f, 0.0330810546875f,
+     -0.0582275390625f, 0.1015625000000f,
+     -0.2003173828125f, 0.7797851562500f,
+     0.4650878906250f, -0.1665039062500f,
+     0.0891113281250f, -0.0517578125000f,
+     0.0292968750000f, -0.0291748046875f,
+     },
+    {
+     -0.0083007812500f, 0.0148925781250f,
+     -0.0266113281250f, 0.0476074218750f,
+     -0.1022949218750f, 0.9721679687500f,
+     0.1373291015625f, -0.0594482421875f,
+     0.0332031250000f, -0.0196533203125f,
+     0.0109863281250f, 0.0017089843750f,
+     },
+};
+
+/**
+ * Returns the max absolute value of the samples
+ * interpolated before src[i].
+ *
+ * Also used for the remainders of the vectorized
+ * kernels.
+ */
+static inline float
+true_peak_at (const float * src, size_t i)
+{
+  float ret = 0.f;
+  for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+    {
+      float y = 0.f;
+      for (int j = 0; j < DSP_TRUE_PEAK_TAPS; j++)
+        {
+          y += true_peak_coeffs[k][j] * src[i - (size_t) j];
+        }
+      ret = MAX (ret, fabsf (y));
+    }
+  return ret;
+}
+
+/*
+ * Plain C kernels.
+ *
+ * These are the reference the vectorized kernels
+ * are tested against.
+ */
+
+static void
+scalar_fill (float * buf, float val, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+static void
+scalar_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+static float
+scalar_abs_max (const float * buf, size_t size)
+{
+  float ret = 0.f;
+  for (size_t i = 0; i < size; i++)
+    {
+      ret = MAX (ret, fabsf (buf[i]));
+    }
+  return ret;
+}
+
+static float
+scalar_min (const float * buf, size_t size)
+{
+  float ret = FLT_MAX;
+  for (size_t i = 0; i < size; i++)
+    {
+      ret = MIN (ret, buf[i]);
+    }
+  return ret;
+}
+
+static float
+scalar_max (const float * buf, size_t size)
+{
+  float ret = -FLT_MAX;
+  for (size_t i = 0; i < size; i++)
+    {
+      ret = MAX (ret, buf[i]);
+    }
+  return ret;
+}
+
+static void
+scalar_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+static void
+scalar_mul_k2 (float * dest, float k, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+static void
+scalar_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+static void
+scalar_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+static void
+scalar_linear_fade (
+  float * dest,
+  size_t  size,
+  bool    fade_in)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      float k =
+        (float) (fade_in ? i : size - i)
+        / (float) size;
+      dest[i] *= k;
+    }
+}
+
+static void
+scalar_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= start + inc * (float) i;
+    }
+}
+
+static void
+scalar_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] += src[i] * (start + inc * (float) i);
+    }
+}
+
+static float
+scalar_true_peak (const float * src, size_t size)
+{
+  float ret = 0.f;
+  for (size_t i = DSP_TRUE_PEAK_TAPS - 1; i < size; i++)
+    {
+      ret = MAX (ret, true_peak_at (src, i));
+    }
+  return ret;
+}
+
+static const DspSimdFuncs scalar_funcs = {
+  .level = DSP_SIMD_NONE,
+  .name = "plain C",
+  .fill = scalar_fill,
+  .limit1 = scalar_limit1,
+  .abs_max = scalar_abs_max,
+  .min = scalar_min,
+  .max = scalar_max,
+  .add2 = scalar_add2,
+  .mul_k2 = scalar_mul_k2,
+  .mix2 = scalar_mix2,
+  .mix_add2 = scalar_mix_add2,
+  .linear_fade = scalar_linear_fade,
+  .mul_ramp = scalar_mul_ramp,
+  .mix_ramp = scalar_mix_ramp,
+  .true_peak = scalar_true_peak,
+};
+
+#ifdef HAVE_X86_SIMD
+
+/*
+ * SSE2 kernels (4 floats).
+ */
+
+SSE2 static void
+sse2_fill (float * buf, float val, size_t size)
+{
+  const __m128 v = _mm_set1_ps (val);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      _mm_storeu_ps (&buf[i], v);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+SSE2 static void
+sse2_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  const __m128 vmin = _mm_set1_ps (minf);
+  const __m128 vmax = _mm_set1_ps (maxf);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 x = _mm_loadu_ps (&buf[i]);
+      x = _mm_min_ps (_mm_max_ps (x, vmin), vmax);
+      _mm_storeu_ps (&buf[i], x);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+SSE2 static float
+sse2_abs_max (const float * buf, size_t size)
+{
+  const __m128 mask =
+    _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+  __m128 acc = _mm_setzero_ps ();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = _mm_max_ps (
+        acc, _mm_and_ps (_mm_loadu_ps (&buf[i]), mask));
+    }
+  float lanes[4];
+  _mm_storeu_ps (lanes, acc);
+  float ret = MAX (
+    MAX (lanes[0], lanes[1]), MAX (lanes[2], lanes[3]));
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, fabsf (buf[i]));
+    }
+  return ret;
+}
+
+SSE2 static float
+sse2_min (const float * buf, size_t size)
+{
+  __m128 acc = _mm_set1_ps (FLT_MAX);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = _mm_min_ps (acc, _mm_loadu_ps (&buf[i]));
+    }
+  float lanes[4];
+  _mm_storeu_ps (lanes, acc);
+  float ret = MIN (
+    MIN (lanes[0], lanes[1]), MIN (lanes[2], lanes[3]));
+  for (; i < size; i++)
+    {
+      ret = MIN (ret, buf[i]);
+    }
+  return ret;
+}
+
+SSE2 static float
+sse2_max (const float * buf, size_t size)
+{
+  __m128 acc = _mm_set1_ps (-FLT_MAX);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = _mm_max_ps (acc, _mm_loadu_ps (&buf[i]));
+    }
+  float lanes[4];
+  _mm_storeu_ps (lanes, acc);
+  float ret = MAX (
+    MAX (lanes[0], lanes[1]), MAX (lanes[2], lanes[3]));
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, buf[i]);
+    }
+  return ret;
+}
+
+SSE2 static void
+sse2_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      _mm_storeu_ps (
+        &dest[i],
+        _mm_add_ps (
+          _mm_loadu_ps (&dest[i]),
+          _mm_loadu_ps (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+SSE2 static void
+sse2_mul_k2 (float * dest, float k, size_t size)
+{
+  const __m128 vk = _mm_set1_ps (k);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      _mm_storeu_ps (
+        &dest[i],
+        _mm_mul_ps (_mm_loadu_ps (&dest[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+SSE2 static void
+sse2_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m128 vk1 = _mm_set1_ps (k1);
+  const __m128 vk2 = _mm_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 d =
+        _mm_mul_ps (_mm_loadu_ps (&dest[i]), vk1);
+      __m128 s =
+        _mm_mul_ps (_mm_loadu_ps (&src[i]), vk2);
+      _mm_storeu_ps (&dest[i], _mm_add_ps (d, s));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+SSE2 static void
+sse2_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m128 vk1 = _mm_set1_ps (k1);
+  const __m128 vk2 = _mm_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 d = _mm_add_ps (
+        _mm_loadu_ps (&dest[i]),
+        _mm_mul_ps (_mm_loadu_ps (&src1[i]), vk1));
+      d = _mm_add_ps (
+        d,
+        _mm_mul_ps (_mm_loadu_ps (&src2[i]), vk2));
+      _mm_storeu_ps (&dest[i], d);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+SSE2 static void
+sse2_linear_fade (
+  float * dest,
+  size_t  size,
+  bool    fade_in)
+{
+  const __m128 vsize = _mm_set1_ps ((float) size);
+  const __m128 step = _mm_set1_ps (4.f);
+  __m128       idx = _mm_set_ps (3.f, 2.f, 1.f, 0.f);
+  size_t       i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 num =
+        fade_in ? idx : _mm_sub_ps (vsize, idx);
+      __m128 k = _mm_div_ps (num, vsize);
+      _mm_storeu_ps (
+        &dest[i],
+        _mm_mul_ps (_mm_loadu_ps (&dest[i]), k));
+      idx = _mm_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      float k =
+        (float) (fade_in ? i : size - i)
+        / (float) size;
+      dest[i] *= k;
+    }
+}
+
+SSE2 static void
+sse2_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  const __m128 vstart = _mm_set1_ps (start);
+  const __m128 vinc = _mm_set1_ps (inc);
+  const __m128 step = _mm_set1_ps (4.f);
+  __m128       idx = _mm_set_ps (3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 k =
+        _mm_add_ps (vstart, _mm_mul_ps (vinc, idx));
+      _mm_storeu_ps (
+        &dest[i],
+        _mm_mul_ps (_mm_loadu_ps (&dest[i]), k));
+      idx = _mm_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= start + inc * (float) i;
+    }
+}
+
+SSE2 static void
+sse2_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  const __m128 vstart = _mm_set1_ps (start);
+  const __m128 vinc = _mm_set1_ps (inc);
+  const __m128 step = _mm_set1_ps (4.f);
+  __m128       idx = _mm_set_ps (3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      __m128 k =
+        _mm_add_ps (vstart, _mm_mul_ps (vinc, idx));
+      _mm_storeu_ps (
+        &dest[i],
+        _mm_add_ps (
+          _mm_loadu_ps (&dest[i]),
+          _mm_mul_ps (_mm_loadu_ps (&src[i]), k)));
+      idx = _mm_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] += src[i] * (start + inc * (float) i);
+    }
+}
+
+SSE2 static float
+sse2_true_peak (const float * src, size_t size)
+{
+  const __m128 mask =
+    _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+  __m128 acc = _mm_setzero_ps ();
+  size_t i = DSP_TRUE_PEAK_TAPS - 1;
+  for (; i + 4 <= size; i += 4)
+    {
+      /* each input vector is used by all phases */
+      __m128 y[DSP_TRUE_PEAK_PHASES];
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          y[k] = _mm_setzero_ps ();
+        }
+      for (int j = 0; j < DSP_TRUE_PEAK_TAPS; j++)
+        {
+          __m128 x = _mm_loadu_ps (&src[i - (size_t) j]);
+          for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+            {
+              y[k] = _mm_add_ps (
+                y[k],
+                _mm_mul_ps (
+                  _mm_set1_ps (true_peak_coeffs[k][j]),
+                  x));
+            }
+        }
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          acc = _mm_max_ps (acc, _mm_and_ps (y[k], mask));
+        }
+    }
+  float lanes[4];
+  _mm_storeu_ps (lanes, acc);
+  float ret = MAX (
+    MAX (lanes[0], lanes[1]), MAX (lanes[2], lanes[3]));
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, true_peak_at (src, i));
+    }
+  return ret;
+}
+
+static const DspSimdFuncs sse2_funcs = {
+  .level = DSP_SIMD_SSE2,
+  .name = "SSE2",
+  .fill = sse2_fill,
+  .limit1 = sse2_limit1,
+  .abs_max = sse2_abs_max,
+  .min = sse2_min,
+  .max = sse2_max,
+  .add2 = sse2_add2,
+  .mul_k2 = sse2_mul_k2,
+  .mix2 = sse2_mix2,
+  .mix_add2 = sse2_mix_add2,
+  .linear_fade = sse2_linear_fade,
+  .mul_ramp = sse2_mul_ramp,
+  .mix_ramp = sse2_mix_ramp,
+  .true_peak = sse2_true_peak,
+};
+
+/*
+ * AVX2 kernels (8 floats).
+ *
+ * FMA is not used so that the results match the
+ * plain C kernels.
+ */
+
+AVX2 static void
+avx2_fill (float * buf, float val, size_t size)
+{
+  const __m256 v = _mm256_set1_ps (val);
+  size_t       i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      _mm256_storeu_ps (&buf[i], v);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+AVX2 static void
+avx2_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  const __m256 vmin = _mm256_set1_ps (minf);
+  const __m256 vmax = _mm256_set1_ps (maxf);
+  size_t       i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 x = _mm256_loadu_ps (&buf[i]);
+      x = _mm256_min_ps (_mm256_max_ps (x, vmin), vmax);
+      _mm256_storeu_ps (&buf[i], x);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+/**
+ * Returns the max of the lanes.
+ */
+AVX2 static inline float
+avx2_reduce_max (__m256 v)
+{
+  __m128 m = _mm_max_ps (
+    _mm256_castps256_ps128 (v),
+    _mm256_extractf128_ps (v, 1));
+  m = _mm_max_ps (m, _mm_movehl_ps (m, m));
+  m = _mm_max_ss (m, _mm_shuffle_ps (m, m, 1));
+  return _mm_cvtss_f32 (m);
+}
+
+/**
+ * Returns the min of the lanes.
+ */
+AVX2 static inline float
+avx2_reduce_min (__m256 v)
+{
+  __m128 m = _mm_min_ps (
+    _mm256_castps256_ps128 (v),
+    _mm256_extractf128_ps (v, 1));
+  m = _mm_min_ps (m, _mm_movehl_ps (m, m));
+  m = _mm_min_ss (m, _mm_shuffle_ps (m, m, 1));
+  return _mm_cvtss_f32 (m);
+}
+
+AVX2 static float
+avx2_abs_max (const float * buf, size_t size)
+{
+  const __m256 mask = _mm256_castsi256_ps (
+    _mm256_set1_epi32 (0x7fffffff));
+  __m256 acc = _mm256_setzero_ps ();
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      acc = _mm256_max_ps (
+        acc,
+        _mm256_and_ps (
+          _mm256_loadu_ps (&buf[i]), mask));
+    }
+  float ret = avx2_reduce_max (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, fabsf (buf[i]));
+    }
+  return ret;
+}
+
+AVX2 static float
+avx2_min (const float * buf, size_t size)
+{
+  __m256 acc = _mm256_set1_ps (FLT_MAX);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      acc = _mm256_min_ps (
+        acc, _mm256_loadu_ps (&buf[i]));
+    }
+  float ret = avx2_reduce_min (acc);
+  for (; i < size; i++)
+    {
+      ret = MIN (ret, buf[i]);
+    }
+  return ret;
+}
+
+AVX2 static float
+avx2_max (const float * buf, size_t size)
+{
+  __m256 acc = _mm256_set1_ps (-FLT_MAX);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      acc = _mm256_max_ps (
+        acc, _mm256_loadu_ps (&buf[i]));
+    }
+  float ret = avx2_reduce_max (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, buf[i]);
+    }
+  return ret;
+}
+
+AVX2 static void
+avx2_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      _mm256_storeu_ps (
+        &dest[i],
+        _mm256_add_ps (
+          _mm256_loadu_ps (&dest[i]),
+          _mm256_loadu_ps (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+AVX2 static void
+avx2_mul_k2 (float * dest, float k, size_t size)
+{
+  const __m256 vk = _mm256_set1_ps (k);
+  size_t       i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      _mm256_storeu_ps (
+        &dest[i],
+        _mm256_mul_ps (_mm256_loadu_ps (&dest[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+AVX2 static void
+avx2_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m256 vk1 = _mm256_set1_ps (k1);
+  const __m256 vk2 = _mm256_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 d =
+        _mm256_mul_ps (_mm256_loadu_ps (&dest[i]), vk1);
+      __m256 s =
+        _mm256_mul_ps (_mm256_loadu_ps (&src[i]), vk2);
+      _mm256_storeu_ps (&dest[i], _mm256_add_ps (d, s));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+AVX2 static void
+avx2_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m256 vk1 = _mm256_set1_ps (k1);
+  const __m256 vk2 = _mm256_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 d = _mm256_add_ps (
+        _mm256_loadu_ps (&dest[i]),
+        _mm256_mul_ps (
+          _mm256_loadu_ps (&src1[i]), vk1));
+      d = _mm256_add_ps (
+        d,
+        _mm256_mul_ps (
+          _mm256_loadu_ps (&src2[i]), vk2));
+      _mm256_storeu_ps (&dest[i], d);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+AVX2 static void
+avx2_linear_fade (
+  float * dest,
+  size_t  size,
+  bool    fade_in)
+{
+  const __m256 vsize = _mm256_set1_ps ((float) size);
+  const __m256 step = _mm256_set1_ps (8.f);
+  __m256       idx = _mm256_set_ps (
+    7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 num =
+        fade_in ? idx : _mm256_sub_ps (vsize, idx);
+      __m256 k = _mm256_div_ps (num, vsize);
+      _mm256_storeu_ps (
+        &dest[i],
+        _mm256_mul_ps (_mm256_loadu_ps (&dest[i]), k));
+      idx = _mm256_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      float k =
+        (float) (fade_in ? i : size - i)
+        / (float) size;
+      dest[i] *= k;
+    }
+}
+
+AVX2 static void
+avx2_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  const __m256 vstart = _mm256_set1_ps (start);
+  const __m256 vinc = _mm256_set1_ps (inc);
+  const __m256 step = _mm256_set1_ps (8.f);
+  __m256       idx = _mm256_set_ps (
+    7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 k =
+        _mm256_add_ps (vstart, _mm256_mul_ps (vinc, idx));
+      _mm256_storeu_ps (
+        &dest[i],
+        _mm256_mul_ps (_mm256_loadu_ps (&dest[i]), k));
+      idx = _mm256_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= start + inc * (float) i;
+    }
+}
+
+AVX2 static void
+avx2_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  const __m256 vstart = _mm256_set1_ps (start);
+  const __m256 vinc = _mm256_set1_ps (inc);
+  const __m256 step = _mm256_set1_ps (8.f);
+  __m256       idx = _mm256_set_ps (
+    7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 k =
+        _mm256_add_ps (vstart, _mm256_mul_ps (vinc, idx));
+      _mm256_storeu_ps (
+        &dest[i],
+        _mm256_add_ps (
+          _mm256_loadu_ps (&dest[i]),
+          _mm256_mul_ps (_mm256_loadu_ps (&src[i]), k)));
+      idx = _mm256_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] += src[i] * (start + inc * (float) i);
+    }
+}
+
+AVX2 static float
+avx2_true_peak (const float * src, size_t size)
+{
+  const __m256 mask = _mm256_castsi256_ps (
+    _mm256_set1_epi32 (0x7fffffff));
+  __m256 acc = _mm256_setzero_ps ();
+  size_t i = DSP_TRUE_PEAK_TAPS - 1;
+  for (; i + 8 <= size; i += 8)
+    {
+      __m256 y[DSP_TRUE_PEAK_PHASES];
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          y[k] = _mm256_setzero_ps ();
+        }
+      for (int j = 0; j < DSP_TRUE_PEAK_TAPS; j++)
+        {
+          __m256 x =
+            _mm256_loadu_ps (&src[i - (size_t) j]);
+          for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+            {
+              y[k] = _mm256_add_ps (
+                y[k],
+                _mm256_mul_ps (
+                  _mm256_set1_ps (
+                    true_peak_coeffs[k][j]),
+                  x));
+            }
+        }
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          acc = _mm256_max_ps (
+            acc, _mm256_and_ps (y[k], mask));
+        }
+    }
+  float ret = avx2_reduce_max (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, true_peak_at (src, i));
+    }
+  return ret;
+}
+
+static const DspSimdFuncs avx2_funcs = {
+  .level = DSP_SIMD_AVX2,
+  .name = "AVX2",
+  .fill = avx2_fill,
+  .limit1 = avx2_limit1,
+  .abs_max = avx2_abs_max,
+  .min = avx2_min,
+  .max = avx2_max,
+  .add2 = avx2_add2,
+  .mul_k2 = avx2_mul_k2,
+  .mix2 = avx2_mix2,
+  .mix_add2 = avx2_mix_add2,
+  .linear_fade = avx2_linear_fade,
+  .mul_ramp = avx2_mul_ramp,
+  .mix_ramp = avx2_mix_ramp,
+  .true_peak = avx2_true_peak,
+};
+
+/*
+ * AVX-512 kernels (16 floats).
+ */
+
+AVX512 static void
+avx512_fill (float * buf, float val, size_t size)
+{
+  const __m512 v = _mm512_set1_ps (val);
+  size_t       i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      _mm512_storeu_ps (&buf[i], v);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+AVX512 static void
+avx512_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  const __m512 vmin = _mm512_set1_ps (minf);
+  const __m512 vmax = _mm512_set1_ps (maxf);
+  size_t       i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 x = _mm512_loadu_ps (&buf[i]);
+      x = _mm512_min_ps (_mm512_max_ps (x, vmin), vmax);
+      _mm512_storeu_ps (&buf[i], x);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+AVX512 static float
+avx512_abs_max (const float * buf, size_t size)
+{
+  const __m512i mask = _mm512_set1_epi32 (0x7fffffff);
+  __m512        acc = _mm512_setzero_ps ();
+  size_t        i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      /* AVX-512F has no float AND */
+      __m512i x =
+        _mm512_castps_si512 (_mm512_loadu_ps (&buf[i]));
+      acc = _mm512_max_ps (
+        acc,
+        _mm512_castsi512_ps (
+          _mm512_and_epi32 (x, mask)));
+    }
+  float ret = _mm512_reduce_max_ps (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, fabsf (buf[i]));
+    }
+  return ret;
+}
+
+AVX512 static float
+avx512_min (const float * buf, size_t size)
+{
+  __m512 acc = _mm512_set1_ps (FLT_MAX);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      acc = _mm512_min_ps (
+        acc, _mm512_loadu_ps (&buf[i]));
+    }
+  float ret = _mm512_reduce_min_ps (acc);
+  for (; i < size; i++)
+    {
+      ret = MIN (ret, buf[i]);
+    }
+  return ret;
+}
+
+AVX512 static float
+avx512_max (const float * buf, size_t size)
+{
+  __m512 acc = _mm512_set1_ps (-FLT_MAX);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      acc = _mm512_max_ps (
+        acc, _mm512_loadu_ps (&buf[i]));
+    }
+  float ret = _mm512_reduce_max_ps (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, buf[i]);
+    }
+  return ret;
+}
+
+AVX512 static void
+avx512_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      _mm512_storeu_ps (
+        &dest[i],
+        _mm512_add_ps (
+          _mm512_loadu_ps (&dest[i]),
+          _mm512_loadu_ps (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+AVX512 static void
+avx512_mul_k2 (float * dest, float k, size_t size)
+{
+  const __m512 vk = _mm512_set1_ps (k);
+  size_t       i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      _mm512_storeu_ps (
+        &dest[i],
+        _mm512_mul_ps (_mm512_loadu_ps (&dest[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+AVX512 static void
+avx512_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m512 vk1 = _mm512_set1_ps (k1);
+  const __m512 vk2 = _mm512_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 d =
+        _mm512_mul_ps (_mm512_loadu_ps (&dest[i]), vk1);
+      __m512 s =
+        _mm512_mul_ps (_mm512_loadu_ps (&src[i]), vk2);
+      _mm512_storeu_ps (&dest[i], _mm512_add_ps (d, s));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+AVX512 static void
+avx512_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  const __m512 vk1 = _mm512_set1_ps (k1);
+  const __m512 vk2 = _mm512_set1_ps (k2);
+  size_t       i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 d = _mm512_add_ps (
+        _mm512_loadu_ps (&dest[i]),
+        _mm512_mul_ps (
+          _mm512_loadu_ps (&src1[i]), vk1));
+      d = _mm512_add_ps (
+        d,
+        _mm512_mul_ps (
+          _mm512_loadu_ps (&src2[i]), vk2));
+      _mm512_storeu_ps (&dest[i], d);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+AVX512 static void
+avx512_linear_fade (
+  float * dest,
+  size_t  size,
+  bool    fade_in)
+{
+  const __m512 vsize = _mm512_set1_ps ((float) size);
+  const __m512 step = _mm512_set1_ps (16.f);
+  __m512       idx = _mm512_set_ps (
+    15.f, 14.f, 13.f, 12.f, 11.f, 10.f, 9.f, 8.f, 7.f,
+    6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 num =
+        fade_in ? idx : _mm512_sub_ps (vsize, idx);
+      __m512 k = _mm512_div_ps (num, vsize);
+      _mm512_storeu_ps (
+        &dest[i],
+        _mm512_mul_ps (_mm512_loadu_ps (&dest[i]), k));
+      idx = _mm512_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      float k =
+        (float) (fade_in ? i : size - i)
+        / (float) size;
+      dest[i] *= k;
+    }
+}
+
+AVX512 static void
+avx512_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  const __m512 vstart = _mm512_set1_ps (start);
+  const __m512 vinc = _mm512_set1_ps (inc);
+  const __m512 step = _mm512_set1_ps (16.f);
+  __m512       idx = _mm512_set_ps (
+    15.f, 14.f, 13.f, 12.f, 11.f, 10.f, 9.f, 8.f, 7.f,
+    6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 k =
+        _mm512_add_ps (vstart, _mm512_mul_ps (vinc, idx));
+      _mm512_storeu_ps (
+        &dest[i],
+        _mm512_mul_ps (_mm512_loadu_ps (&dest[i]), k));
+      idx = _mm512_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= start + inc * (float) i;
+    }
+}
+
+AVX512 static void
+avx512_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  const __m512 vstart = _mm512_set1_ps (start);
+  const __m512 vinc = _mm512_set1_ps (inc);
+  const __m512 step = _mm512_set1_ps (16.f);
+  __m512       idx = _mm512_set_ps (
+    15.f, 14.f, 13.f, 12.f, 11.f, 10.f, 9.f, 8.f, 7.f,
+    6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 k =
+        _mm512_add_ps (vstart, _mm512_mul_ps (vinc, idx));
+      _mm512_storeu_ps (
+        &dest[i],
+        _mm512_add_ps (
+          _mm512_loadu_ps (&dest[i]),
+          _mm512_mul_ps (_mm512_loadu_ps (&src[i]), k)));
+      idx = _mm512_add_ps (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] += src[i] * (start + inc * (float) i);
+    }
+}
+
+AVX512 static float
+avx512_true_peak (const float * src, size_t size)
+{
+  const __m512i mask = _mm512_set1_epi32 (0x7fffffff);
+  __m512        acc = _mm512_setzero_ps ();
+  size_t        i = DSP_TRUE_PEAK_TAPS - 1;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m512 y[DSP_TRUE_PEAK_PHASES];
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          y[k] = _mm512_setzero_ps ();
+        }
+      for (int j = 0; j < DSP_TRUE_PEAK_TAPS; j++)
+        {
+          __m512 x =
+            _mm512_loadu_ps (&src[i - (size_t) j]);
+          for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+            {
+              y[k] = _mm512_add_ps (
+                y[k],
+                _mm512_mul_ps (
+                  _mm512_set1_ps (
+                    true_peak_coeffs[k][j]),
+                  x));
+            }
+        }
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          acc = _mm512_max_ps (
+            acc,
+            _mm512_castsi512_ps (_mm512_and_epi32 (
+              _mm512_castps_si512 (y[k]), mask)));
+        }
+    }
+  float ret = _mm512_reduce_max_ps (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, true_peak_at (src, i));
+    }
+  return ret;
+}
+
+static const DspSimdFuncs avx512_funcs = {
+  .level = DSP_SIMD_AVX512,
+  .name = "AVX-512",
+  .fill = avx512_fill,
+  .limit1 = avx512_limit1,
+  .abs_max = avx512_abs_max,
+  .min = avx512_min,
+  .max = avx512_max,
+  .add2 = avx512_add2,
+  .mul_k2 = avx512_mul_k2,
+  .mix2 = avx512_mix2,
+  .mix_add2 = avx512_mix_add2,
+  .linear_fade = avx512_linear_fade,
+  .mul_ramp = avx512_mul_ramp,
+  .mix_ramp = avx512_mix_ramp,
+  .true_peak = avx512_true_peak,
+};
+
+#endif /* HAVE_X86_SIMD */
+
+#ifdef HAVE_NEON_SIMD
+
+/*
+ * NEON kernels (4 floats).
+ */
+
+static void
+neon_fill (float * buf, float val, size_t size)
+{
+  const float32x4_t v = vdupq_n_f32 (val);
+  size_t            i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      vst1q_f32 (&buf[i], v);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+static void
+neon_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  const float32x4_t vmin = vdupq_n_f32 (minf);
+  const float32x4_t vmax = vdupq_n_f32 (maxf);
+  size_t            i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t x = vld1q_f32 (&buf[i]);
+      x = vminq_f32 (vmaxq_f32 (x, vmin), vmax);
+      vst1q_f32 (&buf[i], x);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+static float
+neon_abs_max (const float * buf, size_t size)
+{
+  float32x4_t acc = vdupq_n_f32 (0.f);
+  size_t      i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = vmaxq_f32 (
+        acc, vabsq_f32 (vld1q_f32 (&buf[i])));
+    }
+  float ret = vmaxvq_f32 (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, fabsf (buf[i]));
+    }
+  return ret;
+}
+
+static float
+neon_min (const float * buf, size_t size)
+{
+  float32x4_t acc = vdupq_n_f32 (FLT_MAX);
+  size_t      i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = vminq_f32 (acc, vld1q_f32 (&buf[i]));
+    }
+  float ret = vminvq_f32 (acc);
+  for (; i < size; i++)
+    {
+      ret = MIN (ret, buf[i]);
+    }
+  return ret;
+}
+
+static float
+neon_max (const float * buf, size_t size)
+{
+  float32x4_t acc = vdupq_n_f32 (-FLT_MAX);
+  size_t      i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      acc = vmaxq_f32 (acc, vld1q_f32 (&buf[i]));
+    }
+  float ret = vmaxvq_f32 (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, buf[i]);
+    }
+  return ret;
+}
+
+static void
+neon_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      vst1q_f32 (
+        &dest[i],
+        vaddq_f32 (
+          vld1q_f32 (&dest[i]), vld1q_f32 (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+static void
+neon_mul_k2 (float * dest, float k, size_t size)
+{
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      vst1q_f32 (
+        &dest[i],
+        vmulq_n_f32 (vld1q_f32 (&dest[i]), k));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+static void
+neon_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t d =
+        vmulq_n_f32 (vld1q_f32 (&dest[i]), k1);
+      float32x4_t s =
+        vmulq_n_f32 (vld1q_f32 (&src[i]), k2);
+      vst1q_f32 (&dest[i], vaddq_f32 (d, s));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+static void
+neon_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t d = vaddq_f32 (
+        vld1q_f32 (&dest[i]),
+        vmulq_n_f32 (vld1q_f32 (&src1[i]), k1));
+      d = vaddq_f32 (
+        d, vmulq_n_f32 (vld1q_f32 (&src2[i]), k2));
+      vst1q_f32 (&dest[i], d);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+static void
+neon_linear_fade (
+  float * dest,
+  size_t  size,
+  bool    fade_in)
+{
+  const float32x4_t vsize = vdupq_n_f32 ((float) size);
+  const float32x4_t step = vdupq_n_f32 (4.f);
+  const float       init[4] = { 0.f, 1.f, 2.f, 3.f };
+  float32x4_t       idx = vld1q_f32 (init);
+  size_t            i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t num =
+        fade_in ? idx : vsubq_f32 (vsize, idx);
+      float32x4_t k = vdivq_f32 (num, vsize);
+      vst1q_f32 (
+        &dest[i], vmulq_f32 (vld1q_f32 (&dest[i]), k));
+      idx = vaddq_f32 (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      float k =
+        (float) (fade_in ? i : size - i)
+        / (float) size;
+      dest[i] *= k;
+    }
+}
+
+static void
+neon_mul_ramp (
+  float * dest,
+  float   start,
+  float   inc,
+  size_t  size)
+{
+  const float32x4_t vstart = vdupq_n_f32 (start);
+  const float32x4_t vinc = vdupq_n_f32 (inc);
+  const float32x4_t step = vdupq_n_f32 (4.f);
+  const float       init[4] = { 0.f, 1.f, 2.f, 3.f };
+  float32x4_t       idx = vld1q_f32 (init);
+  size_t            i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t k =
+        vaddq_f32 (vstart, vmulq_f32 (vinc, idx));
+      vst1q_f32 (
+        &dest[i], vmulq_f32 (vld1q_f32 (&dest[i]), k));
+      idx = vaddq_f32 (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= start + inc * (float) i;
+    }
+}
+
+static void
+neon_mix_ramp (
+  float *       dest,
+  const float * src,
+  float         start,
+  float         inc,
+  size_t        size)
+{
+  const float32x4_t vstart = vdupq_n_f32 (start);
+  const float32x4_t vinc = vdupq_n_f32 (inc);
+  const float32x4_t step = vdupq_n_f32 (4.f);
+  const float       init[4] = { 0.f, 1.f, 2.f, 3.f };
+  float32x4_t       idx = vld1q_f32 (init);
+  size_t            i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t k =
+        vaddq_f32 (vstart, vmulq_f32 (vinc, idx));
+      vst1q_f32 (
+        &dest[i],
+        vaddq_f32 (
+          vld1q_f32 (&dest[i]),
+          vmulq_f32 (vld1q_f32 (&src[i]), k)));
+      idx = vaddq_f32 (idx, step);
+    }
+  for (; i < size; i++)
+    {
+      dest[i] += src[i] * (start + inc * (float) i);
+    }
+}
+
+static float
+neon_true_peak (const float * src, size_t size)
+{
+  float32x4_t acc = vdupq_n_f32 (0.f);
+  size_t      i = DSP_TRUE_PEAK_TAPS - 1;
+  for (; i + 4 <= size; i += 4)
+    {
+      float32x4_t y[DSP_TRUE_PEAK_PHASES];
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          y[k] = vdupq_n_f32 (0.f);
+        }
+      for (int j = 0; j < DSP_TRUE_PEAK_TAPS; j++)
+        {
+          float32x4_t x =
+            vld1q_f32 (&src[i - (size_t) j]);
+          for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+            {
+              y[k] = vaddq_f32 (
+                y[k],
+                vmulq_n_f32 (
+                  x, true_peak_coeffs[k][j]));
+            }
+        }
+      for (int k = 0; k < DSP_TRUE_PEAK_PHASES; k++)
+        {
+          acc = vmaxq_f32 (acc, vabsq_f32 (y[k]));
+        }
+    }
+  float ret = vmaxvq_f32 (acc);
+  for (; i < size; i++)
+    {
+      ret = MAX (ret, true_peak_at (src, i));
+    }
+  return ret;
+}
+
+static const DspSimdFuncs neon_funcs = {
+  .level = DSP_SIMD_NEON,
+  .name = "NEON",
+  .fill = neon_fill,
+  .limit1 = neon_limit1,
+  .abs_max = neon_abs_max,
+  .min = neon_min,
+  .max = neon_max,
+  .add2 = neon_add2,
+  .mul_k2 = neon_mul_k2,
+  .mix2 = neon_mix2,
+  .mix_add2 = neon_mix_add2,
+  .linear_fade = neon_linear_fade,
+  .mul_ramp = neon_mul_ramp,
+  .mix_ramp = neon_mix_ramp,
+  .true_peak = neon_true_peak,
+};
+
+#endif /* HAVE_NEON_SIMD */
+
+const DspSimdFuncs * dsp_simd = &scalar_funcs;
+
+/**
+ * Returns the kernels for the given instruction
+ * set, or NULL if they are not built in or the
+ * CPU does not support them.
+ */
+const DspSimdFuncs *
+dsp_simd_get_funcs (DspSimdLevel level)
+{
+#ifdef HAVE_X86_SIMD
+  __builtin_cpu_init ();
+#endif
+
+  switch (level)
+    {
+    case DSP_SIMD_NONE:
+      return &scalar_funcs;
+#ifdef HAVE_X86_SIMD
+    case DSP_SIMD_SSE2:
+      if (__builtin_cpu_supports ("sse2"))
+        return &sse2_funcs;
+      break;
+    case DSP_SIMD_AVX2:
+      if (__builtin_cpu_supports ("avx2"))
+        return &avx2_funcs;
+      break;
+    case DSP_SIMD_AVX512:
+      if (__builtin_cpu_supports ("avx512f"))
+        return &avx512_funcs;
+      break;
+#endif
+#ifdef HAVE_NEON_SIMD
+    case DSP_SIMD_NEON:
+      return &neon_funcs;
+#endif
+    default:
+      break;
+    }
+
+  return NULL;
+}
+
+/**
+ * Selects the best kernels supported by the CPU.
+ *
+ * AVX-512 is only used when requested with
+ * ZRYTHM_DSP_SIMD, since the frequency drop it
+ * causes on many CPUs costs more than it saves at
+ * audio buffer sizes.
+ */
+void
+dsp_simd_init (void)
+{
+  static const char * names[] = {
+    [DSP_SIMD_NONE] = "none",
+    [DSP_SIMD_SSE2] = "sse2",
+    [DSP_SIMD_AVX2] = "avx2",
+    [DSP_SIMD_AVX512] = "avx512",
+    [DSP_SIMD_NEON] = "neon",
+  };
+
+  const DspSimdFuncs * funcs = NULL;
+  char * requested =
+    env_get_string ("ZRYTHM_DSP_SIMD", NULL);
+  if (requested)
+    {
+      for (int i = 0; i < NUM_DSP_SIMD_LEVELS; i++)
+        {
+          if (
+            g_ascii_strcasecmp (requested, names[i])
+            == 0)
+            {
+              funcs =
+                dsp_simd_get_funcs ((DspSimdLevel) i);
+              if (!funcs)
+                {
+                  g_warning (
+                    "%s DSP kernels are not supported "
+                    "on this CPU",
+                    requested);
+                }
+              break;
+            }
+        }
+      g_free (requested);
+    }
+
+  static const DspSimdLevel preferred[] = {
+    DSP_SIMD_AVX2,
+    DSP_SIMD_SSE2,
+    DSP_SIMD_NEON,
+  };
+  for (size_t i = 0;
+       !funcs && i < G_N_ELEMENTS (preferred); i++)
+    {
+      funcs = dsp_simd_get_funcs (preferred[i]);
+    }
+
+  dsp_simd = funcs ? funcs : &scalar_funcs;
+  g_message ("Using %s DSP kernels", dsp_simd->name);
+}
+
+#ifdef HAVE_X86_SIMD
+/** Flush-to-zero and denormals-are-zero bits of
+ * MXCSR. */
+#  define MXCSR_FTZ_DAZ 0x8040
+#elif defined(HAVE_NEON_SIMD)
+/** Flush-to-zero bit of FPCR (also treats
+ * denormal inputs as zero). */
+#  define FPCR_FZ (1ULL << 24)
+#endif
+
+/**
+ * Returns whether the CPU can flush denormals to
+ * zero (FTZ/DAZ).
+ */
+bool
+dsp_simd_can_flush_denormals (void)
+{
+#ifdef HAVE_X86_SIMD
+  /* DAZ is available on every CPU with SSE2
+   * apart from the earliest Pentium 4 steppings */
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("sse2");
+#elif defined(HAVE_NEON_SIMD)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Sets whether denormal results and inputs are
+ * flushed to zero on the calling thread.
+ *
+ * The control register is only written when the
+ * mode changes, so this is cheap enough to call
+ * every cycle.
+ */
+#ifdef HAVE_X86_SIMD
+SSE2
+#endif
+void
+dsp_simd_set_flush_denormals (bool flush)
+{
+  if (!dsp_simd_can_flush_denormals ())
+    return;
+
+#ifdef HAVE_X86_SIMD
+  unsigned int csr = _mm_getcsr ();
+  unsigned int new_csr =
+    flush ? csr | MXCSR_FTZ_DAZ
+          : csr & ~(unsigned int) MXCSR_FTZ_DAZ;
+  if (new_csr != csr)
+    _mm_setcsr (new_csr);
+#elif defined(HAVE_NEON_SIMD)
+  unsigned long long fpcr;
+  __asm__ __volatile__ ("mrs %0, fpcr" : "=r"(fpcr));
+  unsigned long long new_fpcr =
+    flush ? fpcr | FPCR_FZ : fpcr & ~FPCR_FZ;
+  if (new_fpcr != fpcr)
+    __asm__ __volatile__ ("msr fpcr, %0"
+                          :
+                          : "r"(new_fpcr));
+#endif
+}
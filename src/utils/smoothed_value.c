@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-config.h"
+
+#include <math.h>
+
+#include "utils/dsp.h"
+#include "utils/math.h"
+#include "utils/smoothed_value.h"
+
+#include <glib.h>
+
+/**
+ * Jumps to the given value.
+ */
+void
+smoothed_value_reset (SmoothedValue * self, float val)
+{
+  self->current = val;
+  self->target = val;
+  self->inc = 0.f;
+  self->remaining = 0;
+  self->initialized = true;
+}
+
+/**
+ * Starts ramping to \p target over \p ramp_len
+ * samples.
+ *
+ * Does nothing if \p target is already the
+ * target.
+ */
+void
+smoothed_value_set_target (
+  SmoothedValue *   self,
+  float             target,
+  SmoothedValueType type,
+  nframes_t         ramp_len)
+{
+  if (!self->initialized || ramp_len == 0)
+    {
+      smoothed_value_reset (self, target);
+      return;
+    }
+
+  if (math_floats_equal (self->target, target))
+    return;
+
+  self->target = target;
+  self->remaining = ramp_len;
+
+  if (
+    type == SMOOTHED_VALUE_EXPONENTIAL
+    && self->current >= SMOOTHED_VALUE_EXP_FLOOR
+    && target >= SMOOTHED_VALUE_EXP_FLOOR)
+    {
+      self->type = SMOOTHED_VALUE_EXPONENTIAL;
+      self->inc = powf (
+        target / self->current, 1.f / (float) ramp_len);
+    }
+  else
+    {
+      self->type = SMOOTHED_VALUE_LINEAR;
+      self->inc =
+        (target - self->current) / (float) ramp_len;
+    }
+}
+
+/**
+ * Starts ramping to the given gain over
+ * @ref SMOOTHED_VALUE_GAIN_RAMP_MS.
+ */
+void
+smoothed_value_set_gain (
+  SmoothedValue * self,
+  float           gain,
+  sample_rate_t   sample_rate)
+{
+  nframes_t ramp_len =
+    sample_rate * SMOOTHED_VALUE_GAIN_RAMP_MS / 1000;
+  smoothed_value_set_target (
+    self, gain, SMOOTHED_VALUE_EXPONENTIAL, ramp_len);
+}
+
+/**
+ * Processes the part of the ramp that falls in
+ * the next \p nframes samples, either multiplying
+ * \p dests in place (if \p srcs is NULL) or adding
+ * \p srcs to them.
+ *
+ * @return The number of samples processed.
+ */
+static nframes_t
+process_ramp (
+  SmoothedValue *       self,
+  float * const *       dests,
+  const float * const * srcs,
+  size_t                num_bufs,
+  nframes_t             nframes)
+{
+  nframes_t offset = 0;
+  while (self->remaining > 0 && offset < nframes)
+    {
+      nframes_t len =
+        MIN (self->remaining, nframes - offset);
+      if (self->type == SMOOTHED_VALUE_EXPONENTIAL)
+        {
+          len = MIN (len, SMOOTHED_VALUE_EXP_SEGMENT);
+        }
+
+      /* value at the sample after this segment */
+      float end;
+      if (len == self->remaining)
+        end = self->target;
+      else if (
+        self->type == SMOOTHED_VALUE_EXPONENTIAL)
+        end =
+          self->current * powf (self->inc, (float) len);
+      else
+        end = self->current + self->inc * (float) len;
+
+      float inc = (end - self->current) / (float) len;
+      for (size_t i = 0; i < num_bufs; i++)
+        {
+          if (srcs)
+            {
+              dsp_mix_ramp (
+                &dests[i][offset], &srcs[i][offset],
+                self->current, inc, len);
+            }
+          else
+            {
+              dsp_mul_ramp (
+                &dests[i][offset], self->current,
+                inc, len);
+            }
+        }
+
+      self->current = end;
+      self->remaining -= len;
+      offset += len;
+    }
+
+  return offset;
+}
+
+/**
+ * Multiplies each buffer with the value, ramping
+ * where it has not settled yet.
+ *
+ * Once settled this costs the same as
+ * dsp_mul_k2() (nothing if the value is 1).
+ *
+ * All buffers get the same ramp, and the value
+ * advances by \p nframes.
+ */
+void
+smoothed_value_apply (
+  SmoothedValue * self,
+  float * const * bufs,
+  size_t          num_bufs,
+  nframes_t       nframes)
+{
+  nframes_t offset = process_ramp (
+    self, bufs, NULL, num_bufs, nframes);
+  if (
+    offset == nframes
+    || math_floats_equal (self->current, 1.f))
+    return;
+
+  for (size_t i = 0; i < num_bufs; i++)
+    {
+      dsp_mul_k2 (
+        &bufs[i][offset], self->current,
+        nframes - offset);
+    }
+}
+
+/**
+ * Adds each source multiplied by the value to
+ * the corresponding destination.
+ *
+ * @see smoothed_value_apply().
+ */
+void
+smoothed_value_mix (
+  SmoothedValue *       self,
+  float * const *       dests,
+  const float * const * srcs,
+  size_t                num_bufs,
+  nframes_t             nframes)
+{
+  nframes_t offset = process_ramp (
+    self, dests, srcs, num_bufs, nframes);
+  if (offset == nframes)
+    return;
+
+  for (size_t i = 0; i < num_bufs; i++)
+    {
+      dsp_mix2 (
+        &dests[i][offset], &srcs[i][offset], 1.f,
+        self->current, nframes - offset);
+    }
+}
+
+/**
+ * Advances the value by \p nframes without
+ * processing anything.
+ */
+void
+smoothed_value_skip (
+  SmoothedValue * self,
+  nframes_t       nframes)
+{
+  process_ramp (self, NULL, NULL, 0, nframes);
+}
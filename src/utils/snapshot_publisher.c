@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "utils/snapshot_publisher.h"
+
+/**
+ * Publish waiting for the end of the current
+ * batch.
+ */
+typedef struct PendingPublish
+{
+  SnapshotPublisher * publisher;
+  SnapshotPublishFunc publish_func;
+  void *              owner;
+} PendingPublish;
+
+/** Depth of the open batches, only accessed from
+ * the GUI thread. */
+static int batch_depth = 0;
+
+/** Publishes collected by the open batches. */
+static GArray * pending = NULL;
+
+/**
+ * Frees the replaced snapshots if no thread is
+ * reading.
+ *
+ * Threads that start reading after this check see
+ * the latest snapshot, since it was published
+ * before.
+ */
+static void
+free_retired (SnapshotPublisher * self)
+{
+  if (
+    !self->retired
+    || g_atomic_int_get (&self->num_readers) > 0)
+    return;
+
+  g_ptr_array_set_size (self->retired, 0);
+}
+
+void
+snapshot_publisher_publish (
+  SnapshotPublisher * self,
+  void *              snapshot,
+  GDestroyNotify      free_func)
+{
+  void * prev =
+    g_atomic_pointer_get (&self->snapshot);
+  g_atomic_pointer_set (&self->snapshot, snapshot);
+  if (prev)
+    {
+      if (!self->retired)
+        {
+          self->retired =
+            g_ptr_array_new_with_free_func (
+              free_func);
+        }
+      g_ptr_array_add (self->retired, prev);
+    }
+
+  free_retired (self);
+}
+
+void
+snapshot_publisher_changed (
+  SnapshotPublisher * self,
+  SnapshotPublishFunc publish_func,
+  void *              owner)
+{
+  if (batch_depth == 0)
+    {
+      publish_func (owner);
+      return;
+    }
+
+  if (self->dirty)
+    return;
+
+  if (!pending)
+    {
+      pending =
+        g_array_new (
+          false, false, sizeof (PendingPublish));
+    }
+  PendingPublish pending_publish = {
+    .publisher = self,
+    .publish_func = publish_func,
+    .owner = owner,
+  };
+  g_array_append_val (pending, pending_publish);
+  self->dirty = true;
+}
+
+void
+snapshot_publisher_begin_batch (void)
+{
+  batch_depth++;
+}
+
+void
+snapshot_publisher_end_batch (void)
+{
+  g_return_if_fail (batch_depth > 0);
+  if (--batch_depth > 0 || !pending)
+    return;
+
+  for (guint i = 0; i < pending->len; i++)
+    {
+      PendingPublish * pending_publish =
+        &g_array_index (pending, PendingPublish, i);
+      pending_publish->publisher->dirty = false;
+      pending_publish->publish_func (
+        pending_publish->owner);
+    }
+  g_array_set_size (pending, 0);
+}
+
+void *
+snapshot_publisher_acquire (SnapshotPublisher * self)
+{
+  /* announce the reader before loading the
+   * snapshot so that it is not freed meanwhile
+   * (glib atomics are sequentially consistent) */
+  g_atomic_int_inc (&self->num_readers);
+  return g_atomic_pointer_get (&self->snapshot);
+}
+
+void
+snapshot_publisher_release (SnapshotPublisher * self)
+{
+  g_atomic_int_add (&self->num_readers, -1);
+}
+
+void
+snapshot_publisher_clear (
+  SnapshotPublisher * self,
+  GDestroyNotify      free_func)
+{
+  if (self->dirty)
+    {
+      for (guint i = 0; i < pending->len; i++)
+        {
+          if (
+            g_array_index (pending, PendingPublish, i)
+              .publisher
+            == self)
+            {
+              g_array_remove_index (pending, i);
+              break;
+            }
+        }
+      self->dirty = false;
+    }
+
+  g_warn_if_fail (
+    g_atomic_int_get (&self->num_readers) == 0);
+  if (self->snapshot)
+    {
+      free_func (self->snapshot);
+      self->snapshot = NULL;
+    }
+  if (self->retired)
+    {
+      g_ptr_array_unref (self->retired);
+      self->retired = NULL;
+    }
+}
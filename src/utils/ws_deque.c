@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "utils/objects.h"
+#include "utils/ws_deque.h"
+
+CONST
+static size_t
+power_of_two_size (size_t sz)
+{
+  size_t ret = 2;
+  while (ret < sz)
+    ret <<= 1;
+  return ret;
+}
+
+void
+ws_deque_reserve (WsDeque * self, size_t buffer_size)
+{
+  buffer_size = power_of_two_size (buffer_size);
+
+  if (self->buffer_mask >= buffer_size - 1)
+    return;
+
+  if (self->buffer)
+    free (self->buffer);
+
+  self->buffer = object_new_n (buffer_size, void *);
+  self->buffer_mask = buffer_size - 1;
+
+  ws_deque_clear (self);
+}
+
+WsDeque *
+ws_deque_new (void)
+{
+  WsDeque * self = object_new (WsDeque);
+
+  ws_deque_reserve (self, 8);
+
+  return self;
+}
+
+size_t
+ws_deque_get_capacity (const WsDeque * self)
+{
+  return self->buffer_mask + 1;
+}
+
+void
+ws_deque_clear (WsDeque * self)
+{
+  g_atomic_int_set (&self->top, 0);
+  g_atomic_int_set (&self->bottom, 0);
+}
+
+/*
+ * The indices only grow and wrap around, so they
+ * are compared by their (signed) distance and the
+ * buffer is indexed by masking them.
+ */
+
+bool
+ws_deque_push (WsDeque * self, void * const data)
+{
+  guint b = (guint) g_atomic_int_get (&self->bottom);
+  guint t = (guint) g_atomic_int_get (&self->top);
+  if (G_UNLIKELY ((size_t) (b - t) > self->buffer_mask))
+    {
+      return false;
+    }
+
+  g_atomic_pointer_set (
+    &self->buffer[(size_t) b & self->buffer_mask],
+    data);
+  g_atomic_int_set (&self->bottom, (gint) (b + 1));
+
+  return true;
+}
+
+bool
+ws_deque_pop (WsDeque * self, void ** data)
+{
+  guint b =
+    (guint) g_atomic_int_get (&self->bottom) - 1;
+
+  /* publish the reservation before reading top
+   * (glib atomics are sequentially consistent) */
+  g_atomic_int_set (&self->bottom, (gint) b);
+  guint t = (guint) g_atomic_int_get (&self->top);
+
+  if ((gint) (b - t) < 0)
+    {
+      /* empty */
+      g_atomic_int_set (&self->bottom, (gint) (b + 1));
+      return false;
+    }
+
+  void * ret = g_atomic_pointer_get (
+    &self->buffer[(size_t) b & self->buffer_mask]);
+  if (t == b)
+    {
+      /* last element - race against thieves */
+      bool won = g_atomic_int_compare_and_exchange (
+        &self->top, (gint) t, (gint) (t + 1));
+      g_atomic_int_set (&self->bottom, (gint) (b + 1));
+      if (!won)
+        return false;
+    }
+
+  *data = ret;
+  return true;
+}
+
+bool
+ws_deque_steal (WsDeque * self, void ** data)
+{
+  guint t = (guint) g_atomic_int_get (&self->top);
+  guint b = (guint) g_atomic_int_get (&self->bottom);
+  if ((gint) (b - t) <= 0)
+    return false;
+
+  void * ret = g_atomic_pointer_get (
+    &self->buffer[(size_t) t & self->buffer_mask]);
+  if (!g_atomic_int_compare_and_exchange (
+        &self->top, (gint) t, (gint) (t + 1)))
+    {
+      /* lost the race to another thief or the
+       * owner */
+      return false;
+    }
+
+  *data = ret;
+  return true;
+}
+
+void
+ws_deque_free (WsDeque * self)
+{
+  free (self->buffer);
+
+  free (self);
+}
@@ -66,6 +66,7 @@
 #include "utils/arrays.h"
 #include "utils/backtrace.h"
 #include "utils/cairo.h"
+#include "utils/dsp_simd.h"
 #include "utils/env.h"
 #include "utils/flags.h"
 #include "utils/gtk.h"
@@ -1084,6 +1085,9 @@ zrythm_app_startup (GApplication * app)
   g_message ("Initing audio decoder...");
   audec_init ();
 
+  /* select built-in DSP kernels */
+  dsp_simd_init ();
+
 #ifdef HAVE_LSP_DSP
   /* init lsp dsp */
   g_message ("Initing LSP DSP...");
@@ -134,6 +134,129 @@ test_region_in_2nd_automation_track_get_muted (void)
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Asserts that reading the automation through the
+ * read cache gives the same values as looking up
+ * the automation point and value at each frame.
+ */
+static void
+check_read_normalized_val (
+  AutomationTrack * at,
+  signed_frame_t    end_frame)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      bool ends_after = i == 1;
+
+      /* sequential reads like during playback,
+       * then random reads like when seeking */
+      for (int j = 0; j < 1200; j++)
+        {
+          signed_frame_t frame =
+            j < 1000
+              ? j * (end_frame / 1000)
+              : g_test_rand_int_range (
+                0, (gint32) end_frame);
+          Position pos;
+          position_from_frames (&pos, frame);
+
+          AutomationPoint * ap =
+            automation_track_get_ap_before_pos (
+              at, &pos, ends_after);
+          float val = 0.f;
+          bool  read =
+            automation_track_read_normalized_val (
+              at, frame, ends_after, &val);
+          g_assert_true (read == (ap != NULL));
+          if (!ap)
+            continue;
+
+          float expected =
+            automation_track_get_val_at_pos (
+              at, &pos, true, ends_after);
+          g_assert_cmpfloat_with_epsilon (
+            val, expected, 0.0001f);
+        }
+    }
+}
+
+static void
+test_read_normalized_val (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * master = P_MASTER_TRACK;
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (master);
+  AutomationTrack * at = atl->ats[0];
+
+  /* two overlapping regions with points of
+   * different values and curves */
+  ZRegion * regions[2];
+  for (int i = 0; i < 2; i++)
+    {
+      Position start, end;
+      position_set_to_bar (&start, 2 + i * 3);
+      position_set_to_bar (&end, 6 + i * 3);
+      ZRegion * r = automation_region_new (
+        &start, &end, track_get_name_hash (master),
+        at->index, i);
+      track_add_region (
+        master, r, at, -1, F_GEN_NAME,
+        F_NO_PUBLISH_EVENTS);
+      regions[i] = r;
+
+      for (int j = 0; j < 24; j++)
+        {
+          Position ap_pos;
+          position_from_ticks (
+            &ap_pos,
+            j * TRANSPORT->ticks_per_beat * 0.5
+              + i * 30.0);
+          float normalized_val =
+            (float) ((j * 7 + i * 3) % 10) / 9.f;
+          AutomationPoint * ap =
+            automation_point_new_float (
+              normalized_val, normalized_val,
+              &ap_pos);
+          ap->curve_opts.curviness =
+            (j % 5) * 0.4 - 0.8;
+          automation_region_add_ap (
+            r, ap, F_NO_PUBLISH_EVENTS);
+        }
+    }
+
+  Position end_pos;
+  position_set_to_bar (&end_pos, 12);
+  check_read_normalized_val (at, end_pos.frames);
+
+  /* move, change and remove some points */
+  ZRegion * r = regions[0];
+  arranger_object_move (
+    (ArrangerObject *) r->aps[3],
+    TRANSPORT->ticks_per_beat * 0.25);
+  automation_point_set_fvalue (
+    r->aps[5], 0.3f, F_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  automation_region_remove_ap (
+    r, r->aps[8], false, F_FREE);
+  check_read_normalized_val (at, end_pos.frames);
+
+  /* move a region */
+  arranger_object_move (
+    (ArrangerObject *) regions[1],
+    -TRANSPORT->ticks_per_bar);
+  check_read_normalized_val (at, end_pos.frames);
+
+  /* mute a region */
+  arranger_object_set_muted (
+    (ArrangerObject *) regions[1], true,
+    F_NO_PUBLISH_EVENTS);
+  check_read_normalized_val (at, end_pos.frames);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -149,6 +272,9 @@ main (int argc, char * argv[])
     "test region in 2nd automation track get muted",
     (GTestFunc)
       test_region_in_2nd_automation_track_get_muted);
+  g_test_add_func (
+    TEST_PREFIX "test read normalized val",
+    (GTestFunc) test_read_normalized_val);
 
   return g_test_run ();
 }
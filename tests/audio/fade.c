@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/curve.h"
+#include "audio/fade.h"
+
+#include <glib.h>
+
+#include "tests/helpers/zrythm.h"
+
+#define FADE_LEN 3000
+
+static void
+fill_ones (float * buf, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = 1.f;
+    }
+}
+
+static void
+test_fade_apply_matches_curve (void)
+{
+  test_helper_zrythm_init ();
+
+  static const double curvinesses[] = {
+    -1.0, -0.6, 0.0, 0.3, 1.0
+  };
+  static const nframes_t cycle_sizes[] = {
+    1, 7, 256, FADE_LEN + 1
+  };
+  float * l = g_new (float, FADE_LEN + 1);
+  float * r = g_new (float, FADE_LEN + 1);
+
+  for (int algo = 0; algo < NUM_CURVE_ALGORITHMS;
+       algo++)
+    {
+      /* the pulse is not continuous */
+      if (algo == CURVE_ALGORITHM_PULSE)
+        continue;
+
+      for (size_t i = 0;
+           i < G_N_ELEMENTS (curvinesses); i++)
+        {
+          CurveOptions opts;
+          curve_opts_init (&opts);
+          opts.algo = (CurveAlgorithm) algo;
+          opts.curviness = curvinesses[i];
+
+          for (int fade_in = 0; fade_in < 2;
+               fade_in++)
+            {
+              for (size_t j = 0;
+                   j < G_N_ELEMENTS (cycle_sizes);
+                   j++)
+                {
+                  /* apply the whole fade in
+                   * cycles */
+                  fill_ones (l, FADE_LEN + 1);
+                  fill_ones (r, FADE_LEN + 1);
+                  for (signed_frame_t pos = 0;
+                       pos <= FADE_LEN;
+                       pos += cycle_sizes[j])
+                    {
+                      nframes_t nframes =
+                        (nframes_t) MIN (
+                          cycle_sizes[j],
+                          FADE_LEN + 1 - pos);
+                      fade_apply (
+                        &opts, fade_in, &l[pos],
+                        &r[pos], pos, FADE_LEN,
+                        nframes);
+                    }
+
+                  for (int k = 0; k <= FADE_LEN; k++)
+                    {
+                      double expected =
+                        fade_get_y_normalized (
+                          (double) k / FADE_LEN,
+                          &opts, fade_in);
+                      g_assert_cmpfloat_with_epsilon (
+                        l[k], expected, 0.001);
+                      g_assert_cmpfloat (
+                        l[k], ==, r[k]);
+                    }
+                }
+            }
+        }
+    }
+
+  g_free (l);
+  g_free (r);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_fade_tables_are_shared (void)
+{
+  test_helper_zrythm_init ();
+
+  CurveOptions opts;
+  curve_opts_init (&opts);
+  opts.algo = CURVE_ALGORITHM_SUPERELLIPSE;
+  opts.curviness = 0.4;
+
+  const FadeTable * table =
+    fade_table_acquire (&opts, true);
+  g_assert_nonnull (table);
+  g_assert_true (
+    table == fade_table_acquire (&opts, true));
+  fade_table_release (table);
+
+  /* other direction gets another table */
+  const FadeTable * table_out =
+    fade_table_acquire (&opts, false);
+  g_assert_nonnull (table_out);
+  g_assert_true (table != table_out);
+  g_assert_cmpfloat (table_out->y[0], ==, 1.f);
+  g_assert_cmpfloat (
+    table_out->y[FADE_TABLE_SIZE], ==, 0.f);
+  fade_table_release (table_out);
+
+  /* tables in use are not replaced */
+  for (int i = 0; i < FADE_TABLE_CACHE_SIZE * 2; i++)
+    {
+      CurveOptions other_opts = opts;
+      other_opts.curviness = -0.9 + 0.01 * i;
+      const FadeTable * other =
+        fade_table_acquire (&other_opts, true);
+      g_assert_true (other != table);
+      if (other)
+        fade_table_release (other);
+    }
+  g_assert_true (
+    table == fade_table_acquire (&opts, true));
+  fade_table_release (table);
+  fade_table_release (table);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/fade/"
+
+  g_test_add_func (
+    TEST_PREFIX "test fade apply matches curve",
+    (GTestFunc) test_fade_apply_matches_curve);
+  g_test_add_func (
+    TEST_PREFIX "test fade tables are shared",
+    (GTestFunc) test_fade_tables_are_shared);
+
+  return g_test_run ();
+}
@@ -4,10 +4,14 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/channel.h"
 #include "audio/fader.h"
 #include "audio/midi_event.h"
 #include "audio/router.h"
+#include "audio/track_processor.h"
+#include "plugins/plugin.h"
 #include "utils/math.h"
+#include "utils/smoothed_value.h"
 
 #include "tests/helpers/plugin_manager.h"
 #include "tests/helpers/zrythm.h"
@@ -221,6 +225,74 @@ test_solo (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_silence_propagation (void)
+{
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 1);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * pl = track->channel->inserts[0];
+  g_assert_nonnull (pl);
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  /* process until the plugin's tail elapses */
+  nframes_t tail_frames =
+    pl->latency
+    + AUDIO_ENGINE->sample_rate
+        * PLUGIN_SILENT_TAIL_SECONDS;
+  for (nframes_t i = 0;
+       i <= tail_frames / AUDIO_ENGINE->block_length
+              + 2;
+       i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  /* nothing feeds the track so the flags are set
+   * all the way to the fader */
+  g_assert_true (stereo_ports_is_silent (
+    track->processor->stereo_out));
+  g_assert_true (stereo_ports_is_silent (
+    track->channel->fader->stereo_in));
+  g_assert_true (stereo_ports_is_silent (
+    track->channel->fader->stereo_out));
+  g_assert_false (track_has_sound (track));
+
+  /* the plugin is skipped */
+  g_assert_cmpuint (
+    pl->silent_out_frames, >=, tail_frames);
+  for (int i = 0; i < pl->num_out_ports; i++)
+    {
+      Port * port = pl->out_ports[i];
+      if (port->id.type == TYPE_AUDIO)
+        g_assert_true (port->is_silent);
+    }
+
+  /* the fader gains keep ramping while the input
+   * is silent */
+  Fader * fader = track->channel->fader;
+  fader_set_amp (fader, 0.5f);
+  for (int i = 0; i < 8; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_true (stereo_ports_is_silent (
+    fader->stereo_in));
+  g_assert_true (
+    smoothed_value_is_settled (&fader->gain_l));
+  g_assert_true (
+    smoothed_value_is_settled (&fader->gain_r));
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -233,6 +305,9 @@ main (int argc, char * argv[])
     (GTestFunc) test_fader_process);
   g_test_add_func (
     TEST_PREFIX "test solo", (GTestFunc) test_solo);
+  g_test_add_func (
+    TEST_PREFIX "test silence propagation",
+    (GTestFunc) test_silence_propagation);
 
   return g_test_run ();
 }
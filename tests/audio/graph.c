@@ -0,0 +1,558 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/anticipative_renderer.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/graph_buffer_plan.h"
+#include "audio/graph_node.h"
+#include "audio/graph_thread.h"
+#include "audio/router.h"
+#include "audio/supported_file.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "audio/transport.h"
+#include "gui/backend/clip_editor.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/ws_deque.h"
+#include "zrythm.h"
+
+#include <glib.h>
+
+#include "helpers/plugin_manager.h"
+#include "helpers/project.h"
+#include "helpers/zrythm.h"
+
+static void
+wait_for_cycles (int num_cycles)
+{
+  Graph * graph = ROUTER->graph;
+  gint    epoch = g_atomic_int_get (&graph->epoch);
+  while (
+    g_atomic_int_get (&graph->epoch)
+    < epoch + num_cycles)
+    {
+      g_usleep (1000);
+    }
+}
+
+static void
+test_recalc_while_running (void)
+{
+  test_helper_zrythm_init ();
+
+  /* the dummy engine keeps processing while the
+   * graph is recalculated */
+  g_assert_true (engine_get_run (AUDIO_ENGINE));
+  wait_for_cycles (2);
+
+  Graph *         graph = ROUTER->graph;
+  CompiledGraph * prev_compiled = graph->compiled;
+  g_assert_nonnull (prev_compiled);
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 4);
+  prev_compiled = graph->compiled;
+  wait_for_cycles (2);
+
+  for (int i = 0; i < 8; i++)
+    {
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+      /* the new graph is live and the previous
+       * one is kept until its grace period is
+       * over */
+      g_assert_nonnull (graph->compiled);
+      g_assert_true (graph->compiled != prev_compiled);
+      g_assert_true (
+        graph->compiled->replaced == prev_compiled);
+      g_assert_null (graph->pending);
+      g_assert_null (graph->setup);
+
+      /* the graph replaced before that was
+       * reclaimed, since cycles passed */
+      g_assert_null (prev_compiled->replaced);
+      prev_compiled = graph->compiled;
+
+      wait_for_cycles (2);
+    }
+
+  /* the thread deques fit all the nodes of the
+   * bigger graph */
+  size_t num_nodes =
+    (size_t) g_hash_table_size (graph->compiled->nodes);
+  for (int i = 0; i < graph->num_threads; i++)
+    {
+      g_assert_cmpuint (
+        ws_deque_get_capacity (graph->threads[i]->deque),
+        >=, num_nodes);
+    }
+  g_assert_cmpuint (
+    ws_deque_get_capacity (graph->main_thread->deque),
+    >=, num_nodes);
+
+  /* the port connections match the live graph */
+  Track * track =
+    tracklist_get_last_track (
+      TRACKLIST, TRACKLIST_PIN_OPTION_BOTH, false);
+  g_assert_nonnull (track);
+  Port * out = track->channel->stereo_out->l;
+  g_assert_cmpint (out->num_dests, ==, 1);
+  g_assert_true (
+    out->dests[0] == P_MASTER_TRACK->processor->stereo_in->l);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_packed_schedule (void)
+{
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 2);
+
+  CompiledGraph * compiled = ROUTER->graph->compiled;
+  g_assert_nonnull (compiled->schedule);
+  g_assert_cmpuint (
+    compiled->schedule_size, ==,
+    g_hash_table_size (compiled->nodes));
+
+  for (size_t i = 0; i < compiled->schedule_size; i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      g_assert_cmpint (node->id, ==, (int) i);
+
+      /* fused chains only link single-parent
+       * children */
+      if (node->chain_next)
+        {
+          g_assert_cmpint (node->n_childnodes, ==, 1);
+          g_assert_true (
+            node->chain_next == node->childnodes[0]);
+          g_assert_cmpint (
+            node->chain_next->init_refcount, ==, 1);
+        }
+
+      /* children come after their parents */
+      guint start = compiled->child_offsets[i];
+      guint end = compiled->child_offsets[i + 1];
+      g_assert_cmpuint (
+        end - start, ==, (guint) node->n_childnodes);
+      for (guint j = start; j < end; j++)
+        {
+          guint child = compiled->child_indices[j];
+          g_assert_cmpuint (child, >, i);
+
+          /* the longest paths are triggered first */
+          GraphNode * child_node =
+            &compiled->schedule[child];
+          g_assert_cmpfloat (
+            node->critical_path, >,
+            child_node->critical_path);
+          if (j > start)
+            {
+              g_assert_cmpfloat (
+                compiled
+                  ->schedule
+                    [compiled->child_indices[j - 1]]
+                  .critical_path,
+                >=, child_node->critical_path);
+            }
+          g_assert_true (
+            node->childnodes[j - start]
+            == &compiled->schedule[child]);
+        }
+
+#if !defined(_WOE32) && !defined(__APPLE__)
+      /* refcounts are on separate cache lines */
+      g_assert_cmpuint (
+        (guintptr) &compiled->refcounts[i]
+          % GRAPH_CACHE_LINE_SIZE,
+        ==, 0);
+#endif
+    }
+
+  /* lookups return the packed nodes */
+  GraphNode * node = graph_find_node_from_track (
+    ROUTER->graph, P_MASTER_TRACK, false);
+  g_assert_true (
+    node >= compiled->schedule
+    && node < compiled->schedule
+                + compiled->schedule_size);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_node_timings (void)
+{
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 1);
+  Track * track =
+    tracklist_get_last_track (
+      TRACKLIST, TRACKLIST_PIN_OPTION_BOTH, false);
+  wait_for_cycles (4);
+
+  CompiledGraph * compiled = ROUTER->graph->compiled;
+  GraphNode *     pl_node = NULL;
+  for (size_t i = 0; i < compiled->schedule_size; i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      if (node->type == ROUTE_NODE_TYPE_PLUGIN)
+        {
+          pl_node = node;
+          break;
+        }
+    }
+  g_assert_nonnull (pl_node);
+  g_assert_true (
+    graph_node_get_track (pl_node) == track);
+  g_assert_true (
+    graph_node_get_plugin (pl_node)
+    == track->channel->inserts[0]);
+
+  GraphNodeTimingStats stats;
+  g_assert_true (
+    graph_node_get_timing_stats (pl_node, &stats));
+  g_assert_cmpint (stats.num_samples, >, 0);
+  g_assert_cmpint (
+    stats.num_samples, <=,
+    GRAPH_NODE_TIMING_RING_SIZE);
+  g_assert_cmpfloat (stats.min, <=, stats.mean);
+  g_assert_cmpfloat (stats.mean, <=, stats.p99);
+
+  /* the samples survive recompiling the graph */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  compiled = ROUTER->graph->compiled;
+  for (size_t i = 0; i < compiled->schedule_size; i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      if (node->type == ROUTE_NODE_TYPE_PLUGIN)
+        {
+          g_assert_true (
+            graph_node_get_timing_stats (
+              node, &stats));
+        }
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_anticipative_rendering (void)
+{
+  /* the renderer is created with the graph */
+  g_setenv ("ZRYTHM_DSP_ANTICIPATIVE_MS", "50", true);
+  test_helper_zrythm_init ();
+
+  Graph * graph = ROUTER->graph;
+  g_assert_nonnull (graph->anticipative);
+
+  char * filepath = g_build_filename (
+    TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Track * track = track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    TRACKLIST->num_tracks, 1, NULL);
+  g_assert_nonnull (track);
+  supported_file_free (file);
+
+  /* the track in the editor is processed live */
+  clip_editor_set_region (
+    CLIP_EDITOR, NULL, F_NO_PUBLISH_EVENTS);
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+  /* the pre-fader part is rendered ahead and the
+   * fader plays it */
+  GraphNode * node =
+    graph_find_node_from_track (graph, track, false);
+  g_assert_nonnull (node->anticipative);
+  AnticipativeTrack * at = node->anticipative;
+  g_assert_true (at->track == track);
+  g_assert_nonnull (at->fader_node);
+  g_assert_true (
+    at->fader_node->fader == track->channel->fader);
+  for (size_t i = 1; i < at->num_nodes; i++)
+    {
+      g_assert_cmpint (
+        at->nodes[i - 1]->id, <, at->nodes[i]->id);
+    }
+
+  /* tracks armed for recording are processed
+   * live */
+  track_set_recording (track, true, false);
+  node =
+    graph_find_node_from_track (graph, track, false);
+  g_assert_null (node->anticipative);
+  track_set_recording (track, false, false);
+  node =
+    graph_find_node_from_track (graph, track, false);
+  g_assert_nonnull (node->anticipative);
+  at = node->anticipative;
+
+  /* the track is rendered while rolling */
+  transport_request_roll (TRANSPORT, true);
+  engine_wait_n_cycles (AUDIO_ENGINE, 8);
+  g_assert_true (
+    g_atomic_int_get (&graph->anticipative->ahead));
+  g_assert_true (
+    anticipative_renderer_is_rendering_track (
+      graph->anticipative, track));
+  g_assert_cmpuint (
+    g_atomic_int_get (&at->write_idx), >, 0);
+
+  /* and processed live again when stopped */
+  transport_request_pause (TRANSPORT, true);
+  engine_wait_n_cycles (AUDIO_ENGINE, 8);
+  g_assert_false (
+    g_atomic_int_get (&graph->anticipative->ahead));
+
+  test_helper_zrythm_cleanup ();
+  g_unsetenv ("ZRYTHM_DSP_ANTICIPATIVE_MS");
+}
+
+static void
+test_buffer_arena (void)
+{
+  g_setenv ("ZRYTHM_DSP_BUFFER_ARENA", "1", true);
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 2);
+  char * filepath = g_build_filename (
+    TESTS_SRCDIR, "test_start_with_signal.mp3",
+    NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Track * track = track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    TRACKLIST->num_tracks, 1, NULL);
+  supported_file_free (file);
+
+  CompiledGraph *   compiled = ROUTER->graph->compiled;
+  GraphBufferPlan * plan = compiled->buffer_plan;
+  g_assert_nonnull (plan);
+  g_assert_cmpuint (
+    (guintptr) plan->arena
+      % GRAPH_BUFFER_PLAN_ALIGNMENT,
+    ==, 0);
+  g_assert_cmpuint (plan->num_shared, >, 0);
+  g_assert_cmpuint (
+    plan->arena_size, <, plan->unshared_size);
+
+  /* the audio buffers of the graph are aligned
+   * slots of the arena */
+  for (size_t i = 0; i < compiled->schedule_size;
+       i++)
+    {
+      GraphNode * node = &compiled->schedule[i];
+      if (
+        node->type != ROUTE_NODE_TYPE_PORT
+        || node->port->id.type != TYPE_AUDIO)
+        continue;
+
+      Port * port = node->port;
+      g_assert_true (port->buf_in_arena);
+      g_assert_true (
+        port->buf >= plan->arena
+        && port->buf + AUDIO_ENGINE->block_length
+             <= plan->arena
+                  + plan->arena_size / sizeof (float));
+      g_assert_cmpuint (
+        (guintptr) port->buf
+          % GRAPH_BUFFER_PLAN_ALIGNMENT,
+        ==, 0);
+
+      /* ports sharing a buffer are processed one
+       * after the other */
+      for (size_t j = 0; j < i; j++)
+        {
+          GraphNode * prev_node =
+            &compiled->schedule[j];
+          if (
+            prev_node->type != ROUTE_NODE_TYPE_PORT
+            || prev_node->port->buf != port->buf)
+            continue;
+
+          for (int k = 0;
+               k < prev_node->n_childnodes; k++)
+            {
+              g_assert_cmpint (
+                prev_node->childnodes[k]->id, <,
+                node->id);
+            }
+        }
+
+      /* the monitor fader reads the post-fader
+       * outputs of listened tracks outside the
+       * graph's edges */
+      if (
+        port->id.owner_type == PORT_OWNER_TYPE_FADER
+        && port->id.flow == FLOW_OUTPUT
+        && port->id.flags2 & PORT_FLAG2_POSTFADER)
+        {
+          for (size_t j = 0;
+               j < compiled->schedule_size; j++)
+            {
+              GraphNode * other_node =
+                &compiled->schedule[j];
+              if (
+                j == i
+                || other_node->type
+                     != ROUTE_NODE_TYPE_PORT)
+                continue;
+
+              g_assert_true (
+                other_node->port->buf != port->buf);
+            }
+        }
+    }
+
+  /* the tracks are still heard */
+  test_project_stop_dummy_engine ();
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_true (
+    port_has_sound (track->channel->stereo_out->l));
+
+  /* and after moving to the arena of a new
+   * graph */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_true (
+    ROUTER->graph->compiled->buffer_plan != plan);
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_true (
+    port_has_sound (track->channel->stereo_out->l));
+
+  test_helper_zrythm_cleanup ();
+  g_unsetenv ("ZRYTHM_DSP_BUFFER_ARENA");
+}
+
+static void
+test_port_process_funcs (void)
+{
+  test_helper_zrythm_init ();
+
+  char * filepath = g_build_filename (
+    TESTS_SRCDIR, "test_start_with_signal.mp3",
+    NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Track * track = track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    TRACKLIST->num_tracks, 1, NULL);
+  g_assert_nonnull (track);
+  supported_file_free (file);
+
+  Graph * graph = ROUTER->graph;
+
+  /* track processor inputs only take external
+   * data while armed */
+  GraphNode * node = graph_find_node_from_port (
+    graph, track->processor->stereo_in->l);
+  g_assert_nonnull (node->process_port);
+  g_assert_true (
+    node->port_process_flags
+    & PORT_PROCESS_FLAG_TRACK_INPUT);
+  g_assert_false (
+    node->port_process_flags
+    & PORT_PROCESS_FLAG_METER);
+
+  /* channel outputs are metered */
+  GraphNode * out_node = graph_find_node_from_port (
+    graph, track->channel->stereo_out->l);
+  g_assert_nonnull (out_node->process_port);
+  g_assert_true (
+    out_node->port_process_flags
+    & PORT_PROCESS_FLAG_METER);
+  g_assert_true (
+    out_node->port_process_flags
+    & PORT_PROCESS_FLAG_BOUNCE_TO_MASTER);
+  g_assert_true (
+    out_node->process_port != node->process_port);
+
+  node = graph_find_node_from_port (
+    graph, P_MASTER_TRACK->processor->stereo_in->l);
+  g_assert_true (
+    node->port_process_flags
+    & PORT_PROCESS_FLAG_MASTER_INPUT);
+
+  /* automatable controls read automation while
+   * the pre-fader amp is never processed */
+  node = graph_find_node_from_port (
+    graph, track->channel->fader->amp);
+  g_assert_nonnull (node->process_port);
+  node = graph_find_node_from_port (
+    graph, track->channel->prefader->amp);
+  g_assert_null (node->process_port);
+
+  /* the routine is the one the port would be
+   * processed with outside the graph */
+  PortProcessFlags flags;
+  g_assert_true (
+    port_get_process_func (
+      track->channel->stereo_out->l, &flags)
+    == out_node->process_port);
+  g_assert_cmpint (
+    flags, ==, out_node->port_process_flags);
+
+  /* the track still plays back */
+  test_project_stop_dummy_engine ();
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_true (
+    port_has_sound (track->channel->stereo_out->l));
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/graph/"
+
+  g_test_add_func (
+    TEST_PREFIX "test recalc while running",
+    (GTestFunc) test_recalc_while_running);
+  g_test_add_func (
+    TEST_PREFIX "test packed schedule",
+    (GTestFunc) test_packed_schedule);
+  g_test_add_func (
+    TEST_PREFIX "test node timings",
+    (GTestFunc) test_node_timings);
+  g_test_add_func (
+    TEST_PREFIX "test anticipative rendering",
+    (GTestFunc) test_anticipative_rendering);
+  g_test_add_func (
+    TEST_PREFIX "test buffer arena",
+    (GTestFunc) test_buffer_arena);
+  g_test_add_func (
+    TEST_PREFIX "test port process funcs",
+    (GTestFunc) test_port_process_funcs);
+
+  return g_test_run ();
+}
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "audio/loudness_analyzer.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define SAMPLE_RATE 48000
+#define BUF_SIZE (SAMPLE_RATE * 20)
+
+/**
+ * Fills the buffers with a 1 kHz sine at the given
+ * level in dBFS.
+ */
+static void
+fill_sine (
+  float *  l,
+  float *  r,
+  double   dbfs,
+  double * phase)
+{
+  double amp = pow (10.0, dbfs / 20.0);
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      l[i] = (float) (amp * sin (*phase));
+      r[i] = l[i];
+      *phase += 2.0 * G_PI * 1000.0 / SAMPLE_RATE;
+    }
+}
+
+static void
+process_in_cycles (
+  LoudnessAnalyzer * analyzer,
+  const float *      l,
+  const float *      r,
+  nframes_t          cycle_size)
+{
+  for (nframes_t pos = 0; pos < BUF_SIZE;
+       pos += cycle_size)
+    {
+      loudness_analyzer_process (
+        analyzer, &l[pos], &r[pos],
+        MIN (cycle_size, BUF_SIZE - pos));
+    }
+}
+
+static void
+test_sine_loudness (void)
+{
+  test_helper_zrythm_init ();
+
+  float * l = g_new (float, BUF_SIZE);
+  float * r = g_new (float, BUF_SIZE);
+  double  phase = 0.0;
+
+  LoudnessAnalyzer * analyzer =
+    loudness_analyzer_new (SAMPLE_RATE);
+  g_assert_true (isinf (
+    loudness_analyzer_get_integrated (analyzer)));
+
+  /* a stereo 1 kHz sine at -20 dBFS measures
+   * -20 LUFS */
+  fill_sine (l, r, -20.0, &phase);
+  process_in_cycles (analyzer, l, r, 256);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_integrated (analyzer),
+    -20.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_momentary (analyzer),
+    -20.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_short_term (analyzer),
+    -20.0, 0.1);
+  g_assert_cmpfloat (
+    loudness_analyzer_get_range (analyzer), <,
+    0.5);
+
+  /* 10 LU quieter for as long gives a range of
+   * about 10 LU */
+  fill_sine (l, r, -30.0, &phase);
+  process_in_cycles (analyzer, l, r, 256);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_range (analyzer), 10.0,
+    1.0);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_max_momentary (analyzer),
+    -20.0, 0.1);
+
+  /* the quiet part is below the relative gate of
+   * the loud part so it barely counts */
+  float integrated =
+    loudness_analyzer_get_integrated (analyzer);
+  g_assert_cmpfloat (integrated, <, -20.0);
+  g_assert_cmpfloat (integrated, >, -23.0);
+
+  /* restart */
+  loudness_analyzer_request_reset (analyzer);
+  fill_sine (l, r, -23.0, &phase);
+  process_in_cycles (analyzer, l, r, 256);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_integrated (analyzer),
+    -23.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (
+    loudness_analyzer_get_max_momentary (analyzer),
+    -23.0, 0.1);
+
+  loudness_analyzer_free (analyzer);
+  g_free (l);
+  g_free (r);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_split_cycles (void)
+{
+  test_helper_zrythm_init ();
+
+  float * l = g_new (float, BUF_SIZE);
+  float * r = g_new (float, BUF_SIZE);
+  double  phase = 0.0;
+  fill_sine (l, r, -14.0, &phase);
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      /* vary the level over time */
+      r[i] *= (float) (i % SAMPLE_RATE) / SAMPLE_RATE;
+    }
+
+  LoudnessAnalyzer * whole =
+    loudness_analyzer_new (SAMPLE_RATE);
+  loudness_analyzer_process (whole, l, r, BUF_SIZE);
+
+  static const nframes_t cycle_sizes[] = {
+    1, 17, 4800, 4801
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (cycle_sizes);
+       i++)
+    {
+      LoudnessAnalyzer * split =
+        loudness_analyzer_new (SAMPLE_RATE);
+      process_in_cycles (split, l, r, cycle_sizes[i]);
+
+      g_assert_cmpfloat_with_epsilon (
+        loudness_analyzer_get_integrated (whole),
+        loudness_analyzer_get_integrated (split),
+        0.001);
+      g_assert_cmpfloat_with_epsilon (
+        loudness_analyzer_get_range (whole),
+        loudness_analyzer_get_range (split), 0.001);
+      g_assert_cmpfloat_with_epsilon (
+        loudness_analyzer_get_short_term (whole),
+        loudness_analyzer_get_short_term (split),
+        0.001);
+
+      loudness_analyzer_free (split);
+    }
+
+  loudness_analyzer_free (whole);
+  g_free (l);
+  g_free (r);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/loudness_analyzer/"
+
+  g_test_add_func (
+    TEST_PREFIX "test sine loudness",
+    (GTestFunc) test_sine_loudness);
+  g_test_add_func (
+    TEST_PREFIX "test split cycles",
+    (GTestFunc) test_split_cycles);
+
+  return g_test_run ();
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/meter.h"
+#include "audio/port.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define BUF_SIZE 256
+
+static void
+test_meter_reads_processed_values (void)
+{
+  test_helper_zrythm_init ();
+
+  Port * port = port_new_with_type (
+    TYPE_AUDIO, FLOW_OUTPUT, "Meter test");
+  Meter * meter = meter_new_for_port (port);
+  g_assert_nonnull (port->meter_processor);
+  g_assert_true (
+    meter->processor == port->meter_processor);
+  g_assert_cmpint (
+    meter->algorithm, ==,
+    METER_ALGORITHM_DIGITAL_PEAK);
+
+  /* nothing processed yet */
+  float val, max;
+  meter_get_value (
+    meter, AUDIO_VALUE_AMPLITUDE, &val, &max);
+  g_assert_cmpfloat (val, <, 0.0001f);
+  g_assert_cmpint (
+    port->meter_processor->read, ==, 0);
+
+  float buf[BUF_SIZE];
+  for (int i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = 0.5f;
+    }
+  buf[BUF_SIZE / 2] = -0.8f;
+  meter_processor_process (
+    port->meter_processor, buf, BUF_SIZE);
+  g_assert_cmpint (
+    port->meter_processor->seq, ==, 2);
+
+  meter_get_value (
+    meter, AUDIO_VALUE_AMPLITUDE, &val, &max);
+  g_assert_cmpfloat_with_epsilon (
+    val, 0.8f, 0.0001f);
+  g_assert_cmpfloat (max, >=, val);
+
+  /* the next cycle restarts the held values */
+  g_assert_cmpint (
+    port->meter_processor->read, ==, 1);
+  meter_processor_process (
+    port->meter_processor, buf, BUF_SIZE);
+  g_assert_cmpint (
+    port->meter_processor->read, ==, 0);
+
+  meter_free (meter);
+  port_free (port);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_meters_share_processor (void)
+{
+  test_helper_zrythm_init ();
+
+  Port * port = port_new_with_type (
+    TYPE_AUDIO, FLOW_OUTPUT, "Meter test");
+  Meter * meter1 = meter_new_for_port (port);
+  Meter * meter2 = meter_new_for_port (port);
+  g_assert_true (
+    meter1->processor == meter2->processor);
+
+  MeterProcessor * processor = port->meter_processor;
+  g_assert_cmpint (
+    processor
+      ->num_users[METER_ALGORITHM_DIGITAL_PEAK],
+    ==, 2);
+  meter_free (meter1);
+  g_assert_cmpint (
+    processor
+      ->num_users[METER_ALGORITHM_DIGITAL_PEAK],
+    ==, 1);
+  meter_free (meter2);
+  g_assert_cmpint (
+    processor
+      ->num_users[METER_ALGORITHM_DIGITAL_PEAK],
+    ==, 0);
+
+  /* unused algorithms are not processed */
+  float buf[BUF_SIZE];
+  for (int i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = 0.5f;
+    }
+  meter_processor_process (processor, buf, BUF_SIZE);
+  g_assert_cmpint (
+    processor->amps[METER_ALGORITHM_DIGITAL_PEAK],
+    ==, 0);
+
+  port_free (port);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_meter_outlives_port (void)
+{
+  test_helper_zrythm_init ();
+
+  Port * port = port_new_with_type (
+    TYPE_AUDIO, FLOW_OUTPUT, "Meter test");
+  Meter *          meter = meter_new_for_port (port);
+  MeterProcessor * processor = meter->processor;
+  g_assert_cmpint (processor->refcount, ==, 2);
+
+  /* the meter keeps the processor alive */
+  port_free (port);
+  g_assert_cmpint (processor->refcount, ==, 1);
+  g_assert_cmpint (
+    processor
+      ->num_users[METER_ALGORITHM_DIGITAL_PEAK],
+    ==, 1);
+  meter_free (meter);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/meter/"
+
+  g_test_add_func (
+    TEST_PREFIX "test meter reads processed values",
+    (GTestFunc) test_meter_reads_processed_values);
+  g_test_add_func (
+    TEST_PREFIX "test meters share processor",
+    (GTestFunc) test_meters_share_processor);
+  g_test_add_func (
+    TEST_PREFIX "test meter outlives port",
+    (GTestFunc) test_meter_outlives_port);
+
+  return g_test_run ();
+}
@@ -39,6 +39,83 @@ test_add_note_ons (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_merge_runs (void)
+{
+  test_helper_zrythm_init ();
+
+  MidiEvents * events = midi_events_new ();
+  int          run_starts[3];
+
+  /* first run: a note ending and another one
+   * starting at the same time */
+  run_starts[0] = events->num_queued_events;
+  midi_events_add_note_on (
+    events, 1, 60, 90, 10, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 62, 10, F_QUEUED);
+  midi_events_add_note_on (
+    events, 1, 64, 90, 30, F_QUEUED);
+  midi_events_sort_run (events, 0, F_QUEUED);
+
+  /* second run: duplicates of the first one */
+  run_starts[1] = events->num_queued_events;
+  midi_events_add_note_on (
+    events, 1, 64, 90, 30, F_QUEUED);
+  midi_events_add_note_on (
+    events, 1, 60, 90, 10, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 60, 40, F_QUEUED);
+  midi_events_sort_run (
+    events, run_starts[1], F_QUEUED);
+
+  /* third run */
+  run_starts[2] = events->num_queued_events;
+  midi_events_add_note_off (
+    events, 1, 64, 5, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 60, 10, F_QUEUED);
+
+  midi_events_merge_runs (
+    events, run_starts, 3, F_QUEUED);
+
+  /* sorted by time with note offs first and
+   * without duplicates */
+  const struct
+  {
+    midi_time_t time;
+    bool        note_on;
+    midi_byte_t pitch;
+  } expected[] = {
+    { 5,  false, 64},
+    { 10, false, 60},
+    { 10, false, 62},
+    { 10, true,  60},
+    { 30, true,  64},
+    { 40, false, 60},
+  };
+  g_assert_cmpint (
+    events->num_queued_events, ==,
+    (int) G_N_ELEMENTS (expected));
+  for (size_t i = 0; i < G_N_ELEMENTS (expected);
+       i++)
+    {
+      MidiEvent * ev = &events->queued_events[i];
+      g_assert_cmpuint (
+        ev->time, ==, expected[i].time);
+      g_assert_true (
+        midi_is_note_on (ev->raw_buffer)
+        == expected[i].note_on);
+      g_assert_cmpuint (
+        midi_get_note_number (ev->raw_buffer), ==,
+        expected[i].pitch);
+    }
+
+  midi_events_free (events);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -49,6 +126,9 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test add note ons",
     (GTestFunc) test_add_note_ons);
+  g_test_add_func (
+    TEST_PREFIX "test merge runs",
+    (GTestFunc) test_merge_runs);
 
   return g_test_run ();
 }
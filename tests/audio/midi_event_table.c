@@ -0,0 +1,282 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/midi_event.h"
+#include "audio/midi_event_table.h"
+#include "audio/midi_region.h"
+#include "audio/track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/midi.h"
+#include "zrythm.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "tests/helpers/zrythm.h"
+
+#define NUM_NOTES 400
+#define NUM_BARS 4
+#define BLOCK_SIZE 256
+
+/**
+ * Adds a MIDI track with a region containing
+ * notes of different lengths, in no particular
+ * order, some of them overlapping.
+ */
+static ZRegion *
+add_region_with_notes (void)
+{
+  Track * track = track_new (
+    TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+    "MIDI track", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  Position start, end;
+  position_init (&start);
+  position_from_bars (&end, NUM_BARS + 1);
+  ZRegion * r = midi_region_new (
+    &start, &end, track_get_name_hash (track), 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      Position mn_start, mn_end;
+      position_from_ticks (
+        &mn_start,
+        ((i * 37) % NUM_NOTES)
+          * (NUM_BARS * TRANSPORT->ticks_per_bar)
+          / NUM_NOTES);
+      mn_end = mn_start;
+      position_add_ticks (
+        &mn_end, 20.0 + (i % 7) * 40.0);
+      MidiNote * mn = midi_note_new (
+        &r->id, &mn_start, &mn_end,
+        (midi_byte_t) (36 + i % 48), 90);
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  return r;
+}
+
+static void
+check_table (ZRegion * r)
+{
+  MidiEventTable * table = &r->midi_event_table;
+  g_assert_cmpint (
+    table->num_entries, ==, 2 * r->num_midi_notes);
+
+  for (int i = 0; i < table->num_entries; i++)
+    {
+      const MidiEventTableEntry * entry =
+        &table->entries[i];
+      const ArrangerObject * mn_obj =
+        (const ArrangerObject *) entry->note;
+      g_assert_cmpint (
+        entry->frame, ==,
+        entry->note_off ? mn_obj->end_pos.frames
+                        : mn_obj->pos.frames);
+      if (i > 0)
+        {
+          g_assert_cmpint (
+            entry->frame, >=,
+            table->entries[i - 1].frame);
+        }
+    }
+
+  /* the processing threads see the same entries
+   * and no replaced snapshot is kept around */
+  const MidiEventTableSnapshot * snapshot =
+    table->publisher.snapshot;
+  g_assert_nonnull (snapshot);
+  g_assert_cmpint (
+    snapshot->num_entries, ==, table->num_entries);
+  g_assert_cmpint (
+    memcmp (
+      snapshot->entries, table->entries,
+      (size_t) table->num_entries
+        * sizeof (MidiEventTableEntry)),
+    ==, 0);
+  g_assert_true (
+    !table->publisher.retired
+    || table->publisher.retired->len == 0);
+}
+
+/**
+ * Asserts that filling the events of each block
+ * returns the same events as checking every note.
+ */
+static void
+check_playback (ZRegion * r)
+{
+  MidiEvents * events = midi_events_new ();
+
+  Position end_pos;
+  position_from_bars (&end_pos, NUM_BARS + 1);
+  for (signed_frame_t frame = 0;
+       frame < end_pos.frames; frame += BLOCK_SIZE)
+    {
+      int num_note_ons = 0;
+      int num_note_offs = 0;
+      for (int i = 0; i < r->num_midi_notes; i++)
+        {
+          ArrangerObject * mn_obj =
+            (ArrangerObject *) r->midi_notes[i];
+          if (arranger_object_get_muted (
+                mn_obj, false))
+            continue;
+
+          if (
+            mn_obj->pos.frames >= frame
+            && mn_obj->pos.frames
+                 < frame + BLOCK_SIZE)
+            num_note_ons++;
+          if (
+            mn_obj->end_pos.frames >= frame
+            && mn_obj->end_pos.frames
+                 <= frame + BLOCK_SIZE)
+            num_note_offs++;
+        }
+
+      EngineProcessTimeInfo time_nfo = {
+        .g_start_frame = (unsigned_frame_t) frame,
+        .local_offset = 0,
+        .nframes = BLOCK_SIZE,
+      };
+      midi_region_fill_midi_events (
+        r, &time_nfo, false, events);
+
+      for (int i = 0; i < events->num_queued_events;
+           i++)
+        {
+          const MidiEvent * ev =
+            &events->queued_events[i];
+          if (midi_is_note_on (ev->raw_buffer))
+            num_note_ons--;
+          else if (midi_is_note_off (ev->raw_buffer))
+            num_note_offs--;
+          g_assert_cmpuint (ev->time, <, BLOCK_SIZE);
+        }
+      g_assert_cmpint (num_note_ons, ==, 0);
+      g_assert_cmpint (num_note_offs, ==, 0);
+
+      midi_events_clear (events, F_QUEUED);
+    }
+
+  midi_events_free (events);
+}
+
+static void
+test_playback (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = add_region_with_notes ();
+  check_table (r);
+  check_playback (r);
+
+  /* mute some notes */
+  for (int i = 0; i < r->num_midi_notes; i += 5)
+    {
+      arranger_object_set_muted (
+        (ArrangerObject *) r->midi_notes[i], true,
+        F_NO_PUBLISH_EVENTS);
+    }
+  check_playback (r);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_edit_notes (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = add_region_with_notes ();
+
+  /* move */
+  for (int i = 0; i < r->num_midi_notes; i += 3)
+    {
+      arranger_object_move (
+        (ArrangerObject *) r->midi_notes[i],
+        (i % 2 ? 1 : -1) * (i % 11) * 30.0);
+    }
+  check_table (r);
+  check_playback (r);
+
+  /* move in a batch, which publishes once at
+   * the end */
+  MidiEventTable * table = &r->midi_event_table;
+  const MidiEventTableSnapshot * snapshot =
+    table->publisher.snapshot;
+  snapshot_publisher_begin_batch ();
+  for (int i = 0; i < r->num_midi_notes; i += 2)
+    {
+      arranger_object_move (
+        (ArrangerObject *) r->midi_notes[i],
+        (i % 3 ? 1 : -1) * (i % 7) * 40.0);
+    }
+  g_assert_true (
+    table->publisher.snapshot == snapshot);
+  snapshot_publisher_end_batch ();
+  g_assert_true (
+    table->publisher.snapshot != snapshot);
+  check_table (r);
+  check_playback (r);
+
+  /* resize */
+  for (int i = 1; i < r->num_midi_notes; i += 4)
+    {
+      arranger_object_resize (
+        (ArrangerObject *) r->midi_notes[i], false,
+        ARRANGER_OBJECT_RESIZE_NORMAL,
+        (i % 3 + 1) * 60.0, false);
+    }
+  check_table (r);
+  check_playback (r);
+
+  /* remove */
+  while (r->num_midi_notes > NUM_NOTES / 2)
+    {
+      midi_region_remove_midi_note (
+        r, r->midi_notes[r->num_midi_notes / 3],
+        F_FREE, F_NO_PUBLISH_EVENTS);
+    }
+  check_table (r);
+  check_playback (r);
+
+  /* clone */
+  ZRegion * clone = (ZRegion *) arranger_object_clone (
+    (ArrangerObject *) r);
+  g_assert_cmpint (
+    clone->midi_event_table.num_entries, ==,
+    2 * r->num_midi_notes);
+  arranger_object_free ((ArrangerObject *) clone);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/midi_event_table/"
+
+  g_test_add_func (
+    TEST_PREFIX "test playback",
+    (GTestFunc) test_playback);
+  g_test_add_func (
+    TEST_PREFIX "test edit notes",
+    (GTestFunc) test_edit_notes);
+
+  return g_test_run ();
+}
@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/midi_region.h"
+#include "audio/region_index.h"
+#include "audio/track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "tests/helpers/zrythm.h"
+
+#define NUM_REGIONS 64
+
+/**
+ * Adds a MIDI track with regions of different
+ * lengths, in no particular order, some of them
+ * overlapping.
+ */
+static Track *
+add_track_with_regions (void)
+{
+  Track * track = track_new (
+    TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+    "MIDI track", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  for (int i = 0; i < NUM_REGIONS; i++)
+    {
+      Position start, end;
+      position_from_bars (
+        &start, (i * 37) % NUM_REGIONS);
+      end = start;
+      position_add_bars (&end, 1 + i % 5);
+      ZRegion * r = midi_region_new (
+        &start, &end, track_get_name_hash (track),
+        0, i);
+      track_add_region (
+        track, r, NULL, 0, F_GEN_NAME,
+        F_NO_PUBLISH_EVENTS);
+    }
+
+  return track;
+}
+
+/**
+ * Asserts that the index finds the same regions as
+ * checking every region of the lane.
+ */
+static void
+check_range (
+  TrackLane *    lane,
+  signed_frame_t start,
+  signed_frame_t end)
+{
+  int num_expected = 0;
+  for (int i = 0; i < lane->num_regions; i++)
+    {
+      if (region_is_hit_by_range (
+            lane->regions[i], start, end,
+            F_INCLUSIVE))
+        {
+          num_expected++;
+        }
+    }
+
+  RegionIndex * index = &lane->region_index;
+  const RegionIndexSnapshot * snapshot =
+    region_index_acquire (index);
+  g_assert_nonnull (snapshot);
+  int num_found = 0;
+  for (int i = region_index_find_first (
+         index, snapshot, start);
+       i < snapshot->num_entries; i++)
+    {
+      const RegionIndexEntry * entry =
+        &snapshot->entries[i];
+      if (entry->start > end)
+        break;
+      if (entry->end < start)
+        continue;
+
+      g_assert_true (region_is_hit_by_range (
+        entry->region, start, end, F_INCLUSIVE));
+      num_found++;
+    }
+  region_index_release (index);
+
+  g_assert_cmpint (num_found, ==, num_expected);
+}
+
+static void
+check_index (TrackLane * lane)
+{
+  RegionIndex * index = &lane->region_index;
+  g_assert_cmpint (
+    index->num_entries, ==, lane->num_regions);
+
+  signed_frame_t max_end = G_MININT64;
+  for (int i = 0; i < index->num_entries; i++)
+    {
+      const RegionIndexEntry * entry =
+        &index->entries[i];
+      const ArrangerObject * r_obj =
+        (const ArrangerObject *) entry->region;
+      g_assert_cmpint (
+        entry->start, ==, r_obj->pos.frames);
+      g_assert_cmpint (
+        entry->end, ==, r_obj->end_pos.frames);
+      if (i > 0)
+        {
+          g_assert_cmpint (
+            entry->start, >=,
+            index->entries[i - 1].start);
+        }
+      max_end = MAX (max_end, entry->end);
+      g_assert_cmpint (entry->max_end, ==, max_end);
+    }
+
+  /* the processing threads see the same entries
+   * and no replaced snapshot is kept around */
+  const RegionIndexSnapshot * snapshot =
+    index->publisher.snapshot;
+  g_assert_nonnull (snapshot);
+  g_assert_cmpint (
+    snapshot->num_entries, ==, index->num_entries);
+  g_assert_cmpint (
+    memcmp (
+      snapshot->entries, index->entries,
+      (size_t) index->num_entries
+        * sizeof (RegionIndexEntry)),
+    ==, 0);
+  g_assert_true (
+    !index->publisher.retired
+    || index->publisher.retired->len == 0);
+
+  /* sequential lookups like during playback */
+  Position end_pos;
+  position_from_bars (&end_pos, NUM_REGIONS + 8);
+  nframes_t block = 4096;
+  for (signed_frame_t frame = 0;
+       frame < end_pos.frames; frame += block)
+    {
+      check_range (lane, frame, frame + block - 1);
+    }
+
+  /* random lookups */
+  for (int i = 0; i < 200; i++)
+    {
+      signed_frame_t frame = g_test_rand_int_range (
+        0, (gint32) end_pos.frames);
+      check_range (lane, frame, frame + block - 1);
+    }
+}
+
+static void
+test_lookup (void)
+{
+  test_helper_zrythm_init ();
+
+  Track *     track = add_track_with_regions ();
+  TrackLane * lane = track->lanes[0];
+  check_index (lane);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_edit_regions (void)
+{
+  test_helper_zrythm_init ();
+
+  Track *     track = add_track_with_regions ();
+  TrackLane * lane = track->lanes[0];
+
+  /* move */
+  for (int i = 0; i < NUM_REGIONS; i += 3)
+    {
+      arranger_object_move (
+        (ArrangerObject *) lane->regions[i],
+        (i % 2 ? 1 : -1) * i * 100.0);
+    }
+  check_index (lane);
+
+  /* move in a batch, which publishes once at
+   * the end */
+  RegionIndex * index = &lane->region_index;
+  const RegionIndexSnapshot * snapshot =
+    index->publisher.snapshot;
+  snapshot_publisher_begin_batch ();
+  for (int i = 1; i < NUM_REGIONS; i += 2)
+    {
+      arranger_object_move (
+        (ArrangerObject *) lane->regions[i],
+        (i % 3 ? 1 : -1) * i * 50.0);
+    }
+  g_assert_true (
+    index->publisher.snapshot == snapshot);
+  snapshot_publisher_end_batch ();
+  g_assert_true (
+    index->publisher.snapshot != snapshot);
+  check_index (lane);
+
+  /* resize */
+  for (int i = 1; i < NUM_REGIONS; i += 4)
+    {
+      arranger_object_resize (
+        (ArrangerObject *) lane->regions[i], false,
+        ARRANGER_OBJECT_RESIZE_NORMAL,
+        TRANSPORT->ticks_per_bar * (i % 3 + 1),
+        false);
+    }
+  check_index (lane);
+
+  /* remove */
+  while (lane->num_regions > NUM_REGIONS / 2)
+    {
+      track_remove_region (
+        track, lane->regions[lane->num_regions / 3],
+        F_NO_PUBLISH_EVENTS, F_FREE);
+    }
+  check_index (lane);
+
+  /* clone */
+  TrackLane * clone = track_lane_clone (lane, track);
+  g_assert_cmpint (
+    clone->region_index.num_entries, ==,
+    lane->num_regions);
+  track_lane_free (clone);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/region_index/"
+
+  g_test_add_func (
+    TEST_PREFIX "test lookup",
+    (GTestFunc) test_lookup);
+  g_test_add_func (
+    TEST_PREFIX "test edit regions",
+    (GTestFunc) test_edit_regions);
+
+  return g_test_run ();
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "audio/true_peak_detector.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define BUF_SIZE 1000
+
+static void
+test_split_cycles (void)
+{
+  test_helper_zrythm_init ();
+
+  float buf[BUF_SIZE];
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = sinf ((float) i * 0.9f) * 0.5f;
+    }
+
+  TruePeakDetector detector;
+  true_peak_detector_reset (&detector);
+  float expected = true_peak_detector_process (
+    &detector, buf, BUF_SIZE);
+  g_assert_cmpfloat (expected, >, 0.5f);
+
+  /* cycles shorter and longer than the history
+   * give the same result as one cycle */
+  static const nframes_t cycle_sizes[] = {
+    1, 5, 11, 12, 64
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (cycle_sizes);
+       i++)
+    {
+      true_peak_detector_reset (&detector);
+      float true_peak = 0.f;
+      for (nframes_t pos = 0; pos < BUF_SIZE;
+           pos += cycle_sizes[i])
+        {
+          nframes_t nframes = MIN (
+            cycle_sizes[i], BUF_SIZE - pos);
+          float cycle_true_peak =
+            true_peak_detector_process (
+              &detector, &buf[pos], nframes);
+          true_peak = MAX (true_peak, cycle_true_peak);
+        }
+      g_assert_cmpfloat_with_epsilon (
+        true_peak, expected, 0.00001f);
+    }
+
+  /* most of a single sample's ringing is only
+   * seen in the next cycle */
+  true_peak_detector_reset (&detector);
+  float impulse = 1.f;
+  float zeros[4] = { 0 };
+  float first =
+    true_peak_detector_process (&detector, &impulse, 1);
+  g_assert_cmpfloat (
+    true_peak_detector_process (&detector, zeros, 4),
+    >, first);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/true_peak_detector/"
+
+  g_test_add_func (
+    TEST_PREFIX "test split cycles",
+    (GTestFunc) test_split_cycles);
+
+  return g_test_run ();
+}
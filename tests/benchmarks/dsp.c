@@ -19,10 +19,22 @@
 
 #include "zrythm-test-config.h"
 
+#include <math.h>
+
+#include "audio/curve.h"
+#include "audio/fade.h"
+#include "audio/graph.h"
+#include "audio/router.h"
+#include "audio/true_peak_detector.h"
+#include "audio/true_peak_dsp.h"
 #include "utils/dsp.h"
+#include "utils/dsp_simd.h"
+#include "utils/flags.h"
 #include "utils/objects.h"
+#include "utils/smoothed_value.h"
 #include "zrythm.h"
 
+#include "tests/helpers/benchmark.h"
 #include "tests/helpers/plugin_manager.h"
 #include "tests/helpers/project.h"
 #include "tests/helpers/zrythm.h"
@@ -35,7 +47,11 @@
 #define LARGE_BUFFER_SIZE 2000
 
 #define NUM_ITERATIONS_ENGINE 1000
-#define NUM_ITERATIONS_MANY 30000
+
+/** Samples and iterations per sample of the DSP
+ * benchmarks. */
+#define NUM_SAMPLES 30
+#define NUM_ITERATIONS 1000
 
 #define F_OPTIMIZED 1
 #define F_NOT_OPTIMIZED 0
@@ -45,31 +61,21 @@
 
 #define NUM_TRACKS 100
 
-typedef struct DspBenchmark
-{
-  /* function called */
-  const char * func_name;
-  /* microseconds taken */
-  long unoptimized_usec;
-  long optimized_usec;
-} DspBenchmark;
-
-static DspBenchmark benchmarks[400];
-static int          num_benchmarks = 0;
-
-static DspBenchmark *
-benchmark_find (const char * func_name)
+/** Number of sources summed in the N-way sum
+ * benchmarks. */
+#define NUM_SUM_SRCS 16
+
+/**
+ * One-pole feedback filter.
+ */
+static void
+run_decay (float * buf, size_t size, float * state)
 {
-  for (int i = 0; i < num_benchmarks; i++)
+  for (size_t i = 0; i < size; i++)
     {
-      DspBenchmark * benchmark = &benchmarks[i];
-      if (string_is_equal (
-            benchmark->func_name, func_name))
-        {
-          return benchmark;
-        }
+      *state = buf[i] + 0.995f * *state;
+      buf[i] = *state;
     }
-  return NULL;
 }
 
 static void
@@ -84,7 +90,6 @@ _test_dsp_fill (bool optimized, bool large_buff)
       test_helper_zrythm_init ();
     }
 
-  gint64  start, end;
   float * buf =
     object_new_n (LARGE_BUFFER_SIZE, float);
   float * src =
@@ -94,73 +99,174 @@ _test_dsp_fill (bool optimized, bool large_buff)
   size_t buf_size =
     large_buff ? LARGE_BUFFER_SIZE : BUFFER_SIZE;
 
-  DspBenchmark * benchmark;
-
-#define LOOP_START \
-  start = g_get_monotonic_time (); \
-  for (int i = 0; i < NUM_ITERATIONS_MANY; i++) \
-    {
-
-#define LOOP_END(fname, is_optimized) \
-  } \
-  end = g_get_monotonic_time (); \
-  benchmark = benchmark_find (fname); \
-  if (!benchmark) \
-    { \
-      benchmark = &benchmarks[num_benchmarks]; \
-      num_benchmarks++; \
-    } \
-  benchmark->func_name = fname; \
-  if (is_optimized) \
-    { \
-      benchmark->optimized_usec = end - start; \
-    } \
-  else \
-    { \
-      benchmark->unoptimized_usec = end - start; \
-    }
+#define LOOP_START(fname) \
+  BENCHMARK_LOOP_START ( \
+    optimized ? fname " (optimized)" : fname, \
+    NUM_SAMPLES, NUM_ITERATIONS)
 
-  LOOP_START
+  LOOP_START ("fill")
   dsp_fill (buf, val, buf_size);
-  LOOP_END ("fill", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("limit1")
   dsp_limit1 (buf, -1.0f, 1.1f, buf_size);
-  LOOP_END ("limit1", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("add2")
   dsp_add2 (buf, src, buf_size);
-  LOOP_END ("add2", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("abs_max")
   float abs_max = dsp_abs_max (buf, buf_size);
   (void) abs_max;
-  LOOP_END ("abs_max", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("min")
   dsp_min (buf, buf_size);
-  LOOP_END ("min", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("max")
   dsp_max (buf, buf_size);
-  LOOP_END ("max", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("mul_k2")
   dsp_mul_k2 (buf, 0.99f, buf_size);
-  LOOP_END ("mul_k2", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("copy")
   dsp_copy (buf, src, buf_size);
-  LOOP_END ("copy", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("mix2")
   dsp_mix2 (buf, src, 0.1f, 0.2f, buf_size);
-  LOOP_END ("mix2", optimized);
+  BENCHMARK_LOOP_END;
 
-  LOOP_START
+  LOOP_START ("mix_add2")
   dsp_mix_add2 (
     buf, src, src, 0.1f, 0.2f, buf_size);
-  LOOP_END ("mix_add2", optimized);
+  BENCHMARK_LOOP_END;
+
+  /* summing many sources into a fader input, one
+   * source at a time vs fused */
+  const float * srcs[NUM_SUM_SRCS];
+  float         ks[NUM_SUM_SRCS];
+  for (int j = 0; j < NUM_SUM_SRCS; j++)
+    {
+      srcs[j] = src;
+      ks[j] = 0.5f + 0.01f * (float) j;
+    }
+
+  LOOP_START ("mix2+limit1 (sources)")
+  for (int j = 0; j < NUM_SUM_SRCS; j++)
+    {
+      dsp_mix2 (buf, srcs[j], 1.f, ks[j], buf_size);
+      if (dsp_abs_max (buf, buf_size) > 2.f)
+        dsp_limit1 (buf, -2.f, 2.f, buf_size);
+    }
+  BENCHMARK_LOOP_END;
+
+  LOOP_START ("sum_n (sources)")
+  dsp_sum_n (
+    buf, srcs, ks, NUM_SUM_SRCS, true, -2.f, 2.f,
+    buf_size);
+  BENCHMARK_LOOP_END;
+
+  /* gain ramping over the whole buffer vs settled
+   * gain (should cost the same as mul_k2) */
+  SmoothedValue gain = { 0 };
+  float *       bufs[] = { buf };
+  smoothed_value_reset (&gain, 0.99f);
+
+  LOOP_START ("smoothed gain (ramping)")
+  smoothed_value_set_target (
+    &gain, i % 2 ? 0.99f : 0.98f,
+    SMOOTHED_VALUE_EXPONENTIAL, (nframes_t) buf_size);
+  smoothed_value_apply (
+    &gain, bufs, 1, (nframes_t) buf_size);
+  BENCHMARK_LOOP_END;
+
+  LOOP_START ("smoothed gain (settled)")
+  smoothed_value_apply (
+    &gain, bufs, 1, (nframes_t) buf_size);
+  BENCHMARK_LOOP_END;
+
+  /* fading the whole buffer, per frame vs with a
+   * fade table */
+  CurveOptions fade_opts;
+  curve_opts_init (&fade_opts);
+  fade_opts.algo = CURVE_ALGORITHM_SUPERELLIPSE;
+  fade_opts.curviness = 0.5;
+
+  LOOP_START ("fade (per frame)")
+  for (size_t j = 0; j < buf_size; j++)
+    {
+      float y = (float) fade_get_y_normalized (
+        (double) j / (double) buf_size, &fade_opts,
+        true);
+      buf[j] *= y;
+      src[j] *= y;
+    }
+  BENCHMARK_LOOP_END;
+
+  LOOP_START ("fade (table)")
+  fade_apply (
+    &fade_opts, true, buf, src, 0,
+    (signed_frame_t) buf_size, (nframes_t) buf_size);
+  BENCHMARK_LOOP_END;
+
+  /* a feedback filter decaying in silence (like a
+   * reverb tail) runs into denormals unless they
+   * are prevented with an offset or flushed */
+  float state;
+
+  LOOP_START ("decay (denormals)")
+  dsp_fill (buf, 0.f, buf_size);
+  state = 1e-37f;
+  run_decay (buf, buf_size, &state);
+  BENCHMARK_LOOP_END;
+
+  LOOP_START ("decay (denormal fill)")
+  dsp_fill (buf, i % 2 ? 1e-20f : -1e-20f, buf_size);
+  state = 1e-37f;
+  run_decay (buf, buf_size, &state);
+  BENCHMARK_LOOP_END;
+
+  dsp_simd_set_flush_denormals (true);
+  LOOP_START ("decay (flush denormals)")
+  dsp_fill (buf, 0.f, buf_size);
+  state = 1e-37f;
+  run_decay (buf, buf_size, &state);
+  BENCHMARK_LOOP_END;
+  dsp_simd_set_flush_denormals (false);
+
+  /* true peak of each cycle, resampling vs the
+   * polyphase detector */
+  for (size_t j = 0; j < buf_size; j++)
+    {
+      src[j] = sinf ((float) j * 0.3f);
+    }
+  TruePeakDsp * true_peak_dsp = true_peak_dsp_new ();
+  true_peak_dsp_init (true_peak_dsp, 48000.f);
+
+  LOOP_START ("true peak (resampler)")
+  true_peak_dsp_process (
+    true_peak_dsp, src, (int) buf_size);
+  BENCHMARK_LOOP_END;
+
+  TruePeakDetector true_peak_detector = { 0 };
+  float            true_peak = 0.f;
+
+  LOOP_START ("true peak (polyphase)")
+  float cycle_true_peak = true_peak_detector_process (
+    &true_peak_detector, src, (nframes_t) buf_size);
+  true_peak = MAX (true_peak, cycle_true_peak);
+  BENCHMARK_LOOP_END;
+
+#undef LOOP_START
+
+  g_assert_cmpfloat_with_epsilon (
+    true_peak, 1.f, 0.01f);
+  true_peak_dsp_free (true_peak_dsp);
 
   free (buf);
   free (src);
@@ -177,6 +283,19 @@ test_dsp_fill (void)
 #endif
 }
 
+/**
+ * Recreates the graph so that its threads pick
+ * up the engine's denormal mode, which they only
+ * apply when they start.
+ */
+static void
+restart_graph (void)
+{
+  graph_destroy (ROUTER->graph);
+  ROUTER->graph = NULL;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+}
+
 static void
 _test_run_engine (bool optimized)
 {
@@ -200,81 +319,78 @@ _test_run_engine (bool optimized)
     }
 #endif
 
-    /* create a few tracks with plugins */
+  /* create a few tracks with plugins */
 #ifdef HAVE_LSP_COMPRESSOR
   test_plugin_manager_create_tracks_from_plugin (
     LSP_COMPRESSOR_BUNDLE, LSP_COMPRESSOR_URI,
     false, false, NUM_TRACKS);
 #endif
 
-  DspBenchmark * benchmark;
-
-  gint64 start, end;
-  start = g_get_monotonic_time ();
-  for (int i = 0; i < NUM_ITERATIONS_ENGINE; i++)
-    {
-      engine_process (
-        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
-      LOOP_END ("engine cycles", optimized);
-
-      g_message (
-        "%soptimized time: %ld",
-        optimized ? "" : "un", end - start);
-      /*g_warn_if_reached ();*/
+  /* keeping denormals away with an offset first,
+   * then flushing them to zero (the default) */
+  AUDIO_ENGINE->flush_denormals = false;
+  dsp_simd_set_flush_denormals (false);
+  restart_graph ();
+  BENCHMARK_LOOP_START (
+    optimized
+      ? "engine cycle (denormal fill, optimized)"
+      : "engine cycle (denormal fill)",
+    NUM_ITERATIONS_ENGINE, 1)
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  BENCHMARK_LOOP_END;
+
+  AUDIO_ENGINE->flush_denormals =
+    dsp_simd_can_flush_denormals ();
+  dsp_simd_set_flush_denormals (
+    AUDIO_ENGINE->flush_denormals);
+  restart_graph ();
+  BENCHMARK_LOOP_START (
+    optimized ? "engine cycle (optimized)"
+              : "engine cycle",
+    NUM_ITERATIONS_ENGINE, 1)
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  BENCHMARK_LOOP_END;
+  dsp_simd_set_flush_denormals (false);
 
 #ifdef HAVE_LSP_DSP
-      if (optimized)
-        {
-          lsp_dsp_finish (&ctx);
-        }
+  if (optimized)
+    {
+      lsp_dsp_finish (&ctx);
+    }
 #endif
 
-      test_helper_zrythm_cleanup ();
-    }
+  test_helper_zrythm_cleanup ();
+}
 
-  static void test_run_engine (void)
-  {
+static void
+test_run_engine (void)
+{
 #ifdef HAVE_LSP_DSP
-    _test_run_engine (F_OPTIMIZED);
+  _test_run_engine (F_OPTIMIZED);
 #endif
-    _test_run_engine (F_NOT_OPTIMIZED);
-  }
-
-  static void print_benchmark_results (void)
-  {
-    for (int i = 0; i < num_benchmarks; i++)
-      {
-        DspBenchmark * benchmark = &benchmarks[i];
-        fprintf (
-          stderr,
-          "---- %s ----\n"
-          "unoptimized: %ldms\n"
-          "optimized: %ldms\n",
-          benchmark->func_name,
-          benchmark->unoptimized_usec / 1000,
-          benchmark->optimized_usec / 1000);
-      }
-  }
-
-  int main (int argc, char * argv[])
-  {
-    g_test_init (&argc, &argv, NULL);
+  _test_run_engine (F_NOT_OPTIMIZED);
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
 
 #ifdef HAVE_LSP_DSP
-    lsp_dsp_init ();
+  lsp_dsp_init ();
 #endif
 
 #define TEST_PREFIX "/benchmarks/dsp/"
 
-    g_test_add_func (
-      TEST_PREFIX "test dsp fill",
-      (GTestFunc) test_dsp_fill);
-    g_test_add_func (
-      TEST_PREFIX "test run engine",
-      (GTestFunc) test_run_engine);
-    g_test_add_func (
-      TEST_PREFIX "print benchmark results",
-      (GTestFunc) print_benchmark_results);
-
-    return g_test_run ();
-  }
+  g_test_add_func (
+    TEST_PREFIX "test dsp fill",
+    (GTestFunc) test_dsp_fill);
+  g_test_add_func (
+    TEST_PREFIX "test run engine",
+    (GTestFunc) test_run_engine);
+  BENCHMARK_ADD_RESULT_TESTS (TEST_PREFIX, "dsp");
+
+  return g_test_run ();
+}
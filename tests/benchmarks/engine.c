@@ -0,0 +1,352 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "audio/automation_region.h"
+#include "audio/engine.h"
+#include "audio/meter.h"
+#include "audio/midi_event.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/port.h"
+#include "audio/supported_file.h"
+#include "audio/track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/benchmark.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+/** Samples of the per-cycle benchmarks. */
+#define NUM_CYCLES 2000
+
+/** Samples of the project save/load
+ * benchmarks. */
+#define NUM_SAVE_LOAD_SAMPLES 10
+
+/** Length of the regions, in bars. */
+#define REGION_BARS 64
+
+/** Number of MIDI notes and automation points (one
+ * per sixteenth). */
+#define NUM_OBJECTS (REGION_BARS * 16)
+
+typedef struct EngineFixture
+{
+  Track *           midi_track;
+  Track *           audio_track;
+  AutomationTrack * at;
+} EngineFixture;
+
+/**
+ * Adds a MIDI track with a dense region, an audio
+ * track with a region and a dense automation
+ * region on the master fader.
+ */
+static void
+fixture_set_up (EngineFixture * self)
+{
+  test_project_stop_dummy_engine ();
+
+  Position start, end;
+  position_init (&start);
+  position_from_bars (&end, REGION_BARS);
+
+  /* MIDI */
+  self->midi_track = track_new (
+    TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+    "MIDI track", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, self->midi_track,
+    F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
+  ZRegion * r = midi_region_new (
+    &start, &end,
+    track_get_name_hash (self->midi_track), 0, 0);
+  for (int i = 0; i < NUM_OBJECTS; i++)
+    {
+      Position note_start, note_end;
+      position_init (&note_start);
+      position_add_sixteenths (&note_start, i);
+      note_end = note_start;
+      position_add_ticks (
+        &note_end,
+        TICKS_PER_SIXTEENTH_NOTE_DBL / 2);
+      MidiNote * mn = midi_note_new (
+        &r->id, &note_start, &note_end,
+        (midi_byte_t) (36 + i % 48), 90);
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  track_add_region (
+    self->midi_track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* automation */
+  self->at = channel_get_automation_track (
+    P_MASTER_TRACK->channel, PORT_FLAG_AMPLITUDE);
+  r = automation_region_new (
+    &start, &end,
+    track_get_name_hash (P_MASTER_TRACK),
+    self->at->index, 0);
+  track_add_region (
+    P_MASTER_TRACK, r, self->at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  for (int i = 0; i < NUM_OBJECTS; i++)
+    {
+      Position pos;
+      position_init (&pos);
+      position_add_sixteenths (&pos, i);
+      float             val = (float) (i % 8) / 8.f;
+      AutomationPoint * ap =
+        automation_point_new_float (val, val, &pos);
+      automation_region_add_ap (
+        r, ap, F_NO_PUBLISH_EVENTS);
+    }
+
+  /* audio */
+  char * filepath = g_build_filename (
+    TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  self->audio_track = track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, &start,
+    TRACKLIST->num_tracks, 1, NULL);
+  g_assert_nonnull (self->audio_track);
+  supported_file_free (file);
+  g_free (filepath);
+
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+}
+
+/**
+ * Returns the time info of the given cycle,
+ * wrapping around at the end of the regions.
+ */
+static EngineProcessTimeInfo
+get_cycle_time_nfo (int cycle)
+{
+  Position end;
+  position_from_bars (&end, REGION_BARS);
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+  unsigned_frame_t num_cycles =
+    (unsigned_frame_t) end.frames / nframes;
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame =
+      ((unsigned_frame_t) cycle % num_cycles)
+      * nframes,
+    .local_offset = 0,
+    .nframes = nframes,
+  };
+  return time_nfo;
+}
+
+static void
+test_midi_region_fill (void)
+{
+  test_helper_zrythm_init ();
+
+  EngineFixture fixture;
+  fixture_set_up (&fixture);
+
+  MidiEvents * events = midi_events_new ();
+
+  int cycle = 0;
+  BENCHMARK_LOOP_START (
+    "midi region fill", NUM_CYCLES, 1)
+  EngineProcessTimeInfo time_nfo =
+    get_cycle_time_nfo (cycle++);
+  track_fill_events (
+    fixture.midi_track, &time_nfo, events, NULL);
+  midi_events_clear (events, F_QUEUED);
+  BENCHMARK_LOOP_END;
+
+  midi_events_free (events);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_automation_read (void)
+{
+  test_helper_zrythm_init ();
+
+  EngineFixture fixture;
+  fixture_set_up (&fixture);
+
+  /* one read per cycle, like the engine does */
+  float sum = 0.f;
+  int   cycle = 0;
+  BENCHMARK_LOOP_START (
+    "automation read", NUM_CYCLES, 1)
+  EngineProcessTimeInfo time_nfo =
+    get_cycle_time_nfo (cycle++);
+  Position pos;
+  position_from_frames (
+    &pos, (signed_frame_t) time_nfo.g_start_frame);
+  sum += automation_track_get_val_at_pos (
+    fixture.at, &pos, true, true);
+  BENCHMARK_LOOP_END;
+  g_assert_cmpfloat (sum, >, 0.f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_audio_region_playback (void)
+{
+  test_helper_zrythm_init ();
+
+  EngineFixture fixture;
+  fixture_set_up (&fixture);
+
+  StereoPorts * ports = stereo_ports_new_generic (
+    false, "ports", "ports", PORT_OWNER_TYPE_TRACK,
+    fixture.audio_track);
+  port_allocate_bufs (ports->l);
+  port_allocate_bufs (ports->r);
+
+  int cycle = 0;
+  BENCHMARK_LOOP_START (
+    "audio region playback", NUM_CYCLES, 1)
+  EngineProcessTimeInfo time_nfo =
+    get_cycle_time_nfo (cycle++);
+  track_fill_events (
+    fixture.audio_track, &time_nfo, NULL, ports);
+  BENCHMARK_LOOP_END;
+
+  stereo_ports_free (ports);
+
+  /* the whole engine cycle with all of the
+   * above */
+  BENCHMARK_LOOP_START (
+    "engine cycle", NUM_CYCLES, 1)
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  BENCHMARK_LOOP_END;
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_metering (void)
+{
+  test_helper_zrythm_init ();
+
+  Port * port = port_new_with_type (
+    TYPE_AUDIO, FLOW_OUTPUT, "Meter benchmark");
+  port_allocate_bufs (port);
+  for (nframes_t i = 0;
+       i < AUDIO_ENGINE->block_length; i++)
+    {
+      port->buf[i] = sinf ((float) i * 0.3f) * 0.5f;
+    }
+  Meter * meter = meter_new_for_port (port);
+  MeterProcessor * processor =
+    port->meter_processor;
+
+  static const char * names[] = {
+    [METER_ALGORITHM_DIGITAL_PEAK] =
+      "metering (digital peak)",
+    [METER_ALGORITHM_TRUE_PEAK] =
+      "metering (true peak)",
+    [METER_ALGORITHM_RMS] = "metering (rms)",
+    [METER_ALGORITHM_K] = "metering (k)",
+  };
+
+  /* only the algorithms in use are processed */
+  for (int algo = METER_ALGORITHM_DIGITAL_PEAK;
+       algo < NUM_METER_ALGORITHMS; algo++)
+    {
+      for (int i = 0; i < NUM_METER_ALGORITHMS; i++)
+        {
+          g_atomic_int_set (
+            &processor->num_users[i], i == algo);
+        }
+
+      BENCHMARK_LOOP_START (
+        names[algo], NUM_CYCLES, 1)
+      meter_processor_process (
+        processor, port->buf,
+        AUDIO_ENGINE->block_length);
+      BENCHMARK_LOOP_END;
+    }
+
+  g_atomic_int_set (
+    &processor->num_users[meter->algorithm], 1);
+  meter_free (meter);
+  port_free (port);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_project_save_load (void)
+{
+  test_helper_zrythm_init ();
+
+  EngineFixture fixture;
+  fixture_set_up (&fixture);
+
+  Benchmark * save_benchmark =
+    benchmark_get ("project save");
+  Benchmark * load_benchmark =
+    benchmark_get ("project load");
+  for (int i = 0; i < NUM_SAVE_LOAD_SAMPLES; i++)
+    {
+      benchmark_sample_start (save_benchmark, 1);
+      char * prj_file = test_project_save ();
+      benchmark_sample_end (save_benchmark);
+
+      /* recreate the recording manager to drop
+       * any events */
+      object_free_w_func_and_null (
+        recording_manager_free,
+        ZRYTHM->recording_manager);
+      ZRYTHM->recording_manager =
+        recording_manager_new ();
+
+      benchmark_sample_start (load_benchmark, 1);
+      test_project_reload (prj_file);
+      benchmark_sample_end (load_benchmark);
+      g_free (prj_file);
+
+      test_project_stop_dummy_engine ();
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/engine/"
+
+  g_test_add_func (
+    TEST_PREFIX "test midi region fill",
+    (GTestFunc) test_midi_region_fill);
+  g_test_add_func (
+    TEST_PREFIX "test automation read",
+    (GTestFunc) test_automation_read);
+  g_test_add_func (
+    TEST_PREFIX "test audio region playback",
+    (GTestFunc) test_audio_region_playback);
+  g_test_add_func (
+    TEST_PREFIX "test metering",
+    (GTestFunc) test_metering);
+  g_test_add_func (
+    TEST_PREFIX "test project save load",
+    (GTestFunc) test_project_save_load);
+  BENCHMARK_ADD_RESULT_TESTS (
+    TEST_PREFIX, "engine");
+
+  return g_test_run ();
+}
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "actions/mixer_selections_action.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/router.h"
+#include "settings/plugin_settings.h"
+#include "utils/flags.h"
+#include "utils/string.h"
+#include "zrythm.h"
+
+#include "tests/helpers/benchmark.h"
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_ITERATIONS 2000
+
+static const char * schedulers[] = {
+  "queue",
+  "work-stealing",
+};
+
+static const int track_counts[] = {
+  16,
+  64,
+  256,
+};
+
+static const int plugin_counts[] = {
+  1,
+  4,
+};
+
+static void
+run_graph (
+  const char * scheduler,
+  int          num_tracks,
+  int          num_plugins)
+{
+  /* the scheduler is picked when the graph is
+   * created during project load */
+  g_setenv ("ZRYTHM_GRAPH_SCHEDULER", scheduler, true);
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  /* each track adds a track processor, the
+   * inserts, a prefader, a fader, sends and their
+   * ports to the graph */
+  int last_track_pos =
+    test_plugin_manager_create_tracks_from_plugin (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false,
+      num_tracks);
+  if (num_plugins > 1)
+    {
+      PluginSetting * setting =
+        test_plugin_manager_get_plugin_setting (
+          EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+      for (int i = last_track_pos - num_tracks + 1;
+           i <= last_track_pos; i++)
+        {
+          Track * track = TRACKLIST->tracks[i];
+          bool    ret =
+            mixer_selections_action_perform_create (
+              PLUGIN_SLOT_INSERT,
+              track_get_name_hash (track), 1,
+              setting, num_plugins - 1, NULL);
+          g_assert_true (ret);
+        }
+      plugin_setting_free (setting);
+    }
+
+  g_assert_cmpint (
+    ROUTER->graph->scheduler_type, ==,
+    string_is_equal (scheduler, "work-stealing")
+      ? GRAPH_SCHEDULER_TYPE_WORK_STEALING
+      : GRAPH_SCHEDULER_TYPE_SHARED_QUEUE);
+
+  /* warm up */
+  for (int i = 0; i < 20; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  char * name = g_strdup_printf (
+    "%s scheduler (%d tracks x %d plugins)",
+    scheduler, num_tracks, num_plugins);
+  BENCHMARK_LOOP_START (name, NUM_ITERATIONS, 1)
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  BENCHMARK_LOOP_END;
+  g_free (name);
+
+  test_helper_zrythm_cleanup ();
+  g_unsetenv ("ZRYTHM_GRAPH_SCHEDULER");
+}
+
+static void
+test_schedulers (void)
+{
+  for (size_t i = 0; i < G_N_ELEMENTS (track_counts);
+       i++)
+    {
+      for (size_t j = 0;
+           j < G_N_ELEMENTS (plugin_counts); j++)
+        {
+          for (size_t k = 0;
+               k < G_N_ELEMENTS (schedulers); k++)
+            {
+              run_graph (
+                schedulers[k], track_counts[i],
+                plugin_counts[j]);
+            }
+        }
+    }
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/graph_scheduler/"
+
+  g_test_add_func (
+    TEST_PREFIX "test schedulers",
+    (GTestFunc) test_schedulers);
+  BENCHMARK_ADD_RESULT_TESTS (
+    TEST_PREFIX, "graph_scheduler");
+
+  return g_test_run ();
+}
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "audio/engine.h"
+#include "audio/recording_manager.h"
+#include "audio/transport.h"
+#include "project.h"
+#include "settings/plugin_settings.h"
+#include "utils/io.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include "tests/helpers/benchmark.h"
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include "guile/project_generator.h"
+
+/** Samples of the project load benchmarks. */
+#define NUM_LOAD_SAMPLES 3
+
+/** Samples of the engine cycle benchmarks. */
+#define NUM_CYCLES 500
+
+/** Total number of tracks in each session. */
+static const int track_counts[] = {
+  16,
+  64,
+  256,
+};
+
+/**
+ * Generates a session with half MIDI and half
+ * audio tracks, a bus for every 8 tracks, and
+ * measures how long it takes to load and process.
+ */
+static void
+run_session (int num_tracks)
+{
+  test_helper_zrythm_init ();
+
+  PluginSetting * setting =
+    test_plugin_manager_get_plugin_setting (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+
+  ProjectGeneratorParams params;
+  guile_project_generator_params_init (&params);
+  params.num_midi_tracks = num_tracks / 2;
+  params.num_audio_tracks = num_tracks / 2;
+  params.num_audio_busses = MAX (num_tracks / 8, 1);
+  params.sends_per_track = 2;
+  params.plugins_per_track = 2;
+  params.plugin_setting = setting;
+
+  char * prj_dir = g_dir_make_tmp (
+    "zrythm_benchmark_prj_gen_XXXXXX", NULL);
+  int ret =
+    guile_project_generator_generate_project_from_params (
+      &params, prj_dir);
+  g_assert_cmpint (ret, ==, 0);
+  plugin_setting_free (setting);
+
+  char * prj_file =
+    g_build_filename (prj_dir, PROJECT_FILE, NULL);
+  char * name = g_strdup_printf (
+    "project load (%d tracks)", num_tracks);
+  Benchmark * load_benchmark = benchmark_get (name);
+  g_free (name);
+  for (int i = 0; i < NUM_LOAD_SAMPLES; i++)
+    {
+      object_free_w_func_and_null (
+        project_free, PROJECT);
+
+      /* recreate the recording manager to drop
+       * any events */
+      object_free_w_func_and_null (
+        recording_manager_free,
+        ZRYTHM->recording_manager);
+      ZRYTHM->recording_manager =
+        recording_manager_new ();
+
+      benchmark_sample_start (load_benchmark, 1);
+      test_project_reload (prj_file);
+      benchmark_sample_end (load_benchmark);
+    }
+  g_free (prj_file);
+
+  test_project_stop_dummy_engine ();
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+
+  /* warm up */
+  for (int i = 0; i < 20; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  name = g_strdup_printf (
+    "engine cycle (%d tracks)", num_tracks);
+  BENCHMARK_LOOP_START (name, NUM_CYCLES, 1)
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  BENCHMARK_LOOP_END;
+  g_free (name);
+
+  test_helper_zrythm_cleanup ();
+
+  io_rmdir (prj_dir, true);
+  g_free (prj_dir);
+}
+
+static void
+test_session_scaling (void)
+{
+  for (size_t i = 0; i < G_N_ELEMENTS (track_counts);
+       i++)
+    {
+      run_session (track_counts[i]);
+    }
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/project_generator/"
+
+  g_test_add_func (
+    TEST_PREFIX "test session scaling",
+    (GTestFunc) test_session_scaling);
+  BENCHMARK_ADD_RESULT_TESTS (
+    TEST_PREFIX, "project_generator");
+
+  return g_test_run ();
+}
@@ -0,0 +1,524 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Benchmark helper.
+ *
+ * Collects timings and allocation counts of
+ * benchmarked operations, writes them as JSON and
+ * compares them against the results of a previous
+ * run.
+ *
+ * The following environment variables are used:
+ * - ZRYTHM_BENCHMARK_RESULTS_DIR: directory to
+ *   write the results to (defaults to the tests
+ *   build directory).
+ * - ZRYTHM_BENCHMARK_BASELINE_DIR: directory with
+ *   the results of a previous run to compare to.
+ * - ZRYTHM_BENCHMARK_THRESHOLD: allowed regression
+ *   in percent (defaults to 20).
+ */
+
+#ifndef __TEST_HELPERS_BENCHMARK_H__
+#define __TEST_HELPERS_BENCHMARK_H__
+
+#include "zrythm-test-config.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "utils/string.h"
+
+#include <glib.h>
+
+#include <json-glib/json-glib.h>
+
+/**
+ * @addtogroup tests
+ *
+ * @{
+ */
+
+/** Default allowed regression, in percent. */
+#define BENCHMARK_DEFAULT_THRESHOLD 20.0
+
+#define BENCHMARK_MAX_BENCHMARKS 400
+
+/**
+ * Measurements of a benchmarked operation.
+ */
+typedef struct Benchmark
+{
+  char * name;
+
+  /** Time per iteration of each sample, in
+   * nanoseconds. */
+  GArray * samples;
+
+  /** Iterations over all samples. */
+  gint64 num_iterations;
+
+  /** Allocations over all samples. */
+  gint64 num_allocations;
+
+  /** Start of the current sample. */
+  gint64 sample_start;
+  gint64 sample_allocations_start;
+  int    sample_iterations;
+} Benchmark;
+
+static Benchmark
+  benchmarks[BENCHMARK_MAX_BENCHMARKS];
+static int num_benchmarks = 0;
+
+/**
+ * Number of allocations made by the current
+ * thread.
+ *
+ * Only the allocations of the benchmarked thread
+ * are counted, so that allocations made
+ * concurrently by other threads (such as the glib
+ * worker threads) are not attributed to the
+ * benchmark. Allocations made by the DSP worker
+ * threads are not counted either.
+ */
+static _Thread_local gint64
+  benchmark_num_allocations = 0;
+
+#ifdef __GLIBC__
+/* count allocations by wrapping the allocator
+ * (the executable's definitions take precedence
+ * over libc's, including in the libraries) */
+extern void * __libc_malloc (size_t size);
+extern void *
+__libc_calloc (size_t nmemb, size_t size);
+extern void *
+__libc_realloc (void * ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+  benchmark_num_allocations++;
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  benchmark_num_allocations++;
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void * ptr, size_t size)
+{
+  benchmark_num_allocations++;
+  return __libc_realloc (ptr, size);
+}
+
+#  define BENCHMARK_COUNTS_ALLOCATIONS 1
+#else
+#  define BENCHMARK_COUNTS_ALLOCATIONS 0
+#endif
+
+/**
+ * Returns a monotonic time in nanoseconds.
+ */
+static inline gint64
+benchmark_get_time (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (gint64) ts.tv_sec * 1000000000
+         + (gint64) ts.tv_nsec;
+}
+
+/**
+ * Returns the benchmark with the given name,
+ * creating it if it does not exist.
+ */
+static Benchmark *
+benchmark_get (const char * name)
+{
+  for (int i = 0; i < num_benchmarks; i++)
+    {
+      if (string_is_equal (
+            benchmarks[i].name, name))
+        {
+          return &benchmarks[i];
+        }
+    }
+
+  g_return_val_if_fail (
+    num_benchmarks < BENCHMARK_MAX_BENCHMARKS,
+    NULL);
+  Benchmark * self = &benchmarks[num_benchmarks++];
+  self->name = g_strdup (name);
+  self->samples =
+    g_array_new (false, false, sizeof (double));
+
+  return self;
+}
+
+/**
+ * Starts measuring a sample of \p num_iterations
+ * iterations.
+ */
+static inline void
+benchmark_sample_start (
+  Benchmark * self,
+  int         num_iterations)
+{
+  self->sample_iterations = num_iterations;
+  self->sample_allocations_start =
+    benchmark_num_allocations;
+  self->sample_start = benchmark_get_time ();
+}
+
+/**
+ * Stops measuring the current sample.
+ */
+static inline void
+benchmark_sample_end (Benchmark * self)
+{
+  gint64 end = benchmark_get_time ();
+  gint64 allocations =
+    benchmark_num_allocations
+    - self->sample_allocations_start;
+
+  double ns =
+    (double) (end - self->sample_start)
+    / (double) self->sample_iterations;
+  g_array_append_val (self->samples, ns);
+  self->num_iterations += self->sample_iterations;
+  self->num_allocations += allocations;
+}
+
+/**
+ * Runs the code between this and
+ * BENCHMARK_LOOP_END() \p num_iterations times
+ * for each of the \p num_samples samples.
+ *
+ * The current iteration is available as \p i.
+ */
+#define BENCHMARK_LOOP_START( \
+  bench_name, num_samples, num_iterations) \
+  { \
+    Benchmark * _benchmark = \
+      benchmark_get (bench_name); \
+    for (int _sample = 0; _sample < num_samples; \
+         _sample++) \
+      { \
+        benchmark_sample_start ( \
+          _benchmark, num_iterations); \
+        for (int i = 0; i < num_iterations; i++) \
+          {
+
+#define BENCHMARK_LOOP_END \
+  } \
+  benchmark_sample_end (_benchmark); \
+  } \
+  }
+
+static int
+benchmark_cmp_doubles (
+  const void * a,
+  const void * b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+  return (da > db) - (da < db);
+}
+
+/**
+ * Returns the given percentile of the samples in
+ * nanoseconds.
+ */
+static double
+benchmark_get_percentile (
+  Benchmark * self,
+  double      percentile)
+{
+  if (self->samples->len == 0)
+    return 0.0;
+
+  g_array_sort (
+    self->samples, benchmark_cmp_doubles);
+  guint idx =
+    (guint) (percentile / 100.0
+               * (self->samples->len - 1)
+             + 0.5);
+  return g_array_index (self->samples, double, idx);
+}
+
+/**
+ * Returns the allocations per iteration.
+ */
+static double
+benchmark_get_allocations (Benchmark * self)
+{
+  if (self->num_iterations == 0)
+    return 0.0;
+
+  return (double) self->num_allocations
+         / (double) self->num_iterations;
+}
+
+static char *
+benchmark_get_results_path (
+  const char * dir,
+  const char * suite)
+{
+  char * filename =
+    g_strdup_printf ("%s.json", suite);
+  char * path =
+    g_build_filename (dir, filename, NULL);
+  g_free (filename);
+  return path;
+}
+
+/**
+ * Prints the results and writes them as JSON to
+ * <suite>.json in the results directory.
+ */
+static void
+benchmark_write_results (const char * suite)
+{
+  JsonBuilder * builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "suite");
+  json_builder_add_string_value (builder, suite);
+  json_builder_set_member_name (
+    builder, "counts_allocations");
+  json_builder_add_boolean_value (
+    builder, BENCHMARK_COUNTS_ALLOCATIONS);
+  json_builder_set_member_name (
+    builder, "benchmarks");
+  json_builder_begin_array (builder);
+  for (int i = 0; i < num_benchmarks; i++)
+    {
+      Benchmark * self = &benchmarks[i];
+      double      median =
+        benchmark_get_percentile (self, 50.0);
+      double p99 =
+        benchmark_get_percentile (self, 99.0);
+      double allocations =
+        benchmark_get_allocations (self);
+
+      fprintf (
+        stderr,
+        "---- %s ----\n"
+        "median: %.1fus\n"
+        "p99: %.1fus\n"
+        "allocations: %.2f\n",
+        self->name, median / 1000.0, p99 / 1000.0,
+        allocations);
+
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (
+        builder, "name");
+      json_builder_add_string_value (
+        builder, self->name);
+      json_builder_set_member_name (
+        builder, "samples");
+      json_builder_add_int_value (
+        builder, self->samples->len);
+      json_builder_set_member_name (
+        builder, "iterations");
+      json_builder_add_int_value (
+        builder, self->num_iterations);
+      json_builder_set_member_name (
+        builder, "median_ns");
+      json_builder_add_double_value (
+        builder, median);
+      json_builder_set_member_name (
+        builder, "p99_ns");
+      json_builder_add_double_value (builder, p99);
+      json_builder_set_member_name (
+        builder, "allocations");
+      json_builder_add_double_value (
+        builder, allocations);
+      json_builder_end_object (builder);
+    }
+  json_builder_end_array (builder);
+  json_builder_end_object (builder);
+
+  JsonGenerator * gen = json_generator_new ();
+  JsonNode *      root =
+    json_builder_get_root (builder);
+  json_generator_set_root (gen, root);
+  json_generator_set_pretty (gen, true);
+
+  const char * dir =
+    g_getenv ("ZRYTHM_BENCHMARK_RESULTS_DIR");
+  if (!dir)
+    dir = TESTS_BUILDDIR;
+  g_mkdir_with_parents (dir, 0755);
+  char * path =
+    benchmark_get_results_path (dir, suite);
+  GError * err = NULL;
+  bool     ret =
+    json_generator_to_file (gen, path, &err);
+  g_assert_no_error (err);
+  g_assert_true (ret);
+  g_message (
+    "benchmark results written to %s", path);
+
+  g_free (path);
+  json_node_free (root);
+  g_object_unref (gen);
+  g_object_unref (builder);
+}
+
+/**
+ * Fails the test if any benchmark regressed past
+ * the threshold compared to the baseline results,
+ * if any.
+ *
+ * Benchmarks missing from either side are
+ * ignored.
+ */
+static void
+benchmark_check_regressions (const char * suite)
+{
+  const char * dir =
+    g_getenv ("ZRYTHM_BENCHMARK_BASELINE_DIR");
+  if (!dir || strlen (dir) == 0)
+    {
+      g_test_skip ("no benchmark baseline given");
+      return;
+    }
+
+  double threshold = BENCHMARK_DEFAULT_THRESHOLD;
+  const char * threshold_str =
+    g_getenv ("ZRYTHM_BENCHMARK_THRESHOLD");
+  if (threshold_str && strlen (threshold_str) > 0)
+    {
+      threshold =
+        g_ascii_strtod (threshold_str, NULL);
+    }
+  double max_ratio = 1.0 + threshold / 100.0;
+
+  char * path =
+    benchmark_get_results_path (dir, suite);
+  if (!g_file_test (path, G_FILE_TEST_EXISTS))
+    {
+      g_test_skip ("no baseline for this suite");
+      g_free (path);
+      return;
+    }
+
+  JsonParser * parser = json_parser_new ();
+  GError *     err = NULL;
+  bool     ret =
+    json_parser_load_from_file (parser, path, &err);
+  g_assert_no_error (err);
+  g_assert_true (ret);
+
+  JsonObject * root_obj = json_node_get_object (
+    json_parser_get_root (parser));
+  bool baseline_counts_allocations =
+    json_object_get_boolean_member (
+      root_obj, "counts_allocations");
+  JsonArray * arr = json_object_get_array_member (
+    root_obj, "benchmarks");
+  for (guint i = 0; i < json_array_get_length (arr);
+       i++)
+    {
+      JsonObject * baseline =
+        json_array_get_object_element (arr, i);
+      const char * name =
+        json_object_get_string_member (
+          baseline, "name");
+      Benchmark * self = NULL;
+      for (int j = 0; j < num_benchmarks; j++)
+        {
+          if (string_is_equal (
+                benchmarks[j].name, name))
+            {
+              self = &benchmarks[j];
+              break;
+            }
+        }
+      if (!self)
+        continue;
+
+      double median =
+        benchmark_get_percentile (self, 50.0);
+      double baseline_median =
+        json_object_get_double_member (
+          baseline, "median_ns");
+      if (median > baseline_median * max_ratio)
+        {
+          g_test_message (
+            "%s: median regressed from %.1fus to "
+            "%.1fus",
+            name, baseline_median / 1000.0,
+            median / 1000.0);
+          g_test_fail ();
+        }
+
+      double p99 =
+        benchmark_get_percentile (self, 99.0);
+      double baseline_p99 =
+        json_object_get_double_member (
+          baseline, "p99_ns");
+      if (p99 > baseline_p99 * max_ratio)
+        {
+          g_test_message (
+            "%s: p99 regressed from %.1fus to "
+            "%.1fus",
+            name, baseline_p99 / 1000.0,
+            p99 / 1000.0);
+          g_test_fail ();
+        }
+
+      /* allocations where there were none (such as
+       * in the realtime paths) always fail */
+      if (
+        !BENCHMARK_COUNTS_ALLOCATIONS
+        || !baseline_counts_allocations)
+        continue;
+      double allocations =
+        benchmark_get_allocations (self);
+      double baseline_allocations =
+        json_object_get_double_member (
+          baseline, "allocations");
+      if (
+        allocations
+        > baseline_allocations * max_ratio)
+        {
+          g_test_message (
+            "%s: allocations regressed from %.2f "
+            "to %.2f",
+            name, baseline_allocations,
+            allocations);
+          g_test_fail ();
+        }
+    }
+
+  g_object_unref (parser);
+  g_free (path);
+}
+
+/**
+ * Adds tests that write the results and check
+ * them against the baseline.
+ *
+ * To be called after adding the benchmarks.
+ */
+#define BENCHMARK_ADD_RESULT_TESTS(prefix, suite) \
+  g_test_add_data_func ( \
+    prefix "write results", suite, \
+    (GTestDataFunc) benchmark_write_results); \
+  g_test_add_data_func ( \
+    prefix "check regressions", suite, \
+    (GTestDataFunc) benchmark_check_regressions)
+
+/**
+ * @}
+ */
+
+#endif
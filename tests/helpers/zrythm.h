@@ -38,6 +38,7 @@
 #include "utils/backtrace.h"
 #include "utils/cairo.h"
 #include "utils/datetime.h"
+#include "utils/dsp_simd.h"
 #include "utils/flags.h"
 #include "utils/io.h"
 #include "utils/log.h"
@@ -162,6 +163,8 @@ _test_helper_zrythm_init (
     zrythm_new (NULL, false, true, optimized);
   ZRYTHM->undo_stack_len = 64;
 
+  dsp_simd_init ();
+
   /* init logic - note: will use a random dir in
    * tmp as the user dire */
   zrythm_init_user_dirs_and_files (ZRYTHM);
@@ -111,6 +111,17 @@ _test (
   g_assert_cmpint (
     latency, ==, node->route_playback_latency);
 
+  /* recompile the graph while the plugin is
+   * running and check that the latency reported
+   * while processing is kept */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (pl->latency, ==, latency);
+  node = graph_find_node_from_track (
+    ROUTER->graph, track, false);
+  g_assert_true (node);
+  g_assert_cmpint (
+    latency, ==, node->route_playback_latency);
+
   /* 3. start playback */
   transport_request_roll (TRANSPORT, true);
 
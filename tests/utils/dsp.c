@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "utils/dsp_simd.h"
+
+#include <glib.h>
+
+#define MAX_SIZE 1031
+
+/* sizes around the vector widths to exercise the
+ * remainders */
+static const size_t sizes[] = {
+  0,  1,  3,  4,  5,  7,  8,  9,
+  15, 16, 17, 31, 33, 64, 67, 1031,
+};
+
+static void
+assert_bufs_close (
+  const float * expected,
+  const float * actual,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        expected[i], actual[i],
+        1e-6f * MAX (1.f, fabsf (expected[i])));
+    }
+}
+
+static void
+test_kernels_match_reference (void)
+{
+  const DspSimdFuncs * ref =
+    dsp_simd_get_funcs (DSP_SIMD_NONE);
+  g_assert_nonnull (ref);
+
+  float * src1 = g_new (float, MAX_SIZE);
+  float * src2 = g_new (float, MAX_SIZE);
+  float * expected = g_new (float, MAX_SIZE);
+  float * actual = g_new (float, MAX_SIZE);
+  for (size_t i = 0; i < MAX_SIZE; i++)
+    {
+      src1[i] = sinf ((float) i * 0.37f) * 3.f;
+      src2[i] = cosf ((float) i * 0.11f) * 1.5f;
+    }
+
+  for (int level = 1; level < NUM_DSP_SIMD_LEVELS;
+       level++)
+    {
+      const DspSimdFuncs * funcs =
+        dsp_simd_get_funcs ((DspSimdLevel) level);
+      if (!funcs)
+        continue;
+
+      g_message ("testing %s kernels", funcs->name);
+      g_assert_cmpint (funcs->level, ==, level);
+
+      for (size_t j = 0; j < G_N_ELEMENTS (sizes);
+           j++)
+        {
+          size_t size = sizes[j];
+
+#define RUN(func, ...) \
+  memcpy (expected, src2, size * sizeof (float)); \
+  memcpy (actual, src2, size * sizeof (float)); \
+  ref->func (expected, __VA_ARGS__); \
+  funcs->func (actual, __VA_ARGS__); \
+  assert_bufs_close (expected, actual, size)
+
+          RUN (fill, 0.3f, size);
+          RUN (limit1, -0.5f, 1.f, size);
+          RUN (add2, src1, size);
+          RUN (mul_k2, 0.7f, size);
+          RUN (mix2, src1, 0.7f, 0.3f, size);
+          RUN (mix_add2, src1, src1, 0.7f, 0.3f, size);
+          RUN (linear_fade, size, true);
+          RUN (linear_fade, size, false);
+          RUN (mul_ramp, 0.2f, 0.001f, size);
+          RUN (mix_ramp, src1, 0.2f, 0.001f, size);
+
+#undef RUN
+
+          g_assert_cmpfloat (
+            ref->abs_max (src1, size), ==,
+            funcs->abs_max (src1, size));
+          g_assert_cmpfloat (
+            ref->min (src1, size), ==,
+            funcs->min (src1, size));
+          g_assert_cmpfloat (
+            ref->max (src1, size), ==,
+            funcs->max (src1, size));
+          float true_peak = ref->true_peak (src1, size);
+          g_assert_cmpfloat_with_epsilon (
+            true_peak, funcs->true_peak (src1, size),
+            1e-6f * MAX (1.f, true_peak));
+        }
+    }
+
+  g_free (src1);
+  g_free (src2);
+  g_free (expected);
+  g_free (actual);
+}
+
+static void
+test_true_peak (void)
+{
+  const DspSimdFuncs * ref =
+    dsp_simd_get_funcs (DSP_SIMD_NONE);
+
+  /* a quarter of the sample rate sampled 45
+   * degrees off its peaks only reaches 0.707 */
+  float buf[MAX_SIZE];
+  for (size_t i = 0; i < MAX_SIZE; i++)
+    {
+      buf[i] =
+        sinf ((float) G_PI_2 * (float) i + (float) G_PI_4);
+    }
+  g_assert_cmpfloat_with_epsilon (
+    ref->abs_max (buf, MAX_SIZE), 0.7071f, 0.001f);
+  g_assert_cmpfloat_with_epsilon (
+    ref->true_peak (buf, MAX_SIZE), 1.f, 0.01f);
+
+  /* history only */
+  g_assert_cmpfloat (
+    ref->true_peak (buf, DSP_TRUE_PEAK_TAPS - 1), ==,
+    0.f);
+}
+
+static void
+test_init (void)
+{
+  dsp_simd_init ();
+  g_assert_true (
+    dsp_simd
+    == dsp_simd_get_funcs (dsp_simd->level));
+
+  /* the plain C kernels can be forced */
+  g_setenv ("ZRYTHM_DSP_SIMD", "none", true);
+  dsp_simd_init ();
+  g_assert_cmpint (dsp_simd->level, ==, DSP_SIMD_NONE);
+  g_unsetenv ("ZRYTHM_DSP_SIMD");
+  dsp_simd_init ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/dsp/"
+
+  g_test_add_func (
+    TEST_PREFIX "test kernels match reference",
+    (GTestFunc) test_kernels_match_reference);
+  g_test_add_func (
+    TEST_PREFIX "test true peak",
+    (GTestFunc) test_true_peak);
+  g_test_add_func (
+    TEST_PREFIX "test init",
+    (GTestFunc) test_init);
+
+  return g_test_run ();
+}
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: © 2022 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "utils/smoothed_value.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define BUF_SIZE 256
+#define RAMP_LEN 100
+
+static void
+fill_ones (float * buf)
+{
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = 1.f;
+    }
+}
+
+static void
+test_first_target_jumps (void)
+{
+  test_helper_zrythm_init ();
+
+  SmoothedValue val = { 0 };
+  float         buf[BUF_SIZE];
+  float *       bufs[] = { buf };
+
+  smoothed_value_set_target (
+    &val, 0.5f, SMOOTHED_VALUE_LINEAR, RAMP_LEN);
+  g_assert_true (smoothed_value_is_settled (&val));
+
+  fill_ones (buf);
+  smoothed_value_apply (&val, bufs, 1, BUF_SIZE);
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      g_assert_cmpfloat (buf[i], ==, 0.5f);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_linear_ramp (void)
+{
+  test_helper_zrythm_init ();
+
+  SmoothedValue val = { 0 };
+  float         buf[BUF_SIZE];
+  float *       bufs[] = { buf };
+
+  smoothed_value_reset (&val, 0.f);
+  smoothed_value_set_target (
+    &val, 1.f, SMOOTHED_VALUE_LINEAR, RAMP_LEN);
+
+  /* ramp across 2 cycles */
+  fill_ones (buf);
+  smoothed_value_apply (&val, bufs, 1, RAMP_LEN / 2);
+  g_assert_false (smoothed_value_is_settled (&val));
+  float * rest[] = { &buf[RAMP_LEN / 2] };
+  smoothed_value_apply (
+    &val, rest, 1, BUF_SIZE - RAMP_LEN / 2);
+  g_assert_true (smoothed_value_is_settled (&val));
+
+  for (size_t i = 0; i < RAMP_LEN; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        buf[i], (float) i / RAMP_LEN, 0.0001f);
+    }
+  for (size_t i = RAMP_LEN; i < BUF_SIZE; i++)
+    {
+      g_assert_cmpfloat (buf[i], ==, 1.f);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_exponential_ramp (void)
+{
+  test_helper_zrythm_init ();
+
+  SmoothedValue val = { 0 };
+  float         buf[BUF_SIZE];
+  float *       bufs[] = { buf };
+
+  smoothed_value_reset (&val, 0.01f);
+  smoothed_value_set_target (
+    &val, 1.f, SMOOTHED_VALUE_EXPONENTIAL, RAMP_LEN);
+  fill_ones (buf);
+  smoothed_value_apply (&val, bufs, 1, BUF_SIZE);
+  g_assert_true (smoothed_value_is_settled (&val));
+
+  /* -40 dB to 0 dB in 100 samples, so 0.4 dB
+   * per sample */
+  g_assert_cmpfloat_with_epsilon (
+    buf[SMOOTHED_VALUE_EXP_SEGMENT],
+    0.01f
+      * powf (
+        100.f,
+        (float) SMOOTHED_VALUE_EXP_SEGMENT / RAMP_LEN),
+    0.0001f);
+  for (size_t i = 1; i < RAMP_LEN; i++)
+    {
+      g_assert_cmpfloat (buf[i], >, buf[i - 1]);
+    }
+  g_assert_cmpfloat (buf[RAMP_LEN], ==, 1.f);
+
+  /* ramping to silence falls back to linear */
+  smoothed_value_set_target (
+    &val, 0.f, SMOOTHED_VALUE_EXPONENTIAL, RAMP_LEN);
+  g_assert_cmpint (
+    val.type, ==, SMOOTHED_VALUE_LINEAR);
+  fill_ones (buf);
+  smoothed_value_apply (&val, bufs, 1, BUF_SIZE);
+  g_assert_cmpfloat_with_epsilon (
+    buf[RAMP_LEN / 2], 0.5f, 0.0001f);
+  g_assert_cmpfloat (buf[RAMP_LEN], ==, 0.f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_mix_and_skip (void)
+{
+  test_helper_zrythm_init ();
+
+  SmoothedValue val = { 0 };
+  float         src[BUF_SIZE];
+  float         dest_l[BUF_SIZE];
+  float         dest_r[BUF_SIZE];
+  float *       dests[] = { dest_l, dest_r };
+  const float * srcs[] = { src, src };
+
+  fill_ones (src);
+  fill_ones (dest_l);
+  fill_ones (dest_r);
+
+  /* both buffers get the same ramp */
+  smoothed_value_reset (&val, 0.f);
+  smoothed_value_set_target (
+    &val, 1.f, SMOOTHED_VALUE_LINEAR, RAMP_LEN);
+  smoothed_value_mix (&val, dests, srcs, 2, BUF_SIZE);
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      g_assert_cmpfloat (dest_l[i], ==, dest_r[i]);
+    }
+  g_assert_cmpfloat_with_epsilon (
+    dest_l[RAMP_LEN / 2], 1.5f, 0.0001f);
+  g_assert_cmpfloat (dest_l[RAMP_LEN], ==, 2.f);
+
+  /* skipping advances the ramp */
+  smoothed_value_set_target (
+    &val, 0.f, SMOOTHED_VALUE_LINEAR, RAMP_LEN);
+  smoothed_value_skip (&val, RAMP_LEN / 2);
+  g_assert_cmpfloat_with_epsilon (
+    val.current, 0.5f, 0.0001f);
+  smoothed_value_skip (&val, RAMP_LEN);
+  g_assert_true (smoothed_value_is_settled (&val));
+  g_assert_cmpfloat (val.current, ==, 0.f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/smoothed_value/"
+
+  g_test_add_func (
+    TEST_PREFIX "test first target jumps",
+    (GTestFunc) test_first_target_jumps);
+  g_test_add_func (
+    TEST_PREFIX "test linear ramp",
+    (GTestFunc) test_linear_ramp);
+  g_test_add_func (
+    TEST_PREFIX "test exponential ramp",
+    (GTestFunc) test_exponential_ramp);
+  g_test_add_func (
+    TEST_PREFIX "test mix and skip",
+    (GTestFunc) test_mix_and_skip);
+
+  return g_test_run ();
+}